@@ -0,0 +1,99 @@
+#ifndef BYTE_CODEC_H
+#define BYTE_CODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+/**
+ * @brief Entiers variables (varint, zigzag) et valeurs petit-boutistes
+ *
+ * Partagés par l'enregistrement (sim_recording) et le protocole entre
+ * shards (shard_protocol): un varint occupe 1 octet sous 128, 3 octets
+ * pour un ID de sommet d'une grande région.
+ */
+
+inline void putVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value) | 0x80);
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+inline void putSigned(std::vector<uint8_t>& out, int64_t value) {
+    // Zigzag: 0, -1, 1, -2... -> 0, 1, 2, 3...
+    putVarint(out, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+template <typename T>
+inline void putFixed(std::vector<uint8_t>& out, T value) {
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        out.push_back(static_cast<uint8_t>(static_cast<uint64_t>(value) >> (8 * i)));
+    }
+}
+
+template <typename T>
+inline T getFixed(const uint8_t* data) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        value |= static_cast<uint64_t>(data[i]) << (8 * i);
+    }
+    return static_cast<T>(value);
+}
+
+// double copié bit à bit (relu à l'identique, contrairement aux valeurs quantifiées)
+inline void putDouble(std::vector<uint8_t>& out, double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    putFixed<uint64_t>(out, bits);
+}
+
+// Lecture bornée d'un tampon: toute lecture hors du tampon met ok à false
+struct ByteReader {
+    const uint8_t* data;
+    size_t size;
+    size_t pos;
+    bool ok = true;
+
+    uint8_t byte() {
+        if (pos >= size) {
+            ok = false;
+            return 0;
+        }
+        return data[pos++];
+    }
+    uint64_t varint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            const uint8_t b = byte();
+            value |= static_cast<uint64_t>(b & 0x7F) << shift;
+            if (!(b & 0x80)) return value;
+        }
+        ok = false;
+        return value;
+    }
+    int64_t signedVarint() {
+        const uint64_t z = varint();
+        return static_cast<int64_t>(z >> 1) ^ -static_cast<int64_t>(z & 1);
+    }
+    uint64_t fixed64() {
+        if (pos > size || size - pos < 8) {
+            ok = false;
+            pos = size;
+            return 0;
+        }
+        const uint64_t value = getFixed<uint64_t>(data + pos);
+        pos += 8;
+        return value;
+    }
+    double float64() {
+        const uint64_t bits = fixed64();
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+};
+
+#endif // BYTE_CODEC_H
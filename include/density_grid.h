@@ -0,0 +1,97 @@
+#ifndef DENSITY_GRID_H
+#define DENSITY_GRID_H
+
+#include <cstdint>
+#include <vector>
+#include "interference_graph.h"
+
+/**
+ * @brief Carte de densité de la flotte pour le rendu à faible zoom (LOD)
+ *
+ * Les véhicules sont regroupés dans des cellules de cellPixels × cellPixels
+ * pixels écran au niveau de zoom demandé (coordonnées Web Mercator, même
+ * projection que MapView): la grille ne dépend pas du déplacement de la
+ * vue, et un changement de zoom ne fait qu'agrandir ou réduire l'image
+ * jusqu'au tick suivant.
+ *
+ * Construite par le worker du graphe, juste après le graphe dont elle lit
+ * la connectivité; immuable une fois publiée. Chaque cellule garde le
+ * nombre de véhicules, la somme de leurs degrés et la plus grande
+ * composante connexe présente, et sa couleur est précalculée: teinte selon
+ * le degré moyen (rouge = isolés, vers cyan = bien connectés), opacité
+ * selon le nombre de véhicules (échelle logarithmique). Dessiner la carte
+ * coûte un drawImage, quel que soit le nombre de véhicules.
+ */
+class DensityGrid {
+public:
+    static constexpr int DEFAULT_CELL_PIXELS = 8;
+    static constexpr size_t MAX_CELLS = 1 << 20;  ///< Au-delà, les cellules sont agrandies
+
+    /**
+     * @brief Construit la carte des véhicules d'un snapshot
+     * @param snapshots Positions des véhicules
+     * @param graph Graphe construit à partir de ces snapshots (degrés, composantes)
+     * @param zoom Niveau de zoom de la vue (taille des cellules à l'écran)
+     * @param cellPixels Côté d'une cellule en pixels à ce zoom
+     */
+    static DensityGrid build(const std::vector<VehicleSnapshot>& snapshots, const InterferenceGraph& graph,
+                             int zoom, int cellPixels = DEFAULT_CELL_PIXELS);
+
+    /**
+     * @brief Position d'un point en pixels Web Mercator au niveau de zoom donné
+     * (tuiles de 256 pixels, comme MapView::lonlatToPixel)
+     */
+    static void lonLatToWorld(double lon, double lat, int zoom, double& px, double& py);
+
+    bool empty() const { return m_counts.empty(); }
+    int zoom() const { return m_zoom; }
+    int cellPixels() const { return m_cellPixels; }
+    int cols() const { return m_cols; }
+    int rows() const { return m_rows; }
+    // Coin haut-gauche de la cellule (0, 0) en pixels Web Mercator au zoom de la grille
+    double originX() const { return m_originX; }
+    double originY() const { return m_originY; }
+
+    /**
+     * @brief Cellule contenant un point (pixels Web Mercator au zoom de la grille)
+     * @return -1 hors de la grille
+     */
+    int cellAt(double px, double py) const;
+
+    uint32_t count(int cell) const { return m_counts[cell]; }
+    double meanDegree(int cell) const {
+        return m_counts[cell] > 0 ? static_cast<double>(m_degreeSums[cell]) / m_counts[cell] : 0.0;
+    }
+    // 0 si les composantes connexes n'ont pas été calculées
+    uint32_t largestComponent(int cell) const { return m_largestComponent[cell]; }
+    uint32_t maxCount() const { return m_maxCount; }
+    size_t vehicleCount() const { return m_vehicleCount; }
+
+    /**
+     * @brief Couleurs des cellules, ligne par ligne (0xAARRGGBB, non prémultiplié:
+     * directement utilisable comme QImage::Format_ARGB32)
+     */
+    const std::vector<uint32_t>& pixels() const { return m_pixels; }
+
+    double buildTimeMs() const { return m_buildTimeMs; }
+
+private:
+    void colorize();
+
+private:
+    int m_zoom = 0;
+    int m_cellPixels = DEFAULT_CELL_PIXELS;
+    int m_cols = 0;
+    int m_rows = 0;
+    double m_originX = 0.0;
+    double m_originY = 0.0;
+    std::vector<uint32_t> m_counts;
+    std::vector<uint32_t> m_degreeSums;
+    std::vector<uint32_t> m_largestComponent;
+    std::vector<uint32_t> m_pixels;
+    uint32_t m_maxCount = 0;
+    size_t m_vehicleCount = 0;
+    double m_buildTimeMs = 0.0;
+};
+
+#endif // DENSITY_GRID_H
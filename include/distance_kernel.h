@@ -0,0 +1,113 @@
+#ifndef DISTANCE_KERNEL_H
+#define DISTANCE_KERNEL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#if __cplusplus >= 202002L
+#include <bit>
+#elif defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/**
+ * @brief Positions projetées en mètres locaux, en float32 (une colonne par champ)
+ *
+ * Remplies une fois par construction du graphe: le test de portée d'une paire
+ * se réduit alors à x/y/portée contigus, sans cos() ni sqrt().
+ */
+struct ProjectedPositions {
+    std::vector<float> x;       ///< Est, en mètres depuis l'origine de la projection
+    std::vector<float> y;       ///< Nord, en mètres depuis l'origine de la projection
+    std::vector<float> range;   ///< Portée de transmission (m)
+
+    size_t size() const { return x.size(); }
+
+    void clear() {
+        x.clear();
+        y.clear();
+        range.clear();
+    }
+
+    void push(float px, float py, float r) {
+        x.push_back(px);
+        y.push_back(py);
+        range.push_back(r);
+    }
+
+    /**
+     * @brief Remplace le contenu par les lignes indices[k] de source (dans cet ordre)
+     */
+    void gather(const ProjectedPositions& source, const std::vector<int>& indices);
+};
+
+/**
+ * @brief Noyau vectoriel de test de portée mutuelle
+ *
+ * Un véhicule (x, y, portée) est testé contre un bloc de candidats contigus:
+ * dx² + dy² <= min(portée, portée candidat)². Selon la compilation, le bloc est
+ * traité par AVX2 (8 candidats à la fois), SSE2 ou NEON (4), ou en scalaire.
+ */
+namespace DistanceKernel {
+
+// Nombre maximal de candidats d'un bloc (un bit par candidat)
+constexpr size_t BLOCK_SIZE = 64;
+
+/**
+ * @brief Masque des candidats [0, count) à portée mutuelle, count <= BLOCK_SIZE
+ * @return Bit k à 1 si le candidat k est à portée
+ */
+uint64_t inRangeMask(float x, float y, float range,
+                     const float* xs, const float* ys, const float* ranges, size_t count);
+
+/**
+ * @brief Nom du jeu d'instructions utilisé ("AVX2", "SSE2", "NEON" ou "scalar")
+ */
+const char* backendName();
+
+/**
+ * @brief Indice du bit à 1 le plus faible (mask != 0)
+ */
+inline unsigned lowestSetBit(uint64_t mask) {
+#if __cplusplus >= 202002L
+    return static_cast<unsigned>(std::countr_zero(mask));
+#elif defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, mask);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctzll(mask));
+#endif
+}
+
+/**
+ * @brief Appelle fn(k) pour chaque candidat k de [0, count) à portée mutuelle
+ */
+template <typename Fn>
+inline void forEachInRange(float x, float y, float range,
+                           const float* xs, const float* ys, const float* ranges,
+                           size_t count, Fn&& fn) {
+    for (size_t base = 0; base < count; base += BLOCK_SIZE) {
+        const size_t blockCount = std::min(BLOCK_SIZE, count - base);
+        uint64_t mask = inRangeMask(x, y, range, xs + base, ys + base, ranges + base, blockCount);
+        while (mask != 0) {
+            fn(base + lowestSetBit(mask));
+            mask &= mask - 1;
+        }
+    }
+}
+
+// Même chose pour les candidats [first, last) d'une table de positions projetées
+template <typename Fn>
+inline void forEachInRange(float x, float y, float range, const ProjectedPositions& candidates,
+                           size_t first, size_t last, Fn&& fn) {
+    if (first >= last) return;
+    forEachInRange(x, y, range, candidates.x.data() + first, candidates.y.data() + first,
+                   candidates.range.data() + first, last - first,
+                   [&](size_t k) { fn(first + k); });
+}
+
+} // namespace DistanceKernel
+
+#endif // DISTANCE_KERNEL_H
@@ -0,0 +1,93 @@
+#ifndef GEO_PARTITION_H
+#define GEO_PARTITION_H
+
+#include <utility>
+#include <vector>
+#include "spatial_grid.h"
+
+/**
+ * @brief Découpage géographique de la carte en shards (simulation répartie)
+ *
+ * L'unité de découpage est la région d'une grande antenne: un point
+ * appartient à la région dont le centre est le plus proche (cellules de
+ * Voronoï), et chaque région à un seul shard. Les régions sont réparties
+ * par bissection récursive des coordonnées: l'ensemble est coupé
+ * perpendiculairement à son plus grand axe, au point qui équilibre le poids
+ * (nombre de véhicules) des deux moitiés, jusqu'à obtenir shardCount
+ * groupes de régions voisines.
+ *
+ * Les distances utilisent la projection équirectangulaire locale du
+ * graphe d'interférence (111 km par degré, cos de la latitude moyenne des
+ * centres). Immuable une fois construite: partagée en lecture par les shards.
+ */
+class GeoPartition {
+public:
+    struct Region {
+        int macroAntennaId = -1;
+        double lat = 0.0;
+        double lon = 0.0;
+        double weight = 0.0;   ///< Véhicules de la région au découpage
+        int shard = 0;
+    };
+
+    GeoPartition() = default;
+
+    /**
+     * @brief Découpe des centres pondérés en shardCount groupes
+     * @param centers Centres (lat, lon) des régions
+     * @param weights Poids des régions (même indice; vide = poids égaux)
+     * @param shardCount Nombre de shards (ramené au nombre de régions)
+     */
+    static GeoPartition fromCenters(const std::vector<std::pair<double, double>>& centers,
+                                    const std::vector<double>& weights, int shardCount);
+
+    /**
+     * @brief Régions = grandes antennes de la grille, pondérées par leurs véhicules
+     */
+    static GeoPartition fromSpatialGrid(const SpatialGrid& grid, int shardCount);
+
+    bool empty() const { return m_regions.empty(); }
+    int shardCount() const { return m_shardCount; }
+    const std::vector<Region>& regions() const { return m_regions; }
+
+    /**
+     * @brief Région dont le centre est le plus proche du point (-1 si vide)
+     */
+    int regionOf(double lat, double lon) const;
+
+    /**
+     * @brief Shard propriétaire d'un point (0 si la partition est vide)
+     */
+    int shardOf(double lat, double lon) const;
+
+    /**
+     * @brief Autres shards dont le territoire peut être à moins de marginMeters du point
+     * @param out Remplacé par les shards trouvés (croissants, sans le shard du point)
+     *
+     * Borne conservatrice: la distance au plan médiateur de deux centres
+     * minore la distance à la région d'en face. Un shard absent de la liste
+     * n'a donc aucun point à moins de marginMeters; un shard présent peut
+     * être un peu plus loin (coin de région).
+     */
+    void nearbyShards(double lat, double lon, double marginMeters, std::vector<int>& out) const;
+
+    /**
+     * @brief Poids total des régions de chaque shard
+     */
+    std::vector<double> shardWeights() const;
+
+private:
+    void project(double lat, double lon, double& x, double& y) const;
+    void bisect(std::vector<int>& regionIndices, size_t begin, size_t end, int firstShard, int shards);
+
+private:
+    std::vector<Region> m_regions;
+    std::vector<double> m_x;   // Centres projetés (m)
+    std::vector<double> m_y;
+    double m_originLat = 0.0;
+    double m_originLon = 0.0;
+    double m_metersPerDegLon = 0.0;
+    int m_shardCount = 0;
+};
+
+#endif // GEO_PARTITION_H
@@ -0,0 +1,140 @@
+#pragma once
+
+#ifdef V2V_OPENGL
+
+#include <QColor>
+#include <QOpenGLBuffer>
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLShaderProgram>
+#include <QOpenGLVertexArrayObject>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class InterferenceGraph;
+class VehicleStore;
+
+/**
+ * @brief Rendu OpenGL des routes, des connexions et des véhicules (option V2V_OPENGL)
+ *
+ * Utilisé par MapView quand elle est compilée en QOpenGLWidget. Les positions
+ * sont en Web Mercator normalisé ([0, 1]), relatives à une origine fixe pour
+ * rester précises en float jusqu'au zoom 20:
+ * - routes: VBO statique de segments, envoyé une seule fois (setRoads)
+ * - véhicules et rayons: quads instanciés depuis un tampon par image
+ *   (position, direction, rayon, couleur)
+ * - connexions directes: un seul lot de lignes par image
+ *
+ * Toutes les méthodes doivent être appelées avec le contexte OpenGL courant
+ * (initializeGL / paintGL, entre beginNativePainting et endNativePainting).
+ */
+class GpuMapLayer : protected QOpenGLExtraFunctions {
+public:
+    // Vue courante de la carte (mêmes conventions que MapView)
+    struct View {
+        int zoom;
+        double offsetX;          ///< Décalage monde -> écran (pixels)
+        double offsetY;
+        int width;               ///< Taille du widget (pixels logiques)
+        int height;
+        double devicePixelRatio;
+    };
+
+    // Options d'affichage des véhicules
+    struct VehicleStyle {
+        double size;             ///< Taille d'un véhicule (pixels)
+        bool darkTheme;
+        bool showRanges;
+        bool showConnections;
+    };
+
+    GpuMapLayer() = default;
+    ~GpuMapLayer();
+
+    /**
+     * @brief Compile les shaders et crée les tampons
+     * @return false si le contexte ne permet pas l'instanciation (MapView garde alors QPainter)
+     */
+    bool initialize();
+    bool isReady() const { return m_ready; }
+
+    /**
+     * @brief Envoie les segments de route au GPU (une fois, ou quand ils changent)
+     * @param segments Segments ayant des champs lon1, lat1, lon2, lat2
+     */
+    template <typename Segment>
+    void setRoads(const std::vector<Segment>& segments) {
+        std::vector<double> lonLat;
+        lonLat.reserve(segments.size() * 4);
+        for (const auto& seg : segments) {
+            lonLat.insert(lonLat.end(), {seg.lon1, seg.lat1, seg.lon2, seg.lat2});
+        }
+        uploadRoads(lonLat);
+    }
+    bool hasRoads() const { return m_roadVertexCount > 0; }
+
+    void drawRoads(const View& view, const QColor& color);
+
+    /**
+     * @brief Prépare l'image courante: instances des véhicules et lot des connexions
+     * @param store Positions courantes de la flotte
+     * @param connections Dernier graphe publié (nullptr = pas de connexions)
+     */
+    void prepareVehicles(const View& view, const VehicleStore& store,
+                         const InterferenceGraph* connections, const VehicleStyle& style);
+
+    // Rayons de transmission et connexions directes (sous les antennes)
+    void drawRangesAndConnections(const View& view, const VehicleStyle& style);
+
+    // Véhicules orientés (au-dessus des antennes)
+    void drawVehicles(const View& view, const VehicleStyle& style);
+
+private:
+    // Instance d'un quad: position relative à l'origine, direction, rayon en pixels, couleur
+    struct Instance {
+        float x;
+        float y;
+        float heading;   ///< Degrés, 0 = nord
+        float radius;    ///< Rayon de transmission (pixels), utilisé par les disques de portée
+        uint8_t rgba[4]; ///< Couleur
+    };
+
+    void uploadRoads(const std::vector<double>& lonLat);
+
+    // Position Web Mercator normalisée relative à l'origine
+    void project(double lon, double lat, float& x, float& y);
+
+    // Uniforms de vue communs aux deux programmes
+    void setViewUniforms(QOpenGLShaderProgram& program, const View& view);
+
+    void drawLines(QOpenGLVertexArrayObject& vao, int vertexCount, const View& view, const QColor& color);
+    void drawInstances(int mode, const View& view, double size);
+
+    bool m_ready = false;
+
+    // Origine de la projection (fixée au premier envoi de positions)
+    bool m_hasOrigin = false;
+    double m_originX = 0.0;
+    double m_originY = 0.0;
+
+    std::unique_ptr<QOpenGLShaderProgram> m_lineProgram;
+    std::unique_ptr<QOpenGLShaderProgram> m_spriteProgram;
+
+    QOpenGLVertexArrayObject m_roadVao;
+    QOpenGLBuffer m_roadVbo{QOpenGLBuffer::VertexBuffer};
+    int m_roadVertexCount = 0;
+
+    QOpenGLVertexArrayObject m_edgeVao;
+    QOpenGLBuffer m_edgeVbo{QOpenGLBuffer::VertexBuffer};
+
+    QOpenGLVertexArrayObject m_spriteVao;
+    QOpenGLBuffer m_cornerVbo{QOpenGLBuffer::VertexBuffer};
+    QOpenGLBuffer m_instanceVbo{QOpenGLBuffer::VertexBuffer};
+
+    // Tampons CPU réutilisés d'une image à l'autre
+    std::vector<Instance> m_instances;
+    std::vector<float> m_edgeVertices;
+    int m_edgeVertexCount = 0;
+};
+
+#endif // V2V_OPENGL
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <vector>
+#include <string>
+#include <utility>
+#include <cstdint>
 #include <unordered_map>
 #include <boost/graph/adjacency_list.hpp>
 #include "graph_types.h"    // pour RoadGraph, Vertex, Edge
@@ -17,12 +20,28 @@ public:
     // Calcule la distance géographique entre deux points (en mètres)
     static double distance(double lat1, double lon1, double lat2, double lon2);
 
+    // Précalcule les données dérivées du graphe: extrémités, direction unitaire
+    // et praticabilité de chaque arête, degré praticable de chaque sommet.
+    // Appelée par buildGraph; à rappeler après toute modification du graphe.
+    static void finalizeGraph(RoadGraph& graph);
+
+    // Charge le graphe depuis un cache binaire (RoadGraphCache) au lieu de le
+    // construire; retourne false si le cache est absent ou périmé
+    bool loadCache(const std::string& cachePath, uint64_t sourceHash);
+
+    // Écrit le graphe construit dans un cache binaire
+    bool saveCache(const std::string& cachePath, uint64_t sourceHash) const;
+
     // Affiche un résumé du graphe (nombre de sommets et d’arêtes)
     void printSummary() const;
 
     // Retourne une référence constante vers le graphe
     const RoadGraph& getGraph() const { return graph; }
 
+    // Tronçons praticables (from, to) avec from < to, chacun une seule fois:
+    // une route double sens a deux arêtes dans le graphe. Graphe finalisé.
+    static std::vector<std::pair<Vertex, Vertex>> drivableSegments(const RoadGraph& graph);
+
 private:
     const std::vector<OSMNode>& nodes;  // Référence vers les nœuds OSM
     const std::vector<OSMWay>& ways;    // Référence vers les routes OSM
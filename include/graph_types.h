@@ -1,18 +1,28 @@
 #pragma once
 #include <boost/graph/adjacency_list.hpp>
+#include "road_class.h"
 
 // Données attachées à chaque sommet (node OSM)
 struct VertexData {
     long id;        // identifiant OSM du point
     double lat;     // latitude
     double lon;     // longitude
+    int drivableOutDegree = 0;  // arêtes praticables incidentes (GraphBuilder::finalizeGraph)
 };
 
 // Données attachées à chaque arête (route entre deux sommets)
 struct EdgeData {
-    double distance;   // distance entre les deux sommets (en mètres)
-    bool oneway;       // true si la route est à sens unique
-    std::string type;  //highway type
+    double distance = 0.0;   // distance entre les deux sommets (en mètres)
+    bool oneway = false;     // true si la route est à sens unique
+    RoadClass roadClass = RoadClass::Other;  // highway type
+    bool drivable = false;  // isDrivableRoad(roadClass), précalculé
+    // Extrémités telles qu'insérées (le graphe est non orienté: boost::source
+    // dépend du sens de parcours) et direction unitaire projetée (est, nord)
+    // de from vers to. Remplis par GraphBuilder::finalizeGraph.
+    size_t from = 0;
+    size_t to = 0;
+    float dirEast = 0.0f;
+    float dirNorth = 0.0f;
 };
 
 // Définition du graphe Boost
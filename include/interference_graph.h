@@ -2,11 +2,14 @@
 #define INTERFERENCE_GRAPH_H
 
 #include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
 #include <unordered_map>
 #include <unordered_set>
-#include <queue>
 #include <mutex>
 #include "spatial_grid.h"
+#include "distance_kernel.h"
 
 class Vehicule;
 
@@ -19,20 +22,191 @@ struct VehicleSnapshot {
     int microAntennaId;  // ID de la petite antenne à laquelle ce véhicule appartient
 };
 
+/**
+ * @brief Connexion directe à plat, avec les positions des deux véhicules au
+ * moment du snapshot (chaque paire n'apparaît qu'une fois)
+ */
+struct DirectEdge {
+    int id1;
+    int id2;
+    double lon1;
+    double lat1;
+    double lon2;
+    double lat2;
+};
+
+// Liste d'arêtes (paires d'indices denses de véhicules) produite par un worker de construction
+using EdgeList = std::vector<std::pair<int, int>>;
+
+// Paires d'IDs de véhicules (id1 < id2), triées: connexions apparues ou disparues entre deux ticks
+using EdgeIdList = std::vector<std::pair<int, int>>;
+
+class VerletNeighborList;
+
 // Structure pour stocker les infos de voisinage d'antennes (thread-safe)
 struct AntennaNeighborhood {
     std::unordered_map<int, std::vector<int>> vehiclesPerAntenna;  // microAntennaId -> liste des indices de véhicules
-    std::unordered_map<int, std::set<int>> neighborAntennas;        // microAntennaId -> set des antennes voisines
+    std::unordered_map<int, std::vector<int>> neighborAntennas;     // microAntennaId -> antennes voisines (IDs triés)
+};
+
+/**
+ * @brief Méthode de recherche des paires candidates (broadphase)
+ * utilisée par buildGraphFromSnapshots
+ */
+enum class BroadphaseMode {
+    Antennas,     // Voisinages des micro-antennes K-means (AntennaNeighborhood)
+    UniformGrid   // Grille uniforme en mètres, reconstruite à chaque snapshot
+};
+
+/**
+ * @brief Vue (non propriétaire) sur les voisins directs d'un véhicule
+ *
+ * Pointe dans le tableau CSR du graphe (indices denses triés) et renvoie des IDs
+ * de véhicules à l'itération. Reste valide tant que le graphe n'est pas reconstruit.
+ * Expose le sous-ensemble de l'interface d'un std::unordered_set utilisé par
+ * l'interface graphique (begin/end, size, empty, find, count).
+ */
+class NeighborRange {
+public:
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = int;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const int*;
+        using reference = int;
+
+        const_iterator() = default;
+        const_iterator(const int* pos, const int* ids) : m_pos(pos), m_ids(ids) {}
+
+        int operator*() const { return m_ids[*m_pos]; }
+        const_iterator& operator++() { ++m_pos; return *this; }
+        const_iterator operator++(int) { const_iterator tmp = *this; ++m_pos; return tmp; }
+        bool operator==(const const_iterator& other) const { return m_pos == other.m_pos; }
+        bool operator!=(const const_iterator& other) const { return m_pos != other.m_pos; }
+
+        // Indice dense du voisin courant
+        int index() const { return *m_pos; }
+
+    private:
+        const int* m_pos = nullptr;
+        const int* m_ids = nullptr;
+    };
+    using iterator = const_iterator;
+
+    NeighborRange() = default;
+    NeighborRange(const int* begin, const int* end, const int* ids,
+                  const std::unordered_map<int, int>* idToIndex)
+        : m_begin(begin), m_end(end), m_ids(ids), m_idToIndex(idToIndex) {}
+
+    const_iterator begin() const { return const_iterator(m_begin, m_ids); }
+    const_iterator end() const { return const_iterator(m_end, m_ids); }
+    size_t size() const { return static_cast<size_t>(m_end - m_begin); }
+    bool empty() const { return m_begin == m_end; }
+
+    /**
+     * @brief Recherche un voisin par ID (recherche dichotomique, O(log degré))
+     * @return Itérateur sur le voisin, ou end() s'il est absent
+     */
+    const_iterator find(int vehicleId) const {
+        if (!m_idToIndex || empty()) return end();
+        auto it = m_idToIndex->find(vehicleId);
+        if (it == m_idToIndex->end()) return end();
+        const int* pos = std::lower_bound(m_begin, m_end, it->second);
+        if (pos == m_end || *pos != it->second) return end();
+        return const_iterator(pos, m_ids);
+    }
+
+    size_t count(int vehicleId) const { return find(vehicleId) != end() ? 1 : 0; }
+
+private:
+    const int* m_begin = nullptr;
+    const int* m_end = nullptr;
+    const int* m_ids = nullptr;
+    const std::unordered_map<int, int>* m_idToIndex = nullptr;
+};
+
+/**
+ * @brief Vue paresseuse sur les véhicules accessibles depuis un véhicule
+ *
+ * Parcourt la liste circulaire des membres de la composante connexe du véhicule
+ * (sans le véhicule lui-même). Aucune copie: size() et find() sont en O(1).
+ */
+class ReachableRange {
+public:
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = int;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const int*;
+        using reference = int;
+
+        const_iterator() = default;
+        const_iterator(int pos, const int* next, const int* ids) : m_pos(pos), m_next(next), m_ids(ids) {}
+
+        int operator*() const { return m_ids[m_pos]; }
+        const_iterator& operator++() { m_pos = m_next[m_pos]; return *this; }
+        const_iterator operator++(int) { const_iterator tmp = *this; ++(*this); return tmp; }
+        bool operator==(const const_iterator& other) const { return m_pos == other.m_pos; }
+        bool operator!=(const const_iterator& other) const { return m_pos != other.m_pos; }
+
+        // Indice dense du véhicule courant
+        int index() const { return m_pos; }
+
+    private:
+        int m_pos = -1;
+        const int* m_next = nullptr;
+        const int* m_ids = nullptr;
+    };
+    using iterator = const_iterator;
+
+    ReachableRange() = default;
+    ReachableRange(int start, int componentSize, const int* next, const int* ids,
+                   const int* componentOf, const std::unordered_map<int, int>* idToIndex)
+        : m_start(start), m_size(componentSize > 0 ? componentSize - 1 : 0), m_next(next),
+          m_ids(ids), m_componentOf(componentOf), m_idToIndex(idToIndex) {}
+
+    // La liste est circulaire: on s'arrête en revenant au véhicule de départ
+    const_iterator begin() const { return m_size == 0 ? end() : const_iterator(m_next[m_start], m_next, m_ids); }
+    const_iterator end() const { return const_iterator(m_start, m_next, m_ids); }
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    /**
+     * @brief Recherche un véhicule accessible par ID (comparaison de composantes, O(1))
+     * @return Itérateur sur le véhicule, ou end() s'il n'est pas accessible
+     */
+    const_iterator find(int vehicleId) const {
+        if (!m_idToIndex || empty()) return end();
+        auto it = m_idToIndex->find(vehicleId);
+        if (it == m_idToIndex->end() || it->second == m_start) return end();
+        if (m_componentOf[it->second] != m_componentOf[m_start]) return end();
+        return const_iterator(it->second, m_next, m_ids);
+    }
+
+    size_t count(int vehicleId) const { return find(vehicleId) != end() ? 1 : 0; }
+
+private:
+    int m_start = -1;
+    size_t m_size = 0;
+    const int* m_next = nullptr;
+    const int* m_ids = nullptr;
+    const int* m_componentOf = nullptr;
+    const std::unordered_map<int, int>* m_idToIndex = nullptr;
 };
 
 /**
  * @brief Graphe d'interférence pour gérer la communication entre véhicules
  * 
- * Ce graphe utilise une liste d'adjacence pour représenter les connexions
- * entre véhicules. Deux véhicules sont connectés si:
+ * Ce graphe stocke les connexions directes au format CSR (offsets + tableau
+ * de voisins, indexés par un indice dense de véhicule) entre véhicules. Deux véhicules sont connectés si:
  * 1. Ils sont dans la portée de transmission l'un de l'autre (connexion directe)
  * 2. Ils peuvent communiquer via d'autres véhicules (connexion transitive)
  *    Si A communique avec B et B avec C, alors A et C peuvent aussi communiquer
+ *
+ * Les connexions transitives sont représentées par les composantes connexes
+ * (union-find): un identifiant et une taille de composante par véhicule.
  */
 class InterferenceGraph {
 public:
@@ -44,7 +218,7 @@ public:
      * @param vehicles Liste de tous les véhicules dans la simulation
      * 
      * Étape 1: Connexions directes basées sur la portée de transmission
-     * Étape 2: Calcul de la fermeture transitive pour les connexions indirectes
+     * Étape 2: Calcul des composantes connexes pour les connexions indirectes
      */
     void buildGraph(const std::vector<Vehicule*>& vehicles);
     
@@ -56,6 +230,28 @@ public:
     void buildGraphFromSnapshots(const std::vector<VehicleSnapshot>& snapshots,
                                   const AntennaNeighborhood* antennaInfo = nullptr);
 
+    /**
+     * @brief Construit le graphe en ne retestant que les paires candidates
+     * des listes de Verlet (conservées d'un build à l'autre par l'appelant)
+     * @param snapshots Positions des véhicules
+     * @param neighbors Listes de voisins, reconstruites si un véhicule a trop bougé
+     *
+     * Le résultat est celui d'une construction complète; getAddedEdges() et
+     * getRemovedEdges() donnent en plus les différences avec le build précédent
+     * fait avec les mêmes listes.
+     */
+    void buildGraphIncremental(const std::vector<VehicleSnapshot>& snapshots, VerletNeighborList& neighbors);
+
+    /**
+     * @brief Construit le graphe à partir de connexions connues (relecture d'un enregistrement)
+     * @param snapshots Positions des véhicules
+     * @param edges Connexions directes (paires d'IDs); celles d'un véhicule absent sont ignorées
+     * @param added Connexions apparues, rendues par getAddedEdges()
+     * @param removed Connexions disparues, rendues par getRemovedEdges()
+     */
+    void buildGraphFromEdges(const std::vector<VehicleSnapshot>& snapshots, const EdgeIdList& edges,
+                             EdgeIdList added = {}, EdgeIdList removed = {});
+
     /**
      * @brief Copie les données d'un autre graphe (pour synchronisation thread-safe)
      * @param other Graphe source à copier
@@ -78,21 +274,72 @@ public:
     /**
      * @brief Obtient tous les véhicules avec lesquels un véhicule peut communiquer
      * @param vehicleId ID du véhicule
-     * @return Ensemble des IDs des véhicules accessibles
+     * @return Vue paresseuse sur les IDs des véhicules de sa composante (sans lui-même)
+     */
+    ReachableRange getReachableVehicles(int vehicleId) const;
+
+    /**
+     * @brief Identifiant de la composante connexe d'un véhicule
+     * @return -1 si le véhicule est inconnu
      */
-    std::unordered_set<int> getReachableVehicles(int vehicleId) const;
+    int getComponentId(int vehicleId) const;
+
+    /**
+     * @brief Taille de la composante connexe d'un véhicule (lui compris)
+     * @return 0 si le véhicule est inconnu
+     */
+    int getComponentSize(int vehicleId) const;
+
+    /**
+     * @brief Nombre de composantes connexes du graphe
+     */
+    int getComponentCount() const { return m_componentCount; }
+
+    /**
+     * @brief Fusionne incrémentalement les composantes de deux véhicules
+     * @param id1 ID du premier véhicule
+     * @param id2 ID du deuxième véhicule
+     * @return true si deux composantes distinctes ont été fusionnées
+     *
+     * À utiliser quand une arête apparaît entre deux ticks, sans reconstruire
+     * le graphe. Seule la plus petite composante est réétiquetée (O(petite taille)).
+     * Les voisins directs (CSR) ne sont pas modifiés.
+     */
+    bool connectVehicles(int id1, int id2);
 
     /**
      * @brief Obtient les voisins directs d'un véhicule (portée de transmission)
      * @param vehicleId ID du véhicule
-     * @return Ensemble des IDs des voisins directs
+     * @return Vue sur les IDs des voisins directs (vide si le véhicule est inconnu)
+     */
+    NeighborRange getDirectNeighbors(int vehicleId) const;
+
+    /**
+     * @brief Liste plate et dédoublonnée des connexions directes
+     *
+     * Construite avec le graphe (O(e)); permet de dessiner tous les liens en
+     * une passe sans rechercher les voisins de chaque véhicule.
+     */
+    const std::vector<DirectEdge>& getDirectEdges() const { return m_directEdges; }
+
+    /**
+     * @brief Connexions apparues / disparues depuis le graphe précédent
+     *
+     * Remplies par buildGraphIncremental uniquement (vides après une construction
+     * complète): un consommateur peut se mettre à jour en O(changements).
+     */
+    const EdgeIdList& getAddedEdges() const { return m_addedEdges; }
+    const EdgeIdList& getRemovedEdges() const { return m_removedEdges; }
+
+    /**
+     * @brief true si le dernier buildGraphIncremental a reconstruit les listes de voisins
      */
-    std::unordered_set<int> getDirectNeighbors(int vehicleId) const;
+    bool wasNeighborListRebuilt() const { return m_neighborListRebuilt; }
 
     /**
      * @brief Obtient le nombre de véhicules dans le graphe
      */
-    int getVehicleCount() const { return m_adjacencyList.size(); }
+    int getVehicleCount() const { return static_cast<int>(m_vehicleIds.size()); }
 
     /**
      * @brief Affiche les statistiques du graphe (pour debug)
@@ -110,6 +357,26 @@ public:
      */
     bool isSpatialOptimizationEnabled() const { return m_useSpatialGrid; }
 
+    /**
+     * @brief Choisit la broadphase utilisée par buildGraphFromSnapshots
+     * @param mode Antennas (défaut) ou UniformGrid
+     *
+     * En mode UniformGrid, le paramètre antennaInfo est ignoré.
+     */
+    void setBroadphaseMode(BroadphaseMode mode) { m_broadphaseMode = mode; }
+    BroadphaseMode getBroadphaseMode() const { return m_broadphaseMode; }
+
+    /**
+     * @brief Nombre de threads utilisés par buildGraphFromSnapshots
+     * @param threads 1 = séquentiel (défaut), <= 0 = nombre de cœurs
+     *
+     * Le travail est découpé par antenne (ou par cellule de la grille uniforme);
+     * chaque thread écrit ses arêtes dans son propre buffer, fusionné à la fin.
+     * Le résultat est identique à la construction séquentielle.
+     */
+    void setBuildThreadCount(int threads) { m_buildThreadCount = threads; }
+    int getBuildThreadCount() const { return m_buildThreadCount; }
+
     /**
      * @brief Obtient une référence constante à la grille spatiale
      */
@@ -132,6 +399,12 @@ public:
      */
     void reinitializeSpatialGrid(const std::vector<Vehicule*>& vehicles, int numMacro, int numMicro);
 
+    /**
+     * @brief Remplace la grille spatiale par une grille calculée ailleurs
+     * (placement K-means dans un thread séparé, voir Simulator::placeAntennas)
+     */
+    void adoptSpatialGrid(SpatialGrid&& grid);
+
     /**
      * @brief Assigne un véhicule à son antenne la plus proche
      * À appeler quand un nouveau véhicule est ajouté
@@ -144,6 +417,14 @@ public:
      */
     void removeVehicleFromAntenna(int vehicleId);
 
+    /**
+     * @brief Met à jour les antennes des véhicules ayant changé de cellule
+     * À appeler à chaque tick, avec les positions du VehicleStore
+     * @return Nombre de transferts (handoffs) effectués
+     */
+    int updateAntennaAssignments(const std::vector<int>& ids, const std::vector<double>& lats,
+                                 const std::vector<double>& lons);
+
     /**
      * @brief Met à jour la portée de transmission pour les calculs de voisinage
      * @param range Nouvelle portée en mètres
@@ -154,8 +435,12 @@ public:
     void updateTransmissionRange(double range);
 
     /**
-     * @brief Active ou désactive le calcul de la fermeture transitive
+     * @brief Active ou désactive la fermeture transitive
      * @param enable true pour activer, false pour désactiver
+     *
+     * Les composantes connexes sont toujours calculées (coût quasi linéaire);
+     * ce flag ne conditionne plus que la mise à jour des voisins de chaque
+     * Vehicule dans buildGraph.
      */
     void enableTransitiveClosure(bool enable) { m_computeTransitive = enable; }
 
@@ -166,17 +451,16 @@ public:
 
 private:
     /**
-     * @brief Calcule la fermeture transitive du graphe
-     * Utilise un BFS pour trouver tous les véhicules accessibles depuis chaque véhicule
+     * @brief Calcule les composantes connexes à partir de l'adjacence CSR
+     * Union-find sur les arêtes puis étiquetage à plat de chaque véhicule, O(n + e)
      */
-    void computeTransitiveClosure();
+    void computeComponents();
 
     /**
-     * @brief Effectue un BFS pour trouver tous les nœuds accessibles depuis un nœud source
-     * @param startId ID du véhicule de départ
-     * @return Ensemble des IDs des véhicules accessibles
+     * @brief computeComponents, dont la durée est gardée dans m_lastComponentsTimeMs
+     * et enregistrée par le profileur (étape Components)
      */
-    std::unordered_set<int> bfsReachable(int startId) const;
+    void computeComponentsTimed();
 
     /**
      * @brief Construit le graphe avec la méthode classique O(n²)
@@ -190,33 +474,127 @@ private:
      */
     void buildGraphWithSpatialGrid(const std::vector<Vehicule*>& vehicles);
 
+    /**
+     * @brief Projette les snapshots en mètres locaux (float32), une fois par construction
+     *
+     * Origine au centre de l'emprise, longitudes multipliées par le cos de la
+     * latitude centrale: tous les chemins de construction partagent ces
+     * coordonnées et le noyau DistanceKernel.
+     */
+    static void projectSnapshots(const std::vector<VehicleSnapshot>& snapshots, ProjectedPositions& projected);
+
+    /**
+     * @brief Connexions directes via une grille uniforme (cellule = portée max)
+     * @param snapshots Positions des véhicules
+     * @param projected Positions projetées (même indice que snapshots)
+     * @return Nombre de comparaisons de distance effectuées
+     *
+     * Les véhicules sont projetés en mètres puis triés par cellule (counting sort
+     * dans des tableaux plats, O(n)). Chaque véhicule n'est comparé qu'aux
+     * véhicules de son bloc de 3×3 cellules.
+     */
+    int64_t buildDirectEdgesUniformGrid(const std::vector<VehicleSnapshot>& snapshots,
+                                    const ProjectedPositions& projected);
+
+    /**
+     * @brief Connexions directes via les voisinages d'antennes
+     * @return Nombre de comparaisons de distance effectuées
+     */
+    int64_t buildDirectEdgesAntennas(const ProjectedPositions& projected,
+                                 const AntennaNeighborhood& antennaInfo);
+
+    /**
+     * @brief Connexions directes par comparaison de toutes les paires O(n²)
+     * @return Nombre de comparaisons de distance effectuées
+     */
+    int64_t buildDirectEdgesBruteForce(const ProjectedPositions& projected);
+
+    /**
+     * @brief Réinitialise la table ID <-> indice dense (et vide l'adjacence)
+     */
+    void resetIndex();
+
+    /**
+     * @brief Ajoute un véhicule à la table ID <-> indice dense
+     * @return Indice dense attribué
+     */
+    int addVertex(int vehicleId);
+
+    /**
+     * @brief Construit l'adjacence CSR à partir des arêtes produites par les workers
+     *
+     * Comptage des degrés, somme préfixe des offsets puis remplissage; chaque ligne
+     * est ensuite triée (pour find()) et dédoublonnée. Tout est fait en O(n + e)
+     * dans trois tableaux plats, sans allocation par nœud.
+     */
+    void buildAdjacency(const std::vector<EdgeList>& buffers);
+
+    /**
+     * @brief Remplit m_directEdges à partir du CSR (paires i < j) et des positions
+     */
+    void buildEdgeList();
+
 private:
-    // Liste d'adjacence pour les connexions directes (basées sur la portée)
-    std::unordered_map<int, std::unordered_set<int>> m_adjacencyList;
+    // Table ID <-> indice dense (ordre des snapshots / des véhicules)
+    std::vector<int> m_vehicleIds;                 // indice -> ID
+    std::unordered_map<int, int> m_idToIndex;      // ID -> indice
+    std::vector<double> m_vehicleLon;              // indice -> position au moment du build
+    std::vector<double> m_vehicleLat;
 
-    // Fermeture transitive: pour chaque véhicule, tous les véhicules accessibles
-    // (directement ou indirectement)
-    std::unordered_map<int, std::unordered_set<int>> m_transitiveClosure;
+    // Adjacence directe au format CSR: les voisins de l'indice i sont
+    // m_neighbors[m_offsets[i] .. m_offsets[i + 1]), triés par indice
+    std::vector<int> m_offsets;
+    std::vector<int> m_neighbors;
+
+    // Connexions directes à plat (getDirectEdges)
+    std::vector<DirectEdge> m_directEdges;
+
+    // Différences avec le build précédent (mode incrémental)
+    EdgeIdList m_addedEdges;
+    EdgeIdList m_removedEdges;
+    bool m_neighborListRebuilt = false;
+
+    // Composantes connexes (connexions transitives), indexées par indice dense:
+    // étiquette = indice du représentant, taille valide au représentant, et liste
+    // circulaire des membres de chaque composante (m_nextInComponent)
+    std::vector<int> m_componentOf;
+    std::vector<int> m_componentSize;
+    std::vector<int> m_nextInComponent;
+    int m_componentCount = 0;
 
     // Grille spatiale pour optimisation des calculs de distance
     SpatialGrid m_spatialGrid;
     bool m_useSpatialGrid;
     bool m_gridInitialized;  // Flag pour savoir si la grille a été initialisée
     bool m_computeTransitive; // Flag pour activer/désactiver la fermeture transitive
+    BroadphaseMode m_broadphaseMode = BroadphaseMode::Antennas;
+    int m_buildThreadCount = 1;
 
     // Map pour accéder rapidement aux véhicules par ID
     std::unordered_map<int, Vehicule*> m_vehicleMap;
     
     // Statistiques de performance (mis à jour à chaque buildGraph)
-    mutable int m_lastComparisons = 0;
+    mutable int64_t m_lastComparisons = 0;
     mutable double m_lastAvgNeighbors = 0.0;
     mutable double m_lastBuildTimeMs = 0.0;
+    mutable double m_lastComponentsTimeMs = 0.0;  // Part des composantes connexes dans le build
+
+    // Numéro du tick dont proviennent les positions (0 = graphe vide initial)
+    uint64_t m_tickSequence = 0;
     
 public:
     // Getters pour les statistiques de performance
-    int getLastComparisons() const { return m_lastComparisons; }
+    int64_t getLastComparisons() const { return m_lastComparisons; }
     double getLastAvgNeighbors() const { return m_lastAvgNeighbors; }
     double getLastBuildTimeMs() const { return m_lastBuildTimeMs; }
+    double getLastComponentsTimeMs() const { return m_lastComponentsTimeMs; }
+
+    /**
+     * @brief Numéro du tick de simulation dont ce graphe est issu
+     * Permet aux consommateurs de mesurer le retard du graphe sur la simulation
+     */
+    void setTickSequence(uint64_t sequence) { m_tickSequence = sequence; }
+    uint64_t getTickSequence() const { return m_tickSequence; }
 };
 
 #endif // INTERFERENCE_GRAPH_H
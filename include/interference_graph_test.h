@@ -26,6 +26,14 @@ public:
      */
     bool runAllTests();
 
+    /**
+     * @brief Lance les tests qui font tourner des Simulator (Qt)
+     *
+     * Définis dans shard_coordinator_test.cpp, hors de V2VMicrobench qui ne lie pas Qt.
+     * @return true si tous les tests passent, false sinon
+     */
+    bool runSimulatorTests();
+
     /**
      * @brief Affiche un rapport détaillé des résultats
      */
@@ -43,6 +51,26 @@ private:
     bool testAsymmetricRange();
     bool testCompleteGraph();
     bool testStarTopology();
+    bool testUniformGridMatchesBruteForce();
+    bool testParallelBuildMatchesSerial();
+    bool testComponentsMatchBfs();
+    bool testParallelVehicleUpdate();
+    bool testDrivableSegments();
+    bool testRoadGraphCache();
+    bool testRoutePlanner();
+    bool testRoadVertexIndex();
+    bool testSpatialGridHandoff();
+    bool testDistanceKernel();
+    bool testDirectEdgeList();
+    bool testProfiler();
+    bool testIncrementalGraph();
+    bool testKMeansPlacement();
+    bool testRecordingReplay();
+    bool testMessagePropagation();
+    bool testVehiclePool();
+    bool testDensityGrid();
+    bool testGeoSharding();
+    bool testShardedRun();
 
     // Fonctions utilitaires
     void printTestHeader(const std::string& testName) const;
@@ -53,6 +81,16 @@ private:
     Vehicule* createTestVehicle(int id, double lat, double lon, double range);
     void cleanupVehicles(std::vector<Vehicule*>& vehicles);
 
+    // Snapshots pseudo-aléatoires (graine fixe) autour de Strasbourg
+    std::vector<VehicleSnapshot> createRandomSnapshots(int count, double spanDeg, unsigned seed) const;
+
+    // Quadrillage routier side × side (~110 m entre carrefours) autour de Strasbourg
+    RoadGraph createRoadGrid(int side) const;
+
+    // Compare les voisins directs de deux graphes pour tous les snapshots
+    bool sameDirectNeighbors(const InterferenceGraph& a, const InterferenceGraph& b,
+                             const std::vector<VehicleSnapshot>& snapshots) const;
+
 private:
     // Statistiques des tests
     int m_totalTests;
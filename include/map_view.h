@@ -5,29 +5,56 @@
 #include <QHash>
 #include <QCache>
 #include <QNetworkAccessManager>
+#include <QNetworkDiskCache>
 #include <QNetworkReply>
+#include <QNetworkRequest>
 #include <QPointer>
 #include <QTimer>
+#include <algorithm>
+#include <memory>
 #include <vector>
 
+#ifdef V2V_OPENGL
+#include <QOpenGLWidget>
+#endif
+
 class Simulator;
 class UIOverlay;
 class Vehicule;
+class InterferenceGraph;
+class GpuMapLayer;
+class DensityGrid;
 
+// Tuile identifiée par des entiers (thème, zoom, x, y) plutôt que par son URL
 struct TileKey {
     int z;
     int x;
     int y;
-    bool operator==(const TileKey& o) const noexcept { return z==o.z && x==o.x && y==o.y; }
+    bool dark = true;
+    bool operator==(const TileKey& o) const noexcept { return z==o.z && x==o.x && y==o.y && dark==o.dark; }
+
+    // Clé du cache mémoire: x et y < 2^20 jusqu'au zoom 20
+    quint64 packed() const noexcept {
+        return (quint64(dark) << 62) | (quint64(z) << 48) | (quint64(x) << 24) | quint64(y);
+    }
 };
 inline uint qHash(const TileKey &k, uint seed=0) noexcept {
-    return qHash((k.z*73856093) ^ (k.x*19349663) ^ (k.y*83492791), seed);
+    return qHash(k.packed(), seed);
 }
 
-class MapView : public QWidget {
+// Avec V2V_OPENGL, la carte est un QOpenGLWidget: routes, rayons, connexions et
+// véhicules passent par GpuMapLayer, le reste (tuiles, antennes, HUD) par QPainter
+#ifdef V2V_OPENGL
+using MapViewBase = QOpenGLWidget;
+#else
+using MapViewBase = QWidget;
+#endif
+
+class MapView : public MapViewBase {
     Q_OBJECT
 public:
     explicit MapView(QWidget* parent=nullptr);
+    ~MapView() override;
 
     // Image test (fallback offline)
     bool loadImage(const QString& path);
@@ -42,6 +69,11 @@ public:
     void setNetworkIdentity(const QString& ua, const QString& ref) { m_userAgent = ua; m_referer = ref; }
     void setRequestRateLimitMs(qint64 ms) { m_minRequestIntervalMs = ms; }
 
+    // Cache disque des tuiles (conservé entre deux lancements, lu hors ligne)
+    void setDiskCacheDirectory(const QString& path, qint64 maxBytes = 512LL * 1024 * 1024);
+    // Nombre maximum de téléchargements simultanés (visibles d'abord, puis préchargement)
+    void setMaxInflightRequests(int count) { m_maxInflightRequests = std::max(1, count); }
+
     //getter
     int zoomLevel() const { return m_zoom; }
     double centerLon() const;
@@ -66,7 +98,12 @@ signals:
     void cursorInfoChanged(const QString& text);
 
 protected:
+#ifdef V2V_OPENGL
+    void initializeGL() override;
+    void paintGL() override;
+#else
     void paintEvent(QPaintEvent* ev) override;
+#endif
     void wheelEvent(QWheelEvent* ev) override;
     void mousePressEvent(QMouseEvent* ev) override;
     void mouseMoveEvent(QMouseEvent* ev) override;
@@ -87,6 +124,9 @@ private:
     bool m_drawDirectConnections = true;
     bool m_showRanges = true;
     bool m_showRoads = false;
+    bool m_densityLod = true;  // Carte de densité au lieu des véhicules quand m_zoom <= LOD_MAX_ZOOM
+    static constexpr int LOD_MAX_ZOOM = 13;
+    std::vector<int> m_visibleRows;  // Lignes du store visibles à l'écran (réutilisé d'une image à l'autre)
     
     // ---- Cache pour les routes (optimisation) ----
     struct RoadSegment {
@@ -95,6 +135,10 @@ private:
     std::vector<RoadSegment> m_validRoads;  // Pré-calculé une fois
     bool m_roadsPrecomputed = false;
 
+    // ---- Rendu OpenGL (option V2V_OPENGL, nullptr sinon ou si indisponible) ----
+    std::unique_ptr<GpuMapLayer> m_gpuLayer;
+    bool m_gpuRoadsUploaded = false;
+
     // ---- Toggle low quality tiles mode ----
     bool m_lowQualityMode = true;
 
@@ -106,12 +150,24 @@ private:
     // ---- Tuiles XYZ ----
     QString m_tilesTemplate;
     QNetworkAccessManager m_net;
-    QCache<QString, QPixmap> m_darkCache;                  // Cache pour tuiles sombres
-    QCache<QString, QPixmap> m_lightCache;                 // Cache pour tuiles claires
+    QNetworkDiskCache* m_diskCache = nullptr;              // Possédé par m_net
+    QCache<quint64, QPixmap> m_darkCache;                  // Cache pour tuiles sombres (clé TileKey::packed)
+    QCache<quint64, QPixmap> m_lightCache;                 // Cache pour tuiles claires
     QHash<TileKey, QPointer<QNetworkReply>> m_inflight;    // téléchargements en cours
+    QHash<TileKey, bool> m_onDisk;                         // Présence au cache disque, sondée une fois par tuile
+
+    // File d'attente reconstruite à chaque image: tuiles visibles puis préchargement
+    struct TileRequest {
+        TileKey key;
+        bool visible;
+    };
+    std::vector<TileRequest> m_tileQueue;
+    int m_maxInflightRequests = 6;
+    bool m_tilePumpScheduled = false;
     
-    // Helper pour obtenir le cache actif selon le thème
-    QCache<QString, QPixmap>& getActiveCache() { return m_darkTheme ? m_darkCache : m_lightCache; }
+    // Helper pour obtenir le cache d'un thème
+    QCache<quint64, QPixmap>& cacheFor(bool dark) { return dark ? m_darkCache : m_lightCache; }
+    QCache<quint64, QPixmap>& getActiveCache() { return cacheFor(m_darkTheme); }
 
     // ---- Vue ----
     int m_zoom = 13;
@@ -123,7 +179,7 @@ private:
     QPoint m_pressPos;  // Position initiale du clic
     
     // ---- Suivi de véhicule ----
-    Vehicule* m_trackedVehicle = nullptr;  // Véhicule suivi par la caméra
+    int m_trackedVehicleId = -1;           // ID du véhicule suivi par la caméra (-1 = aucun)
     bool m_followingVehicle = false;       // True si on suit un véhicule
 
     // ---- Réseau (option) ----
@@ -136,9 +192,25 @@ private:
 
     static void pixelToLonlat(double px, double py, int z, double& lonDeg, double& latDeg);
     void zoomAt(const QPoint& screenPos, double factor);
+    void renderFrame();
     void drawTiles(QPainter& p);
     void drawHUD(QPainter& p);
-    void requestTile(int z,int x,int y);
+    // Carte de densité publiée par le simulateur, mise à l'échelle du zoom courant
+    void drawDensityMap(QPainter& p, const DensityGrid& grid);
+
+    // Passes OpenGL: renvoient false si le rendu GPU n'est pas actif (repli QPainter)
+    bool drawRoadsGpu(QPainter& p);
+    bool drawRangesAndConnectionsGpu(QPainter& p, const InterferenceGraph& connections, double vehicleSize);
+    bool drawVehiclesGpu(QPainter& p, double vehicleSize);
+    // Tuiles: niveau de zoom des tuiles et plage couverte par une vue
+    int tileZoomFor(int zoom) const;
+    void tileRange(int zoom, double offsetX, double offsetY, int tileZoom,
+                   int& x0, int& y0, int& x1, int& y1) const;
+    void queueTile(const TileKey& key, bool visible);
+    void pumpTileRequests();
+    bool isTileOnDisk(const TileKey& key, const QString& url);
+    void startTileRequest(const TileRequest& request, const QString& url,
+                          QNetworkRequest::CacheLoadControl cacheControl);
     QString buildUrl(int z,int x,int y) const;
     void setCenterWorld(double px, double py, int zoom);
 
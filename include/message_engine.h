@@ -0,0 +1,214 @@
+#ifndef MESSAGE_ENGINE_H
+#define MESSAGE_ENGINE_H
+
+#include <cstdint>
+#include <queue>
+#include <random>
+#include <vector>
+#include "interference_graph.h"
+
+/**
+ * @brief Stratégie de retransmission d'un message reçu pour la première fois
+ */
+enum class PropagationStrategy {
+    Flooding,  ///< Chaque véhicule retransmet (inondation)
+    Gossip     ///< Chaque véhicule retransmet avec une probabilité fixe
+};
+
+/**
+ * @brief Paramètres du canal et du protocole
+ */
+struct MessageEngineConfig {
+    PropagationStrategy strategy = PropagationStrategy::Flooding;
+    double gossipProbability = 0.6;   ///< Probabilité de retransmission (Gossip)
+    int maxHops = 8;                  ///< Sauts au-delà desquels un message n'est plus retransmis (TTL)
+    double airtimeMs = 0.5;           ///< Occupation du canal de l'émetteur par une diffusion
+    double hopDelayMs = 2.0;          ///< Délai de propagation et de traitement d'une diffusion
+    double hopJitterMs = 1.0;         ///< Gigue uniforme ajoutée au délai d'une diffusion
+    double lossProbability = 0.05;    ///< Perte indépendante de chaque réception
+    int inboxCapacity = 16;           ///< Derniers messages conservés par véhicule
+    double histogramBinMs = 5.0;      ///< Largeur d'une classe de l'histogramme des latences
+    uint64_t seed = 42;
+};
+
+/**
+ * @brief Statistiques cumulées depuis le dernier resetStats()
+ */
+struct MessageStats {
+    static constexpr int HISTOGRAM_BINS = 32;  ///< La dernière classe regroupe les latences plus longues
+
+    uint64_t messagesCreated = 0;
+    uint64_t messagesCompleted = 0;   ///< Messages dont plus aucune réception n'est en attente
+    uint64_t transmissions = 0;       ///< Diffusions (origine + retransmissions)
+    uint64_t deliveries = 0;          ///< Premières réceptions
+    uint64_t duplicates = 0;          ///< Réceptions d'un message déjà reçu
+    uint64_t lost = 0;                ///< Réceptions perdues sur le canal
+    uint64_t events = 0;              ///< Événements traités (un par diffusion)
+    double reachSum = 0.0;            ///< Somme des portées (fraction de la flotte) des messages terminés
+    double latencySumMs = 0.0;        ///< Somme des latences de première réception
+    double histogramBinMs = 5.0;
+    uint64_t latencyHistogram[HISTOGRAM_BINS] = {};
+
+    // Fraction moyenne de la flotte atteinte par un message terminé
+    double meanReach() const { return messagesCompleted > 0 ? reachSum / messagesCompleted : 0.0; }
+    double meanLatencyMs() const { return deliveries > 0 ? latencySumMs / deliveries : 0.0; }
+    // Part des réceptions qui n'apportent rien (message déjà reçu)
+    double duplicateRate() const {
+        const uint64_t received = deliveries + duplicates;
+        return received > 0 ? static_cast<double>(duplicates) / received : 0.0;
+    }
+    // Percentile des latences (borne haute de la classe qui le contient)
+    double latencyPercentileMs(double p) const;
+};
+
+/**
+ * @brief Dernier message reçu par un véhicule
+ */
+struct InboxEntry {
+    uint64_t messageId = 0;
+    int originId = -1;
+    int fromId = -1;       ///< Véhicule qui a retransmis le message
+    int hops = 0;
+    double latencyMs = 0.0;
+};
+
+/**
+ * @brief Propagation de messages V2V à événements discrets
+ *
+ * Un message part d'un véhicule et saute de voisin direct en voisin direct
+ * du graphe d'interférence. Chaque diffusion occupe le canal de l'émetteur
+ * pendant airtimeMs (les diffusions d'un même véhicule sont mises en file),
+ * puis atteint tous ses voisins après hopDelayMs + gigue, chaque réception
+ * pouvant être perdue indépendamment. Une diffusion ne coûte qu'un
+ * événement (sa réception), quel que soit le nombre de voisins.
+ * À la première réception, le véhicule range le message dans sa boîte de
+ * réception et le retransmet selon la stratégie, tant que maxHops n'est pas
+ * atteint; les réceptions suivantes sont comptées comme doublons.
+ *
+ * Les événements sont ordonnés par (instant, numéro d'émission) dans une file
+ * de priorité: à graine égale, le résultat ne dépend que des graphes fournis.
+ * Les messages en cours et leurs ensembles de véhicules atteints sont
+ * recyclés (pool) pour éviter les allocations à chaque message.
+ *
+ * Les voisins d'une diffusion sont ceux du graphe passé à advanceTo() au
+ * moment de la réception. Utilisé depuis un seul thread.
+ */
+class MessageEngine {
+public:
+    explicit MessageEngine(const MessageEngineConfig& config = MessageEngineConfig());
+
+    void setConfig(const MessageEngineConfig& config);
+    const MessageEngineConfig& config() const { return m_config; }
+
+    /**
+     * @brief Crée un message diffusé par un véhicule à l'instant courant
+     * @param originId ID du véhicule émetteur (>= 0)
+     * @param fleetSize Nombre de véhicules, pour la portée du message
+     * @return Identifiant du message
+     */
+    uint64_t broadcast(int originId, size_t fleetSize);
+
+    /**
+     * @brief Crée count messages depuis des véhicules tirés au hasard
+     */
+    void broadcastRandom(const std::vector<int>& vehicleIds, int count);
+
+    /**
+     * @brief Traite tous les événements jusqu'à timeMs (temps simulé)
+     * @param timeMs Nouvel instant courant (croissant)
+     * @param graph Connexions directes à utiliser pour les diffusions
+     * @return Nombre d'événements traités
+     */
+    size_t advanceTo(double timeMs, const InterferenceGraph& graph);
+
+    double now() const { return m_now; }
+    size_t activeMessages() const { return m_active; }
+    size_t pendingEvents() const { return m_events.size(); }
+
+    const MessageStats& stats() const { return m_stats; }
+    void resetStats();
+
+    /**
+     * @brief Derniers messages reçus par un véhicule, du plus ancien au plus récent
+     */
+    std::vector<InboxEntry> inbox(int vehicleId) const;
+
+    /**
+     * @brief Oublie les messages en cours, les boîtes de réception et les statistiques
+     */
+    void clear();
+
+private:
+    // Un message en cours (emplacement du pool)
+    struct Message {
+        uint64_t id = 0;
+        int originId = -1;
+        double createdMs = 0.0;
+        size_t fleetSize = 0;
+        size_t reached = 0;             // Véhicules atteints (origine exclue)
+        size_t pending = 0;             // Événements en attente
+        std::vector<uint64_t> seen;     // Bit par ID de véhicule (capacité conservée par le pool)
+    };
+
+    // Réception d'une diffusion par les voisins de l'émetteur
+    struct Event {
+        double timeMs;
+        uint64_t sequence;   // Départage les événements simultanés (ordre d'émission)
+        uint32_t slot;       // Emplacement du message dans le pool
+        int senderId;
+        int hops;            // Sauts effectués par le message à la réception
+
+        bool operator>(const Event& other) const {
+            return timeMs != other.timeMs ? timeMs > other.timeMs : sequence > other.sequence;
+        }
+    };
+
+    uint32_t acquireMessage();
+    void releaseMessage(uint32_t slot);
+    void finishEvent(uint32_t slot);
+
+    // Marque vehicleId comme atteint; false s'il l'était déjà
+    bool markSeen(Message& message, int vehicleId);
+
+    // Diffusion immédiate: réserve le canal de l'émetteur et planifie la réception
+    void transmit(uint32_t slot, int sender, int hops);
+    void deliver(const Event& event, const InterferenceGraph& graph);
+    void storeInInbox(int vehicleId, const InboxEntry& entry);
+
+    // Tirage de Bernoulli sur un entier brut du générateur (pas de conversion en double)
+    static uint64_t probabilityThreshold(double p);
+    bool draw(uint64_t threshold) { return threshold == UINT64_MAX || m_rng() < threshold; }
+
+    // true si la réception courante est perdue
+    bool nextReceptionLost();
+    void drawNextLoss();
+
+private:
+    MessageEngineConfig m_config;
+    std::mt19937_64 m_rng;
+    std::uniform_real_distribution<double> m_unit{0.0, 1.0};
+    // Pertes: nombre de réceptions avant la prochaine perte, tiré selon une loi
+    // géométrique (un tirage par perte au lieu d'un par réception)
+    uint64_t m_receptionsUntilLoss = 0;
+    uint64_t m_gossipThreshold = 0;   // m_rng() < seuil <=> retransmission (Gossip)
+
+    double m_now = 0.0;
+    uint64_t m_nextMessageId = 1;
+    uint64_t m_nextSequence = 0;
+
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event>> m_events;
+
+    // Pool de messages: emplacements réutilisés via la liste libre
+    std::vector<Message> m_messages;
+    std::vector<uint32_t> m_freeSlots;
+    size_t m_active = 0;
+
+    // Par ID de véhicule: fin d'occupation du canal, boîte de réception circulaire
+    std::vector<double> m_channelFreeMs;
+    std::vector<InboxEntry> m_inboxes;      // inboxCapacity entrées par véhicule
+    std::vector<uint32_t> m_inboxCounts;    // Messages reçus (la tête est count % capacité)
+
+    MessageStats m_stats;
+};
+
+#endif // MESSAGE_ENGINE_H
@@ -1,6 +1,7 @@
 #pragma once
 #include <vector>
 #include <string>
+#include "road_class.h"
 
 struct OSMNode {
     long id;
@@ -10,21 +11,32 @@ struct OSMNode {
 
 struct OSMWay {
     long id;
-    std::vector<long> nodeRefs;
+    std::vector<long> nodeRefs;   // dans le sens de circulation si oneway
     bool oneway;
-    std::string highwayType;
+    RoadClass roadClass;          // tag highway converti à la lecture
 };
 
 class OSMReader {
 public:
-    explicit OSMReader(const std::string& filePath);
+    // Full: tous les nodes et ways du fichier
+    // DrivableOnly: deux passes, seules les routes praticables et leurs nodes
+    enum class ReadMode { Full, DrivableOnly };
+
+    explicit OSMReader(const std::string& filePath, ReadMode mode = ReadMode::Full);
     void read();             // lit et stocke les données
     void printSummary() const; // affiche un résumé
 
+    // Threads de décodage PBF (<= 0 = nombre de cœurs)
+    void setThreadCount(int count) { threadCount = count; }
+
     std::vector<OSMNode> nodes;
     std::vector<OSMWay> ways;
 
 private:
+    void readFull();
+    void readDrivable();
+
     std::string filePath;
+    ReadMode mode;
+    int threadCount = 0;
 };
-
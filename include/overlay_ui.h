@@ -10,6 +10,7 @@
 #include <QGraphicsOpacityEffect>
 
 class Simulator;
+struct MessageStats;
 
 /**
  * @brief Barre supérieure avec effet de flou et contrôles principaux
@@ -115,7 +116,25 @@ public:
     
     void updateStats(int activeVehicles, int connectedVehicles, 
                      int totalConnections, double connectionRate,
-                     int comparisons, double avgNeighbors, double buildTimeMs);
+                     qint64 comparisons, double avgNeighbors, double buildTimeMs);
+    
+    // Retard du graphe publié sur la simulation (en ticks)
+    void updateGraphLatency(int latencyTicks);
+
+    // Véhicules ayant changé de petite antenne au dernier tick
+    void updateHandoffs(int handoffs);
+
+    // Connexions apparues / disparues au dernier graphe (mode incrémental)
+    void updateEdgeChanges(int added, int removed);
+
+    // Temps moyen d'une image et répartition par étape (profileur)
+    void updateFrameProfile(double frameMs, const QString& breakdown);
+
+    // Propagation des messages: portée, latences (histogramme) et doublons
+    void updateMessages(bool enabled, const QString& strategy, const MessageStats& stats);
+
+signals:
+    void exportTraceRequested();
 
 private:
     QLabel* m_activeVehicles;
@@ -125,6 +144,16 @@ private:
     QLabel* m_comparisons;
     QLabel* m_avgNeighbors;
     QLabel* m_buildTime;
+    QLabel* m_graphLatency;
+    QLabel* m_handoffs;
+    QLabel* m_edgeChanges;
+    QLabel* m_frameTime;
+    QLabel* m_frameBreakdown;
+    QLabel* m_messageReach;
+    QLabel* m_messageLatency;
+    QLabel* m_messageDuplicates;
+    QLabel* m_messageHistogram;
+    QPushButton* m_exportTraceBtn;
     
     void setupUI();
     QWidget* createStatRow(const QString& title, QLabel*& valueLabel, const QString& color = "white");
@@ -157,7 +186,7 @@ private:
     StatsPanel* m_statsPanel;
     QPropertyAnimation* m_animation;
     bool m_expanded = true;
-    int m_expandedHeight = 380;
+    int m_expandedHeight = 600;  // Statistiques des messages comprises
     int m_collapsedHeight = 0;
     
     void setupUI();
@@ -0,0 +1,67 @@
+#ifndef PARALLEL_FOR_H
+#define PARALLEL_FOR_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Nombre de threads effectif pour une demande utilisateur
+ * @param requested Nombre demandé (<= 0 = nombre de cœurs disponibles)
+ */
+inline int resolveThreadCount(int requested) {
+    if (requested > 0) return requested;
+    unsigned hw = std::thread::hardware_concurrency();
+    return hw > 0 ? static_cast<int>(hw) : 1;
+}
+
+/**
+ * @brief Exécute fn(begin, end, workerIndex) sur [0, count) en parallèle
+ * @param count Nombre d'éléments à traiter
+ * @param threadCount Nombre de threads (<= 0 = auto)
+ * @param grain Taille des blocs distribués aux threads
+ * @param fn Fonction appelée pour chaque bloc [begin, end)
+ *
+ * Les blocs sont distribués dynamiquement (compteur atomique) pour équilibrer
+ * la charge. workerIndex est dans [0, threadCount) et permet à l'appelant
+ * d'utiliser des buffers propres à chaque thread, sans verrou.
+ * Avec un seul thread, tout est exécuté dans le thread appelant.
+ */
+template <typename Fn>
+void parallelFor(size_t count, int threadCount, size_t grain, Fn&& fn) {
+    if (count == 0) return;
+    grain = std::max<size_t>(1, grain);
+
+    const size_t numChunks = (count + grain - 1) / grain;
+    const int workers = static_cast<int>(std::min<size_t>(resolveThreadCount(threadCount), numChunks));
+
+    if (workers <= 1) {
+        fn(size_t(0), count, 0);
+        return;
+    }
+
+    std::atomic<size_t> nextChunk{0};
+    auto worker = [&](int workerIndex) {
+        while (true) {
+            size_t chunk = nextChunk.fetch_add(1, std::memory_order_relaxed);
+            if (chunk >= numChunks) break;
+            size_t begin = chunk * grain;
+            size_t end = std::min(count, begin + grain);
+            fn(begin, end, workerIndex);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(workers - 1);
+    for (int w = 1; w < workers; ++w) {
+        threads.emplace_back(worker, w);
+    }
+    worker(0);  // Le thread appelant participe aussi
+    for (auto& t : threads) {
+        t.join();
+    }
+}
+
+#endif // PARALLEL_FOR_H
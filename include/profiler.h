@@ -0,0 +1,132 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Instrumentation légère des étapes coûteuses (simulation, graphe, rendu)
+ *
+ * - ScopedTimer: mesure une étape et l'enregistre à la sortie du bloc
+ * - compteurs atomiques indexés par Counter (comparaisons, tuiles, véhicules dessinés...)
+ * - tampon circulaire sans verrou des derniers échantillons, exportable en trace
+ *   Chrome (chrome://tracing, Perfetto)
+ *
+ * Utilisable depuis n'importe quel thread. Quand le profilage est désactivé,
+ * un ScopedTimer ne coûte qu'une lecture atomique.
+ */
+namespace Profiler {
+
+// Étapes mesurées (une ligne par étape dans la trace et le panneau de stats)
+enum class Stage : uint8_t {
+    VehicleUpdate,     ///< Déplacement des véhicules + réécriture du store
+    Handoff,           ///< Transferts d'antenne
+    Snapshot,          ///< Copie des positions pour le worker (GraphJob)
+    GraphBuild,        ///< Connexions directes (broadphase + noyau + CSR)
+    Components,        ///< Composantes connexes
+    GraphPublish,      ///< Échange du graphe publié (et libération de l'ancien)
+    DensityGrid,       ///< Carte de densité du rendu à faible zoom (worker)
+    MessagePropagation, ///< Événements du moteur de messages traités pendant le tick
+    Paint,             ///< Image complète de MapView
+    PaintTiles,
+    PaintRoads,
+    PaintConnections,  ///< Rayons de transmission et connexions
+    PaintAntennas,
+    PaintVehicles,
+    PaintHud,          ///< Mise à jour de l'overlay et échelle
+    TileFetch,         ///< D'une requête de tuile à sa réponse (asynchrone)
+    Count
+};
+
+// Compteurs cumulés depuis le dernier reset()
+enum class Counter : uint8_t {
+    Ticks,
+    DistanceComparisons,
+    Handoffs,
+    DroppedGraphJobs,
+    Frames,
+    VehiclesDrawn,
+    TileRequests,
+    TileErrors,
+    Count
+};
+
+constexpr size_t STAGE_COUNT = static_cast<size_t>(Stage::Count);
+constexpr size_t COUNTER_COUNT = static_cast<size_t>(Counter::Count);
+
+// Capacité du tampon d'échantillons (puissance de deux)
+constexpr size_t RING_CAPACITY = size_t(1) << 16;
+
+/**
+ * @brief Un intervalle mesuré (horloge monotone, nanosecondes)
+ */
+struct Sample {
+    Stage stage;
+    int thread;          ///< Numéro de thread attribué par le profileur (0, 1, 2...)
+    int64_t startNs;
+    int64_t durationNs;
+};
+
+const char* stageName(Stage stage);
+const char* counterName(Counter counter);
+
+void setEnabled(bool enabled);
+bool isEnabled();
+
+// Horloge monotone du profileur (ns depuis son démarrage)
+int64_t nowNs();
+
+/**
+ * @brief Enregistre un intervalle terminé (étapes asynchrones: tuiles...)
+ */
+void record(Stage stage, int64_t startNs, int64_t durationNs);
+
+void add(Counter counter, int64_t delta = 1);
+int64_t counter(Counter counter);
+
+// Durée du dernier échantillon et moyenne glissante (exponentielle) d'une étape, en ms
+double lastMs(Stage stage);
+double averageMs(Stage stage);
+
+/**
+ * @brief Copie des échantillons présents dans le tampon, du plus ancien au plus récent
+ *
+ * Les cases en cours d'écriture par un autre thread sont ignorées.
+ */
+std::vector<Sample> samples();
+
+/**
+ * @brief Écrit les échantillons et les compteurs au format Chrome Trace Event (JSON)
+ * @return false si le fichier ne peut pas être écrit
+ */
+bool writeChromeTrace(const std::string& path);
+
+// Vide le tampon, les moyennes et les compteurs
+void reset();
+
+/**
+ * @brief Mesure la durée d'un bloc et l'enregistre à sa sortie
+ */
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Stage stage) : m_stage(stage), m_startNs(isEnabled() ? nowNs() : -1) {}
+    ~ScopedTimer() { stop(); }
+
+    // Enregistre la mesure avant la fin du bloc (étapes successives d'une même fonction)
+    void stop() {
+        if (m_startNs >= 0) record(m_stage, m_startNs, nowNs() - m_startNs);
+        m_startNs = -1;
+    }
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    Stage m_stage;
+    int64_t m_startNs;
+};
+
+} // namespace Profiler
+
+#endif // PROFILER_H
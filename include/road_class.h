@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+// Classe de route OSM (tag highway) stockée sur un octet dans EdgeData
+// à la place de la chaîne de caractères
+enum class RoadClass : uint8_t {
+    Motorway,
+    Trunk,
+    Primary,
+    Secondary,
+    Tertiary,
+    MotorwayLink,
+    TrunkLink,
+    PrimaryLink,
+    SecondaryLink,
+    TertiaryLink,
+    Unclassified,
+    Road,
+    Residential,
+    LivingStreet,
+    Service,
+    Track,
+    Footway,
+    Cycleway,
+    Path,
+    Pedestrian,
+    Steps,
+    Other,      // tout autre tag highway (ou absence de tag)
+    Count
+};
+
+// Masque d'une classe dans un ensemble (bitmask sur 32 bits)
+constexpr uint32_t roadClassBit(RoadClass c) {
+    return 1u << static_cast<uint32_t>(c);
+}
+
+// Routes praticables par les véhicules de la simulation
+constexpr uint32_t DRIVABLE_ROAD_MASK =
+    roadClassBit(RoadClass::Motorway) | roadClassBit(RoadClass::Trunk) |
+    roadClassBit(RoadClass::Primary) | roadClassBit(RoadClass::Secondary) |
+    roadClassBit(RoadClass::Tertiary) | roadClassBit(RoadClass::MotorwayLink) |
+    roadClassBit(RoadClass::TrunkLink) | roadClassBit(RoadClass::PrimaryLink) |
+    roadClassBit(RoadClass::SecondaryLink) | roadClassBit(RoadClass::TertiaryLink) |
+    roadClassBit(RoadClass::Unclassified) | roadClassBit(RoadClass::Road);
+
+// Test de praticabilité: un ET binaire, sans comparaison de chaînes
+constexpr bool isDrivableRoad(RoadClass c) {
+    return (DRIVABLE_ROAD_MASK & roadClassBit(c)) != 0;
+}
+
+// Conversion depuis / vers la valeur du tag OSM highway
+RoadClass roadClassFromString(const std::string& highwayType);
+const char* roadClassName(RoadClass c);
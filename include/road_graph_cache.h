@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include "graph_types.h"
+
+/**
+ * @brief Instantané binaire du graphe routier, projeté en mémoire (mmap)
+ *
+ * Évite de relire et reconstruire le fichier OSM PBF à chaque lancement:
+ * le graphe construit par GraphBuilder est écrit une fois, puis relu en
+ * projetant le fichier en mémoire et en recopiant les tableaux en bloc.
+ *
+ * Format (petit-boutiste, champs de taille fixe):
+ *   CacheHeader
+ *   CachedVertex[vertexCount]   dans l'ordre des sommets du RoadGraph
+ *   CachedEdge[edgeCount]       dans l'ordre d'insertion (boost::edges)
+ *
+ * Le cache est invalide si la version du format ou l'empreinte du fichier
+ * source (hashFile) ne correspondent plus.
+ */
+class RoadGraphCache {
+public:
+    // 2: graphe issu de la lecture filtrée (routes praticables uniquement)
+    // 3: empreinte rapide de la source (taille, date, blocs échantillonnés)
+    static constexpr uint32_t FORMAT_VERSION = 3;
+
+    // Blocs du fichier source lus par hashFile
+    static constexpr uint64_t SAMPLE_BLOCK_SIZE = 64 * 1024;
+    static constexpr uint64_t SAMPLE_BLOCK_COUNT = 8;
+
+    struct CacheHeader {
+        char magic[8];           // "V2VGRPH\0"
+        uint32_t version;        // FORMAT_VERSION
+        uint32_t headerSize;     // sizeof(CacheHeader)
+        uint64_t sourceHash;     // empreinte du fichier OSM source (hashFile)
+        uint64_t vertexCount;
+        uint64_t edgeCount;
+    };
+
+    struct CachedVertex {
+        int64_t id;              // identifiant OSM
+        double lat;
+        double lon;
+    };
+
+    struct CachedEdge {
+        uint32_t source;         // extrémités dans le sens d'insertion
+        uint32_t target;
+        double distance;         // mètres
+        uint8_t roadClass;       // RoadClass
+        uint8_t oneway;
+        uint8_t padding[6];
+    };
+
+    /**
+     * @brief Empreinte d'un fichier source (0 si illisible)
+     *
+     * FNV-1a 64 bits de la taille, de la date de modification et de
+     * SAMPLE_BLOCK_COUNT blocs répartis du début à la fin (le fichier entier
+     * s'il est plus petit): au plus 512 Kio lus, quelle que soit la taille
+     * de l'extrait OSM.
+     */
+    static uint64_t hashFile(const std::string& path);
+
+    /**
+     * @brief Chemin du cache associé à un fichier source ("<source>.graph")
+     */
+    static std::string defaultCachePath(const std::string& sourcePath);
+
+    /**
+     * @brief Écrit le graphe dans le cache (fichier temporaire puis renommage)
+     * @return true si l'écriture a réussi
+     */
+    static bool save(const std::string& cachePath, const RoadGraph& graph, uint64_t sourceHash);
+
+    /**
+     * @brief Charge le graphe depuis le cache s'il est valide pour sourceHash
+     * @param graph Graphe remplacé en cas de succès (non finalisé:
+     *              appeler GraphBuilder::finalizeGraph ensuite)
+     * @return false si le cache est absent, corrompu ou périmé
+     */
+    static bool load(const std::string& cachePath, uint64_t sourceHash, RoadGraph& graph);
+};
@@ -0,0 +1,81 @@
+#ifndef ROAD_VERTEX_INDEX_H
+#define ROAD_VERTEX_INDEX_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include <boost/geometry.hpp>
+#include <boost/geometry/index/rtree.hpp>
+#include "graph_types.h"
+
+/**
+ * @brief Index spatial (R-tree) des sommets praticables du graphe routier
+ *
+ * Construit une seule fois (chargement en bloc), il répond en O(log n) aux
+ * requêtes "sommet praticable le plus proche" et "sommets dans une zone",
+ * qui demandaient auparavant un parcours de tous les sommets.
+ *
+ * Les coordonnées sont projetées localement (longitude multipliée par
+ * cos(latitude moyenne)) pour que la distance utilisée soit proche de la
+ * distance au sol.
+ */
+class RoadVertexIndex {
+public:
+    RoadVertexIndex() = default;
+    explicit RoadVertexIndex(const RoadGraph& graph) { build(graph); }
+
+    /**
+     * @brief (Re)construit l'index avec les sommets ayant une arête praticable
+     */
+    void build(const RoadGraph& graph);
+
+    size_t size() const { return m_vertices.size(); }
+    bool empty() const { return m_vertices.empty(); }
+
+    /**
+     * @brief Sommet praticable le plus proche de (lon, lat)
+     * @return false si l'index est vide
+     */
+    bool nearest(double lon, double lat, Vertex& vertex) const;
+
+    /**
+     * @brief Les k sommets praticables les plus proches, du plus proche au plus lointain
+     */
+    std::vector<Vertex> nearestK(double lon, double lat, size_t k) const;
+
+    /**
+     * @brief Sommets praticables dans le rectangle [minLon, maxLon] × [minLat, maxLat]
+     */
+    std::vector<Vertex> inRegion(double minLon, double minLat, double maxLon, double maxLat) const;
+
+    /**
+     * @brief Sommet praticable tiré uniformément dans une zone
+     * @param random Valeur aléatoire fournie par l'appelant
+     * @return false si la zone ne contient aucun sommet praticable
+     */
+    bool randomInRegion(double minLon, double minLat, double maxLon, double maxLat,
+                        uint32_t random, Vertex& vertex) const;
+
+    /**
+     * @brief Sommet praticable tiré uniformément dans tout le graphe, en O(1)
+     */
+    Vertex randomVertex(uint32_t random) const { return m_vertices[random % m_vertices.size()]; }
+
+    // Tous les sommets praticables indexés
+    const std::vector<Vertex>& vertices() const { return m_vertices; }
+
+private:
+    using Point = boost::geometry::model::point<double, 2, boost::geometry::cs::cartesian>;
+    using Box = boost::geometry::model::box<Point>;
+    using Entry = std::pair<Point, Vertex>;
+    using Tree = boost::geometry::index::rtree<Entry, boost::geometry::index::rstar<16>>;
+
+    // Projection locale (x = lon · cos(lat moyenne), y = lat)
+    Point project(double lon, double lat) const { return Point(lon * m_lonScale, lat); }
+
+    Tree m_tree;
+    std::vector<Vertex> m_vertices;
+    double m_lonScale = 1.0;
+};
+
+#endif // ROAD_VERTEX_INDEX_H
@@ -0,0 +1,102 @@
+#ifndef ROUTE_PLANNER_H
+#define ROUTE_PLANNER_H
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "graph_types.h"
+
+/**
+ * @brief Calcul d'itinéraires A* sur le graphe routier, avec cache LRU partagé
+ *
+ * Les véhicules demandent un itinéraire une fois par trajet (origine -> but).
+ * Seules les arêtes praticables sont suivies, dans le sens autorisé pour les
+ * sens uniques (EdgeData::from -> EdgeData::to). L'heuristique est la distance
+ * géodésique au but, qui minore toujours la longueur restante: les
+ * itinéraires sont donc les plus courts.
+ *
+ * findRoute() peut être appelée depuis plusieurs threads à la fois (mise à jour
+ * parallèle des véhicules): l'A* utilise des tableaux propres à chaque thread
+ * et seul l'accès au cache est protégé par un mutex.
+ */
+class RoutePlanner {
+public:
+    // Itinéraire immuable partagé entre le cache et les véhicules:
+    // sommets de l'origine au but inclus, vide si le but est inaccessible
+    using Route = std::shared_ptr<const std::vector<Vertex>>;
+
+    /**
+     * @param graph Graphe finalisé (GraphBuilder::finalizeGraph)
+     * @param cacheCapacity Nombre de trajets origine/but conservés (0 = pas de cache)
+     */
+    explicit RoutePlanner(const RoadGraph& graph, size_t cacheCapacity = 4096);
+
+    /**
+     * @brief Itinéraire le plus court de start à goal (depuis le cache si possible)
+     */
+    Route findRoute(Vertex start, Vertex goal);
+
+    /**
+     * @brief Calcule un lot de trajets en parallèle (ex: à la création de la flotte)
+     * @param trips Couples (origine, but)
+     * @param threadCount Nombre de threads (<= 0 = tous les cœurs)
+     * @return Un itinéraire par trajet, dans le même ordre
+     */
+    std::vector<Route> planBatch(const std::vector<std::pair<Vertex, Vertex>>& trips, int threadCount = 0);
+
+    /**
+     * @brief Longueur d'un itinéraire en mètres (somme des arêtes suivies)
+     */
+    double routeLength(const std::vector<Vertex>& route) const;
+
+    /**
+     * @brief Sommets ayant au moins une arête praticable (précalculé):
+     * remplace le parcours de tout le graphe pour tirer un nouveau but
+     */
+    const std::vector<Vertex>& validVertices() const { return m_validVertices; }
+
+    // Statistiques du cache
+    size_t cacheHits() const { return m_cacheHits.load(std::memory_order_relaxed); }
+    size_t cacheMisses() const { return m_cacheMisses.load(std::memory_order_relaxed); }
+    void clearCache();
+
+    /**
+     * @brief Arête praticable la plus courte de u vers v dans le sens autorisé
+     * @return false si aucune arête ne relie u à v dans ce sens
+     */
+    static bool findEdge(const RoadGraph& graph, Vertex u, Vertex v, Edge& edge);
+
+    /**
+     * @brief true si l'arête e peut être parcourue depuis u (praticable, sens autorisé)
+     */
+    static bool canTraverse(const RoadGraph& graph, Edge e, Vertex u) {
+        const EdgeData& data = graph[e];
+        return data.drivable && (!data.oneway || data.from == u);
+    }
+
+private:
+    // A* proprement dit, sans cache
+    std::vector<Vertex> computeRoute(Vertex start, Vertex goal) const;
+
+    static uint64_t cacheKey(Vertex start, Vertex goal) {
+        return (static_cast<uint64_t>(start) << 32) | static_cast<uint32_t>(goal);
+    }
+
+    const RoadGraph& m_graph;
+    std::vector<Vertex> m_validVertices;
+
+    // Cache LRU: liste du plus récent au plus ancien + index par clé
+    size_t m_cacheCapacity;
+    std::mutex m_cacheMutex;
+    std::list<std::pair<uint64_t, Route>> m_lru;
+    std::unordered_map<uint64_t, std::list<std::pair<uint64_t, Route>>::iterator> m_cacheIndex;
+    std::atomic<size_t> m_cacheHits{0};
+    std::atomic<size_t> m_cacheMisses{0};
+};
+
+#endif // ROUTE_PLANNER_H
@@ -0,0 +1,123 @@
+#ifndef SHARD_COORDINATOR_H
+#define SHARD_COORDINATOR_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "geo_partition.h"
+#include "shard_node.h"
+#include "shard_protocol.h"
+#include "sim_recording.h"
+
+/**
+ * @brief Réglages d'une simulation répartie
+ */
+struct ShardRunOptions {
+    bool processes = true;        ///< Un processus par shard (fork + socketpair), sinon tous dans ce processus
+    int threadsPerShard = 1;      ///< Threads de mise à jour et de graphe de chaque shard
+    uint64_t seed = 42;
+    double speed = 50.0 / 3.6;    ///< m/s
+    double range = 500.0;         ///< Portée de transmission (m), largeur de la zone frontière
+    double collisionDist = 5.0;
+    std::string viewPath;         ///< Enregistrement de la vue sous-échantillonnée (vide = aucune)
+    uint64_t graphSourceHash = 0; ///< Empreinte du fichier OSM (RoadGraphCache::hashFile), écrite dans la vue
+    uint32_t viewStride = 10;     ///< Un véhicule sur viewStride dans la vue
+    int viewInterval = 1;         ///< Une vue tous les viewInterval ticks
+};
+
+/**
+ * @brief Liaison vers un shard: envoi de trames, réception jusqu'à une trame donnée
+ */
+class ShardLink {
+public:
+    virtual ~ShardLink() = default;
+    virtual bool send(const std::vector<uint8_t>& frames) = 0;
+    // Ajoute à frames les trames reçues jusqu'à la première de type last (incluse)
+    virtual bool receiveUntil(ShardMessage last, std::vector<uint8_t>& frames) = 0;
+};
+
+/**
+ * @brief Coordinateur de la simulation répartie
+ *
+ * Démarre les shards (un ShardNode par territoire de la GeoPartition), puis
+ * à chaque tick: envoie Step à tous les shards (les processus avancent en
+ * parallèle), relaie les trames Boundary et Migration de chaque shard vers
+ * leur destinataire suivies de Flush, et collecte vues et compteurs. Les
+ * trames relayées ne sont pas décodées: le coordinateur n'en lit que l'en-tête.
+ *
+ * Topologie en étoile: les shards ne se parlent pas directement, chaque
+ * octet échangé est compté ici (exchangedBytes). La vue sous-échantillonnée
+ * (véhicules d'ID multiple de viewStride) est écrite au format
+ * d'enregistrement (sim_recording.h), que l'interface relit avec --replay.
+ */
+class ShardCoordinator {
+public:
+    /**
+     * @param graph Graphe routier complet, chargé avant le démarrage (partagé par les processus fils)
+     */
+    ShardCoordinator(RoadGraph& graph, GeoPartition partition, const ShardRunOptions& options);
+    ~ShardCoordinator();
+    ShardCoordinator(const ShardCoordinator&) = delete;
+    ShardCoordinator& operator=(const ShardCoordinator&) = delete;
+
+    /**
+     * @brief Démarre les shards; chacun crée les véhicules de fleet partis de son territoire
+     * @return false si un shard n'a pas pu être démarré
+     */
+    bool start(const std::vector<ShardVehicleSeed>& fleet);
+
+    /**
+     * @brief Exécute un tick sur tous les shards
+     * @return false si un shard ne répond plus ou envoie une trame invalide
+     */
+    bool step(double dtSeconds);
+
+    /**
+     * @brief Arrête les shards et ferme la vue
+     */
+    void shutdown();
+
+    const GeoPartition& partition() const { return m_partition; }
+    int shardCount() const { return m_partition.shardCount(); }
+    bool usesProcesses() const { return m_processes; }
+    uint32_t tick() const { return m_tick; }
+
+    // Compteurs du dernier tick, par shard, et leur somme
+    const std::vector<ShardTickStats>& lastStats() const { return m_lastStats; }
+    ShardTickStats totals() const;
+    // Connexions directes de toute la flotte (chaque connexion entre shards comptée une fois)
+    uint64_t totalEdges() const;
+
+    // Octets des trames Boundary et Migration relayées au dernier tick
+    uint64_t lastExchangeBytes() const { return m_lastExchangeBytes; }
+    uint64_t totalExchangeBytes() const { return m_totalExchangeBytes; }
+
+    RecordingWriter* viewRecorder() { return m_view.get(); }
+
+private:
+    bool startProcess(int shard, const std::vector<ShardVehicleSeed>& fleet);
+    bool collectReplies(int shard);
+
+private:
+    RoadGraph& m_graph;
+    GeoPartition m_partition;
+    ShardRunOptions m_options;
+    bool m_processes = false;
+    std::vector<std::unique_ptr<ShardLink>> m_links;
+    uint32_t m_tick = 0;
+    bool m_running = false;
+
+    std::vector<std::vector<uint8_t>> m_received;  // Trames reçues de chaque shard
+    std::vector<std::vector<uint8_t>> m_outgoing;  // Trames à envoyer à chaque shard
+    std::vector<ShardTickStats> m_lastStats;
+    uint64_t m_lastExchangeBytes = 0;
+    uint64_t m_totalExchangeBytes = 0;
+
+    std::unique_ptr<RecordingWriter> m_view;
+    std::vector<ShardViewRow> m_viewRows;
+    VehicleStore m_viewStore;
+    double m_viewSeconds = 0.0;  // Temps simulé depuis la dernière vue
+};
+
+#endif // SHARD_COORDINATOR_H
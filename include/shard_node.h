@@ -0,0 +1,98 @@
+#ifndef SHARD_NODE_H
+#define SHARD_NODE_H
+
+#include <cstdint>
+#include <vector>
+#include "simulator.h"
+#include "geo_partition.h"
+#include "shard_protocol.h"
+
+/**
+ * @brief Véhicule de la flotte initiale (même tirage dans tous les shards)
+ */
+struct ShardVehicleSeed {
+    int id = -1;
+    Vertex start = 0;
+    Vertex goal = 0;
+};
+
+/**
+ * @brief Un shard de la simulation répartie: un Simulator et les véhicules de son territoire
+ *
+ * Piloté par les trames du coordinateur (shard_protocol.h), dans le même
+ * processus ou dans un processus fils. Un tick se déroule en deux phases:
+ * 1. Step: déplacement des véhicules possédés (Simulator::stepVehicles),
+ *    puis, pour chaque véhicule, shard propriétaire de sa nouvelle position
+ *    et shards dont la frontière est à moins d'une portée (GeoPartition::nearbyShards).
+ *    Le shard envoie une trame Boundary par voisin concerné, une trame
+ *    Migration par shard qui reçoit des véhicules sortis du territoire
+ *    (retirés de la flotte locale), puis Flush.
+ * 2. Après les trames relayées par le coordinateur et son Flush: adoption des
+ *    véhicules reçus, remplacement des fantômes (véhicules voisins des autres
+ *    shards) et fin du tick (Simulator::completeStep: graphe avec les
+ *    fantômes). Le shard répond par sa vue sous-échantillonnée (si demandée)
+ *    et ses compteurs (Stats).
+ *
+ * Une connexion entre deux shards apparaît dans les deux graphes locaux:
+ * seul le propriétaire du plus petit ID la compte (crossEdges), la somme
+ * des compteurs des shards ne compte donc chaque connexion qu'une fois.
+ * La simulation utilise la grille uniforme (les fantômes n'ont pas d'antenne).
+ * Le graphe routier est chargé en entier par chaque shard: les ID de
+ * sommets sont les mêmes partout, ce qui rend les migrations exactes.
+ */
+class ShardNode {
+public:
+    // Marge relative ajoutée à la portée: écarts entre la projection de la
+    // partition et celle de chaque graphe local
+    static constexpr double BOUNDARY_SLACK = 1.02;
+
+    /**
+     * @param graph Graphe routier complet (partagé, non modifié)
+     * @param partition Découpage commun à tous les shards (conservé par référence)
+     * @param shardId Territoire de ce shard
+     * @param maxRange Portée maximale de la flotte (m): largeur de la zone frontière
+     */
+    ShardNode(RoadGraph& graph, const GeoPartition& partition, int shardId, double maxRange);
+
+    /**
+     * @brief Crée les véhicules de la flotte dont le départ est dans ce shard
+     */
+    void populate(const std::vector<ShardVehicleSeed>& fleet, double speed, double range, double collisionDist);
+
+    /**
+     * @brief Traite une trame du coordinateur
+     * @param out Trames de réponse ajoutées à la fin
+     * @return false après Shutdown ou sur une trame invalide
+     */
+    bool handleFrame(const ShardFrameHeader& header, const uint8_t* payload, std::vector<uint8_t>& out);
+
+    int shardId() const { return m_shardId; }
+    Simulator& simulator() { return m_simulator; }
+    const Simulator& simulator() const { return m_simulator; }
+    const ShardTickStats& lastStats() const { return m_stats; }
+
+private:
+    void advance(uint32_t tick, std::vector<uint8_t>& out);
+    void complete(uint32_t tick, std::vector<uint8_t>& out);
+    void countEdges(ShardTickStats& stats) const;
+    void appendView(uint32_t tick, std::vector<uint8_t>& out);
+
+private:
+    Simulator m_simulator;
+    const GeoPartition& m_partition;
+    int m_shardId;
+    double m_margin;
+
+    ShardStep m_step;
+    ShardTickStats m_stats;
+    // Tampons d'un tick (capacité conservée)
+    std::vector<std::vector<VehicleSnapshot>> m_outBoundary;      // Par shard destinataire
+    std::vector<std::vector<VehicleMotionState>> m_outMigrations;  // Par shard destinataire
+    std::vector<std::pair<int, int>> m_emigrants;                  // (ID, nouveau shard)
+    std::vector<VehicleSnapshot> m_ghosts;
+    std::vector<VehicleMotionState> m_immigrants;
+    std::vector<int> m_nearby;
+    std::vector<ShardViewRow> m_viewRows;
+};
+
+#endif // SHARD_NODE_H
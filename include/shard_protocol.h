@@ -0,0 +1,137 @@
+#ifndef SHARD_PROTOCOL_H
+#define SHARD_PROTOCOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "interference_graph.h"
+#include "vehicule.h"
+
+/**
+ * @brief Protocole binaire entre le coordinateur et les shards
+ *
+ * Chaque trame commence par un en-tête fixe de 16 octets (petit-boutiste):
+ * magic "VS" (2), version (1), type (1), shard émetteur (2), shard
+ * destinataire (2), tick (4), taille de la charge utile (4). Les trames se
+ * suivent sans séparateur sur le même flux (socket, tampon mémoire).
+ *
+ * Charges utiles (entiers en varint, zigzag pour les écarts signés):
+ * - Step: pas de temps (µs), un véhicule sur viewStride dans la vue (0 = pas de vue)
+ * - Boundary: véhicules proches de la frontière du destinataire; ID, lat et
+ *   lon (1e-7 degré, environ 1 cm) en écart à la ligne précédente, portée (cm)
+ * - Migration: état complet (VehicleMotionState) des véhicules qui passent
+ *   chez le destinataire (itinéraire restant compris); doubles copiés bit à
+ *   bit, la trajectoire continue à l'identique
+ * - Flush: fin d'une phase (le shard a tout envoyé / le coordinateur a tout relayé)
+ * - Stats: compteurs du tick d'un shard (ShardTickStats), dernière trame du tick
+ * - View: véhicules sous-échantillonnés, même contenu qu'une ligne d'enregistrement
+ * - Shutdown: fin de la simulation
+ */
+
+enum class ShardMessage : uint8_t {
+    Step = 1,
+    Boundary = 2,
+    Migration = 3,
+    Flush = 4,
+    Stats = 5,
+    View = 6,
+    Shutdown = 7
+};
+
+enum class ShardFrameStatus {
+    Ok,        ///< Trame complète
+    NeedMore,  ///< En-tête ou charge utile incomplet
+    Invalid    ///< Magic, version, type ou taille incorrects
+};
+
+struct ShardFrameHeader {
+    ShardMessage type = ShardMessage::Flush;
+    uint16_t source = 0;
+    uint16_t target = 0;
+    uint32_t tick = 0;
+    uint32_t length = 0;   ///< Octets de charge utile après l'en-tête
+};
+
+static constexpr size_t SHARD_FRAME_HEADER_SIZE = 16;
+static constexpr uint16_t SHARD_COORDINATOR = 0xFFFF;          ///< Identifiant du coordinateur
+static constexpr uint32_t SHARD_MAX_PAYLOAD = 256u << 20;      ///< Au-delà, la trame est refusée
+
+/**
+ * @brief Pas de simulation demandé par le coordinateur
+ */
+struct ShardStep {
+    double dtSeconds = 0.0;
+    uint32_t viewStride = 0;   ///< Véhicules d'ID multiple de viewStride dans la vue (0 = aucune)
+};
+
+/**
+ * @brief Compteurs d'un shard pour un tick
+ */
+struct ShardTickStats {
+    uint32_t vehicles = 0;      ///< Véhicules possédés
+    uint32_t ghosts = 0;        ///< Véhicules voisins reçus des autres shards
+    uint32_t immigrants = 0;    ///< Véhicules reçus à ce tick
+    uint32_t emigrants = 0;     ///< Véhicules cédés à ce tick
+    uint32_t boundaryRows = 0;  ///< Lignes de frontière envoyées (un véhicule par shard voisin)
+    uint64_t localEdges = 0;    ///< Connexions entre véhicules possédés
+    uint64_t crossEdges = 0;    ///< Connexions vers un shard voisin, comptées par le propriétaire du plus petit ID
+    uint64_t comparisons = 0;
+    uint64_t components = 0;    ///< Composantes connexes du graphe local (fantômes compris)
+    double updateMs = 0.0;
+    double graphMs = 0.0;
+};
+
+/**
+ * @brief Véhicule de la vue sous-échantillonnée (colonnes d'un VehicleStore)
+ */
+struct ShardViewRow {
+    int id = -1;
+    Vertex edgeSource = 0;
+    Vertex edgeTarget = 0;
+    double positionOnEdge = 0.0;
+    double speed = 0.0;
+    double heading = 0.0;
+    double range = 0.0;
+};
+
+/**
+ * @brief Ouvre une trame à la fin de out (en-tête dont la taille est complétée par endShardFrame)
+ * @return Position de la trame dans out
+ */
+size_t beginShardFrame(std::vector<uint8_t>& out, ShardMessage type, uint16_t source, uint16_t target,
+                       uint32_t tick);
+
+/**
+ * @brief Écrit la taille de la charge utile ajoutée depuis beginShardFrame
+ */
+void endShardFrame(std::vector<uint8_t>& out, size_t frameStart);
+
+/**
+ * @brief Trame sans charge utile (Flush, Shutdown)
+ */
+void appendShardFrame(std::vector<uint8_t>& out, ShardMessage type, uint16_t source, uint16_t target,
+                      uint32_t tick);
+
+/**
+ * @brief Lit l'en-tête d'une trame au début de data
+ * @return Ok si l'en-tête et toute la charge utile sont présents
+ */
+ShardFrameStatus parseShardFrame(const uint8_t* data, size_t size, ShardFrameHeader& header);
+
+// Charges utiles: encode* ajoute à out, decode* ajoute à result (false si tronqué ou incohérent)
+void encodeShardStep(std::vector<uint8_t>& out, const ShardStep& step);
+bool decodeShardStep(const uint8_t* data, size_t size, ShardStep& step);
+
+void encodeBoundary(std::vector<uint8_t>& out, const std::vector<VehicleSnapshot>& rows);
+bool decodeBoundary(const uint8_t* data, size_t size, std::vector<VehicleSnapshot>& result);
+
+void encodeMigrations(std::vector<uint8_t>& out, const std::vector<VehicleMotionState>& states);
+bool decodeMigrations(const uint8_t* data, size_t size, std::vector<VehicleMotionState>& result);
+
+void encodeShardStats(std::vector<uint8_t>& out, const ShardTickStats& stats);
+bool decodeShardStats(const uint8_t* data, size_t size, ShardTickStats& stats);
+
+void encodeShardView(std::vector<uint8_t>& out, const std::vector<ShardViewRow>& rows);
+bool decodeShardView(const uint8_t* data, size_t size, std::vector<ShardViewRow>& result);
+
+#endif // SHARD_PROTOCOL_H
@@ -0,0 +1,278 @@
+#ifndef SIM_RECORDING_H
+#define SIM_RECORDING_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "interference_graph.h"
+#include "vehicle_store.h"
+
+/**
+ * @brief Enregistrement compact de l'état de la simulation, tick par tick
+ *
+ * Format (petit-boutiste):
+ * - en-tête: "V2VREC" + version + identité du graphe routier (empreinte du
+ *   fichier source, nombres de sommets et d'arêtes): les arêtes sont des
+ *   indices de sommets, valables seulement pour ce graphe
+ * - blocs indépendants, chacun commençant par une trame complète (keyframe)
+ *   suivie de trames différentielles; chaque bloc peut être compressé (zstd)
+ * - index des blocs en fin de fichier (reconstruit par parcours des blocs
+ *   si le fichier a été tronqué)
+ *
+ * Trame complète: pour chaque véhicule, ID (écart au précédent), arête
+ * (source, cible), position sur l'arête, vitesse, cap, portée, puis toutes
+ * les connexions. Trame différentielle (mêmes véhicules dans le même ordre):
+ * un octet de drapeaux par véhicule, l'écart de position au déplacement du
+ * tick précédent, les seuls champs modifiés, puis les connexions apparues
+ * et disparues. Entiers en varint (zigzag pour les écarts signés).
+ *
+ * Grandeurs quantifiées au centième (cm, cm/s, centièmes de degré): la
+ * relecture redonne exactement les valeurs quantifiées, quel que soit le
+ * point de départ (lecture continue ou seek).
+ */
+
+/**
+ * @brief Graphe routier auquel renvoient les sommets enregistrés (edgeSource/edgeTarget)
+ */
+struct RecordingGraphIdentity {
+    uint64_t sourceHash = 0;   ///< RoadGraphCache::hashFile du fichier OSM (0 = inconnu)
+    uint64_t vertexCount = 0;
+    uint64_t edgeCount = 0;
+
+    bool operator==(const RecordingGraphIdentity& other) const {
+        return sourceHash == other.sourceHash && vertexCount == other.vertexCount &&
+               edgeCount == other.edgeCount;
+    }
+    bool operator!=(const RecordingGraphIdentity& other) const { return !(*this == other); }
+};
+
+/**
+ * @brief Réglages d'un enregistrement
+ */
+struct RecordingOptions {
+    int keyframeInterval = 200;   ///< Trames par bloc (une trame complète au début de chaque bloc)
+    int frameInterval = 1;        ///< N'enregistrer qu'un tick sur frameInterval
+    bool compress = true;         ///< Compression zstd des blocs (si compilé avec V2V_ZSTD)
+    size_t maxQueuedFrames = 32;  ///< Trames en attente d'écriture avant de bloquer push()
+    RecordingGraphIdentity graph; ///< Écrit dans l'en-tête, vérifié à la relecture
+};
+
+/**
+ * @brief Une trame relue: état complet de la flotte et connexions à ce tick
+ */
+struct RecordedFrame {
+    uint64_t tick = 0;
+    double dtSeconds = 0.0;        ///< Temps simulé depuis la trame précédente
+    bool keyframe = false;
+    std::vector<int> ids;
+    std::vector<uint64_t> edgeSource;  ///< Arête courante (sommets du graphe routier)
+    std::vector<uint64_t> edgeTarget;
+    std::vector<double> positionOnEdge;  ///< m
+    std::vector<double> speed;           ///< m/s
+    std::vector<double> heading;         ///< degrés
+    std::vector<double> range;           ///< m
+    EdgeIdList edges;    ///< Connexions directes courantes (id1 < id2, triées)
+    EdgeIdList added;    ///< Apparues depuis la trame précédente
+    EdgeIdList removed;  ///< Disparues depuis la trame précédente
+};
+
+/**
+ * @brief État partagé par l'encodeur et le décodeur (valeurs quantifiées de la
+ * dernière trame): chaque trame différentielle s'exprime par rapport à lui
+ */
+struct RecordingCodecState {
+    std::vector<int> ids;
+    std::vector<int64_t> source;
+    std::vector<int64_t> target;
+    std::vector<int64_t> position;
+    std::vector<int64_t> positionStep;  ///< Déplacement du tick précédent (prédiction)
+    std::vector<int64_t> speed;
+    std::vector<int64_t> heading;
+    std::vector<int64_t> range;
+    EdgeIdList edges;
+    uint64_t tick = 0;
+    bool valid = false;  ///< false avant la première trame (ou après un seek)
+};
+
+/**
+ * @brief Écrit un enregistrement depuis un thread dédié
+ *
+ * push() ne fait que copier les tableaux du VehicleStore et garder une
+ * référence sur le graphe publié; la quantification, l'extraction des
+ * connexions, l'encodage, la compression et l'écriture ont lieu dans le
+ * thread d'écriture. push() ne bloque que si maxQueuedFrames trames
+ * attendent déjà (disque ou compression trop lents).
+ */
+class RecordingWriter {
+public:
+    RecordingWriter() = default;
+    ~RecordingWriter();
+    RecordingWriter(const RecordingWriter&) = delete;
+    RecordingWriter& operator=(const RecordingWriter&) = delete;
+
+    /**
+     * @brief Crée le fichier et démarre le thread d'écriture
+     * @return false si le fichier ne peut pas être créé
+     */
+    bool open(const std::string& path, const RecordingOptions& options = RecordingOptions());
+
+    /**
+     * @brief Ajoute l'état d'un tick
+     * @param tick Numéro du tick (croissant)
+     * @param dtSeconds Temps simulé écoulé depuis le tick précédent
+     * @param store Positions de la flotte (copiées)
+     * @param graph Graphe publié à ce moment (nullptr = aucune connexion)
+     */
+    void push(uint64_t tick, double dtSeconds, const VehicleStore& store,
+              std::shared_ptr<const InterferenceGraph> graph);
+
+    /**
+     * @brief Écrit les trames en attente, le dernier bloc et l'index, puis ferme le fichier
+     */
+    void close();
+
+    bool isOpen() const { return m_thread.joinable(); }
+    bool failed() const;
+    uint64_t framesWritten() const;
+    uint64_t bytesWritten() const;
+
+    // true si le binaire sait compresser les blocs (V2V_ZSTD)
+    static bool compressionAvailable();
+
+private:
+    // État copié sur le thread appelant
+    struct Capture {
+        uint64_t tick = 0;
+        double dtSeconds = 0.0;
+        std::vector<int> ids;
+        std::vector<Vertex> source;
+        std::vector<Vertex> target;
+        std::vector<double> position;
+        std::vector<double> speed;
+        std::vector<double> heading;
+        std::vector<double> range;
+        std::shared_ptr<const InterferenceGraph> graph;
+    };
+
+    struct ChunkInfo {
+        uint64_t firstTick;
+        uint64_t lastTick;
+        uint64_t offset;
+        uint32_t frameCount;
+    };
+
+    void run();
+    void encode(const Capture& capture);
+    void flushChunk();
+    void writeIndex();
+
+private:
+    RecordingOptions m_options;
+    std::ofstream m_file;
+    std::thread m_thread;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_notEmpty;
+    std::condition_variable m_notFull;
+    std::deque<Capture> m_queue;
+    bool m_stopping = false;
+
+    // Sous-échantillonnage (thread appelant)
+    uint64_t m_pushCount = 0;
+    double m_skippedSeconds = 0.0;
+
+    // Thread d'écriture uniquement
+    RecordingCodecState m_state;
+    std::vector<uint8_t> m_chunk;  // Trames brutes du bloc courant
+    uint32_t m_chunkFrames = 0;
+    uint64_t m_chunkFirstTick = 0;
+    uint64_t m_chunkLastTick = 0;
+    std::vector<ChunkInfo> m_index;
+    std::shared_ptr<const InterferenceGraph> m_lastGraph;
+
+    // Lus par les autres threads (sous m_mutex)
+    uint64_t m_framesWritten = 0;
+    uint64_t m_bytesWritten = 0;
+    bool m_failed = false;
+};
+
+/**
+ * @brief Relit un enregistrement, trame par trame, avec accès direct aux blocs
+ */
+class RecordingReader {
+public:
+    /**
+     * @brief Ouvre un fichier et charge l'index des blocs
+     * @return false si le fichier n'est pas un enregistrement lisible
+     */
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return m_file.is_open(); }
+
+    // Graphe routier de l'enregistrement (à comparer au graphe chargé avant relecture)
+    const RecordingGraphIdentity& graphIdentity() const { return m_graph; }
+
+    // Trames et ticks couverts par le fichier
+    uint64_t frameCount() const { return m_frameCount; }
+    uint64_t firstTick() const { return m_chunks.empty() ? 0 : m_chunks.front().firstTick; }
+    uint64_t lastTick() const { return m_chunks.empty() ? 0 : m_chunks.back().lastTick; }
+    size_t chunkCount() const { return m_chunks.size(); }
+
+    /**
+     * @brief Trame suivante
+     * @return false à la fin du fichier (ou sur un bloc illisible)
+     */
+    bool next(RecordedFrame& frame);
+
+    /**
+     * @brief Place la lecture sur la dernière trame dont le tick est <= tick
+     * (la première trame si tick la précède)
+     *
+     * Décode depuis la trame complète du bloc concerné: O(keyframeInterval).
+     */
+    bool seek(uint64_t tick);
+
+    /**
+     * @brief Revient au début du fichier
+     */
+    bool rewind() { return seek(firstTick()); }
+
+private:
+    struct ChunkInfo {
+        uint64_t firstTick;
+        uint64_t lastTick;
+        uint64_t offset;
+        uint32_t frameCount;
+    };
+
+    bool readIndex(uint64_t fileSize);
+    bool scanChunks(uint64_t fileSize);
+    bool loadChunk(size_t index);
+    bool decodeFrame(RecordedFrame& frame);
+    uint64_t peekTick() const;  // Tick de la prochaine trame du bloc chargé
+
+private:
+    std::ifstream m_file;
+    uint64_t m_fileSize = 0;
+    RecordingGraphIdentity m_graph;
+    std::vector<ChunkInfo> m_chunks;
+    uint64_t m_frameCount = 0;
+
+    size_t m_chunkIndex = 0;       // Bloc chargé (m_chunks.size() = aucun)
+    std::vector<uint8_t> m_chunk;  // Trames brutes du bloc chargé
+    size_t m_cursor = 0;
+    uint32_t m_framesLeft = 0;
+    RecordingCodecState m_state;
+
+    // Trame déjà décodée par seek(), rendue par le prochain next()
+    RecordedFrame m_pending;
+    bool m_hasPending = false;
+};
+
+#endif // SIM_RECORDING_H
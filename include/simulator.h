@@ -6,20 +6,77 @@
 #include <QElapsedTimer>
 #include <QFutureWatcher>
 #include <QMutex>
+#include <algorithm>
 #include <vector>
 #include <iostream>
 #include <atomic>
+#include <memory>
 
 #include "vehicule.h"
-#include "map_view.h"
 #include "graph_builder.h"
 #include "interference_graph.h"
+#include "verlet_neighbor_list.h"
+#include "sim_recording.h"
+#include "message_engine.h"
+#include "density_grid.h"
+#include "vehicle_store.h"
+#include "vehicle_pool.h"
+#include "route_planner.h"
+#include "road_vertex_index.h"
+
+/**
+ * @brief Politique appliquée quand le calcul du graphe est en retard
+ * sur la simulation (un calcul est encore en cours au tick suivant)
+ */
+enum class BackpressurePolicy {
+    Drop,      // Ignorer les positions de ce tick (comportement historique)
+    Coalesce,  // Garder uniquement les positions les plus récentes, lancées dès la fin du calcul
+    Block      // Attendre la fin du calcul en cours avant de continuer
+};
+
+/**
+ * @brief Travail de construction du graphe pour un tick
+ *
+ * Partagé (shared_ptr) avec le worker puis rendu au Simulator, qui le
+ * réutilise: les tableaux gardent leur capacité d'un tick à l'autre.
+ */
+struct GraphJob {
+    std::vector<VehicleSnapshot> snapshots;
+    AntennaNeighborhood antennaInfo;
+    uint64_t antennaLayout = 0;  // SpatialGrid::getLayoutVersion() des voisinages de antennaInfo
+    bool computeTransitive = false;
+    BroadphaseMode broadphaseMode = BroadphaseMode::Antennas;
+    int threadCount = 0;
+    uint64_t tickSequence = 0;
+    bool buildDensity = false;   // Construire aussi la carte de densité (rendu LOD)
+    int densityZoom = 0;         // Zoom de la vue au moment du snapshot
+    // Listes de Verlet du mode incrémental (nullptr = construction complète);
+    // partagées entre les jobs successifs, un seul worker à la fois les modifie
+    std::shared_ptr<VerletNeighborList> neighborList;
+};
+
+/**
+ * @brief Durées des étapes du dernier tick exécuté par stepOnce (en ms)
+ */
+struct TickTimings {
+    double updateMs = 0.0;      // Déplacement des véhicules + réécriture du store
+    double snapshotMs = 0.0;    // Transferts d'antenne + copie des positions (GraphJob)
+    double graphBuildMs = 0.0;  // Connexions directes (broadphase + noyau de distance + CSR)
+    double closureMs = 0.0;     // Composantes connexes (connexions transitives)
+    int64_t comparisons = 0;    // Tests de distance effectués par la construction
+    int handoffs = 0;           // Véhicules ayant changé de petite antenne
+    int edgesAdded = 0;         // Connexions apparues (mode incrémental)
+    int edgesRemoved = 0;       // Connexions disparues (mode incrémental)
+    bool neighborListRebuilt = false;  // Listes de Verlet reconstruites à ce tick
+    double messagesMs = 0.0;    // Propagation des messages (moteur à événements)
+    int messageEvents = 0;      // Événements de messages traités
+};
 
 class Simulator : public QObject {
     Q_OBJECT
 
 public:
-    explicit Simulator(RoadGraph& graph, MapView* mapView, QObject* parent = nullptr);
+    explicit Simulator(RoadGraph& graph, QObject* parent = nullptr);
     ~Simulator() override;
 
     // Controls
@@ -27,30 +84,151 @@ public:
     void stop(); // stops and resets timer
     void pause(); // pauses (timer stops but state preserved)
     void resume(); // resumes after pause
-    void stepOnce(); // perform a single simulation
+    // Avance d'un pas fixe et construit le graphe dans le thread appelant
+    // (mode sans interface: pas de timer ni de worker, durées dans lastTickTimings)
+    void stepOnce(double deltaSeconds);
+    // stepOnce en deux temps (mode réparti, sans effet en relecture): déplacement
+    // des véhicules, puis, après l'échange avec les shards voisins, antennes,
+    // graphe, messages et enregistrement
+    void stepVehicles(double deltaSeconds);
+    void completeStep(double deltaSeconds);
     void togglePause(); // toggle between pause and resume
     void reset(); // reset simulation to initial state
     bool isRunning() const { return m_running && !m_paused; }
 
     //vehicle management
-    void addVehicle(Vehicule* v); // takes ownership
+    void addVehicle(Vehicule* v); // takes ownership (allocated with new or by createVehicle)
+    // Construit un véhicule dans le pool du simulateur et l'ajoute
+    Vehicule* createVehicle(int id, Vertex start, Vertex goal, double speed, double range, double collisionDist);
+    // Suppression en O(1): le dernier véhicule prend la ligne libérée
     bool removeVehicle(Vehicule* v);
     void clearVehicles();
     void setVehicleCount(int count); // Dynamically add or remove vehicles to match count
     Vehicule* createVehicleNear(double lon, double lat); // Create a vehicle near a position
+    // Recrée un véhicule migré depuis un autre processus (même graphe routier),
+    // à la position et avec le générateur aléatoire de son état
+    Vehicule* adoptVehicle(const VehicleMotionState& state);
+
+    // Véhicules d'autres shards ajoutés aux snapshots des prochains graphes
+    // (IDs distincts de ceux de la flotte; voisins mais jamais simulés ici)
+    void setGhostVehicles(const std::vector<VehicleSnapshot>& ghosts);
+    const std::vector<VehicleSnapshot>& ghostVehicles() const { return m_ghostSnapshots; }
     
     // Antenna management
-    void placeAntennas(int numLarge, int numSmall); // Run K-means to place antennas
+    // Lance le K-means dans un thread séparé (départ à chaud depuis les antennes
+    // actuelles); la grille est remplacée à la fin, puis antennasPlaced() est émis.
+    // Une demande faite pendant un placement en cours remplace la demande en attente.
+    void placeAntennas(int numLarge, int numSmall);
+    // Attend le placement en cours (et celui en attente) et applique le résultat
+    void waitForAntennas();
+    bool antennaPlacementInProgress() const { return m_antennaWatcher->isRunning(); }
 
     // Simulation parameters
     void setSpeedMultiplier(double m);
     double speedMultiplier() const;
     void setCollisionDetectionEnabled(bool e);
 
+    // Nombre de threads pour la mise à jour des véhicules (1 = séquentiel, <= 0 = tous les cœurs)
+    void setUpdateThreadCount(int threads) { m_updateThreadCount = threads; }
+    int updateThreadCount() const { return m_updateThreadCount; }
+
+    // Graine des générateurs aléatoires des véhicules (appliquée aux véhicules ajoutés ensuite)
+    void setRandomSeed(uint64_t seed) { m_randomSeed = seed; }
+    uint64_t randomSeed() const { return m_randomSeed; }
+
+    // Calcule en parallèle (RoutePlanner::planBatch) l'itinéraire des véhicules
+    // qui n'en ont pas encore; sinon chacun le demande à son premier déplacement
+    void planRoutes();
+
+    // Index spatial des sommets praticables (plus proche voisin, tirage par zone)
+    const RoadVertexIndex& vertexIndex() const { return m_vertexIndex; }
+
+    // Planificateur d'itinéraires partagé par tous les véhicules
+    RoutePlanner& routePlanner() { return m_routePlanner; }
+    const RoutePlanner& routePlanner() const { return m_routePlanner; }
+
     // Read-only access for rendering / UI
     const std::vector<Vehicule*>& vehicles() const { return m_vehicles; }
 
-    // Access to interference graph for visualization
+    // État de la flotte en tableaux contigus; la ligne i correspond à vehicles()[i]
+    const VehicleStore& vehicleStore() const { return m_vehicleStore; }
+
+    // Véhicule à partir de son ID en O(1) (nullptr s'il a été supprimé ou en relecture)
+    Vehicule* findVehicle(int vehicleId) const {
+        const int row = m_vehicleStore.rowOf(vehicleId);
+        return row < 0 || row >= static_cast<int>(m_vehicles.size()) ? nullptr : m_vehicles[row];
+    }
+
+    // Dernier graphe d'interférence calculé (immuable, partagé sans copie).
+    // Le pointeur reste valide tant que l'appelant le conserve, même si un
+    // nouveau graphe est publié entre-temps par le worker.
+    std::shared_ptr<const InterferenceGraph> currentGraph() const;
+
+    // Pipeline: numéro du dernier tick simulé et retard du graphe publié (en ticks)
+    uint64_t tickSequence() const { return m_tickSequence; }
+    int graphLatencyTicks() const;
+
+    // Politique quand le calcul du graphe n'a pas fini au tick suivant
+    void setBackpressurePolicy(BackpressurePolicy policy) { m_backpressurePolicy = policy; }
+    BackpressurePolicy backpressurePolicy() const { return m_backpressurePolicy; }
+
+    // Mode incrémental: le graphe ne reteste que les paires des listes de Verlet
+    // (reconstruites quand un véhicule a parcouru plus de la moitié de la marge,
+    // skinFraction × portée max)
+    void setIncrementalGraph(bool enabled, double skinFraction = 0.1);
+    bool incrementalGraph() const { return m_neighborList != nullptr; }
+    const VerletNeighborList* neighborList() const { return m_neighborList.get(); }
+
+    // Carte de densité de la flotte (rendu à faible zoom), construite par le
+    // worker avec chaque graphe; nullptr tant qu'aucune n'a été construite
+    void setDensityMap(bool enabled);
+    bool densityMapEnabled() const { return m_densityEnabled; }
+    // Zoom de la vue: taille des cellules des prochaines cartes
+    void setDensityZoom(int zoom) { m_densityZoom = zoom; }
+    std::shared_ptr<const DensityGrid> currentDensity() const;
+
+    // Empreinte du fichier OSM du graphe routier (RoadGraphCache::hashFile):
+    // écrite dans les enregistrements, vérifiée par openReplay
+    void setRoadGraphSourceHash(uint64_t hash) { m_roadGraphSourceHash = hash; }
+    RecordingGraphIdentity roadGraphIdentity() const;
+
+    // Enregistrement: à chaque tick, positions et connexions du graphe publié
+    // sont écrites dans path par un thread dédié (format de sim_recording.h)
+    bool startRecording(const std::string& path, const RecordingOptions& options = RecordingOptions());
+    void stopRecording();
+    bool isRecording() const { return m_recorder != nullptr; }
+    RecordingWriter* recorder() { return m_recorder.get(); }
+
+    // Relecture: la flotte et les connexions viennent du fichier (aucun véhicule
+    // simulé, vehicles() reste vide); les trames suivent le temps simulé enregistré
+    bool openReplay(const std::string& path);
+    void closeReplay();
+    bool isReplaying() const { return m_replay != nullptr; }
+    const RecordingReader* replayReader() const { return m_replay.get(); }
+    // Affiche la dernière trame dont le tick est <= tick
+    bool seekReplay(uint64_t tick);
+    // Affiche la trame suivante sans attendre (false en fin de fichier)
+    bool stepReplayFrame();
+
+    // Propagation de messages sur les connexions directes du graphe publié:
+    // messagesPerSecond messages (temps simulé) émis par des véhicules tirés au hasard
+    void setMessagePropagation(bool enabled);
+    bool messagePropagationEnabled() const { return m_messagesEnabled; }
+    void setMessageRate(double messagesPerSecond) { m_messageRate = std::max(0.0, messagesPerSecond); }
+    double messageRate() const { return m_messageRate; }
+    MessageEngine& messageEngine() { return m_messageEngine; }
+    const MessageEngine& messageEngine() const { return m_messageEngine; }
+
+    // Nombre de snapshots ignorés (Drop) ou remplacés par un plus récent (Coalesce)
+    int droppedGraphJobs() const { return m_droppedGraphJobs; }
+
+    // Nombre de véhicules ayant changé de petite antenne au dernier tick
+    int lastHandoffCount() const { return m_lastHandoffCount; }
+
+    // Durées des étapes du dernier stepOnce
+    const TickTimings& lastTickTimings() const { return m_lastTickTimings; }
+
+    // Access to interference graph configuration (spatial grid, options)
     const InterferenceGraph& interferenceGraph() const { return m_interferenceGraph; }
     InterferenceGraph& interferenceGraph() { return m_interferenceGraph; }
     const InterferenceGraph& getInterferenceGraph() const { return m_interferenceGraph; }
@@ -67,6 +245,12 @@ signals:
     // Emitted after each tick (after vehicles updated) to repaint
     void ticked(double deltaTimeSeconds);
 
+    // Émis quand un nouveau graphe d'interférence est publié (ou vidé par reset)
+    void graphUpdated();
+
+    // Émis quand une nouvelle disposition des antennes est en place
+    void antennasPlaced();
+
 
 public slots:
     // slot used by internal timer
@@ -74,18 +258,58 @@ public slots:
     
 private slots:
     void onGraphCalculationFinished();
+    void onAntennaPlacementFinished();
 
 
 private:
     // Internal step logic: advances all vehicles by deltaTime
     void updateSimulation(double deltaSeconds);
     
-    // Lance le calcul du graphe en arrière-plan
+    // Attend le calcul lancé par le timer et rend les jobs en cours et en attente
+    void finishGraphJobs();
+
+    // Soumet les positions du tick courant au calcul du graphe selon la politique
     void startGraphCalculation();
 
+    // Copie les positions courantes et les infos d'antennes dans job (thread GUI)
+    void captureGraphJob(GraphJob& job) const;
+
+    // Lance un calcul de graphe dans un thread séparé
+    void launchGraphJob(std::shared_ptr<GraphJob> job);
+
+    // Job libre (tampons du tick précédent) ou nouveau, et retour à la liste libre
+    std::shared_ptr<GraphJob> acquireGraphJob();
+    void recycleGraphJob(std::shared_ptr<GraphJob> job);
+
+    // Détruit un véhicule retiré de la flotte (pool ou delete selon son origine)
+    void releaseVehicle(Vehicule* v);
+
+    // Remplace atomiquement le graphe publié (appelé depuis le worker)
+    void publishGraph(std::shared_ptr<const InterferenceGraph> graph);
+
+    // Construit et publie la carte de densité d'un graphe (thread du graphe)
+    void publishDensity(const std::vector<VehicleSnapshot>& snapshots, const InterferenceGraph& graph, int zoom);
+
+    // Copie les positions et la grille courante puis lance le K-means dans un thread séparé
+    void launchAntennaPlacement(int numLarge, int numSmall);
+
+    // Installe la grille calculée (thread GUI), une seule fois par placement
+    void applyAntennaPlacement();
+
+    // Relecture: consomme les trames dues après deltaSeconds et affiche la dernière
+    void advanceReplay(double deltaSeconds);
+
+    // Réécrit le store et publie le graphe d'une trame relue
+    void applyReplayFrame(const RecordedFrame& frame);
+
+    // Émet les messages du tick et traite les événements jusqu'à la fin du tick
+    // (renvoie le nombre d'événements)
+    size_t advanceMessages(double deltaSeconds);
+
 private:
     const RoadGraph& graph;
-    MapView* m_mapView;
+    RoutePlanner m_routePlanner;    // A* + cache LRU, partagé par les véhicules
+    RoadVertexIndex m_vertexIndex;  // R-tree des sommets praticables
 
     QTimer* m_timer;
     QElapsedTimer m_elapsed;    //to compute deltaTime between ticks (tick = update)
@@ -94,16 +318,60 @@ private:
     bool m_running = false;
     bool m_paused = false;
     bool m_collisionDetectionEnabled = true;
+    int m_updateThreadCount = 0;
+    uint64_t m_randomSeed = 0;
 
+    VehiclePool m_vehiclePool;      // Véhicules créés par le simulateur (adresses stables)
     std::vector<Vehicule*> m_vehicles;
+    VehicleStore m_vehicleStore;    // Positions / états synchronisés avec m_vehicles
+    std::vector<VehicleSnapshot> m_ghostSnapshots;  // Voisins des autres shards (mode réparti)
+    // Configuration du graphe et grille spatiale (thread GUI uniquement)
     InterferenceGraph m_interferenceGraph;
     
+    // Dernier résultat publié, lu/écrit via std::atomic_load/std::atomic_store
+    std::shared_ptr<const InterferenceGraph> m_publishedGraph;
+    // Carte de densité du dernier graphe, même protocole
+    std::shared_ptr<const DensityGrid> m_publishedDensity;
+    bool m_densityEnabled = false;
+    int m_densityZoom = 12;
+    
     // Pour le calcul asynchrone du graphe
-    QFutureWatcher<InterferenceGraph>* m_futureWatcher = nullptr;
+    QFutureWatcher<void>* m_futureWatcher = nullptr;
     std::atomic<bool> m_calculationInProgress{false};
     
+    // Pipeline tick -> graphe
+    uint64_t m_tickSequence = 0;
+    BackpressurePolicy m_backpressurePolicy = BackpressurePolicy::Coalesce;
+    std::shared_ptr<GraphJob> m_pendingJob;  // Dernier snapshot en attente (Coalesce)
+    std::shared_ptr<GraphJob> m_runningJob;  // Job du calcul en cours, rendu à la fin du calcul
+    std::vector<std::shared_ptr<GraphJob>> m_freeGraphJobs;  // Tampons réutilisables
+    int m_droppedGraphJobs = 0;
+    int m_lastHandoffCount = 0;     // Transferts d'antenne du dernier tick
+    TickTimings m_lastTickTimings;  // Durées des étapes du dernier stepOnce
+    std::shared_ptr<VerletNeighborList> m_neighborList;  // Mode incrémental (nullptr = désactivé)
+    
+    // Placement asynchrone des antennes
+    QFutureWatcher<std::shared_ptr<SpatialGrid>>* m_antennaWatcher = nullptr;
+    bool m_antennaResultPending = false;  // Résultat terminé pas encore installé
+    int m_pendingMacroAntennas = -1;      // Demande arrivée pendant un placement (-1 = aucune)
+    int m_pendingMicroAntennas = -1;
+    
+    // Enregistrement et relecture
+    std::unique_ptr<RecordingWriter> m_recorder;
+    uint64_t m_roadGraphSourceHash = 0;
+    std::unique_ptr<RecordingReader> m_replay;
+    RecordedFrame m_replayNext;        // Prochaine trame, lue mais pas encore due
+    bool m_replayNextReady = false;
+    double m_replayClock = 0.0;        // Temps simulé écoulé depuis la dernière trame affichée
+    
+    // Propagation des messages
+    MessageEngine m_messageEngine;
+    bool m_messagesEnabled = false;
+    double m_messageRate = 200.0;      // Messages par seconde simulée
+    double m_messageBacklog = 0.0;     // Fraction de message reportée au tick suivant
+    double m_simulatedMs = 0.0;        // Horloge du moteur de messages
+    
     // Pour la création dynamique de véhicules
-    std::vector<Vertex> m_vertices;
     int m_nextVehicleId = 0;
 };
 
@@ -4,8 +4,9 @@
 #include <vector>
 #include <unordered_map>
 #include <unordered_set>
-#include <set>
+#include <utility>
 #include <cmath>
+#include <cstdint>
 
 class Vehicule;
 
@@ -18,8 +19,9 @@ struct MicroAntenna {
     double centerLat;
     double centerLon;
     double radius;  // Rayon de couverture
-    std::vector<int> vehicleIds;  // Véhicules dans cette zone
-    std::set<int> neighborMicroIds;  // Petites antennes voisines
+    double handoffRadius = 0.0;  // En deçà, aucune autre petite antenne n'est plus proche
+    std::vector<int> vehicleIds;  // Véhicules dans cette zone (ordre quelconque)
+    std::vector<int> neighborMicroIds;  // Petites antennes voisines (IDs triés)
 };
 
 /**
@@ -31,7 +33,7 @@ struct MacroAntenna {
     double centerLon;
     double radius;  // Rayon de couverture
     std::vector<int> microAntennaIds;  // IDs des petites antennes
-    std::set<int> neighborMacroIds;  // Grandes antennes voisines
+    std::vector<int> neighborMacroIds;  // Grandes antennes voisines (IDs triés)
 };
 
 /**
@@ -44,17 +46,59 @@ class SpatialGrid {
 public:
     SpatialGrid();
     ~SpatialGrid();
+    SpatialGrid(const SpatialGrid&) = default;
+    SpatialGrid& operator=(const SpatialGrid&) = default;
+    SpatialGrid(SpatialGrid&&) = default;
+    SpatialGrid& operator=(SpatialGrid&&) = default;
 
     /**
      * @brief Initialise la grille spatiale basée sur les positions des véhicules
      * @param vehicles Liste des véhicules
      * @param numMacroAntennas Nombre de grandes antennes (défaut: 10)
      * @param microPerMacro Nombre de petites antennes par grande antenne (défaut: 10)
+     *
+     * Les centres des grandes antennes déjà placées servent de départ au K-means.
      */
     void initialize(const std::vector<Vehicule*>& vehicles, 
                    int numMacroAntennas = 10, 
                    int microPerMacro = 10);
 
+    /**
+     * @brief Initialise la grille à partir de positions copiées (utilisable hors du thread GUI)
+     * @param ids Identifiants des véhicules
+     * @param lats Latitudes (même indice que ids)
+     * @param lons Longitudes (même indice que ids)
+     * @param warmStart Centres (lat, lon) de départ du K-means, complétés par k-means++
+     */
+    void initialize(const std::vector<int>& ids, const std::vector<double>& lats,
+                    const std::vector<double>& lons, int numMacroAntennas, int microPerMacro,
+                    const std::vector<std::pair<double, double>>& warmStart = {});
+
+    /**
+     * @brief Centres (lat, lon) des grandes antennes, par ID croissant
+     */
+    std::vector<std::pair<double, double>> getMacroCenters() const;
+
+    /**
+     * @brief Nombre de threads du K-means (1 = séquentiel, <= 0 = nombre de cœurs)
+     *
+     * Le résultat ne dépend pas du nombre de threads.
+     */
+    void setThreadCount(int threads) { m_threadCount = threads; }
+    int getThreadCount() const { return m_threadCount; }
+
+    // Itérations de Lloyd effectuées par le dernier placement (convergence ou plafond)
+    int getLastKMeansIterations() const { return m_lastKMeansIterations; }
+
+    /**
+     * @brief Identifiant des petites antennes et de leurs voisinages actuels
+     *
+     * Change (valeur unique, tous objets confondus) à chaque recalcul des
+     * voisinages et à chaque clear(); conservé par copie (0 = grille jamais remplie).
+     * Permet de ne recopier les voisinages que s'ils ont changé.
+     */
+    uint64_t getLayoutVersion() const { return m_layoutVersion; }
+
     /**
      * @brief Définit la portée de transmission maximale pour le calcul des voisinages
      * @param range Portée maximale en mètres
@@ -77,6 +121,9 @@ public:
      * @param vehicles Liste des véhicules
      */
     void assignVehiclesToAntennas(const std::vector<Vehicule*>& vehicles);
+    // Même chose à partir de positions copiées (recherche parallèle, insertion dans l'ordre des ids)
+    void assignVehiclesToAntennas(const std::vector<int>& ids, const std::vector<double>& lats,
+                                  const std::vector<double>& lons);
 
     /**
      * @brief Assigne un seul véhicule à sa petite antenne la plus proche
@@ -85,11 +132,36 @@ public:
     void assignVehicleToAntenna(Vehicule* vehicle);
 
     /**
-     * @brief Retire un véhicule de son antenne
+     * @brief Retire un véhicule de son antenne (en O(1), par échange avec le dernier)
      * @param vehicleId ID du véhicule à retirer
      */
     void removeVehicleFromAntenna(int vehicleId);
 
+    /**
+     * @brief Transfert incrémental (handoff) des véhicules ayant changé de cellule
+     * @param ids Identifiants des véhicules
+     * @param lats Latitudes courantes (même indice que ids)
+     * @param lons Longitudes courantes (même indice que ids)
+     * @return Nombre de véhicules transférés vers une autre petite antenne
+     *
+     * Un véhicule à moins de handoffRadius du centre de son antenne reste en
+     * place sans autre calcul. Sinon il n'est transféré que si la nouvelle
+     * antenne est plus proche d'au moins la marge d'hystérésis, pour éviter
+     * les allers-retours en bordure de cellule.
+     */
+    int updateAssignments(const std::vector<int>& ids, const std::vector<double>& lats,
+                          const std::vector<double>& lons);
+
+    /**
+     * @brief Marge d'hystérésis des transferts (mètres)
+     */
+    void setHandoffHysteresis(double meters) { m_handoffHysteresis = meters; }
+    double getHandoffHysteresis() const { return m_handoffHysteresis; }
+
+    // Statistiques de transfert: dernier appel à updateAssignments et cumul
+    int getLastHandoffCount() const { return m_lastHandoffCount; }
+    long long getTotalHandoffCount() const { return m_totalHandoffCount; }
+
     /**
      * @brief Obtient tous les véhicules proches (même antenne + voisines)
      * @param vehicleId ID du véhicule
@@ -107,6 +179,11 @@ public:
      */
     int getMacroAntennaId(int vehicleId) const;
 
+    /**
+     * @brief IDs de tous les véhicules assignés à une antenne
+     */
+    std::vector<int> assignedVehicleIds() const;
+
     /**
      * @brief Efface toutes les données
      */
@@ -124,8 +201,13 @@ public:
 private:
     /**
      * @brief Place les grandes antennes selon la densité de véhicules (K-means)
+     *
+     * Lloyd sur toutes les positions, projetées en mètres autour du centre de
+     * l'emprise, en parallèle par blocs (sommes partielles par bloc, réduites
+     * dans l'ordre). Départ: warmStart, complété par k-means++ (tirage D²).
      */
-    void placeMacroAntennas(const std::vector<Vehicule*>& vehicles, int numMacro);
+    void placeMacroAntennas(const std::vector<double>& lats, const std::vector<double>& lons, int numMacro,
+                            const std::vector<std::pair<double, double>>& warmStart);
 
     /**
      * @brief Place les petites antennes uniformément dans chaque grande antenne
@@ -137,6 +219,28 @@ private:
      */
     void computeNeighborhoods();
 
+    /**
+     * @brief Voisinages des petites antennes (portée + rayons), via une grille
+     * dont la cellule couvre la distance maximale de communication: seules
+     * les antennes des 3×3 cellules voisines sont comparées
+     */
+    void computeMicroNeighborhoods();
+
+    /**
+     * @brief Calcule le rayon de maintien de chaque petite antenne
+     * (moitié de la distance à la petite antenne la plus proche)
+     */
+    void computeHandoffRadii();
+
+    // Position d'un véhicule: antenne et indice dans MicroAntenna::vehicleIds
+    struct AntennaSlot {
+        int microId;
+        int index;
+    };
+
+    void addToMicro(int vehicleId, int microId);
+    void removeFromMicro(const AntennaSlot& slot);
+
     /**
      * @brief Trouve l'antenne la plus proche d'une position
      */
@@ -150,12 +254,18 @@ private:
 private:
     std::unordered_map<int, MacroAntenna> m_macroAntennas;
     std::unordered_map<int, MicroAntenna> m_microAntennas;
-    std::unordered_map<int, int> m_vehicleToMicroAntenna;  // vehicleId -> microAntennaId
+    std::unordered_map<int, AntennaSlot> m_vehicleToMicroAntenna;  // vehicleId -> antenne et indice
     
     // Paramètres
     int m_numMacroAntennas;
     int m_microPerMacro;
     double m_maxTransmissionRange = 1000.0;  // Portée de transmission max (par défaut 1000m)
+    double m_handoffHysteresis = 10.0;       // Marge avant transfert vers une autre antenne (m)
+    int m_lastHandoffCount = 0;
+    long long m_totalHandoffCount = 0;
+    int m_threadCount = 0;
+    int m_lastKMeansIterations = 0;
+    uint64_t m_layoutVersion = 0;
 };
 
 #endif // SPATIAL_GRID_H
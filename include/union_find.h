@@ -0,0 +1,64 @@
+#ifndef UNION_FIND_H
+#define UNION_FIND_H
+
+#include <numeric>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Structure union-find (ensembles disjoints) sur des indices denses [0, n)
+ *
+ * Union par taille et compression de chemin par division (path halving):
+ * chaque opération est en O(α(n)), quasi constant.
+ */
+class UnionFind {
+public:
+    explicit UnionFind(size_t n = 0) { reset(n); }
+
+    /**
+     * @brief Réinitialise la structure avec n singletons
+     */
+    void reset(size_t n) {
+        m_parent.resize(n);
+        std::iota(m_parent.begin(), m_parent.end(), 0);
+        m_size.assign(n, 1);
+    }
+
+    /**
+     * @brief Représentant de l'ensemble contenant x
+     */
+    int find(int x) {
+        while (m_parent[x] != x) {
+            m_parent[x] = m_parent[m_parent[x]];
+            x = m_parent[x];
+        }
+        return x;
+    }
+
+    /**
+     * @brief Fusionne les ensembles de a et b
+     * @return true si une fusion a eu lieu (a et b étaient séparés)
+     */
+    bool unite(int a, int b) {
+        a = find(a);
+        b = find(b);
+        if (a == b) return false;
+        if (m_size[a] < m_size[b]) std::swap(a, b);
+        m_parent[b] = a;
+        m_size[a] += m_size[b];
+        return true;
+    }
+
+    /**
+     * @brief Taille de l'ensemble contenant x
+     */
+    int componentSize(int x) { return m_size[find(x)]; }
+
+    size_t size() const { return m_parent.size(); }
+
+private:
+    std::vector<int> m_parent;
+    std::vector<int> m_size;
+};
+
+#endif // UNION_FIND_H
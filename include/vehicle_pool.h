@@ -0,0 +1,73 @@
+#ifndef VEHICLE_POOL_H
+#define VEHICLE_POOL_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "vehicule.h"
+
+/**
+ * @brief Allocateur par blocs (slabs) des véhicules de la simulation
+ *
+ * Les véhicules sont construits sur place dans des blocs de SLAB_SIZE
+ * emplacements qui ne sont jamais déplacés: un Vehicule* reste valide
+ * jusqu'à destroy(), quels que soient les ajouts suivants. Les emplacements
+ * libérés sont réutilisés en priorité (liste libre, le dernier libéré
+ * d'abord) et les blocs ne sont rendus qu'à la destruction du pool.
+ * Ajouts et suppressions ne touchent donc plus au tas une fois la flotte
+ * à sa taille maximale.
+ *
+ * Utilisé depuis un seul thread (thread GUI du Simulator).
+ */
+class VehiclePool {
+public:
+    static constexpr size_t SLAB_SIZE = 256;  ///< Véhicules par bloc
+
+    VehiclePool() = default;
+    ~VehiclePool() = default;  // Les véhicules encore vivants doivent avoir été détruits
+    VehiclePool(const VehiclePool&) = delete;
+    VehiclePool& operator=(const VehiclePool&) = delete;
+
+    /**
+     * @brief Construit un véhicule dans un emplacement libre
+     * @param args Arguments du constructeur de Vehicule
+     */
+    template <typename... Args>
+    Vehicule* create(Args&&... args) {
+        void* slot = acquireSlot();
+        m_live++;
+        return new (slot) Vehicule(std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Détruit un véhicule créé par ce pool et libère son emplacement
+     */
+    void destroy(Vehicule* v);
+
+    /**
+     * @brief true si v est (ou a été) construit dans un bloc de ce pool
+     *
+     * Recherche dichotomique dans les débuts de blocs: O(log blocs).
+     */
+    bool owns(const Vehicule* v) const;
+
+    size_t liveCount() const { return m_live; }
+    size_t capacity() const { return m_slabs.size() * SLAB_SIZE; }
+    size_t slabCount() const { return m_slabs.size(); }
+
+private:
+    using Slot = std::aligned_storage_t<sizeof(Vehicule), alignof(Vehicule)>;
+
+    void* acquireSlot();
+
+private:
+    std::vector<std::unique_ptr<Slot[]>> m_slabs;
+    std::vector<Slot*> m_freeSlots;
+    std::vector<const Slot*> m_slabBases;  // Début de chaque bloc, trié par adresse (owns)
+    size_t m_live = 0;
+};
+
+#endif // VEHICLE_POOL_H
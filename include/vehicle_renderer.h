@@ -4,57 +4,123 @@
 #include <QPainter>
 #include <QPixmap>
 #include <QImage>
+#include <QHash>
 #include <QSvgRenderer>
 #include <cmath>
 #include <memory>
+#include <vector>
 #include <QString>
 
 /**
  * @brief Classe responsable du rendu des véhicules sous forme de SVG
- * 
+ *
  * Cette classe gère le dessin des véhicules comme de petites voitures orientées
  * selon leur direction de déplacement. Utilise une image SVG chargée depuis le disque.
+ *
+ * Le SVG n'est rastérisé qu'une fois par teinte et par taille: les sprites
+ * teintés sont gardés en cache, et la palette des véhicules est regroupée dans
+ * un atlas dessiné en un seul appel drawPixmapFragments par image.
  */
 class VehicleRenderer {
 public:
     VehicleRenderer() = default;
     ~VehicleRenderer() = default;
 
+    // Nombre de teintes de la palette des véhicules (une cellule d'atlas chacune)
+    static constexpr int PALETTE_SIZE = 32;
+
+    /**
+     * @brief Véhicule à dessiner dans un lot (drawVehicles)
+     */
+    struct Sprite {
+        QPointF position;   ///< Centre du véhicule (en pixels écran)
+        double heading;     ///< Direction en degrés (0° = vers le haut)
+        int tint;           ///< Indice dans la palette (paletteIndex)
+    };
+
     /**
      * @brief Définit le chemin vers l'image SVG (lazy initialization)
      * @param svgPath Chemin vers le fichier SVG (ex: "data/top_view_icon.svg")
      */
     static void setSvgPath(const QString& svgPath);
 
+    /**
+     * @brief Teinte de la palette attribuée à un véhicule
+     */
+    static int paletteIndex(int vehicleId) {
+        return ((vehicleId % PALETTE_SIZE) + PALETTE_SIZE) % PALETTE_SIZE;
+    }
+
+    /**
+     * @brief Couleur d'une teinte de la palette selon le thème
+     */
+    static QColor paletteColor(int index, bool darkTheme);
+
     /**
      * @brief Dessine un véhicule à une position et orientation données
-     * 
+     *
      * @param painter Le QPainter à utiliser pour le dessin
      * @param position Position du centre du véhicule (en pixels écran)
      * @param heading Direction du véhicule en degrés (0° = vers le haut)
      * @param color Couleur du véhicule
      * @param size Taille approximative du véhicule en pixels
      */
-    static void drawVehicle(QPainter& painter, 
+    static void drawVehicle(QPainter& painter,
                            const QPointF& position,
                            double heading,
                            const QColor& color,
                            double size = 12.0);
 
+    /**
+     * @brief Dessine un lot de véhicules teintés avec la palette
+     *
+     * Un seul drawPixmapFragments depuis l'atlas de la palette (rotation comprise);
+     * sans SVG, repli sur la forme vectorielle de drawVehicle.
+     *
+     * @param painter Le QPainter à utiliser pour le dessin
+     * @param sprites Véhicules à dessiner
+     * @param darkTheme Palette du thème sombre ou clair
+     * @param size Taille approximative des véhicules en pixels
+     */
+    static void drawVehicles(QPainter& painter,
+                             const std::vector<Sprite>& sprites,
+                             bool darkTheme,
+                             double size);
+
 private:
     /**
      * @brief Initialise le SVG la première fois qu'il est nécessaire
      */
     static void lazyInitialize();
 
+    /**
+     * @brief Sprite teinté (côté en pixels physiques), rastérisé au premier appel
+     */
+    static const QImage& tintedSprite(const QColor& color, int pixelSize);
+
+    /**
+     * @brief Atlas des teintes de la palette (grille de PALETTE_SIZE cellules)
+     * @return nullptr si le SVG n'est pas disponible
+     */
+    static const QPixmap* paletteAtlas(bool darkTheme, int pixelSize);
+
+    // Côté du sprite en pixels physiques pour une taille logique et un écran donnés
+    static int spritePixelSize(double size, qreal devicePixelRatio) {
+        return qMax(1, static_cast<int>(std::ceil(size * devicePixelRatio)));
+    }
+
     /**
      * @brief Convertit les degrés en radians
      */
     static constexpr double degreesToRadians(double degrees) {
         return degrees * M_PI / 180.0;
     }
-    
+
     static std::unique_ptr<QSvgRenderer> svgRenderer;
     static QString cachedSvgPath;
     static bool initialized;
+
+    // Caches: clé (couleur, côté en pixels physiques) et (thème, côté)
+    static QHash<quint64, QImage> spriteCache;
+    static QHash<quint64, QPixmap> atlasCache;
 };
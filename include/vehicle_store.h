@@ -0,0 +1,84 @@
+#ifndef VEHICLE_STORE_H
+#define VEHICLE_STORE_H
+
+#include <vector>
+#include <cstddef>
+#include <unordered_map>
+#include "graph_types.h"
+
+class Vehicule;
+
+/**
+ * @brief État courant de la flotte en tableaux contigus (structure of arrays)
+ *
+ * La ligne i correspond à m_vehicles[i] du Simulator. Les boucles chaudes
+ * (snapshots du graphe, filtrage des véhicules visibles au rendu) parcourent
+ * ces tableaux plats au lieu de suivre les pointeurs Vehicule* et de
+ * recalculer chaque position à partir du graphe routier.
+ *
+ * Les lignes sont réécrites par Simulator::updateSimulation juste après la
+ * mise à jour de chaque véhicule (dans le même thread, sans verrou).
+ */
+class VehicleStore {
+public:
+    /**
+     * @brief Ajoute une ligne à la fin à partir de l'état d'un véhicule
+     */
+    void push(const Vehicule& v);
+
+    /**
+     * @brief Réécrit la ligne i à partir de l'état d'un véhicule
+     */
+    void write(size_t i, const Vehicule& v);
+
+    /**
+     * @brief Supprime la ligne i (les lignes suivantes sont décalées,
+     * comme dans std::vector::erase)
+     */
+    void erase(size_t i);
+
+    /**
+     * @brief Supprime la ligne i en y déplaçant la dernière ligne (O(1),
+     * comme m_vehicles[i] = m_vehicles.back() suivi de pop_back())
+     */
+    void swapRemove(size_t i);
+
+    /**
+     * @brief Remplace les véhicules du store par ces IDs, dans cet ordre
+     * (relecture d'un enregistrement: les autres colonnes sont à remplir par l'appelant)
+     */
+    void setIds(const std::vector<int>& newIds);
+
+    void popBack();
+    void clear();
+    void reserve(size_t n);
+
+    /**
+     * @brief Ligne d'un véhicule à partir de son ID (table de hachage, O(1))
+     * @return -1 si le véhicule n'est pas dans le store
+     */
+    int rowOf(int vehicleId) const {
+        auto it = m_rowOfId.find(vehicleId);
+        return it == m_rowOfId.end() ? -1 : it->second;
+    }
+
+    size_t size() const { return ids.size(); }
+    bool empty() const { return ids.empty(); }
+
+    // Tableaux publics en lecture: un indice = un véhicule
+    std::vector<int> ids;
+    std::vector<double> lat;
+    std::vector<double> lon;
+    std::vector<double> heading;         // degrés, 0 = nord
+    std::vector<double> speed;           // m/s
+    std::vector<double> range;           // portée de transmission (m)
+    std::vector<Vertex> edgeSource;      // arête courante (source, cible)
+    std::vector<Vertex> edgeTarget;
+    std::vector<double> positionOnEdge;  // distance parcourue sur l'arête (m)
+
+private:
+    // ID -> ligne, tenu à jour par push / erase / clear
+    std::unordered_map<int, int> m_rowOfId;
+};
+
+#endif // VEHICLE_STORE_H
@@ -2,10 +2,44 @@
 #define VEHICULE_H
 
 #include "graph_types.h"
+#include "route_planner.h"
 #include <vector>
-#include <deque>
+#include <array>
 #include <utility>
 #include <cmath>
+#include <cstdint>
+
+/**
+ * @brief Portable state of a vehicle: enough to rebuild it in another process
+ * that loaded the same road graph (vertex ids are graph descriptors)
+ *
+ * Used to migrate a vehicle between shards: the trip continues exactly as if
+ * the vehicle had stayed (remaining route and generator state included).
+ */
+struct VehicleMotionState {
+    int id = -1;
+    Vertex start = 0;
+    Vertex goal = 0;
+    Vertex currVertex = 0;
+    Vertex nextVertex = 0;
+    Vertex previousVertex = 0;
+    bool onEdge = false;         ///< false when no edge is selected yet (e.g. trip just started)
+    double positionOnEdge = 0.0;
+    double speed = 0.0;
+    double transmissionRange = 0.0;
+    double collisionDist = 0.0;
+    double heading = 0.0;
+    uint64_t rngState = 0;
+    // Anti-loop history, in ring order: the random walk continues identically
+    static constexpr int HISTORY_SIZE = 8;
+    std::array<Vertex, HISTORY_SIZE> recentVertices{};
+    int recentCount = 0;
+    int recentHead = 0;
+    int stuckCounter = 0;
+    // Remaining planned route, from the vertex the vehicle is heading to (empty = none)
+    std::vector<Vertex> route;
+    bool routeRequested = false;
+};
 
 
 class Vehicule {
@@ -33,7 +67,7 @@ public:
      * @param from Another vehicle to measure distance from.
      * @return Euclidean distance between vehicles.
      */
-    double calculateDist(Vehicule from) const;
+    double calculateDist(const Vehicule& from) const;
     std::pair<double, double> getPosition() const;
 
     /**
@@ -48,12 +82,60 @@ public:
      */
     Vertex pickNextEdge();
 
+    /**
+     * @brief Enables goal-directed movement: the vehicle asks the planner for a
+     * route once per trip and follows it instead of walking at random
+     * @param planner Shared planner (not owned), nullptr for the random walk
+     */
+    void setRoutePlanner(RoutePlanner* planner) { routePlanner = planner; }
+
+    /**
+     * @brief Sets the route of the current trip (e.g. planned in a batch)
+     * @param newRoute Vertices from the current vertex to the goal
+     */
+    void setRoute(RoutePlanner::Route newRoute);
+
+    /**
+     * @brief true if the vehicle is following a planned route
+     */
+    bool hasRoute() const { return route && route->size() > 1; }
+
+    Vertex getCurrentVertex() const { return currVertex; }
+    Vertex getGoal() const { return goal; }
+
+    /**
+     * @brief Seeds the vehicle's own random generator (used by pickNextEdge)
+     * @param seed Simulation seed, mixed with the vehicle id
+     *
+     * Each vehicle draws from its own deterministic generator instead of the
+     * shared rand(): update() can run on any thread, and a run is reproducible
+     * for a given seed regardless of the number of threads.
+     */
+    void seedRandom(uint64_t seed);
+
+    /**
+     * @brief Snapshot of the state needed to continue the trip elsewhere
+     */
+    VehicleMotionState getMotionState() const;
+
+    /**
+     * @brief Puts the vehicle back on the edge and at the position of a state
+     * taken by getMotionState (same road graph), random generator and route included
+     * @return false if the edge no longer exists (the vehicle then restarts
+     * from state.currVertex)
+     */
+    bool restoreMotionState(const VehicleMotionState& state);
+
     /**
      * @brief checks road validity for car movement/ placement
-     * @param the Edge to check, and graph
+     * @param roadClass the road class of the edge (see DRIVABLE_ROAD_MASK)
      * @return boolean
      */
-    static bool isValidRoad(const std::string& type);
+    static bool isValidRoad(RoadClass roadClass) { return isDrivableRoad(roadClass); }
+
+    /**
+     * @brief O(1): uses the drivable out-degree precomputed by GraphBuilder::finalizeGraph
+     */
     static bool isValidVertex(Vertex v, const RoadGraph& graph);
 
 
@@ -76,6 +158,15 @@ public:
      * @return Angle en degrés (0° = vers le haut, 90° = vers la droite)
      */
     double getHeading() const { return currentHeading; }
+
+    double getSpeed() const { return speed; }
+    double getPositionOnEdge() const { return positionOnEdge; }
+
+    /**
+     * @brief Endpoints of the current edge (both equal to the current vertex
+     * when no edge is selected yet)
+     */
+    std::pair<Vertex, Vertex> getEdgeEndpoints() const;
     
     //setter
     void setTransmissionRange(double range) { transmissionRange = range; }
@@ -101,16 +192,35 @@ private:
     double speed;
     
     // Anti-loop and stuck detection
-    std::deque<Vertex> recentVertices;  // Last N vertices visited
-    static constexpr int MAX_HISTORY = 8;  // Keep track of last 8 vertices
+    static constexpr int MAX_HISTORY = VehicleMotionState::HISTORY_SIZE;  // Keep track of last 8 vertices
+    std::array<Vertex, MAX_HISTORY> recentVertices{};  // Inline ring of the last N vertices visited
+    int recentCount = 0;  // Number of valid entries in recentVertices
+    int recentHead = 0;   // Next slot to overwrite (oldest entry once full)
     int stuckCounter = 0;  // Count consecutive failed edge selections
 
+    void rememberVertex(Vertex v);
+    bool wasRecentlyVisited(Vertex v) const;
+    void clearHistory() { recentCount = 0; recentHead = 0; }
+
+    // Per-vehicle random generator (splitmix64), see seedRandom()
+    uint64_t rngState = 0;
+    uint32_t nextRandom(uint32_t bound);
+
     //default values
     Vertex currVertex;
     double edgeLength = 0.0;      ///< Cach of graph[currEdge].distance
     double positionOnEdge = 0.0;     ///< Distance along the current edge
     bool destReached = false;
     double slowFactor = 0.8;        ///< Speed reduction factor when avoiding collision
+    // Géométrie de l'arête courante dans le sens de parcours, copiée au choix
+    // de l'arête: getPosition n'accède plus au graphe routier
+    double edgeFromLat = 0.0;
+    double edgeFromLon = 0.0;
+    double edgeToLat = 0.0;
+    double edgeToLon = 0.0;
+    double edgeDirEast = 0.0;       ///< Direction unitaire projetée (est)
+    double edgeDirNorth = 0.0;      ///< Direction unitaire projetée (nord)
+
     double currentHeading = 0.0;    ///< Direction du véhicule en degrés (lissée)
     double targetHeading = 0.0;     ///< Direction cible avant lissage
     double headingSmoothingFactor = 0.15; ///< Facteur de lissage du heading (0-1, plus haut = plus rapide)
@@ -120,7 +230,15 @@ private:
     double previousLon = 0.0;
 
     std::vector<Vehicule*> neighbors;
-    std::vector<Vertex> route;      ///< Optional route (sequence of vertices)
+
+    // Itinéraire du trajet courant (partagé avec le cache du planificateur)
+    RoutePlanner* routePlanner = nullptr;
+    RoutePlanner::Route route;      ///< Sequence of vertices from trip start to goal
+    size_t routeIndex = 0;          ///< Index of currVertex in route
+    bool routeRequested = false;    ///< Route already asked for this trip
+
+    bool followRoute(Edge& edge);
+    void applyEdge(Edge e);
 };
 
 #endif
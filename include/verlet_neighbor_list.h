@@ -0,0 +1,107 @@
+#ifndef VERLET_NEIGHBOR_LIST_H
+#define VERLET_NEIGHBOR_LIST_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "interference_graph.h"
+
+/**
+ * @brief Listes de voisins de Verlet, conservées d'un tick à l'autre
+ *
+ * Chaque véhicule garde la liste des candidats situés à moins de
+ * portée + marge (skin) lors de la dernière reconstruction. Tant qu'aucun
+ * véhicule ne s'est déplacé de plus de skin/2 depuis, aucune paire hors de
+ * cette liste ne peut être passée à portée: chaque tick ne reteste que les
+ * paires candidates, et les connexions sont comparées à celles du tick
+ * précédent pour produire les arêtes ajoutées et retirées.
+ *
+ * La liste est reconstruite (grille uniforme, cellule = portée max + marge)
+ * au premier appel, quand un véhicule a parcouru plus de skin/2, quand
+ * l'ensemble des véhicules change ou quand une portée change.
+ *
+ * Un seul thread à la fois doit appeler update() (le worker du graphe).
+ */
+class VerletNeighborList {
+public:
+    /**
+     * @brief Résultat d'une mise à jour
+     */
+    struct Update {
+        std::vector<EdgeList> edges;  ///< Connexions courantes (indices des snapshots), un buffer par thread
+        EdgeIdList added;             ///< Connexions apparues depuis l'appel précédent
+        EdgeIdList removed;           ///< Connexions disparues depuis l'appel précédent
+        int64_t comparisons = 0;      ///< Tests de distance (paires candidates + reconstruction)
+        bool rebuilt = false;         ///< true si les candidats ont été recalculés
+    };
+
+    /**
+     * @brief Reteste les paires candidates avec les positions courantes
+     * @param snapshots Positions du tick (même ordre d'un appel à l'autre, sinon reconstruction)
+     * @param threads Nombre de threads (<= 0 = nombre de cœurs)
+     * @param out Connexions courantes et différences avec l'appel précédent
+     */
+    void update(const std::vector<VehicleSnapshot>& snapshots, int threads, Update& out);
+
+    /**
+     * @brief Marge ajoutée à la portée, en fraction de la portée maximale
+     * @param fraction 0.1 par défaut: candidats à moins de 1,1 × portée
+     *
+     * Une marge plus grande espace les reconstructions mais allonge les listes.
+     * Prend effet à la prochaine reconstruction.
+     */
+    void setSkinFraction(double fraction) { m_skinFraction = std::max(0.0, fraction); }
+    double skinFraction() const { return m_skinFraction; }
+
+    // Marge courante (m) et nombre de paires candidates
+    double skin() const { return m_skin; }
+    size_t candidateCount() const { return m_candidates.size(); }
+
+    // Nombre de reconstructions depuis la création
+    uint64_t rebuildCount() const { return m_rebuildCount; }
+
+    /**
+     * @brief Oublie les candidats et les connexions (prochain update = reconstruction)
+     */
+    void clear();
+
+private:
+    // Projection à origine fixe (choisie à la reconstruction), en float comme DistanceKernel
+    void project(const std::vector<VehicleSnapshot>& snapshots, ProjectedPositions& projected) const;
+
+    // true si les candidats ne garantissent plus de voir toutes les paires à portée
+    bool needsRebuild(const std::vector<VehicleSnapshot>& snapshots, const ProjectedPositions& projected) const;
+
+    // Recalcule m_candidates (CSR, j > i) par grille uniforme
+    int64_t rebuild(const std::vector<VehicleSnapshot>& snapshots, int threads);
+
+    // Connexions courantes en paires d'IDs triées (à partir de m_inRange)
+    EdgeIdList currentEdgeIds() const;
+
+    // Teste chaque paire candidate et remplit out.edges (et les différences si emitDeltas)
+    void testCandidates(const ProjectedPositions& projected, int threads, bool emitDeltas, Update& out);
+
+private:
+    double m_skinFraction = 0.1;
+    double m_skin = 0.0;
+
+    // Origine de la projection et échelle des longitudes
+    double m_originLat = 0.0;
+    double m_originLon = 0.0;
+    double m_metersPerDegLon = 0.0;
+
+    // État à la dernière reconstruction (mêmes indices que les snapshots)
+    std::vector<int> m_ids;
+    std::vector<double> m_ranges;
+    ProjectedPositions m_reference;
+
+    // Candidats au format CSR: ceux du véhicule i sont
+    // m_candidates[m_offsets[i] .. m_offsets[i + 1]), tous d'indice > i
+    std::vector<int> m_offsets;
+    std::vector<int> m_candidates;
+    std::vector<uint8_t> m_inRange;  // Paire candidate k à portée au dernier update
+
+    uint64_t m_rebuildCount = 0;
+};
+
+#endif // VERLET_NEIGHBOR_LIST_H
@@ -0,0 +1,123 @@
+#include "density_grid.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include "profiler.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Degré moyen à mi-chemin de la palette (teinte 95°, vert-jaune)
+static constexpr double DEGREE_HALF_SCALE = 4.0;
+// Teinte des cellules les mieux connectées (0° = rouge, cellules de véhicules isolés)
+static constexpr double MAX_HUE = 190.0;
+// Opacité d'une cellule à un véhicule et de la cellule la plus dense
+static constexpr double MIN_ALPHA = 70.0;
+static constexpr double MAX_ALPHA = 235.0;
+
+// Couleur 0xAARRGGBB d'une teinte (degrés), saturation et valeur dans [0, 1]
+static uint32_t hsvToArgb(double hue, double saturation, double value, uint32_t alpha) {
+    const double c = value * saturation;
+    const double h = std::fmod(hue, 360.0) / 60.0;
+    const double x = c * (1.0 - std::fabs(std::fmod(h, 2.0) - 1.0));
+    double r = 0.0, g = 0.0, b = 0.0;
+    switch (static_cast<int>(h)) {
+        case 0: r = c; g = x; break;
+        case 1: r = x; g = c; break;
+        case 2: g = c; b = x; break;
+        case 3: g = x; b = c; break;
+        case 4: r = x; b = c; break;
+        default: r = c; b = x; break;
+    }
+    const double m = value - c;
+    auto channel = [m](double v) { return static_cast<uint32_t>(std::lround((v + m) * 255.0)); };
+    return (alpha << 24) | (channel(r) << 16) | (channel(g) << 8) | channel(b);
+}
+
+void DensityGrid::lonLatToWorld(double lon, double lat, int zoom, double& px, double& py) {
+    const double n = std::pow(2.0, zoom);
+    const double latRad = lat * M_PI / 180.0;
+    px = (lon + 180.0) / 360.0 * 256.0 * n;
+    py = (1.0 - std::log(std::tan(latRad) + 1.0 / std::cos(latRad)) / M_PI) / 2.0 * 256.0 * n;
+}
+
+DensityGrid DensityGrid::build(const std::vector<VehicleSnapshot>& snapshots, const InterferenceGraph& graph,
+                               int zoom, int cellPixels) {
+    Profiler::ScopedTimer timer(Profiler::Stage::DensityGrid);
+    auto startTime = std::chrono::steady_clock::now();
+
+    DensityGrid grid;
+    grid.m_zoom = zoom;
+    grid.m_cellPixels = std::max(1, cellPixels);
+    if (snapshots.empty()) return grid;
+
+    // Positions écran au zoom demandé et emprise de la flotte
+    std::vector<double> xs(snapshots.size()), ys(snapshots.size());
+    double minX = std::numeric_limits<double>::max(), minY = minX;
+    double maxX = std::numeric_limits<double>::lowest(), maxY = maxX;
+    for (size_t i = 0; i < snapshots.size(); ++i) {
+        lonLatToWorld(snapshots[i].lon, snapshots[i].lat, zoom, xs[i], ys[i]);
+        minX = std::min(minX, xs[i]);
+        maxX = std::max(maxX, xs[i]);
+        minY = std::min(minY, ys[i]);
+        maxY = std::max(maxY, ys[i]);
+    }
+
+    // Flotte très étendue à ce zoom: agrandir les cellules plutôt que d'allouer sans limite
+    auto cellsFor = [&](double cell) {
+        return (std::floor(maxX / cell) - std::floor(minX / cell) + 1.0) *
+               (std::floor(maxY / cell) - std::floor(minY / cell) + 1.0);
+    };
+    while (cellsFor(grid.m_cellPixels) > static_cast<double>(MAX_CELLS)) {
+        grid.m_cellPixels *= 2;
+    }
+    const double cell = grid.m_cellPixels;
+    grid.m_originX = std::floor(minX / cell) * cell;
+    grid.m_originY = std::floor(minY / cell) * cell;
+    grid.m_cols = static_cast<int>(std::floor(maxX / cell) - std::floor(minX / cell)) + 1;
+    grid.m_rows = static_cast<int>(std::floor(maxY / cell) - std::floor(minY / cell)) + 1;
+
+    const size_t cellCount = static_cast<size_t>(grid.m_cols) * grid.m_rows;
+    grid.m_counts.assign(cellCount, 0);
+    grid.m_degreeSums.assign(cellCount, 0);
+    grid.m_largestComponent.assign(cellCount, 0);
+
+    for (size_t i = 0; i < snapshots.size(); ++i) {
+        const int c = grid.cellAt(xs[i], ys[i]);
+        if (c < 0) continue;
+        const int id = snapshots[i].id;
+        grid.m_counts[c]++;
+        grid.m_degreeSums[c] += static_cast<uint32_t>(graph.getDirectNeighbors(id).size());
+        grid.m_largestComponent[c] = std::max<uint32_t>(grid.m_largestComponent[c], graph.getComponentSize(id));
+    }
+    grid.m_vehicleCount = snapshots.size();
+    grid.m_maxCount = *std::max_element(grid.m_counts.begin(), grid.m_counts.end());
+    grid.colorize();
+
+    grid.m_buildTimeMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - startTime).count();
+    return grid;
+}
+
+int DensityGrid::cellAt(double px, double py) const {
+    const double cell = m_cellPixels;
+    const double col = std::floor((px - m_originX) / cell);
+    const double row = std::floor((py - m_originY) / cell);
+    if (col < 0 || row < 0 || col >= m_cols || row >= m_rows) return -1;
+    return static_cast<int>(row) * m_cols + static_cast<int>(col);
+}
+
+void DensityGrid::colorize() {
+    m_pixels.assign(m_counts.size(), 0);
+    const double logMax = std::log1p(static_cast<double>(std::max<uint32_t>(m_maxCount, 1)));
+    for (size_t c = 0; c < m_counts.size(); ++c) {
+        if (m_counts[c] == 0) continue;  // Transparent
+        const double degree = meanDegree(static_cast<int>(c));
+        const double hue = MAX_HUE * degree / (degree + DEGREE_HALF_SCALE);
+        const double density = logMax > 0.0 ? std::log1p(static_cast<double>(m_counts[c])) / logMax : 1.0;
+        const uint32_t alpha = static_cast<uint32_t>(std::lround(MIN_ALPHA + (MAX_ALPHA - MIN_ALPHA) * density));
+        m_pixels[c] = hsvToArgb(hue, 0.9, 1.0, alpha);
+    }
+}
@@ -0,0 +1,101 @@
+#include "distance_kernel.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+void ProjectedPositions::gather(const ProjectedPositions& source, const std::vector<int>& indices) {
+    x.resize(indices.size());
+    y.resize(indices.size());
+    range.resize(indices.size());
+    for (size_t k = 0; k < indices.size(); ++k) {
+        const int i = indices[k];
+        x[k] = source.x[i];
+        y[k] = source.y[i];
+        range[k] = source.range[i];
+    }
+}
+
+namespace DistanceKernel {
+
+// Candidats restants (fin de bloc non multiple de la largeur vectorielle)
+static inline uint64_t scalarMask(float x, float y, float range,
+                                  const float* xs, const float* ys, const float* ranges,
+                                  size_t begin, size_t count) {
+    uint64_t mask = 0;
+    for (size_t k = begin; k < count; ++k) {
+        const float dx = xs[k] - x;
+        const float dy = ys[k] - y;
+        const float r = std::min(range, ranges[k]);
+        if (dx * dx + dy * dy <= r * r) {
+            mask |= uint64_t(1) << k;
+        }
+    }
+    return mask;
+}
+
+uint64_t inRangeMask(float x, float y, float range,
+                     const float* xs, const float* ys, const float* ranges, size_t count) {
+    uint64_t mask = 0;
+    size_t k = 0;
+
+#if defined(__AVX2__)
+    const __m256 vx = _mm256_set1_ps(x);
+    const __m256 vy = _mm256_set1_ps(y);
+    const __m256 vr = _mm256_set1_ps(range);
+    for (; k + 8 <= count; k += 8) {
+        const __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(xs + k), vx);
+        const __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(ys + k), vy);
+        const __m256 r = _mm256_min_ps(_mm256_loadu_ps(ranges + k), vr);
+        const __m256 d2 = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+        const __m256 inRange = _mm256_cmp_ps(d2, _mm256_mul_ps(r, r), _CMP_LE_OQ);
+        mask |= static_cast<uint64_t>(_mm256_movemask_ps(inRange)) << k;
+    }
+#elif defined(__SSE2__)
+    const __m128 vx = _mm_set1_ps(x);
+    const __m128 vy = _mm_set1_ps(y);
+    const __m128 vr = _mm_set1_ps(range);
+    for (; k + 4 <= count; k += 4) {
+        const __m128 dx = _mm_sub_ps(_mm_loadu_ps(xs + k), vx);
+        const __m128 dy = _mm_sub_ps(_mm_loadu_ps(ys + k), vy);
+        const __m128 r = _mm_min_ps(_mm_loadu_ps(ranges + k), vr);
+        const __m128 d2 = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+        const __m128 inRange = _mm_cmple_ps(d2, _mm_mul_ps(r, r));
+        mask |= static_cast<uint64_t>(_mm_movemask_ps(inRange)) << k;
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    const float32x4_t vx = vdupq_n_f32(x);
+    const float32x4_t vy = vdupq_n_f32(y);
+    const float32x4_t vr = vdupq_n_f32(range);
+    static const uint32_t laneBits[4] = {1, 2, 4, 8};
+    const uint32x4_t bits = vld1q_u32(laneBits);
+    for (; k + 4 <= count; k += 4) {
+        const float32x4_t dx = vsubq_f32(vld1q_f32(xs + k), vx);
+        const float32x4_t dy = vsubq_f32(vld1q_f32(ys + k), vy);
+        const float32x4_t r = vminq_f32(vld1q_f32(ranges + k), vr);
+        const float32x4_t d2 = vaddq_f32(vmulq_f32(dx, dx), vmulq_f32(dy, dy));
+        const uint32x4_t inRange = vcleq_f32(d2, vmulq_f32(r, r));
+        mask |= static_cast<uint64_t>(vaddvq_u32(vandq_u32(inRange, bits))) << k;
+    }
+#endif
+
+    return mask | scalarMask(x, y, range, xs, ys, ranges, k, count);
+}
+
+const char* backendName() {
+#if defined(__AVX2__)
+    return "AVX2";
+#elif defined(__SSE2__)
+    return "SSE2";
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    return "NEON";
+#else
+    return "scalar";
+#endif
+}
+
+} // namespace DistanceKernel
@@ -0,0 +1,189 @@
+#include "geo_partition.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <numeric>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Même échelle que le graphe d'interférence et la grille spatiale
+static constexpr double METERS_PER_DEG = 111000.0;
+
+GeoPartition GeoPartition::fromCenters(const std::vector<std::pair<double, double>>& centers,
+                                       const std::vector<double>& weights, int shardCount) {
+    GeoPartition partition;
+    const size_t n = centers.size();
+    if (n == 0) return partition;
+
+    const bool weighted = weights.size() == n &&
+        std::any_of(weights.begin(), weights.end(), [](double w) { return w > 0.0; });
+    double sumLat = 0.0;
+    double sumLon = 0.0;
+    partition.m_regions.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        Region& region = partition.m_regions[i];
+        region.lat = centers[i].first;
+        region.lon = centers[i].second;
+        region.weight = weighted ? std::max(0.0, weights[i]) : 1.0;
+        sumLat += region.lat;
+        sumLon += region.lon;
+    }
+    partition.m_originLat = sumLat / n;
+    partition.m_originLon = sumLon / n;
+    partition.m_metersPerDegLon = METERS_PER_DEG * std::cos(partition.m_originLat * M_PI / 180.0);
+    partition.m_x.resize(n);
+    partition.m_y.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        partition.project(partition.m_regions[i].lat, partition.m_regions[i].lon,
+                          partition.m_x[i], partition.m_y[i]);
+    }
+
+    partition.m_shardCount = std::clamp(shardCount, 1, static_cast<int>(n));
+    if (partition.m_shardCount < shardCount) {
+        std::cout << "[GeoPartition] " << n << " régions seulement: " << partition.m_shardCount
+                  << " shards au lieu de " << shardCount << std::endl;
+    }
+    std::vector<int> indices(n);
+    std::iota(indices.begin(), indices.end(), 0);
+    partition.bisect(indices, 0, n, 0, partition.m_shardCount);
+    return partition;
+}
+
+GeoPartition GeoPartition::fromSpatialGrid(const SpatialGrid& grid, int shardCount) {
+    // Ordre des IDs (unordered_map): même découpage d'un processus à l'autre
+    std::vector<int> macroIds;
+    for (const auto& [id, macro] : grid.getMacroAntennas()) {
+        macroIds.push_back(id);
+    }
+    std::sort(macroIds.begin(), macroIds.end());
+
+    std::vector<std::pair<double, double>> centers;
+    std::vector<double> weights;
+    for (int id : macroIds) {
+        const MacroAntenna& macro = grid.getMacroAntennas().at(id);
+        size_t vehicles = 0;
+        for (int microId : macro.microAntennaIds) {
+            auto it = grid.getMicroAntennas().find(microId);
+            if (it != grid.getMicroAntennas().end()) vehicles += it->second.vehicleIds.size();
+        }
+        centers.emplace_back(macro.centerLat, macro.centerLon);
+        weights.push_back(static_cast<double>(vehicles));
+    }
+
+    GeoPartition partition = fromCenters(centers, weights, shardCount);
+    for (size_t i = 0; i < macroIds.size(); ++i) {
+        partition.m_regions[i].macroAntennaId = macroIds[i];
+    }
+    return partition;
+}
+
+void GeoPartition::project(double lat, double lon, double& x, double& y) const {
+    x = (lon - m_originLon) * m_metersPerDegLon;
+    y = (lat - m_originLat) * METERS_PER_DEG;
+}
+
+void GeoPartition::bisect(std::vector<int>& regionIndices, size_t begin, size_t end, int firstShard, int shards) {
+    if (shards <= 1) {
+        for (size_t i = begin; i < end; ++i) {
+            m_regions[regionIndices[i]].shard = firstShard;
+        }
+        return;
+    }
+
+    // Couper perpendiculairement au plus grand axe de l'emprise des centres
+    double minX = std::numeric_limits<double>::max(), minY = minX;
+    double maxX = std::numeric_limits<double>::lowest(), maxY = maxX;
+    double total = 0.0;
+    for (size_t i = begin; i < end; ++i) {
+        const int r = regionIndices[i];
+        minX = std::min(minX, m_x[r]);
+        maxX = std::max(maxX, m_x[r]);
+        minY = std::min(minY, m_y[r]);
+        maxY = std::max(maxY, m_y[r]);
+        total += m_regions[r].weight;
+    }
+    const std::vector<double>& axis = (maxX - minX) >= (maxY - minY) ? m_x : m_y;
+    // Départage par indice: découpage identique quel que soit l'ordre d'entrée
+    std::sort(regionIndices.begin() + begin, regionIndices.begin() + end, [&axis](int a, int b) {
+        return axis[a] != axis[b] ? axis[a] < axis[b] : a < b;
+    });
+
+    // Première moitié: shards/2 shards, autant de poids que possible en proportion
+    const int leftShards = shards / 2;
+    const double target = total * leftShards / shards;
+    size_t leftCount = 0;
+    double accumulated = 0.0;
+    while (begin + leftCount < end && accumulated + m_regions[regionIndices[begin + leftCount]].weight / 2.0 < target) {
+        accumulated += m_regions[regionIndices[begin + leftCount]].weight;
+        leftCount++;
+    }
+    // Au moins une région par shard de chaque côté
+    const size_t count = end - begin;
+    leftCount = std::clamp(leftCount, static_cast<size_t>(leftShards), count - static_cast<size_t>(shards - leftShards));
+
+    bisect(regionIndices, begin, begin + leftCount, firstShard, leftShards);
+    bisect(regionIndices, begin + leftCount, end, firstShard + leftShards, shards - leftShards);
+}
+
+int GeoPartition::regionOf(double lat, double lon) const {
+    double x, y;
+    project(lat, lon, x, y);
+    int best = -1;
+    double bestDist = std::numeric_limits<double>::max();
+    for (size_t r = 0; r < m_regions.size(); ++r) {
+        const double dx = x - m_x[r];
+        const double dy = y - m_y[r];
+        const double d = dx * dx + dy * dy;
+        if (d < bestDist) {
+            bestDist = d;
+            best = static_cast<int>(r);
+        }
+    }
+    return best;
+}
+
+int GeoPartition::shardOf(double lat, double lon) const {
+    const int region = regionOf(lat, lon);
+    return region < 0 ? 0 : m_regions[region].shard;
+}
+
+void GeoPartition::nearbyShards(double lat, double lon, double marginMeters, std::vector<int>& out) const {
+    out.clear();
+    const int own = regionOf(lat, lon);
+    if (own < 0 || m_shardCount <= 1) return;
+
+    double x, y;
+    project(lat, lon, x, y);
+    const int ownShard = m_regions[own].shard;
+    const double ownDx = x - m_x[own];
+    const double ownDy = y - m_y[own];
+    const double ownDist2 = ownDx * ownDx + ownDy * ownDy;
+    for (size_t r = 0; r < m_regions.size(); ++r) {
+        const int shard = m_regions[r].shard;
+        if (shard == ownShard || std::find(out.begin(), out.end(), shard) != out.end()) continue;
+        // Distance du point au plan médiateur des centres own et r:
+        // (|p - c_r|² - |p - c_own|²) / (2 |c_r - c_own|)
+        const double dx = x - m_x[r];
+        const double dy = y - m_y[r];
+        const double cx = m_x[r] - m_x[own];
+        const double cy = m_y[r] - m_y[own];
+        const double separation = std::sqrt(cx * cx + cy * cy);
+        const double toBisector = separation > 0.0
+            ? (dx * dx + dy * dy - ownDist2) / (2.0 * separation) : 0.0;
+        if (toBisector <= marginMeters) {
+            out.push_back(shard);
+        }
+    }
+    std::sort(out.begin(), out.end());
+}
+
+std::vector<double> GeoPartition::shardWeights() const {
+    std::vector<double> weights(m_shardCount, 0.0);
+    for (const Region& region : m_regions) {
+        weights[region.shard] += region.weight;
+    }
+    return weights;
+}
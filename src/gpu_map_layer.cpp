@@ -0,0 +1,342 @@
+#ifdef V2V_OPENGL
+
+#include "gpu_map_layer.h"
+#include "interference_graph.h"
+#include "vehicle_renderer.h"
+#include "vehicle_store.h"
+#include <QOpenGLContext>
+#include <QSurfaceFormat>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Rayon terrestre utilisé par MapView::metersPerPixelAtLat
+static constexpr double EARTH_RADIUS = 6378137.0;
+
+// Lignes (routes et connexions): position monde -> NDC
+static const char* LINE_VERTEX_SHADER = R"(
+#version 330 core
+layout(location = 0) in vec2 a_pos;
+uniform float u_scale;
+uniform vec2 u_translate;
+uniform vec2 u_viewport;
+void main() {
+    vec2 screen = a_pos * u_scale + u_translate;
+    gl_Position = vec4(screen.x / u_viewport.x * 2.0 - 1.0, 1.0 - screen.y / u_viewport.y * 2.0, 0.0, 1.0);
+}
+)";
+
+static const char* LINE_FRAGMENT_SHADER = R"(
+#version 330 core
+uniform vec4 u_color;
+out vec4 fragColor;
+void main() {
+    fragColor = u_color;
+}
+)";
+
+// Quads instanciés: u_mode 0 = véhicule orienté, 1 = disque de portée
+static const char* SPRITE_VERTEX_SHADER = R"(
+#version 330 core
+layout(location = 0) in vec2 a_corner;
+layout(location = 1) in vec2 a_pos;
+layout(location = 2) in float a_heading;
+layout(location = 3) in float a_radius;
+layout(location = 4) in vec4 a_color;
+uniform float u_scale;
+uniform vec2 u_translate;
+uniform vec2 u_viewport;
+uniform int u_mode;
+uniform float u_size;
+out vec2 v_local;
+out vec4 v_color;
+void main() {
+    vec2 offset;
+    if (u_mode == 0) {
+        // Même sens que QPainter::rotate (y vers le bas): heading 0 = vers le haut
+        float a = radians(a_heading);
+        vec2 c = a_corner * u_size;
+        offset = vec2(c.x * cos(a) - c.y * sin(a), c.x * sin(a) + c.y * cos(a));
+    } else {
+        offset = a_corner * (2.0 * a_radius);
+    }
+    vec2 screen = a_pos * u_scale + u_translate + offset;
+    gl_Position = vec4(screen.x / u_viewport.x * 2.0 - 1.0, 1.0 - screen.y / u_viewport.y * 2.0, 0.0, 1.0);
+    v_local = a_corner;
+    v_color = a_color;
+}
+)";
+
+static const char* SPRITE_FRAGMENT_SHADER = R"(
+#version 330 core
+in vec2 v_local;
+in vec4 v_color;
+uniform int u_mode;
+uniform vec4 u_rangeFill;
+uniform vec4 u_rangeOutline;
+out vec4 fragColor;
+void main() {
+    if (u_mode == 0) {
+        // Carrosserie: rectangle arrondi de 2/3 de large, avant plus clair
+        const float radius = 1.0 / 6.0;
+        vec2 q = abs(v_local) - (vec2(1.0 / 3.0, 0.5) - radius);
+        float d = length(max(q, 0.0)) + min(max(q.x, q.y), 0.0) - radius;
+        float aa = fwidth(d);
+        float alpha = 1.0 - smoothstep(-aa, aa, d);
+        if (alpha <= 0.0) discard;
+        vec3 rgb = v_local.y < -1.0 / 3.0 ? min(v_color.rgb * 1.5, vec3(1.0)) : v_color.rgb;
+        fragColor = vec4(rgb, v_color.a * alpha);
+    } else {
+        // Disque: remplissage léger et contour d'un pixel
+        float d = length(v_local) * 2.0;
+        if (d > 1.0) discard;
+        float aa = fwidth(d);
+        fragColor = mix(u_rangeFill, u_rangeOutline, smoothstep(1.0 - 2.0 * aa, 1.0 - aa, d));
+    }
+}
+)";
+
+GpuMapLayer::~GpuMapLayer() {
+    // Contexte courant requis (MapView appelle makeCurrent avant de détruire la couche)
+    m_roadVao.destroy();
+    m_edgeVao.destroy();
+    m_spriteVao.destroy();
+    m_roadVbo.destroy();
+    m_edgeVbo.destroy();
+    m_cornerVbo.destroy();
+    m_instanceVbo.destroy();
+}
+
+static std::unique_ptr<QOpenGLShaderProgram> buildProgram(const char* vertexSource, const char* fragmentSource) {
+    auto program = std::make_unique<QOpenGLShaderProgram>();
+    if (!program->addShaderFromSourceCode(QOpenGLShader::Vertex, vertexSource) ||
+        !program->addShaderFromSourceCode(QOpenGLShader::Fragment, fragmentSource) ||
+        !program->link()) {
+        std::cerr << "[GpuMapLayer] Erreur de shader: " << program->log().toStdString() << std::endl;
+        return nullptr;
+    }
+    return program;
+}
+
+bool GpuMapLayer::initialize() {
+    QOpenGLContext* context = QOpenGLContext::currentContext();
+    if (!context) {
+        return false;
+    }
+    const QSurfaceFormat format = context->format();
+    if (context->isOpenGLES() || format.version() < qMakePair(3, 3)) {
+        std::cout << "[GpuMapLayer] OpenGL 3.3 indisponible (" << format.majorVersion() << "."
+                  << format.minorVersion() << "), rendu QPainter conservé" << std::endl;
+        return false;
+    }
+    initializeOpenGLFunctions();
+
+    m_lineProgram = buildProgram(LINE_VERTEX_SHADER, LINE_FRAGMENT_SHADER);
+    m_spriteProgram = buildProgram(SPRITE_VERTEX_SHADER, SPRITE_FRAGMENT_SHADER);
+    if (!m_lineProgram || !m_spriteProgram) {
+        return false;
+    }
+
+    // Routes et connexions: un attribut vec2 par sommet
+    auto setupLineVao = [this](QOpenGLVertexArrayObject& vao, QOpenGLBuffer& vbo, QOpenGLBuffer::UsagePattern usage) {
+        vao.create();
+        vao.bind();
+        vbo.create();
+        vbo.setUsagePattern(usage);
+        vbo.bind();
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), nullptr);
+        vao.release();
+        vbo.release();
+    };
+    setupLineVao(m_roadVao, m_roadVbo, QOpenGLBuffer::StaticDraw);
+    setupLineVao(m_edgeVao, m_edgeVbo, QOpenGLBuffer::StreamDraw);
+
+    // Quads: 4 coins statiques (triangle strip) + un tampon d'instances par image
+    static const float corners[8] = {-0.5f, -0.5f, 0.5f, -0.5f, -0.5f, 0.5f, 0.5f, 0.5f};
+    m_spriteVao.create();
+    m_spriteVao.bind();
+    m_cornerVbo.create();
+    m_cornerVbo.bind();
+    m_cornerVbo.allocate(corners, sizeof(corners));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), nullptr);
+
+    m_instanceVbo.create();
+    m_instanceVbo.setUsagePattern(QOpenGLBuffer::StreamDraw);
+    m_instanceVbo.bind();
+    const GLsizei stride = sizeof(Instance);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(offsetof(Instance, x)));
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(offsetof(Instance, heading)));
+    glEnableVertexAttribArray(3);
+    glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(offsetof(Instance, radius)));
+    glEnableVertexAttribArray(4);
+    glVertexAttribPointer(4, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, reinterpret_cast<void*>(offsetof(Instance, rgba)));
+    for (GLuint attribute = 1; attribute <= 4; ++attribute) {
+        glVertexAttribDivisor(attribute, 1);
+    }
+    m_spriteVao.release();
+    m_instanceVbo.release();
+
+    m_ready = true;
+    std::cout << "[GpuMapLayer] Rendu OpenGL " << format.majorVersion() << "." << format.minorVersion()
+              << " activé" << std::endl;
+    return true;
+}
+
+void GpuMapLayer::project(double lon, double lat, float& x, float& y) {
+    // Web Mercator normalisé (même formule que MapView::lonlatToPixel, sans le zoom)
+    const double latRad = lat * M_PI / 180.0;
+    const double mx = (lon + 180.0) / 360.0;
+    const double my = (1.0 - std::log(std::tan(latRad) + 1.0 / std::cos(latRad)) / M_PI) / 2.0;
+    if (!m_hasOrigin) {
+        m_originX = mx;
+        m_originY = my;
+        m_hasOrigin = true;
+    }
+    x = static_cast<float>(mx - m_originX);
+    y = static_cast<float>(my - m_originY);
+}
+
+void GpuMapLayer::uploadRoads(const std::vector<double>& lonLat) {
+    std::vector<float> vertices(lonLat.size());
+    for (size_t i = 0; i + 1 < lonLat.size(); i += 2) {
+        project(lonLat[i], lonLat[i + 1], vertices[i], vertices[i + 1]);
+    }
+    m_roadVbo.bind();
+    m_roadVbo.allocate(vertices.data(), static_cast<int>(vertices.size() * sizeof(float)));
+    m_roadVbo.release();
+    m_roadVertexCount = static_cast<int>(vertices.size() / 2);
+}
+
+void GpuMapLayer::setViewUniforms(QOpenGLShaderProgram& program, const View& view) {
+    // screen = relatif * échelle + (origine * échelle - décalage), calculé en double
+    const double scale = 256.0 * std::pow(2.0, view.zoom);
+    program.setUniformValue("u_scale", static_cast<GLfloat>(scale));
+    program.setUniformValue("u_translate", static_cast<GLfloat>(m_originX * scale - view.offsetX),
+                            static_cast<GLfloat>(m_originY * scale - view.offsetY));
+    program.setUniformValue("u_viewport", static_cast<GLfloat>(view.width), static_cast<GLfloat>(view.height));
+}
+
+void GpuMapLayer::drawLines(QOpenGLVertexArrayObject& vao, int vertexCount, const View& view, const QColor& color) {
+    if (vertexCount == 0) return;
+    glViewport(0, 0, static_cast<GLsizei>(view.width * view.devicePixelRatio),
+               static_cast<GLsizei>(view.height * view.devicePixelRatio));
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    m_lineProgram->bind();
+    setViewUniforms(*m_lineProgram, view);
+    m_lineProgram->setUniformValue("u_color", color);
+    vao.bind();
+    glDrawArrays(GL_LINES, 0, vertexCount);
+    vao.release();
+    m_lineProgram->release();
+}
+
+void GpuMapLayer::drawRoads(const View& view, const QColor& color) {
+    if (!m_ready) return;
+    drawLines(m_roadVao, m_roadVertexCount, view, color);
+}
+
+void GpuMapLayer::prepareVehicles(const View& view, const VehicleStore& store,
+                                  const InterferenceGraph* connections, const VehicleStyle& style) {
+    if (!m_ready) return;
+    const size_t n = store.size();
+
+    // Palette précalculée (évite un QRandomGenerator par véhicule et par image)
+    uint8_t palette[VehicleRenderer::PALETTE_SIZE][4];
+    for (int i = 0; i < VehicleRenderer::PALETTE_SIZE; ++i) {
+        QColor c = VehicleRenderer::paletteColor(i, style.darkTheme);
+        palette[i][0] = static_cast<uint8_t>(c.red());
+        palette[i][1] = static_cast<uint8_t>(c.green());
+        palette[i][2] = static_cast<uint8_t>(c.blue());
+        palette[i][3] = static_cast<uint8_t>(c.alpha());
+    }
+
+    // Mètres par pixel à l'équateur, multiplié par cos(lat) pour chaque véhicule
+    const double metersPerPixelEquator = 2.0 * M_PI * EARTH_RADIUS / (256.0 * std::pow(2.0, view.zoom));
+
+    m_instances.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        Instance& inst = m_instances[i];
+        project(store.lon[i], store.lat[i], inst.x, inst.y);
+        inst.heading = static_cast<float>(store.heading[i]);
+        const double metersPerPixel = metersPerPixelEquator * std::cos(store.lat[i] * M_PI / 180.0);
+        inst.radius = static_cast<float>(store.range[i] / metersPerPixel);
+        std::copy(palette[VehicleRenderer::paletteIndex(store.ids[i])],
+                  palette[VehicleRenderer::paletteIndex(store.ids[i])] + 4, inst.rgba);
+    }
+    m_instanceVbo.bind();
+    m_instanceVbo.allocate(m_instances.data(), static_cast<int>(n * sizeof(Instance)));
+    m_instanceVbo.release();
+
+    // Connexions directes: liste d'arêtes à plat du graphe publié, positions
+    // courantes des deux véhicules via la table ID -> ligne du store
+    m_edgeVertices.clear();
+    if (connections && style.showConnections) {
+        const auto& edges = connections->getDirectEdges();
+        m_edgeVertices.reserve(edges.size() * 4);
+        for (const DirectEdge& edge : edges) {
+            const int row1 = store.rowOf(edge.id1);
+            const int row2 = store.rowOf(edge.id2);
+            if (row1 < 0 || row2 < 0) continue;  // Véhicule supprimé depuis le calcul du graphe
+            m_edgeVertices.insert(m_edgeVertices.end(),
+                                  {m_instances[row1].x, m_instances[row1].y, m_instances[row2].x, m_instances[row2].y});
+        }
+    }
+    m_edgeVbo.bind();
+    m_edgeVbo.allocate(m_edgeVertices.data(), static_cast<int>(m_edgeVertices.size() * sizeof(float)));
+    m_edgeVbo.release();
+    m_edgeVertexCount = static_cast<int>(m_edgeVertices.size() / 2);
+}
+
+void GpuMapLayer::drawInstances(int mode, const View& view, double size) {
+    if (m_instances.empty()) return;
+    glViewport(0, 0, static_cast<GLsizei>(view.width * view.devicePixelRatio),
+               static_cast<GLsizei>(view.height * view.devicePixelRatio));
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    m_spriteProgram->bind();
+    setViewUniforms(*m_spriteProgram, view);
+    m_spriteProgram->setUniformValue("u_mode", mode);
+    m_spriteProgram->setUniformValue("u_size", static_cast<GLfloat>(size));
+    m_spriteVao.bind();
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(m_instances.size()));
+    m_spriteVao.release();
+    m_spriteProgram->release();
+}
+
+void GpuMapLayer::drawRangesAndConnections(const View& view, const VehicleStyle& style) {
+    if (!m_ready) return;
+
+    // Mêmes couleurs que le rendu QPainter de MapView
+    if (style.showRanges) {
+        m_spriteProgram->bind();
+        m_spriteProgram->setUniformValue("u_rangeFill",
+            style.darkTheme ? QColor(100, 200, 220, 5) : QColor(0, 180, 255, 40));
+        m_spriteProgram->setUniformValue("u_rangeOutline",
+            style.darkTheme ? QColor(100, 200, 220, 80) : QColor(0, 180, 255, 110));
+        m_spriteProgram->release();
+        drawInstances(1, view, style.size);
+    }
+    if (style.showConnections) {
+        drawLines(m_edgeVao, m_edgeVertexCount, view,
+                  style.darkTheme ? QColor(135, 206, 235, 150) : QColor(0, 120, 255, 200));
+    }
+}
+
+void GpuMapLayer::drawVehicles(const View& view, const VehicleStyle& style) {
+    if (!m_ready) return;
+    drawInstances(0, view, style.size);
+}
+
+#endif // V2V_OPENGL
@@ -0,0 +1,480 @@
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "distance_kernel.h"
+#include "graph_builder.h"
+#include "interference_graph.h"
+#include "road_vertex_index.h"
+#include "spatial_grid.h"
+#include "vehicule.h"
+#include "verlet_neighbor_list.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// ----------------------
+// Microbenchmarks des constructions du graphe d'interférence et des index spatiaux
+// (Google Benchmark). Chaque scénario (distribution, nombre de véhicules, portée)
+// est enregistré pour toutes les méthodes à la suite: la flotte n'est générée
+// qu'une fois par scénario.
+//
+// Distributions:
+//   uniform  - tirage uniforme dans un carré de 20 km
+//   roads    - véhicules le long d'une trame de rues (200 m entre deux rues)
+//   junction - un carrefour très dense (gaussienne, sigma = 300 m)
+//   replay   - positions réelles relues depuis V2V_BENCH_POSITIONS
+//              (une ligne "lon lat" par véhicule), tirées avec remise
+// ----------------------
+
+namespace {
+
+constexpr double ORIGIN_LON = 7.75;   // Strasbourg
+constexpr double ORIGIN_LAT = 48.58;
+constexpr double AREA_SIDE_M = 20000.0;
+constexpr double STREET_SPACING_M = 200.0;
+constexpr double JUNCTION_SIGMA_M = 300.0;
+constexpr double METERS_PER_DEG_LAT = 111320.0;
+
+// Au-delà, le graphe ne tient plus raisonnablement en mémoire (CSR + liste d'arêtes)
+constexpr double MAX_ESTIMATED_EDGES = 1.5e7;
+// Méthodes O(n²): limitées aux petites flottes
+constexpr int MAX_QUADRATIC_VEHICLES = 10000;
+// Construction à partir des Vehicule* (positions relues et distance haversine)
+constexpr int MAX_VEHICLE_PATH_VEHICLES = 50000;
+
+enum class Distribution { Uniform, Roads, Junction, Replay };
+
+const char* distributionName(Distribution d) {
+    switch (d) {
+        case Distribution::Uniform:  return "uniform";
+        case Distribution::Roads:    return "roads";
+        case Distribution::Junction: return "junction";
+        case Distribution::Replay:   return "replay";
+    }
+    return "?";
+}
+
+struct Scenario {
+    Distribution distribution;
+    int vehicles;
+    double range;
+};
+
+// Positions rejouées (V2V_BENCH_POSITIONS) et leur emprise en m²
+std::vector<std::pair<double, double>> g_replayLonLat;
+double g_replayAreaM2 = 0.0;
+
+bool loadReplayPositions() {
+    const char* path = std::getenv("V2V_BENCH_POSITIONS");
+    if (!path || !*path) return false;
+    std::ifstream in(path);
+    double lon = 0.0, lat = 0.0;
+    double minLon = 1e9, maxLon = -1e9, minLat = 1e9, maxLat = -1e9;
+    while (in >> lon >> lat) {
+        g_replayLonLat.emplace_back(lon, lat);
+        minLon = std::min(minLon, lon);
+        maxLon = std::max(maxLon, lon);
+        minLat = std::min(minLat, lat);
+        maxLat = std::max(maxLat, lat);
+    }
+    if (g_replayLonLat.empty()) {
+        std::cerr << "[Bench] Aucune position lue dans " << path << std::endl;
+        return false;
+    }
+    const double midLat = 0.5 * (minLat + maxLat) * M_PI / 180.0;
+    const double width = std::max(1.0, (maxLon - minLon) * METERS_PER_DEG_LAT * std::cos(midLat));
+    const double height = std::max(1.0, (maxLat - minLat) * METERS_PER_DEG_LAT);
+    g_replayAreaM2 = width * height;
+    std::cerr << "[Bench] " << g_replayLonLat.size() << " positions rejouées depuis " << path << std::endl;
+    return true;
+}
+
+// Nombre d'arêtes attendu: n²/2 × probabilité qu'une paire soit à portée
+double estimatedEdges(const Scenario& s) {
+    double pairArea = AREA_SIDE_M * AREA_SIDE_M;
+    if (s.distribution == Distribution::Roads) {
+        pairArea /= 2.0;   // Véhicules concentrés sur les rues
+    } else if (s.distribution == Distribution::Junction) {
+        pairArea = 4.0 * M_PI * JUNCTION_SIGMA_M * JUNCTION_SIGMA_M;
+    } else if (s.distribution == Distribution::Replay) {
+        pairArea = g_replayAreaM2 / 4.0;   // Données réelles: densité très inégale
+    }
+    const double p = std::min(1.0, M_PI * s.range * s.range / pairArea);
+    return 0.5 * s.vehicles * static_cast<double>(s.vehicles) * p;
+}
+
+/**
+ * @brief Flotte immobile d'un scénario: un sommet routier par véhicule
+ *
+ * Les véhicules sont arrêtés sur leur sommet (start = goal), de sorte que
+ * getPosition() renvoie la position tirée. La grille d'antennes n'est calculée
+ * (K-means) que si une méthode en a besoin.
+ */
+struct Fleet {
+    Scenario scenario{};
+    RoadGraph roads;
+    std::vector<std::unique_ptr<Vehicule>> owned;
+    std::vector<Vehicule*> vehicles;
+    std::vector<VehicleSnapshot> snapshots;
+
+    bool antennasReady = false;
+    InterferenceGraph antennaGraph;   // Porte la grille K-means de buildGraphWithSpatialGrid
+    std::vector<VehicleSnapshot> antennaSnapshots;
+    AntennaNeighborhood antennaInfo;
+
+    void ensureAntennas();
+};
+
+// Mise en sourdine de std::cout (journaux des constructions) pendant une mesure
+class QuietCout {
+public:
+    QuietCout() : m_previous(std::cout.rdbuf(nullptr)) {}
+    ~QuietCout() { std::cout.rdbuf(m_previous); }
+private:
+    std::streambuf* m_previous;
+};
+
+void Fleet::ensureAntennas() {
+    if (antennasReady) return;
+    QuietCout quiet;
+    // Nombre d'antennes automatique, comme l'application
+    antennaGraph.initializeSpatialGrid(vehicles, 0, 0);
+    const SpatialGrid& grid = antennaGraph.getSpatialGrid();
+
+    // Même construction que Simulator::captureGraphJob
+    antennaSnapshots = snapshots;
+    for (size_t i = 0; i < antennaSnapshots.size(); ++i) {
+        int antennaId = grid.getMicroAntennaId(antennaSnapshots[i].id);
+        antennaSnapshots[i].microAntennaId = antennaId;
+        if (antennaId >= 0) {
+            antennaInfo.vehiclesPerAntenna[antennaId].push_back(static_cast<int>(i));
+        }
+    }
+    for (const auto& [antennaId, micro] : grid.getMicroAntennas()) {
+        antennaInfo.neighborAntennas[antennaId] = micro.neighborMicroIds;
+    }
+    antennasReady = true;
+}
+
+std::unique_ptr<Fleet> makeFleet(const Scenario& s) {
+    auto fleet = std::make_unique<Fleet>();
+    fleet->scenario = s;
+
+    // Graine fixe par scénario: mêmes positions d'une exécution à l'autre
+    std::mt19937 rng(static_cast<uint32_t>(s.vehicles * 31 + static_cast<int>(s.distribution)));
+    std::uniform_real_distribution<double> inArea(-0.5 * AREA_SIDE_M, 0.5 * AREA_SIDE_M);
+    std::uniform_int_distribution<int> street(0, static_cast<int>(AREA_SIDE_M / STREET_SPACING_M));
+    std::normal_distribution<double> jitter(0.0, 5.0);
+    std::normal_distribution<double> junction(0.0, JUNCTION_SIGMA_M);
+
+    const double metersPerDegLon = METERS_PER_DEG_LAT * std::cos(ORIGIN_LAT * M_PI / 180.0);
+    fleet->owned.reserve(s.vehicles);
+    fleet->vehicles.reserve(s.vehicles);
+    fleet->snapshots.reserve(s.vehicles);
+    for (int i = 0; i < s.vehicles; ++i) {
+        double lon = ORIGIN_LON;
+        double lat = ORIGIN_LAT;
+        if (s.distribution == Distribution::Replay) {
+            const auto& p = g_replayLonLat[rng() % g_replayLonLat.size()];
+            lon = p.first + jitter(rng) / metersPerDegLon;
+            lat = p.second + jitter(rng) / METERS_PER_DEG_LAT;
+        } else {
+            double x = 0.0, y = 0.0;
+            if (s.distribution == Distribution::Uniform) {
+                x = inArea(rng);
+                y = inArea(rng);
+            } else if (s.distribution == Distribution::Roads) {
+                // Rue nord-sud ou est-ouest, position quelconque le long de la rue
+                const double across = street(rng) * STREET_SPACING_M - 0.5 * AREA_SIDE_M + jitter(rng);
+                const double along = inArea(rng);
+                if (rng() & 1u) { x = across; y = along; } else { x = along; y = across; }
+            } else {
+                x = junction(rng);
+                y = junction(rng);
+            }
+            lon += x / metersPerDegLon;
+            lat += y / METERS_PER_DEG_LAT;
+        }
+
+        Vertex v = boost::add_vertex(fleet->roads);
+        fleet->roads[v].id = i;
+        fleet->roads[v].lat = lat;
+        fleet->roads[v].lon = lon;
+        fleet->snapshots.push_back({i, lon, lat, s.range, -1});
+    }
+    for (int i = 0; i < s.vehicles; ++i) {
+        Vertex v = static_cast<Vertex>(i);
+        fleet->owned.push_back(std::make_unique<Vehicule>(i, fleet->roads, v, v, 0.0, s.range, 5.0));
+        fleet->vehicles.push_back(fleet->owned.back().get());
+    }
+    return fleet;
+}
+
+// Scénarios enregistrés à la suite: on ne garde que la dernière flotte générée
+Fleet& fleetFor(const Scenario& s) {
+    static std::unique_ptr<Fleet> cached;
+    if (!cached || cached->scenario.distribution != s.distribution ||
+        cached->scenario.vehicles != s.vehicles || cached->scenario.range != s.range) {
+        cached.reset();
+        cached = makeFleet(s);
+    }
+    return *cached;
+}
+
+void reportGraph(benchmark::State& state, const InterferenceGraph& graph, int vehicles) {
+    state.SetItemsProcessed(state.iterations() * vehicles);
+    state.counters["edges"] = static_cast<double>(graph.getDirectEdges().size());
+    state.counters["comparisons"] = graph.getLastComparisons();
+    state.counters["components"] = graph.getComponentCount();
+}
+
+// ---- Constructions à partir des Vehicule* (chemin historique) ----
+
+void BM_BuildGraphClassic(benchmark::State& state, Scenario s) {
+    Fleet& fleet = fleetFor(s);
+    InterferenceGraph graph;
+    graph.enableSpatialOptimization(false);
+    QuietCout quiet;
+    for (auto _ : state) {
+        graph.buildGraph(fleet.vehicles);
+    }
+    reportGraph(state, graph, s.vehicles);
+}
+
+void BM_BuildGraphWithSpatialGrid(benchmark::State& state, Scenario s) {
+    Fleet& fleet = fleetFor(s);
+    fleet.ensureAntennas();
+    QuietCout quiet;
+    for (auto _ : state) {
+        fleet.antennaGraph.buildGraph(fleet.vehicles);
+    }
+    reportGraph(state, fleet.antennaGraph, s.vehicles);
+}
+
+// ---- Constructions à partir des snapshots (chemin du simulateur) ----
+
+void BM_SnapshotsBruteForce(benchmark::State& state, Scenario s) {
+    Fleet& fleet = fleetFor(s);
+    InterferenceGraph graph;
+    for (auto _ : state) {
+        graph.buildGraphFromSnapshots(fleet.snapshots, nullptr);
+    }
+    reportGraph(state, graph, s.vehicles);
+}
+
+void BM_SnapshotsAntennas(benchmark::State& state, Scenario s, int threads) {
+    Fleet& fleet = fleetFor(s);
+    fleet.ensureAntennas();
+    InterferenceGraph graph;
+    graph.setBuildThreadCount(threads);
+    for (auto _ : state) {
+        graph.buildGraphFromSnapshots(fleet.antennaSnapshots, &fleet.antennaInfo);
+    }
+    reportGraph(state, graph, s.vehicles);
+}
+
+void BM_SnapshotsUniformGrid(benchmark::State& state, Scenario s, int threads) {
+    Fleet& fleet = fleetFor(s);
+    InterferenceGraph graph;
+    graph.setBroadphaseMode(BroadphaseMode::UniformGrid);
+    graph.setBuildThreadCount(threads);
+    for (auto _ : state) {
+        graph.buildGraphFromSnapshots(fleet.snapshots, nullptr);
+    }
+    reportGraph(state, graph, s.vehicles);
+}
+
+// Tick incrémental en régime établi: chaque véhicule avance puis recule de 0,7 m
+// (14 m/s, pas de 50 ms), les listes de Verlet ne sont reconstruites qu'au départ
+void BM_SnapshotsIncremental(benchmark::State& state, Scenario s, int threads) {
+    Fleet& fleet = fleetFor(s);
+    std::vector<VehicleSnapshot> snapshots = fleet.snapshots;
+    VerletNeighborList neighbors;
+    InterferenceGraph graph;
+    graph.setBuildThreadCount(threads);
+    graph.buildGraphIncremental(snapshots, neighbors);
+    const double stepDeg = 0.7 / 111000.0;
+    double direction = 1.0;
+    for (auto _ : state) {
+        for (auto& snap : snapshots) snap.lat += direction * stepDeg;
+        direction = -direction;
+        graph.buildGraphIncremental(snapshots, neighbors);
+    }
+    reportGraph(state, graph, s.vehicles);
+    state.counters["rebuilds"] = static_cast<double>(neighbors.rebuildCount());
+}
+
+// Composantes connexes seules (union-find sur le CSR), temps relevé par le graphe
+void BM_Components(benchmark::State& state, Scenario s) {
+    Fleet& fleet = fleetFor(s);
+    InterferenceGraph graph;
+    graph.setBroadphaseMode(BroadphaseMode::UniformGrid);
+    graph.setBuildThreadCount(0);
+    for (auto _ : state) {
+        graph.buildGraphFromSnapshots(fleet.snapshots, nullptr);
+        state.SetIterationTime(graph.getLastComponentsTimeMs() / 1000.0);
+    }
+    reportGraph(state, graph, s.vehicles);
+}
+
+// Placement K-means des antennes (auto: 30 grandes × 20 petites au-delà de 2000 véhicules)
+void BM_SpatialGridInitialize(benchmark::State& state, Scenario s) {
+    Fleet& fleet = fleetFor(s);
+    const int numMacro = s.vehicles > 2000 ? 30 : (s.vehicles > 500 ? 20 : 10);
+    const int numMicro = s.vehicles > 2000 ? 20 : (s.vehicles > 500 ? 15 : 10);
+    QuietCout quiet;
+    for (auto _ : state) {
+        SpatialGrid grid;
+        grid.setMaxTransmissionRange(s.range);
+        grid.initialize(fleet.vehicles, numMacro, numMicro);
+        benchmark::DoNotOptimize(grid.getMicroAntennas().size());
+    }
+    state.SetItemsProcessed(state.iterations() * s.vehicles);
+}
+
+// Nouveau placement depuis les antennes existantes (départ à chaud, réglage des sliders)
+void BM_SpatialGridReinitialize(benchmark::State& state, Scenario s) {
+    Fleet& fleet = fleetFor(s);
+    const int numMacro = s.vehicles > 2000 ? 30 : (s.vehicles > 500 ? 20 : 10);
+    const int numMicro = s.vehicles > 2000 ? 20 : (s.vehicles > 500 ? 15 : 10);
+    QuietCout quiet;
+    SpatialGrid grid;
+    grid.setMaxTransmissionRange(s.range);
+    grid.initialize(fleet.vehicles, numMacro, numMicro);
+    for (auto _ : state) {
+        grid.initialize(fleet.vehicles, numMacro, numMicro);
+        benchmark::DoNotOptimize(grid.getMicroAntennas().size());
+    }
+    state.counters["kmeans_iterations"] = grid.getLastKMeansIterations();
+    state.SetItemsProcessed(state.iterations() * s.vehicles);
+}
+
+// ---- Noyaux et index indépendants des scénarios ----
+
+// Test de portée d'un véhicule contre state.range(0) candidats contigus
+void BM_DistanceKernel(benchmark::State& state) {
+    const size_t count = static_cast<size_t>(state.range(0));
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> pos(-2000.0f, 2000.0f);
+    ProjectedPositions candidates;
+    for (size_t i = 0; i < count; ++i) {
+        candidates.push(pos(rng), pos(rng), 500.0f);
+    }
+    size_t hits = 0;
+    for (auto _ : state) {
+        DistanceKernel::forEachInRange(0.0f, 0.0f, 500.0f, candidates, 0, count,
+                                       [&](size_t) { ++hits; });
+        benchmark::DoNotOptimize(hits);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(count));
+    state.SetLabel(DistanceKernel::backendName());
+}
+
+// Sommet praticable le plus proche dans une trame de state.range(0)² carrefours
+void BM_RoadVertexIndexNearest(benchmark::State& state) {
+    const int side = static_cast<int>(state.range(0));
+    RoadGraph roads;
+    for (int y = 0; y < side; ++y) {
+        for (int x = 0; x < side; ++x) {
+            Vertex v = boost::add_vertex(roads);
+            roads[v].id = y * side + x;
+            roads[v].lat = ORIGIN_LAT + y * 0.001;
+            roads[v].lon = ORIGIN_LON + x * 0.0015;
+        }
+    }
+    auto addRoad = [&](int a, int b) {
+        double d = GraphBuilder::distance(roads[a].lat, roads[a].lon, roads[b].lat, roads[b].lon);
+        boost::add_edge(a, b, EdgeData{d, false, RoadClass::Primary}, roads);
+    };
+    for (int y = 0; y < side; ++y) {
+        for (int x = 0; x < side; ++x) {
+            if (x + 1 < side) addRoad(y * side + x, y * side + x + 1);
+            if (y + 1 < side) addRoad(y * side + x, (y + 1) * side + x);
+        }
+    }
+    GraphBuilder::finalizeGraph(roads);
+    RoadVertexIndex index(roads);
+
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<double> lon(ORIGIN_LON, ORIGIN_LON + side * 0.0015);
+    std::uniform_real_distribution<double> lat(ORIGIN_LAT, ORIGIN_LAT + side * 0.001);
+    Vertex nearest = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(index.nearest(lon(rng), lat(rng), nearest));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_DistanceKernel)->RangeMultiplier(4)->Range(64, 16384);
+BENCHMARK(BM_RoadVertexIndexNearest)->Arg(100)->Arg(300)->Arg(1000);
+
+template <typename Fn>
+void registerScenario(const std::string& method, const Scenario& s, Fn&& fn, bool manualTime = false) {
+    const std::string name = method + "/" + distributionName(s.distribution) +
+                             "/vehicles:" + std::to_string(s.vehicles) +
+                             "/range:" + std::to_string(static_cast<int>(s.range));
+    auto* bench = benchmark::RegisterBenchmark(name.c_str(), std::forward<Fn>(fn), s);
+    bench->Unit(benchmark::kMillisecond);
+    if (manualTime) bench->UseManualTime();
+}
+
+void registerScenarios() {
+    std::vector<Distribution> distributions = {Distribution::Uniform, Distribution::Roads,
+                                               Distribution::Junction};
+    if (loadReplayPositions()) distributions.push_back(Distribution::Replay);
+
+    for (Distribution d : distributions) {
+        for (int n : {1000, 10000, 50000, 200000}) {
+            for (double range : {100.0, 300.0, 1000.0}) {
+                const Scenario s{d, n, range};
+                if (estimatedEdges(s) > MAX_ESTIMATED_EDGES) continue;
+
+                if (n <= MAX_QUADRATIC_VEHICLES) {
+                    registerScenario("BM_BuildGraphClassic", s, BM_BuildGraphClassic);
+                    registerScenario("BM_SnapshotsBruteForce", s, BM_SnapshotsBruteForce);
+                }
+                if (n <= MAX_VEHICLE_PATH_VEHICLES) {
+                    registerScenario("BM_BuildGraphWithSpatialGrid", s, BM_BuildGraphWithSpatialGrid);
+                }
+                registerScenario("BM_SnapshotsAntennas", s,
+                                 [](benchmark::State& st, Scenario sc) { BM_SnapshotsAntennas(st, sc, 1); });
+                registerScenario("BM_SnapshotsAntennasParallel", s,
+                                 [](benchmark::State& st, Scenario sc) { BM_SnapshotsAntennas(st, sc, 0); });
+                registerScenario("BM_SnapshotsUniformGrid", s,
+                                 [](benchmark::State& st, Scenario sc) { BM_SnapshotsUniformGrid(st, sc, 1); });
+                registerScenario("BM_SnapshotsUniformGridParallel", s,
+                                 [](benchmark::State& st, Scenario sc) { BM_SnapshotsUniformGrid(st, sc, 0); });
+                registerScenario("BM_SnapshotsIncremental", s,
+                                 [](benchmark::State& st, Scenario sc) { BM_SnapshotsIncremental(st, sc, 1); });
+                registerScenario("BM_SnapshotsIncrementalParallel", s,
+                                 [](benchmark::State& st, Scenario sc) { BM_SnapshotsIncremental(st, sc, 0); });
+                registerScenario("BM_Components", s, BM_Components, true);
+                // K-means: indépendant de la portée
+                if (range == 100.0) {
+                    registerScenario("BM_SpatialGridInitialize", s, BM_SpatialGridInitialize);
+                    registerScenario("BM_SpatialGridReinitialize", s, BM_SpatialGridReinitialize);
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    registerScenarios();
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -1,6 +1,8 @@
 #include "graph_builder.h"
+#include "road_graph_cache.h"
 #include <iostream>
 #include <cmath>
+#include <algorithm>
 #include <boost/graph/graph_traits.hpp>
 #include <boost/graph/adjacency_list.hpp>
 #include <boost/graph/iteration_macros.hpp>
@@ -30,6 +32,9 @@ void GraphBuilder::buildGraph() {
     // ==============================
     for (const auto& way : ways) {
 
+        // Classe de route convertie une seule fois par way, à la lecture
+        const RoadClass roadClass = way.roadClass;
+
         for (size_t i = 1; i < way.nodeRefs.size(); ++i) {
 
             long id1 = way.nodeRefs[i - 1];
@@ -58,7 +63,7 @@ void GraphBuilder::buildGraph() {
                 if (inserted) {
                     graph[e].distance = dist;
                     graph[e].oneway   = true;
-                    graph[e].type     = way.highwayType;
+                    graph[e].roadClass = roadClass;
                 }
 
             } else {
@@ -68,7 +73,7 @@ void GraphBuilder::buildGraph() {
                 if (i1) {
                     graph[e1].distance = dist;
                     graph[e1].oneway   = false;
-                    graph[e1].type     = way.highwayType;
+                    graph[e1].roadClass = roadClass;
                 }
 
                 // Double sens : v2 -> v1
@@ -77,15 +82,54 @@ void GraphBuilder::buildGraph() {
                 if (i2) {
                     graph[e2].distance = dist;
                     graph[e2].oneway   = false;
-                    graph[e2].type     = way.highwayType;
+                    graph[e2].roadClass = roadClass;
                 }
             }
         }
     }
 
+    // ==============================
+    // Étape 3 : données dérivées
+    // ==============================
+    finalizeGraph(graph);
+
     cout << "Graphe construit avec succès (sens de circulation respecté)." << endl;
 }
 
+// ==========================================================
+// Données dérivées (géométrie des arêtes, degré praticable)
+// ==========================================================
+void GraphBuilder::finalizeGraph(RoadGraph& graph) {
+    const double metersPerDeg = 111320.0;
+
+    // boost::edges parcourt les arêtes dans leur sens d'insertion
+    for (auto ep = boost::edges(graph); ep.first != ep.second; ++ep.first) {
+        Edge e = *ep.first;
+        Vertex s = boost::source(e, graph);
+        Vertex t = boost::target(e, graph);
+        EdgeData& data = graph[e];
+
+        data.drivable = isDrivableRoad(data.roadClass);
+        data.from = s;
+        data.to = t;
+
+        double east = (graph[t].lon - graph[s].lon) * metersPerDeg *
+                      cos((graph[s].lat + graph[t].lat) / 2.0 * M_PI / 180.0);
+        double north = (graph[t].lat - graph[s].lat) * metersPerDeg;
+        double norm = sqrt(east * east + north * north);
+        data.dirEast = norm > 0.0 ? static_cast<float>(east / norm) : 0.0f;
+        data.dirNorth = norm > 0.0 ? static_cast<float>(north / norm) : 0.0f;
+    }
+
+    for (auto vp = boost::vertices(graph); vp.first != vp.second; ++vp.first) {
+        int degree = 0;
+        for (auto oe = boost::out_edges(*vp.first, graph); oe.first != oe.second; ++oe.first) {
+            if (graph[*oe.first].drivable) degree++;
+        }
+        graph[*vp.first].drivableOutDegree = degree;
+    }
+}
+
 // ==========================================================
 // Distance géographique (optimisée)
 // ==========================================================
@@ -118,6 +162,19 @@ double GraphBuilder::distance(double lat1, double lon1,
     return R * c;
 }
 
+// ==========================================================
+// Cache binaire du graphe
+// ==========================================================
+bool GraphBuilder::loadCache(const std::string& cachePath, uint64_t sourceHash) {
+    if (!RoadGraphCache::load(cachePath, sourceHash, graph)) return false;
+    finalizeGraph(graph);
+    return true;
+}
+
+bool GraphBuilder::saveCache(const std::string& cachePath, uint64_t sourceHash) const {
+    return RoadGraphCache::save(cachePath, graph, sourceHash);
+}
+
 // ==========================================================
 // Résumé du graphe
 // ==========================================================
@@ -126,3 +183,19 @@ void GraphBuilder::printSummary() const {
     cout << "  Sommets : " << boost::num_vertices(graph) << endl;
     cout << "  Arêtes  : " << boost::num_edges(graph) << endl;
 }
+
+// ==========================================================
+// Tronçons praticables (tracé des routes)
+// ==========================================================
+std::vector<std::pair<Vertex, Vertex>> GraphBuilder::drivableSegments(const RoadGraph& graph) {
+    std::vector<std::pair<Vertex, Vertex>> segments;
+    segments.reserve(boost::num_edges(graph) / 2);
+    for (auto ep = boost::edges(graph); ep.first != ep.second; ++ep.first) {
+        const EdgeData& data = graph[*ep.first];
+        if (!data.drivable || data.from == data.to) continue;
+        segments.emplace_back(std::min(data.from, data.to), std::max(data.from, data.to));
+    }
+    std::sort(segments.begin(), segments.end());
+    segments.erase(std::unique(segments.begin(), segments.end()), segments.end());
+    return segments;
+}
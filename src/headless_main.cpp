@@ -0,0 +1,559 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSysInfo>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+#include "simulator.h"
+#include "graph_builder.h"
+#include "osm_reader.h"
+#include "profiler.h"
+#include "road_graph_cache.h"
+#include "shard_coordinator.h"
+
+// ----------------------
+// Mode sans interface: N ticks à pas fixe, aussi vite que possible, rapport JSON
+// (débit, latences p50/p99 par étape, comparaisons, pic mémoire)
+// ----------------------
+
+// Percentile par rang le plus proche (valeurs triées en place)
+static double percentile(std::vector<double>& values, double p) {
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * values.size()));
+    return values[std::clamp<size_t>(rank, 1, values.size()) - 1];
+}
+
+static QJsonObject stageReport(std::vector<double> samples) {
+    std::sort(samples.begin(), samples.end());
+    double sum = 0.0;
+    for (double v : samples) sum += v;
+    QJsonObject stage;
+    stage["mean_ms"] = samples.empty() ? 0.0 : sum / samples.size();
+    stage["p50_ms"] = percentile(samples, 50.0);
+    stage["p99_ms"] = percentile(samples, 99.0);
+    stage["max_ms"] = samples.empty() ? 0.0 : samples.back();
+    return stage;
+}
+
+// Pic de mémoire résidente du processus (Mo)
+static double peakRssMb() {
+#if defined(__APPLE__)
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / (1024.0 * 1024.0);   // octets
+#elif defined(__unix__)
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1024.0;              // kilo-octets
+#else
+    return 0.0;
+#endif
+}
+
+// Écrit le rapport JSON dans outputPath (- = sortie standard)
+static bool writeReport(const QJsonObject& report, const QString& outputPath) {
+    const QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+    if (outputPath == "-") {
+        std::cout << json.constData();
+        return true;
+    }
+    QFile file(outputPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        std::cerr << "[Headless] Impossible d'écrire " << outputPath.toStdString() << std::endl;
+        return false;
+    }
+    file.write(json);
+    std::cout << "[Headless] Rapport écrit dans " << outputPath.toStdString() << std::endl;
+    return true;
+}
+
+// Paramètres communs au mode réparti
+struct ShardedRun {
+    int shards = 2;
+    int vehicles = 0;
+    int macroAntennas = 5;
+    int microAntennas = 20;
+    int ticks = 0;
+    int warmup = 0;
+    double dt = 0.05;
+    int threads = 0;
+    ShardRunOptions options;
+};
+
+// Mode réparti: la flotte est partagée entre des shards géographiques (régions
+// des grandes antennes), pilotés par un ShardCoordinator
+static int runSharded(RoadGraph& graph, const ShardedRun& run, QJsonObject& config, const QString& outputPath,
+                      double loadMs) {
+    // Même tirage de la flotte que le mode à un seul Simulator (mêmes IDs, départs et destinations)
+    RoadVertexIndex vertexIndex(graph);
+    if (vertexIndex.empty()) {
+        std::cerr << "[Headless] Aucun sommet praticable" << std::endl;
+        return 1;
+    }
+    std::mt19937 rng(static_cast<uint32_t>(run.options.seed));
+    std::vector<ShardVehicleSeed> fleet(run.vehicles);
+    std::vector<int> ids(run.vehicles);
+    std::vector<double> lats(run.vehicles), lons(run.vehicles);
+    for (int i = 0; i < run.vehicles; ++i) {
+        fleet[i].id = i;
+        fleet[i].start = vertexIndex.randomVertex(rng());
+        fleet[i].goal = vertexIndex.randomVertex(rng());
+        ids[i] = i;
+        lats[i] = graph[fleet[i].start].lat;
+        lons[i] = graph[fleet[i].start].lon;
+    }
+
+    // Régions = grandes antennes placées sur la flotte initiale; plusieurs par
+    // shard pour que la bissection puisse équilibrer les poids
+    const int regions = std::max(run.macroAntennas, 4 * run.shards);
+    SpatialGrid grid;
+    grid.setThreadCount(run.threads);
+    grid.initialize(ids, lats, lons, regions, std::max(1, run.microAntennas));
+    GeoPartition partition = GeoPartition::fromSpatialGrid(grid, run.shards);
+    const std::vector<double> shardWeights = partition.shardWeights();
+
+    ShardCoordinator coordinator(graph, std::move(partition), run.options);
+    if (!coordinator.start(fleet)) {
+        return 1;
+    }
+    for (int i = 0; i < run.warmup; ++i) {
+        if (!coordinator.step(run.dt)) return 1;
+    }
+
+    std::vector<double> tickMs, updateMs, graphMs;
+    tickMs.reserve(run.ticks);
+    updateMs.reserve(run.ticks);
+    graphMs.reserve(run.ticks);
+    uint64_t exchangeBytes = 0;
+    uint64_t migrations = 0;
+    uint64_t boundaryRows = 0;
+    uint64_t ghosts = 0;
+
+    std::cout << "[Headless] " << run.vehicles << " véhicules sur " << coordinator.shardCount() << " shards, "
+              << run.ticks << " ticks de " << run.dt << " s..." << std::endl;
+    auto runStart = std::chrono::steady_clock::now();
+    for (int i = 0; i < run.ticks; ++i) {
+        auto tickStart = std::chrono::steady_clock::now();
+        if (!coordinator.step(run.dt)) return 1;
+        tickMs.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - tickStart).count());
+
+        const ShardTickStats total = coordinator.totals();
+        updateMs.push_back(total.updateMs);
+        graphMs.push_back(total.graphMs);
+        exchangeBytes += coordinator.lastExchangeBytes();
+        migrations += total.emigrants;
+        boundaryRows += total.boundaryRows;
+        ghosts += total.ghosts;
+    }
+    const double runSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - runStart).count();
+
+    const ShardTickStats total = coordinator.totals();
+    QJsonArray shards;
+    for (int s = 0; s < coordinator.shardCount(); ++s) {
+        const ShardTickStats& last = coordinator.lastStats()[s];
+        QJsonObject shard;
+        shard["shard"] = s;
+        shard["initial_weight"] = shardWeights[s];
+        shard["vehicles"] = static_cast<qint64>(last.vehicles);
+        shard["ghosts"] = static_cast<qint64>(last.ghosts);
+        shard["local_edges"] = static_cast<qint64>(last.localEdges);
+        shard["cross_edges"] = static_cast<qint64>(last.crossEdges);
+        shard["update_ms"] = last.updateMs;
+        shard["graph_ms"] = last.graphMs;
+        shards.append(shard);
+    }
+
+    config["shards"] = coordinator.shardCount();
+    config["regions"] = static_cast<int>(coordinator.partition().regions().size());
+    config["transport"] = coordinator.usesProcesses() ? "processes" : "in-process";
+    config["threads_per_shard"] = run.options.threadsPerShard;
+    config["broadphase"] = "grid";
+
+    QJsonObject stages;
+    stages["tick"] = stageReport(tickMs);
+    stages["slowest_shard_update"] = stageReport(updateMs);
+    stages["slowest_shard_graph"] = stageReport(graphMs);
+
+    const double ticks = std::max(1, run.ticks);
+    QJsonObject report;
+    report["config"] = config;
+    report["graph_load_ms"] = loadMs;
+    report["road_vertices"] = static_cast<qint64>(boost::num_vertices(graph));
+    report["ticks_per_second"] = runSeconds > 0.0 ? run.ticks / runSeconds : 0.0;
+    report["simulated_seconds_per_second"] = runSeconds > 0.0 ? run.ticks * run.dt / runSeconds : 0.0;
+    report["stages"] = stages;
+    report["exchange_bytes_per_tick"] = exchangeBytes / ticks;
+    report["exchange_bytes_per_vehicle_tick"] = run.vehicles > 0 ? exchangeBytes / ticks / run.vehicles : 0.0;
+    report["migrations_per_tick"] = migrations / ticks;
+    report["boundary_rows_per_tick"] = boundaryRows / ticks;
+    report["ghosts_per_tick"] = ghosts / ticks;
+    report["final_vehicles"] = static_cast<qint64>(total.vehicles);
+    report["final_direct_edges"] = static_cast<qint64>(coordinator.totalEdges());
+    report["final_cross_edges"] = static_cast<qint64>(total.crossEdges);
+    report["shard_stats"] = shards;
+    // Processus du coordinateur seulement (chaque shard a sa propre mémoire)
+    report["peak_rss_mb"] = peakRssMb();
+    if (RecordingWriter* view = coordinator.viewRecorder()) {
+        view->close();
+        QJsonObject viewReport;
+        viewReport["path"] = QString::fromStdString(run.options.viewPath);
+        viewReport["stride"] = static_cast<int>(run.options.viewStride);
+        viewReport["frames"] = static_cast<qint64>(view->framesWritten());
+        viewReport["bytes"] = static_cast<qint64>(view->bytesWritten());
+        report["view"] = viewReport;
+    }
+    coordinator.shutdown();
+
+    if (!writeReport(report, outputPath)) return 1;
+    std::cout << "[Headless] " << report["ticks_per_second"].toDouble() << " ticks/s, "
+              << report["exchange_bytes_per_tick"].toDouble() << " octets échangés par tick, "
+              << report["migrations_per_tick"].toDouble() << " migrations par tick" << std::endl;
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    // Pas de QApplication ni de widgets: uniquement la boucle Qt Core
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("V2VHeadless");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Simulation V2V sans interface et mesure de débit");
+    parser.addHelpOption();
+    QCommandLineOption osmOption("osm", "Fichier OSM (.osm.pbf).", "path", "../data/strasbourg.osm.pbf");
+    QCommandLineOption ticksOption("ticks", "Nombre de ticks mesurés.", "n", "500");
+    QCommandLineOption warmupOption("warmup", "Ticks de chauffe (non mesurés).", "n", "20");
+    QCommandLineOption dtOption("dt", "Pas de simulation (s).", "seconds", "0.05");
+    QCommandLineOption vehiclesOption("vehicles", "Nombre de véhicules.", "n", "2000");
+    QCommandLineOption rangeOption("range", "Portée de transmission (m).", "meters", "500");
+    QCommandLineOption speedOption("speed", "Vitesse des véhicules (km/h).", "kmh", "50");
+    QCommandLineOption macroOption("macro-antennas", "Nombre de grandes antennes.", "n", "5");
+    QCommandLineOption microOption("micro-antennas", "Petites antennes par grande antenne.", "n", "20");
+    QCommandLineOption broadphaseOption("broadphase", "antennas ou grid.", "mode", "antennas");
+    QCommandLineOption threadsOption("threads", "Threads (mise à jour et graphe, 0 = tous les cœurs).", "n", "0");
+    QCommandLineOption seedOption("seed", "Graine des tirages.", "n", "42");
+    QCommandLineOption outputOption("output", "Fichier JSON du rapport (- = sortie standard).", "path", "headless_bench.json");
+    QCommandLineOption traceOption("trace", "Trace Chrome des ticks mesurés (chrome://tracing).", "path");
+    QCommandLineOption incrementalOption("incremental", "Graphe incrémental (listes de voisins de Verlet).");
+    QCommandLineOption skinOption("skin", "Marge des listes de Verlet, en fraction de la portée.", "fraction", "0.1");
+    QCommandLineOption recordOption("record", "Enregistre les ticks mesurés dans <path>.", "path");
+    QCommandLineOption keyframeOption("keyframe-interval", "Trames par bloc de l'enregistrement.", "n", "200");
+    QCommandLineOption recordIntervalOption("record-interval", "N'enregistrer qu'un tick sur n.", "n", "1");
+    QCommandLineOption noCompressOption("no-compress", "Enregistrement sans compression zstd.");
+    QCommandLineOption replayOption("replay", "Relit <path> aussi vite que possible au lieu de simuler.", "path");
+    QCommandLineOption messagesOption("messages", "Messages émis par seconde simulée (0 = pas de propagation).", "rate", "0");
+    QCommandLineOption strategyOption("strategy", "Propagation des messages: flooding ou gossip.", "name", "flooding");
+    QCommandLineOption maxHopsOption("max-hops", "Sauts maximum d'un message.", "n", "8");
+    QCommandLineOption lossOption("loss", "Probabilité de perte d'une réception.", "p", "0.05");
+    QCommandLineOption shardsOption("shards", "Shards géographiques (1 = un seul Simulator).", "n", "1");
+    QCommandLineOption inProcessOption("shards-in-process", "Shards dans ce processus au lieu de processus fils.");
+    QCommandLineOption viewOption("view", "Vue sous-échantillonnée des shards, enregistrée dans <path>.", "path");
+    QCommandLineOption viewStrideOption("view-stride", "Un véhicule sur n dans la vue.", "n", "10");
+    QCommandLineOption viewIntervalOption("view-interval", "Une vue tous les n ticks.", "n", "1");
+    parser.addOptions({osmOption, ticksOption, warmupOption, dtOption, vehiclesOption, rangeOption, speedOption,
+                       macroOption, microOption, broadphaseOption, threadsOption, seedOption, outputOption,
+                       traceOption, incrementalOption, skinOption, recordOption, keyframeOption,
+                       recordIntervalOption, noCompressOption, replayOption, messagesOption, strategyOption,
+                       maxHopsOption, lossOption, shardsOption, inProcessOption, viewOption, viewStrideOption,
+                       viewIntervalOption});
+    parser.process(app);
+
+    const std::string osmPath = parser.value(osmOption).toStdString();
+    const int ticks = std::max(1, parser.value(ticksOption).toInt());
+    const int warmup = std::max(0, parser.value(warmupOption).toInt());
+    const double dt = parser.value(dtOption).toDouble();
+    const int numVehicles = std::max(0, parser.value(vehiclesOption).toInt());
+    const double range = parser.value(rangeOption).toDouble();
+    const double speed = parser.value(speedOption).toDouble() / 3.6;
+    const int numMacro = parser.value(macroOption).toInt();
+    const int numMicro = parser.value(microOption).toInt();
+    const bool uniformGrid = parser.value(broadphaseOption) == "grid";
+    const int threads = parser.value(threadsOption).toInt();
+    const uint64_t seed = parser.value(seedOption).toULongLong();
+    const bool incremental = parser.isSet(incrementalOption);
+    const double skinFraction = parser.value(skinOption).toDouble();
+
+    // Chargement du graphe routier (ou du cache binaire s'il est à jour), comme l'application
+    const std::string cachePath = RoadGraphCache::defaultCachePath(osmPath);
+    const uint64_t osmHash = RoadGraphCache::hashFile(osmPath);
+    OSMReader reader(osmPath, OSMReader::ReadMode::DrivableOnly);
+    GraphBuilder builder(reader.nodes, reader.ways);
+    auto loadStart = std::chrono::steady_clock::now();
+    if (!builder.loadCache(cachePath, osmHash)) {
+        reader.read();
+        builder.buildGraph();
+        builder.saveCache(cachePath, osmHash);
+    }
+    const double loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStart).count();
+    const RoadGraph& graph = builder.getGraph();
+
+    const int shardCount = std::max(1, parser.value(shardsOption).toInt());
+    if (shardCount > 1 && !parser.isSet(replayOption)) {
+        ShardedRun run;
+        run.shards = shardCount;
+        run.vehicles = numVehicles;
+        run.macroAntennas = numMacro;
+        run.microAntennas = numMicro;
+        run.ticks = ticks;
+        run.warmup = warmup;
+        run.dt = dt;
+        run.threads = threads;
+        run.options.processes = !parser.isSet(inProcessOption);
+        // Sans réglage: les cœurs sont partagés entre les processus
+        const int cores = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        run.options.threadsPerShard = threads > 0 ? threads : std::max(1, cores / shardCount);
+        run.options.seed = seed;
+        run.options.graphSourceHash = osmHash;
+        run.options.speed = speed;
+        run.options.range = range;
+        if (parser.isSet(viewOption)) {
+            run.options.viewPath = parser.value(viewOption).toStdString();
+        }
+        run.options.viewStride = static_cast<uint32_t>(std::max(1, parser.value(viewStrideOption).toInt()));
+        run.options.viewInterval = std::max(1, parser.value(viewIntervalOption).toInt());
+
+        QJsonObject config;
+        config["osm"] = QString::fromStdString(osmPath);
+        config["vehicles"] = numVehicles;
+        config["ticks"] = ticks;
+        config["warmup_ticks"] = warmup;
+        config["dt_s"] = dt;
+        config["range_m"] = range;
+        config["speed_kmh"] = speed * 3.6;
+        config["hardware_threads"] = static_cast<int>(std::thread::hardware_concurrency());
+        config["seed"] = QString::number(seed);
+        config["cpu"] = QSysInfo::currentCpuArchitecture();
+        config["backend"] = DistanceKernel::backendName();
+        return runSharded(const_cast<RoadGraph&>(graph), run, config, parser.value(outputOption), loadMs);
+    }
+
+    Simulator simulator(const_cast<RoadGraph&>(graph));
+    simulator.setRoadGraphSourceHash(osmHash);
+    simulator.setRandomSeed(seed);
+    simulator.setUpdateThreadCount(threads);
+    simulator.interferenceGraph().setBuildThreadCount(threads);
+    simulator.interferenceGraph().setBroadphaseMode(uniformGrid ? BroadphaseMode::UniformGrid
+                                                                : BroadphaseMode::Antennas);
+    simulator.setIncrementalGraph(incremental, skinFraction);
+
+    const double messageRate = std::max(0.0, parser.value(messagesOption).toDouble());
+    MessageEngineConfig messageConfig;
+    messageConfig.strategy = parser.value(strategyOption) == "gossip" ? PropagationStrategy::Gossip
+                                                                      : PropagationStrategy::Flooding;
+    messageConfig.maxHops = std::max(0, parser.value(maxHopsOption).toInt());
+    messageConfig.lossProbability = std::clamp(parser.value(lossOption).toDouble(), 0.0, 1.0);
+    messageConfig.seed = seed;
+    simulator.messageEngine().setConfig(messageConfig);
+    simulator.setMessageRate(messageRate);
+
+    if (parser.isSet(replayOption)) {
+        // Débit de relecture: décodage + reconstruction du graphe, sans attente
+        const std::string replayPath = parser.value(replayOption).toStdString();
+        if (!simulator.openReplay(replayPath)) {
+            return 1;
+        }
+        uint64_t frames = 1;
+        size_t maxVehicles = simulator.vehicleStore().size();
+        auto replayStart = std::chrono::steady_clock::now();
+        while (simulator.stepReplayFrame()) {
+            frames++;
+            maxVehicles = std::max(maxVehicles, simulator.vehicleStore().size());
+        }
+        const double replaySeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - replayStart).count();
+
+        QJsonObject report;
+        report["replay"] = QString::fromStdString(replayPath);
+        report["frames"] = static_cast<qint64>(frames);
+        report["chunks"] = static_cast<qint64>(simulator.replayReader()->chunkCount());
+        report["max_vehicles"] = static_cast<qint64>(maxVehicles);
+        report["frames_per_second"] = replaySeconds > 0.0 ? frames / replaySeconds : 0.0;
+        report["peak_rss_mb"] = peakRssMb();
+        return writeReport(report, parser.value(outputOption)) ? 0 : 1;
+    }
+
+    const RoadVertexIndex& vertexIndex = simulator.vertexIndex();
+    if (vertexIndex.empty()) {
+        std::cerr << "[Headless] Aucun sommet praticable dans " << osmPath << std::endl;
+        return 1;
+    }
+    std::mt19937 rng(static_cast<uint32_t>(seed));
+    for (int i = 0; i < numVehicles; ++i) {
+        Vertex start = vertexIndex.randomVertex(rng());
+        Vertex goal = vertexIndex.randomVertex(rng());
+        simulator.createVehicle(i, start, goal, speed, range, 5.0);
+    }
+    simulator.planRoutes();
+    if (!uniformGrid) {
+        simulator.placeAntennas(numMacro, numMicro);
+        simulator.waitForAntennas();
+    }
+
+    for (int i = 0; i < warmup; ++i) {
+        simulator.stepOnce(dt);
+    }
+    // La trace et les compteurs ne couvrent que les ticks mesurés
+    Profiler::reset();
+    simulator.setMessagePropagation(messageRate > 0.0);
+
+    if (parser.isSet(recordOption)) {
+        RecordingOptions recordingOptions;
+        recordingOptions.keyframeInterval = std::max(1, parser.value(keyframeOption).toInt());
+        recordingOptions.frameInterval = std::max(1, parser.value(recordIntervalOption).toInt());
+        recordingOptions.compress = !parser.isSet(noCompressOption);
+        if (!simulator.startRecording(parser.value(recordOption).toStdString(), recordingOptions)) {
+            return 1;
+        }
+    }
+
+    std::vector<double> updateMs, snapshotMs, buildMs, closureMs, messagesMs, tickMs;
+    updateMs.reserve(ticks);
+    snapshotMs.reserve(ticks);
+    buildMs.reserve(ticks);
+    closureMs.reserve(ticks);
+    messagesMs.reserve(ticks);
+    tickMs.reserve(ticks);
+    long long comparisons = 0;
+    long long handoffs = 0;
+    long long edgesAdded = 0;
+    long long edgesRemoved = 0;
+    long long messageEvents = 0;
+    int neighborListRebuilds = 0;
+
+    std::cout << "[Headless] " << numVehicles << " véhicules, " << ticks << " ticks de " << dt << " s..." << std::endl;
+    auto runStart = std::chrono::steady_clock::now();
+    for (int i = 0; i < ticks; ++i) {
+        auto tickStart = std::chrono::steady_clock::now();
+        simulator.stepOnce(dt);
+        tickMs.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - tickStart).count());
+
+        const TickTimings& t = simulator.lastTickTimings();
+        updateMs.push_back(t.updateMs);
+        snapshotMs.push_back(t.snapshotMs);
+        buildMs.push_back(t.graphBuildMs);
+        closureMs.push_back(t.closureMs);
+        messagesMs.push_back(t.messagesMs);
+        messageEvents += t.messageEvents;
+        comparisons += t.comparisons;
+        handoffs += t.handoffs;
+        edgesAdded += t.edgesAdded;
+        edgesRemoved += t.edgesRemoved;
+        neighborListRebuilds += t.neighborListRebuilt ? 1 : 0;
+    }
+    const double runSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - runStart).count();
+
+    // Vider la file d'écriture avant de lire la taille de l'enregistrement
+    uint64_t recordedFrames = 0;
+    uint64_t recordedBytes = 0;
+    if (RecordingWriter* recorder = simulator.recorder()) {
+        recorder->close();
+        recordedFrames = recorder->framesWritten();
+        recordedBytes = recorder->bytesWritten();
+        simulator.stopRecording();
+    }
+
+    std::shared_ptr<const InterferenceGraph> finalGraph = simulator.currentGraph();
+
+    QJsonObject config;
+    config["osm"] = QString::fromStdString(osmPath);
+    config["vehicles"] = numVehicles;
+    config["ticks"] = ticks;
+    config["warmup_ticks"] = warmup;
+    config["dt_s"] = dt;
+    config["range_m"] = range;
+    config["speed_kmh"] = speed * 3.6;
+    config["macro_antennas"] = numMacro;
+    config["micro_antennas"] = numMicro;
+    config["broadphase"] = uniformGrid ? "grid" : "antennas";
+    config["incremental"] = incremental;
+    config["skin_fraction"] = skinFraction;
+    config["threads"] = threads;
+    config["hardware_threads"] = static_cast<int>(std::thread::hardware_concurrency());
+    config["seed"] = QString::number(seed);
+    config["cpu"] = QSysInfo::currentCpuArchitecture();
+    config["backend"] = DistanceKernel::backendName();
+
+    QJsonObject stages;
+    stages["tick"] = stageReport(tickMs);
+    stages["update"] = stageReport(updateMs);
+    stages["snapshot"] = stageReport(snapshotMs);
+    stages["graph_build"] = stageReport(buildMs);
+    stages["closure"] = stageReport(closureMs);
+    if (messageRate > 0.0) {
+        stages["messages"] = stageReport(messagesMs);
+    }
+
+    QJsonObject report;
+    report["config"] = config;
+    report["graph_load_ms"] = loadMs;
+    report["road_vertices"] = static_cast<qint64>(boost::num_vertices(graph));
+    report["ticks_per_second"] = runSeconds > 0.0 ? ticks / runSeconds : 0.0;
+    report["simulated_seconds_per_second"] = runSeconds > 0.0 ? ticks * dt / runSeconds : 0.0;
+    report["stages"] = stages;
+    report["comparisons_per_tick"] = static_cast<double>(comparisons) / ticks;
+    report["handoffs_per_tick"] = static_cast<double>(handoffs) / ticks;
+    report["edges_added_per_tick"] = static_cast<double>(edgesAdded) / ticks;
+    report["edges_removed_per_tick"] = static_cast<double>(edgesRemoved) / ticks;
+    report["neighbor_list_rebuilds"] = neighborListRebuilds;
+    report["final_direct_edges"] = static_cast<qint64>(finalGraph->getDirectEdges().size());
+    report["final_components"] = finalGraph->getComponentCount();
+    report["peak_rss_mb"] = peakRssMb();
+    if (messageRate > 0.0) {
+        const MessageStats& ms = simulator.messageEngine().stats();
+        QJsonObject messages;
+        messages["rate_per_s"] = messageRate;
+        messages["strategy"] = messageConfig.strategy == PropagationStrategy::Gossip ? "gossip" : "flooding";
+        messages["max_hops"] = messageConfig.maxHops;
+        messages["loss"] = messageConfig.lossProbability;
+        messages["created"] = static_cast<qint64>(ms.messagesCreated);
+        messages["completed"] = static_cast<qint64>(ms.messagesCompleted);
+        messages["transmissions"] = static_cast<qint64>(ms.transmissions);
+        messages["events_per_tick"] = static_cast<double>(messageEvents) / ticks;
+        messages["mean_reach"] = ms.meanReach();
+        messages["latency_mean_ms"] = ms.meanLatencyMs();
+        messages["latency_p50_ms"] = ms.latencyPercentileMs(50.0);
+        messages["latency_p99_ms"] = ms.latencyPercentileMs(99.0);
+        messages["duplicate_rate"] = ms.duplicateRate();
+        messages["loss_count"] = static_cast<qint64>(ms.lost);
+        report["messages"] = messages;
+    }
+    if (parser.isSet(recordOption)) {
+        QJsonObject recording;
+        recording["path"] = parser.value(recordOption);
+        recording["frames"] = static_cast<qint64>(recordedFrames);
+        recording["bytes"] = static_cast<qint64>(recordedBytes);
+        recording["bytes_per_vehicle_tick"] = recordedFrames > 0 && numVehicles > 0
+            ? static_cast<double>(recordedBytes) / (recordedFrames * numVehicles) : 0.0;
+        report["recording"] = recording;
+    }
+
+    if (parser.isSet(traceOption)) {
+        const std::string tracePath = parser.value(traceOption).toStdString();
+        if (Profiler::writeChromeTrace(tracePath)) {
+            std::cout << "[Headless] Trace écrite dans " << tracePath << std::endl;
+        } else {
+            std::cerr << "[Headless] Impossible d'écrire " << tracePath << std::endl;
+        }
+    }
+
+    if (!writeReport(report, parser.value(outputOption))) {
+        return 1;
+    }
+
+    std::cout << "[Headless] " << report["ticks_per_second"].toDouble() << " ticks/s, tick p99 "
+              << stages["tick"].toObject()["p99_ms"].toDouble() << " ms, pic mémoire "
+              << report["peak_rss_mb"].toDouble() << " Mo" << std::endl;
+    return 0;
+}
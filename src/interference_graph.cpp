@@ -3,6 +3,20 @@
 #include <iostream>
 #include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <numeric>
+#include <unordered_map>
+#include "parallel_for.h"
+#include "profiler.h"
+#include "union_find.h"
+#include "verlet_neighbor_list.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Mètres par degré de latitude (approximation utilisée pour les snapshots)
+static constexpr double METERS_PER_DEG = 111000.0;
 
 InterferenceGraph::InterferenceGraph() 
     : m_useSpatialGrid(true), m_gridInitialized(false), m_computeTransitive(false) {}
@@ -12,39 +26,54 @@ InterferenceGraph::~InterferenceGraph() {
 }
 
 void InterferenceGraph::clear() {
-    m_adjacencyList.clear();
-    m_transitiveClosure.clear();
+    resetIndex();
     m_vehicleMap.clear();
     m_spatialGrid.clear();
 }
 
 void InterferenceGraph::copyFrom(const InterferenceGraph& other) {
-    m_adjacencyList = other.m_adjacencyList;
-    m_transitiveClosure = other.m_transitiveClosure;
+    m_vehicleIds = other.m_vehicleIds;
+    m_idToIndex = other.m_idToIndex;
+    m_vehicleLon = other.m_vehicleLon;
+    m_vehicleLat = other.m_vehicleLat;
+    m_offsets = other.m_offsets;
+    m_neighbors = other.m_neighbors;
+    m_directEdges = other.m_directEdges;
+    m_addedEdges = other.m_addedEdges;
+    m_removedEdges = other.m_removedEdges;
+    m_neighborListRebuilt = other.m_neighborListRebuilt;
+    m_componentOf = other.m_componentOf;
+    m_componentSize = other.m_componentSize;
+    m_nextInComponent = other.m_nextInComponent;
+    m_componentCount = other.m_componentCount;
     // On ne copie pas m_vehicleMap car il contient des pointeurs
     // On ne copie pas m_spatialGrid car elle est initialisée séparément
     m_lastBuildTimeMs = other.m_lastBuildTimeMs;
+    m_lastComponentsTimeMs = other.m_lastComponentsTimeMs;
     m_lastComparisons = other.m_lastComparisons;
     m_lastAvgNeighbors = other.m_lastAvgNeighbors;
+    m_tickSequence = other.m_tickSequence;
 }
 
 void InterferenceGraph::buildGraph(const std::vector<Vehicule*>& vehicles) {
     auto startTime = std::chrono::high_resolution_clock::now();
     
-    // Effacer seulement les listes d'adjacence, pas la grille spatiale
-    m_adjacencyList.clear();
-    m_transitiveClosure.clear();
+    // Effacer seulement l'adjacence, pas la grille spatiale
+    resetIndex();
     m_vehicleMap.clear();
 
     if (vehicles.empty()) {
         return;
     }
 
-    // Construire la map pour accès rapide et initialiser les ensembles
+    // Construire la map pour accès rapide et la table des indices denses
     for (auto* v : vehicles) {
-        if (v) {
+        if (v && m_idToIndex.count(v->getId()) == 0) {
             m_vehicleMap[v->getId()] = v;
-            m_adjacencyList[v->getId()] = std::unordered_set<int>();
+            addVertex(v->getId());
+            auto [lat, lon] = v->getPosition();
+            m_vehicleLon.push_back(lon);
+            m_vehicleLat.push_back(lat);
         }
     }
 
@@ -54,28 +83,27 @@ void InterferenceGraph::buildGraph(const std::vector<Vehicule*>& vehicles) {
     }
 
     // Construire les connexions directes
+    Profiler::ScopedTimer buildTimer(Profiler::Stage::GraphBuild);
     if (m_useSpatialGrid && vehicles.size() >= 20) {
         buildGraphWithSpatialGrid(vehicles);
     } else {
         buildGraphClassic(vehicles);
     }
+    buildEdgeList();
+    buildTimer.stop();
+    Profiler::add(Profiler::Counter::DistanceComparisons, m_lastComparisons);
 
-    // Calculer la fermeture transitive (optimisée avec grille spatiale) si activé
-    if (m_computeTransitive) {
-        computeTransitiveClosure();
+    // Composantes connexes (connexions transitives): toujours calculées
+    computeComponentsTimed();
 
-        // Mettre à jour les voisins de chaque véhicule
+    // Mettre à jour les voisins de chaque véhicule si la fermeture transitive est activée
+    if (m_computeTransitive) {
         for (auto* v : vehicles) {
             if (!v) continue;
 
             v->clearNeighbors();
-            const auto& reachable = m_transitiveClosure[v->getId()];
-            
-            for (auto* other : vehicles) {
-                if (!other || other == v) continue;
-                if (reachable.find(other->getId()) != reachable.end()) {
-                    v->addNeighbor(other);
-                }
+            for (int reachableId : getReachableVehicles(v->getId())) {
+                v->addNeighbor(m_vehicleMap[reachableId]);
             }
         }
     }
@@ -86,13 +114,38 @@ void InterferenceGraph::buildGraph(const std::vector<Vehicule*>& vehicles) {
     
     // Stocker le temps de build
     m_lastBuildTimeMs = duration.count() / 1000.0;
-    
-    // Toujours afficher pour debug avec beaucoup de véhicules
-    if (vehicles.size() > 1000) {
-        std::cout << "[buildGraph] " << vehicles.size() << " véhicules, " 
-                  << duration.count() / 1000.0 << " ms ("
-                  << (m_useSpatialGrid && vehicles.size() >= 20 ? "optimisé" : "classique") << ")" << std::endl;
+}
+
+// Snapshots sans doublon d'ID (première occurrence conservée), indices
+// d'antennes renumérotés en conséquence. Renvoie false si aucun doublon:
+// l'indice dense reste alors la position dans le tableau d'origine.
+static bool dropDuplicateIds(const std::vector<VehicleSnapshot>& snapshots, const AntennaNeighborhood* antennaInfo,
+                             std::vector<VehicleSnapshot>& unique, AntennaNeighborhood* uniqueInfo) {
+    std::unordered_map<int, int> seen;
+    seen.reserve(snapshots.size());
+    std::vector<int> remap(snapshots.size(), -1);
+    for (size_t i = 0; i < snapshots.size(); ++i) {
+        if (seen.emplace(snapshots[i].id, static_cast<int>(unique.size())).second) {
+            remap[i] = static_cast<int>(unique.size());
+            unique.push_back(snapshots[i]);
+        }
+    }
+    if (unique.size() == snapshots.size()) return false;
+
+    std::cerr << "[InterferenceGraph] " << snapshots.size() - unique.size()
+              << " snapshots à l'ID dupliqué ignorés" << std::endl;
+    if (antennaInfo && uniqueInfo) {
+        uniqueInfo->neighborAntennas = antennaInfo->neighborAntennas;
+        for (const auto& [antennaId, indices] : antennaInfo->vehiclesPerAntenna) {
+            std::vector<int>& kept = uniqueInfo->vehiclesPerAntenna[antennaId];
+            for (int idx : indices) {
+                if (idx >= 0 && static_cast<size_t>(idx) < remap.size() && remap[idx] >= 0) {
+                    kept.push_back(remap[idx]);
+                }
+            }
+        }
     }
+    return true;
 }
 
 void InterferenceGraph::buildGraphFromSnapshots(const std::vector<VehicleSnapshot>& snapshots,
@@ -100,131 +153,497 @@ void InterferenceGraph::buildGraphFromSnapshots(const std::vector<VehicleSnapsho
     // Cette méthode est thread-safe car elle travaille sur des copies
     auto startTime = std::chrono::high_resolution_clock::now();
     
-    m_adjacencyList.clear();
-    m_transitiveClosure.clear();
+    resetIndex();
     m_vehicleMap.clear();
 
     if (snapshots.empty()) {
         return;
     }
 
-    // Initialiser les ensembles pour chaque véhicule
+    // Indice dense = position dans le tableau de snapshots: un ID dupliqué
+    // décalerait toutes les lignes suivantes
+    {
+        std::vector<VehicleSnapshot> unique;
+        AntennaNeighborhood uniqueInfo;
+        if (dropDuplicateIds(snapshots, antennaInfo, unique, &uniqueInfo)) {
+            buildGraphFromSnapshots(unique, antennaInfo ? &uniqueInfo : nullptr);
+            return;
+        }
+    }
+
+    m_vehicleIds.reserve(snapshots.size());
+    m_idToIndex.reserve(snapshots.size());
+    m_vehicleLon.reserve(snapshots.size());
+    m_vehicleLat.reserve(snapshots.size());
     for (const auto& snap : snapshots) {
-        m_adjacencyList[snap.id] = std::unordered_set<int>();
+        addVertex(snap.id);
+        m_vehicleLon.push_back(snap.lon);
+        m_vehicleLat.push_back(snap.lat);
     }
 
-    int comparisons = 0;
+    int64_t comparisons = 0;
+    Profiler::ScopedTimer buildTimer(Profiler::Stage::GraphBuild);
+
+    // Projection unique: les tests de portée n'appellent plus ni cos() ni sqrt()
+    ProjectedPositions projected;
+    projectSnapshots(snapshots, projected);
     
-    // Si on a les infos d'antennes, utiliser l'optimisation par antennes
-    if (antennaInfo != nullptr && !antennaInfo->vehiclesPerAntenna.empty()) {
-        // Créer un index pour accéder aux snapshots par leur ID
-        std::unordered_map<int, size_t> idToIndex;
-        for (size_t i = 0; i < snapshots.size(); ++i) {
-            idToIndex[snapshots[i].id] = i;
+    if (m_broadphaseMode == BroadphaseMode::UniformGrid) {
+        // Grille uniforme reconstruite à partir des positions courantes
+        comparisons = buildDirectEdgesUniformGrid(snapshots, projected);
+    } else if (antennaInfo != nullptr && !antennaInfo->vehiclesPerAntenna.empty()) {
+        // Si on a les infos d'antennes, utiliser l'optimisation par antennes
+        comparisons = buildDirectEdgesAntennas(projected, *antennaInfo);
+    } else {
+        // Fallback: O(n²) classique si pas d'infos d'antennes
+        comparisons = buildDirectEdgesBruteForce(projected);
+    }
+    buildEdgeList();
+    buildTimer.stop();
+    Profiler::add(Profiler::Counter::DistanceComparisons, comparisons);
+
+    // Composantes connexes (connexions transitives)
+    computeComponentsTimed();
+
+    m_lastComparisons = comparisons;
+    m_lastAvgNeighbors = snapshots.size() > 0 ? 2.0 * static_cast<double>(comparisons) / snapshots.size() : 0.0;
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
+    m_lastBuildTimeMs = duration.count() / 1000.0;
+}
+
+void InterferenceGraph::buildGraphIncremental(const std::vector<VehicleSnapshot>& snapshots,
+                                              VerletNeighborList& neighbors) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    {
+        // Même contrainte d'indices que buildGraphFromSnapshots
+        std::vector<VehicleSnapshot> unique;
+        if (dropDuplicateIds(snapshots, nullptr, unique, nullptr)) {
+            buildGraphIncremental(unique, neighbors);
+            return;
         }
-        
-        // Pour chaque antenne, comparer les véhicules de cette antenne entre eux
-        // et avec les véhicules des antennes voisines
-        for (const auto& [antennaId, vehicleIndices] : antennaInfo->vehiclesPerAntenna) {
+    }
+
+    resetIndex();
+    m_vehicleMap.clear();
+
+    m_vehicleIds.reserve(snapshots.size());
+    m_idToIndex.reserve(snapshots.size());
+    m_vehicleLon.reserve(snapshots.size());
+    m_vehicleLat.reserve(snapshots.size());
+    for (const auto& snap : snapshots) {
+        addVertex(snap.id);
+        m_vehicleLon.push_back(snap.lon);
+        m_vehicleLat.push_back(snap.lat);
+    }
+
+    // Seules les paires candidates sont retestées; les connexions courantes
+    // reviennent sous forme d'arêtes (indices des snapshots) comme pour les autres builds
+    Profiler::ScopedTimer buildTimer(Profiler::Stage::GraphBuild);
+    VerletNeighborList::Update update;
+    neighbors.update(snapshots, m_buildThreadCount, update);
+    m_addedEdges = std::move(update.added);
+    m_removedEdges = std::move(update.removed);
+    m_neighborListRebuilt = update.rebuilt;
+
+    if (snapshots.empty()) {
+        return;
+    }
+
+    buildAdjacency(update.edges);
+    buildEdgeList();
+    buildTimer.stop();
+    Profiler::add(Profiler::Counter::DistanceComparisons, update.comparisons);
+
+    computeComponentsTimed();
+
+    m_lastComparisons = update.comparisons;
+    m_lastAvgNeighbors = static_cast<double>(m_neighbors.size()) / snapshots.size();
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
+    m_lastBuildTimeMs = duration.count() / 1000.0;
+}
+
+void InterferenceGraph::buildGraphFromEdges(const std::vector<VehicleSnapshot>& snapshots,
+                                            const EdgeIdList& edges, EdgeIdList added, EdgeIdList removed) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    resetIndex();
+    m_vehicleMap.clear();
+
+    m_vehicleIds.reserve(snapshots.size());
+    m_idToIndex.reserve(snapshots.size());
+    m_vehicleLon.reserve(snapshots.size());
+    m_vehicleLat.reserve(snapshots.size());
+    for (const auto& snap : snapshots) {
+        addVertex(snap.id);
+        m_vehicleLon.push_back(snap.lon);
+        m_vehicleLat.push_back(snap.lat);
+    }
+    m_addedEdges = std::move(added);
+    m_removedEdges = std::move(removed);
+
+    if (snapshots.empty()) {
+        return;
+    }
+
+    // Aucun test de distance: les paires d'IDs sont converties en indices
+    std::vector<EdgeList> buffers(1);
+    buffers[0].reserve(edges.size());
+    for (const auto& [id1, id2] : edges) {
+        auto it1 = m_idToIndex.find(id1);
+        auto it2 = m_idToIndex.find(id2);
+        if (it1 == m_idToIndex.end() || it2 == m_idToIndex.end() || it1->second == it2->second) continue;
+        buffers[0].emplace_back(it1->second, it2->second);
+    }
+    buildAdjacency(buffers);
+    buildEdgeList();
+
+    computeComponentsTimed();
+
+    m_lastComparisons = 0;
+    m_lastAvgNeighbors = static_cast<double>(m_neighbors.size()) / snapshots.size();
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
+    m_lastBuildTimeMs = duration.count() / 1000.0;
+}
+
+void InterferenceGraph::resetIndex() {
+    m_vehicleIds.clear();
+    m_idToIndex.clear();
+    m_vehicleLon.clear();
+    m_vehicleLat.clear();
+    m_offsets.clear();
+    m_neighbors.clear();
+    m_directEdges.clear();
+    m_addedEdges.clear();
+    m_removedEdges.clear();
+    m_neighborListRebuilt = false;
+    m_componentOf.clear();
+    m_componentSize.clear();
+    m_nextInComponent.clear();
+    m_componentCount = 0;
+}
+
+int InterferenceGraph::addVertex(int vehicleId) {
+    auto [it, inserted] = m_idToIndex.emplace(vehicleId, static_cast<int>(m_vehicleIds.size()));
+    if (inserted) {
+        m_vehicleIds.push_back(vehicleId);
+    }
+    return it->second;
+}
+
+void InterferenceGraph::buildAdjacency(const std::vector<EdgeList>& buffers) {
+    // Fusion séquentielle après le join des workers: aucun verrou nécessaire
+    const size_t n = m_vehicleIds.size();
+
+    // 1. Degrés puis somme préfixe
+    m_offsets.assign(n + 1, 0);
+    for (const auto& buffer : buffers) {
+        for (const auto& [idx1, idx2] : buffer) {
+            m_offsets[idx1 + 1]++;
+            m_offsets[idx2 + 1]++;
+        }
+    }
+    for (size_t i = 0; i < n; ++i) {
+        m_offsets[i + 1] += m_offsets[i];
+    }
+
+    // 2. Remplissage (les deux sens de chaque arête)
+    m_neighbors.resize(m_offsets[n]);
+    std::vector<int> fillPos(m_offsets.begin(), m_offsets.end() - 1);
+    for (const auto& buffer : buffers) {
+        for (const auto& [idx1, idx2] : buffer) {
+            m_neighbors[fillPos[idx1]++] = idx2;
+            m_neighbors[fillPos[idx2]++] = idx1;
+        }
+    }
+
+    // 3. Tri de chaque ligne et compactage en place des doublons éventuels
+    int write = 0;
+    for (size_t i = 0; i < n; ++i) {
+        auto rowBegin = m_neighbors.begin() + m_offsets[i];
+        auto rowEnd = m_neighbors.begin() + m_offsets[i + 1];
+        std::sort(rowBegin, rowEnd);
+        rowEnd = std::unique(rowBegin, rowEnd);
+
+        m_offsets[i] = write;
+        write = static_cast<int>(std::copy(rowBegin, rowEnd, m_neighbors.begin() + write) - m_neighbors.begin());
+    }
+    m_offsets[n] = write;
+    m_neighbors.resize(write);
+}
+
+void InterferenceGraph::buildEdgeList() {
+    // Chaque arête figure dans les deux lignes du CSR: on ne garde que j > i
+    m_directEdges.clear();
+    m_directEdges.reserve(m_neighbors.size() / 2);
+    const int n = static_cast<int>(m_vehicleIds.size());
+    for (int i = 0; i < n; ++i) {
+        for (int k = m_offsets[i]; k < m_offsets[i + 1]; ++k) {
+            const int j = m_neighbors[k];
+            if (j <= i) continue;
+            m_directEdges.push_back({m_vehicleIds[i], m_vehicleIds[j],
+                                     m_vehicleLon[i], m_vehicleLat[i], m_vehicleLon[j], m_vehicleLat[j]});
+        }
+    }
+}
+
+void InterferenceGraph::projectSnapshots(const std::vector<VehicleSnapshot>& snapshots,
+                                         ProjectedPositions& projected) {
+    projected.clear();
+    if (snapshots.empty()) return;
+
+    double minLat = snapshots[0].lat, maxLat = snapshots[0].lat;
+    double minLon = snapshots[0].lon, maxLon = snapshots[0].lon;
+    for (const auto& snap : snapshots) {
+        minLat = std::min(minLat, snap.lat);
+        maxLat = std::max(maxLat, snap.lat);
+        minLon = std::min(minLon, snap.lon);
+        maxLon = std::max(maxLon, snap.lon);
+    }
+
+    // Origine au centre de l'emprise: coordonnées petites, donc précises en float
+    const double originLat = (minLat + maxLat) / 2.0;
+    const double originLon = (minLon + maxLon) / 2.0;
+    const double metersPerDegLon = METERS_PER_DEG * std::cos(originLat * M_PI / 180.0);
+
+    projected.x.resize(snapshots.size());
+    projected.y.resize(snapshots.size());
+    projected.range.resize(snapshots.size());
+    for (size_t i = 0; i < snapshots.size(); ++i) {
+        projected.x[i] = static_cast<float>((snapshots[i].lon - originLon) * metersPerDegLon);
+        projected.y[i] = static_cast<float>((snapshots[i].lat - originLat) * METERS_PER_DEG);
+        projected.range[i] = static_cast<float>(snapshots[i].transmissionRange);
+    }
+}
+
+int64_t InterferenceGraph::buildDirectEdgesBruteForce(const ProjectedPositions& projected) {
+    const size_t n = projected.size();
+    const int threads = resolveThreadCount(m_buildThreadCount);
+    std::vector<EdgeList> buffers(threads);
+    std::vector<int64_t> comparisons(threads, 0);
+
+    // Une ligne i compare le véhicule i avec tous les j > i (blocs dynamiques: charge triangulaire),
+    // contigus dans les colonnes projetées: le noyau les teste par blocs vectoriels
+    parallelFor(n, threads, 64, [&](size_t begin, size_t end, int worker) {
+        EdgeList& edges = buffers[worker];
+        for (size_t i = begin; i < end; ++i) {
+            comparisons[worker] += static_cast<int64_t>(n - i - 1);
+            DistanceKernel::forEachInRange(projected.x[i], projected.y[i], projected.range[i],
+                                           projected, i + 1, n, [&](size_t j) {
+                edges.emplace_back(static_cast<int>(i), static_cast<int>(j));
+            });
+        }
+    });
+
+    buildAdjacency(buffers);
+    return std::accumulate(comparisons.begin(), comparisons.end(), int64_t{0});
+}
+
+int64_t InterferenceGraph::buildDirectEdgesAntennas(const ProjectedPositions& projected,
+                                                 const AntennaNeighborhood& antennaInfo) {
+    // Liste des antennes à traiter (une antenne = une unité de travail)
+    std::vector<int> antennaIds;
+    antennaIds.reserve(antennaInfo.vehiclesPerAntenna.size());
+    for (const auto& [antennaId, vehicleIndices] : antennaInfo.vehiclesPerAntenna) {
+        antennaIds.push_back(antennaId);
+    }
+    std::sort(antennaIds.begin(), antennaIds.end());
+
+    const int threads = resolveThreadCount(m_buildThreadCount);
+    std::vector<EdgeList> buffers(threads);
+    std::vector<int64_t> comparisons(threads, 0);
+
+    // Indices valides d'une antenne (les indices hors snapshots sont ignorés)
+    auto validIndices = [&](const std::vector<int>& indices, std::vector<int>& out) {
+        out.clear();
+        for (int idx : indices) {
+            if (idx >= 0 && static_cast<size_t>(idx) < projected.size()) out.push_back(idx);
+        }
+    };
+
+    // Pour chaque antenne, comparer les véhicules de cette antenne entre eux
+    // et avec les véhicules des antennes voisines. Les positions de chaque
+    // antenne sont recopiées en colonnes contiguës pour le noyau vectoriel.
+    parallelFor(antennaIds.size(), threads, 1, [&](size_t begin, size_t end, int worker) {
+        EdgeList& edges = buffers[worker];
+        int64_t& count = comparisons[worker];
+        std::vector<int> own, other;
+        ProjectedPositions ownPos, otherPos;
+
+        for (size_t a = begin; a < end; ++a) {
+            const int antennaId = antennaIds[a];
+            validIndices(antennaInfo.vehiclesPerAntenna.at(antennaId), own);
+            ownPos.gather(projected, own);
+
             // 1. Comparer les véhicules de la même antenne entre eux
-            for (size_t i = 0; i < vehicleIndices.size(); ++i) {
-                size_t idx1 = vehicleIndices[i];
-                if (idx1 >= snapshots.size()) continue;
-                const auto& v1 = snapshots[idx1];
-                
-                for (size_t j = i + 1; j < vehicleIndices.size(); ++j) {
-                    size_t idx2 = vehicleIndices[j];
-                    if (idx2 >= snapshots.size()) continue;
-                    const auto& v2 = snapshots[idx2];
-                    
-                    comparisons++;
-                    
-                    // Calcul rapide de distance (approximation euclidienne)
-                    double dLat = (v2.lat - v1.lat) * 111000.0;
-                    double dLon = (v2.lon - v1.lon) * 111000.0 * std::cos(v1.lat * M_PI / 180.0);
-                    double distance = std::sqrt(dLat * dLat + dLon * dLon);
-                    
-                    if (distance <= v1.transmissionRange && distance <= v2.transmissionRange) {
-                        m_adjacencyList[v1.id].insert(v2.id);
-                        m_adjacencyList[v2.id].insert(v1.id);
-                    }
-                }
+            for (size_t i = 0; i < own.size(); ++i) {
+                count += static_cast<int64_t>(own.size() - i - 1);
+                DistanceKernel::forEachInRange(ownPos.x[i], ownPos.y[i], ownPos.range[i],
+                                               ownPos, i + 1, own.size(), [&](size_t j) {
+                    edges.emplace_back(own[i], own[j]);
+                });
             }
             
             // 2. Comparer avec les véhicules des antennes voisines
-            auto neighborIt = antennaInfo->neighborAntennas.find(antennaId);
-            if (neighborIt != antennaInfo->neighborAntennas.end()) {
-                for (int neighborAntennaId : neighborIt->second) {
-                    // Ne comparer que si notre ID est plus petit (éviter doublons)
-                    if (neighborAntennaId <= antennaId) continue;
-                    
-                    auto neighborVehiclesIt = antennaInfo->vehiclesPerAntenna.find(neighborAntennaId);
-                    if (neighborVehiclesIt == antennaInfo->vehiclesPerAntenna.end()) continue;
-                    
-                    for (size_t idx1 : vehicleIndices) {
-                        if (idx1 >= snapshots.size()) continue;
-                        const auto& v1 = snapshots[idx1];
-                        
-                        for (size_t idx2 : neighborVehiclesIt->second) {
-                            if (idx2 >= snapshots.size()) continue;
-                            const auto& v2 = snapshots[idx2];
-                            
-                            comparisons++;
-                            
-                            double dLat = (v2.lat - v1.lat) * 111000.0;
-                            double dLon = (v2.lon - v1.lon) * 111000.0 * std::cos(v1.lat * M_PI / 180.0);
-                            double distance = std::sqrt(dLat * dLat + dLon * dLon);
-                            
-                            if (distance <= v1.transmissionRange && distance <= v2.transmissionRange) {
-                                m_adjacencyList[v1.id].insert(v2.id);
-                                m_adjacencyList[v2.id].insert(v1.id);
-                            }
-                        }
-                    }
-                }
-            }
-        }
-    } else {
-        // Fallback: O(n²) classique si pas d'infos d'antennes
-        for (size_t i = 0; i < snapshots.size(); ++i) {
-            const auto& v1 = snapshots[i];
+            auto neighborIt = antennaInfo.neighborAntennas.find(antennaId);
+            if (neighborIt == antennaInfo.neighborAntennas.end()) continue;
 
-            for (size_t j = i + 1; j < snapshots.size(); ++j) {
-                const auto& v2 = snapshots[j];
-                comparisons++;
+            for (int neighborAntennaId : neighborIt->second) {
+                // Ne comparer que si notre ID est plus petit (éviter doublons)
+                if (neighborAntennaId <= antennaId) continue;
                 
-                double dLat = (v2.lat - v1.lat) * 111000.0;
-                double dLon = (v2.lon - v1.lon) * 111000.0 * std::cos(v1.lat * M_PI / 180.0);
-                double distance = std::sqrt(dLat * dLat + dLon * dLon);
+                auto neighborVehiclesIt = antennaInfo.vehiclesPerAntenna.find(neighborAntennaId);
+                if (neighborVehiclesIt == antennaInfo.vehiclesPerAntenna.end()) continue;
 
-                if (distance <= v1.transmissionRange && distance <= v2.transmissionRange) {
-                    m_adjacencyList[v1.id].insert(v2.id);
-                    m_adjacencyList[v2.id].insert(v1.id);
+                validIndices(neighborVehiclesIt->second, other);
+                otherPos.gather(projected, other);
+                
+                for (size_t i = 0; i < own.size(); ++i) {
+                    count += static_cast<int64_t>(other.size());
+                    DistanceKernel::forEachInRange(ownPos.x[i], ownPos.y[i], ownPos.range[i],
+                                                   otherPos, 0, other.size(), [&](size_t j) {
+                        edges.emplace_back(own[i], other[j]);
+                    });
                 }
             }
         }
+    });
+
+    buildAdjacency(buffers);
+    return std::accumulate(comparisons.begin(), comparisons.end(), int64_t{0});
+}
+
+int64_t InterferenceGraph::buildDirectEdgesUniformGrid(const std::vector<VehicleSnapshot>& snapshots,
+                                                    const ProjectedPositions& projected) {
+    const size_t n = snapshots.size();
+
+    // Emprise des positions et portée maximale
+    double maxRange = 0.0;
+    double minLat = snapshots[0].lat, maxLat = snapshots[0].lat;
+    double minLon = snapshots[0].lon, maxLon = snapshots[0].lon;
+    for (const auto& snap : snapshots) {
+        maxRange = std::max(maxRange, snap.transmissionRange);
+        minLat = std::min(minLat, snap.lat);
+        maxLat = std::max(maxLat, snap.lat);
+        minLon = std::min(minLon, snap.lon);
+        maxLon = std::max(maxLon, snap.lon);
+    }
+    if (maxRange <= 0.0) {
+        return 0;
     }
 
-    // Calculer la fermeture transitive si activé
-    if (m_computeTransitive) {
-        computeTransitiveClosure();
+    // Projection en mètres. On prend le plus petit cos(lat) de la zone : les distances
+    // projetées sont alors toujours <= à celles de projectSnapshots, donc deux véhicules
+    // à portée sont forcément dans des cellules adjacentes.
+    const double cosRef = std::min(std::cos(minLat * M_PI / 180.0), std::cos(maxLat * M_PI / 180.0));
+    const double metersPerDegLon = METERS_PER_DEG * cosRef;
+    const double widthMeters = (maxLon - minLon) * metersPerDegLon;
+    const double heightMeters = (maxLat - minLat) * METERS_PER_DEG;
+
+    // Cellule = portée max. Si la zone est immense par rapport à la flotte,
+    // on agrandit les cellules pour garder un nombre de cellules en O(n)
+    const size_t maxCells = std::max<size_t>(4 * n, 4096);
+    double cellSize = maxRange;
+    size_t cols = 0, rows = 0;
+    while (true) {
+        cols = static_cast<size_t>(widthMeters / cellSize) + 1;
+        rows = static_cast<size_t>(heightMeters / cellSize) + 1;
+        if (cols * rows <= maxCells) break;
+        cellSize *= 2.0;
+    }
+    const size_t numCells = cols * rows;
+
+    // Counting sort des véhicules par cellule
+    std::vector<int> cellOf(n);
+    std::vector<int> cellStart(numCells + 1, 0);
+    for (size_t i = 0; i < n; ++i) {
+        size_t cx = std::min(cols - 1, static_cast<size_t>((snapshots[i].lon - minLon) * metersPerDegLon / cellSize));
+        size_t cy = std::min(rows - 1, static_cast<size_t>((snapshots[i].lat - minLat) * METERS_PER_DEG / cellSize));
+        cellOf[i] = static_cast<int>(cy * cols + cx);
+        cellStart[cellOf[i] + 1]++;
+    }
+    for (size_t c = 0; c < numCells; ++c) {
+        cellStart[c + 1] += cellStart[c];
+    }
+    std::vector<int> sorted(n);
+    std::vector<int> fillPos(cellStart.begin(), cellStart.end() - 1);
+    for (size_t i = 0; i < n; ++i) {
+        sorted[fillPos[cellOf[i]]++] = static_cast<int>(i);
     }
 
-    m_lastComparisons = comparisons;
-    m_lastAvgNeighbors = snapshots.size() > 0 ? static_cast<double>(comparisons * 2) / snapshots.size() : 0.0;
+    // Positions projetées dans l'ordre du tri: le contenu d'une cellule est contigu
+    ProjectedPositions sortedPos;
+    sortedPos.gather(projected, sorted);
 
-    auto endTime = std::chrono::high_resolution_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
-    m_lastBuildTimeMs = duration.count() / 1000.0;
+    // Liste des cellules non vides (dans l'ordre du tri): une cellule = une unité de travail
+    std::vector<int> occupiedCells;
+    for (size_t k = 0; k < n; k = cellStart[cellOf[sorted[k]] + 1]) {
+        occupiedCells.push_back(cellOf[sorted[k]]);
+    }
+
+    const int threads = resolveThreadCount(m_buildThreadCount);
+    std::vector<EdgeList> buffers(threads);
+    std::vector<int64_t> comparisons(threads, 0);
+
+    // Demi-voisinage (E, NO, N, NE) : chaque paire de cellules n'est visitée qu'une fois
+    static const int halfNeighborhood[4][2] = {{1, 0}, {-1, 1}, {0, 1}, {1, 1}};
+
+    parallelFor(occupiedCells.size(), threads, 16, [&](size_t first, size_t last, int worker) {
+        // Véhicule a (rang dans le tri) contre les rangs [candBegin, candEnd)
+        auto testRange = [&](int a, int candBegin, int candEnd) {
+            if (candBegin >= candEnd) return;
+            comparisons[worker] += candEnd - candBegin;
+            DistanceKernel::forEachInRange(sortedPos.x[a], sortedPos.y[a], sortedPos.range[a],
+                                           sortedPos, candBegin, candEnd, [&](size_t b) {
+                buffers[worker].emplace_back(sorted[a], sorted[b]);
+            });
+        };
+
+        for (size_t c = first; c < last; ++c) {
+            const int cell = occupiedCells[c];
+            const int begin = cellStart[cell];
+            const int end = cellStart[cell + 1];
+            const long cx = cell % static_cast<long>(cols);
+            const long cy = cell / static_cast<long>(cols);
+
+            // 1. Véhicules de la même cellule
+            for (int a = begin; a < end; ++a) {
+                testRange(a, a + 1, end);
+            }
+
+            // 2. Cellules voisines du bloc 3×3
+            for (const auto& offset : halfNeighborhood) {
+                const long nx = cx + offset[0];
+                const long ny = cy + offset[1];
+                if (nx < 0 || ny < 0 || nx >= static_cast<long>(cols) || ny >= static_cast<long>(rows)) continue;
+
+                const size_t neighborCell = ny * cols + nx;
+                for (int a = begin; a < end; ++a) {
+                    testRange(a, cellStart[neighborCell], cellStart[neighborCell + 1]);
+                }
+            }
+        }
+    });
+
+    buildAdjacency(buffers);
+    return std::accumulate(comparisons.begin(), comparisons.end(), int64_t{0});
 }
 
 void InterferenceGraph::buildGraphClassic(const std::vector<Vehicule*>& vehicles) {
     // Méthode O(n²): comparer toutes les paires
-    int comparisons = 0;
+    int64_t comparisons = 0;
+    std::vector<EdgeList> buffers(1);
     
     for (size_t i = 0; i < vehicles.size(); ++i) {
         Vehicule* v1 = vehicles[i];
         if (!v1) continue;
+        const int idx1 = m_idToIndex.at(v1->getId());
 
         for (size_t j = i + 1; j < vehicles.size(); ++j) {
             Vehicule* v2 = vehicles[j];
@@ -236,11 +655,12 @@ void InterferenceGraph::buildGraphClassic(const std::vector<Vehicule*>& vehicles
             bool v2CanReachV1 = distance <= v2->getTransmissionRange();
 
             if (v1CanReachV2 && v2CanReachV1) {
-                m_adjacencyList[v1->getId()].insert(v2->getId());
-                m_adjacencyList[v2->getId()].insert(v1->getId());
+                buffers[0].emplace_back(idx1, m_idToIndex.at(v2->getId()));
             }
         }
     }
+
+    buildAdjacency(buffers);
     
     // Stocker les statistiques (méthode classique)
     m_lastComparisons = comparisons;
@@ -249,11 +669,13 @@ void InterferenceGraph::buildGraphClassic(const std::vector<Vehicule*>& vehicles
 
 void InterferenceGraph::buildGraphWithSpatialGrid(const std::vector<Vehicule*>& vehicles) {
     // Méthode optimisée O(n × k): comparer uniquement avec les voisins spatiaux
-    int totalComparisons = 0;
-    int totalNearby = 0;
+    int64_t totalComparisons = 0;
+    int64_t totalNearby = 0;
+    std::vector<EdgeList> buffers(1);
     
     for (auto* v1 : vehicles) {
         if (!v1) continue;
+        const int idx1 = m_idToIndex.at(v1->getId());
 
         // Obtenir les véhicules proches via la grille spatiale
         std::vector<int> nearbyIds = m_spatialGrid.getNearbyVehicles(v1->getId());
@@ -276,115 +698,164 @@ void InterferenceGraph::buildGraphWithSpatialGrid(const std::vector<Vehicule*>&
             bool v2CanReachV1 = distance <= v2->getTransmissionRange();
 
             if (v1CanReachV2 && v2CanReachV1) {
-                m_adjacencyList[v1->getId()].insert(v2->getId());
-                m_adjacencyList[v2->getId()].insert(v1->getId());
+                buffers[0].emplace_back(idx1, m_idToIndex.at(v2->getId()));
             }
         }
     }
+
+    buildAdjacency(buffers);
     
     // Stocker les statistiques
     m_lastComparisons = totalComparisons;
     m_lastAvgNeighbors = vehicles.size() > 0 ? static_cast<double>(totalNearby) / vehicles.size() : 0.0;
-    
-    std::cout << "[buildGraphWithSpatialGrid] " << totalComparisons << " comparaisons de distance effectuées"
-              << " (moyenne " << (totalNearby / vehicles.size()) << " voisins par véhicule)" << std::endl;
 }
 
-void InterferenceGraph::computeTransitiveClosure() {
-    // Pour chaque véhicule, calculer tous les véhicules accessibles
-    // en utilisant un parcours en largeur (BFS)
-    
-    m_transitiveClosure.clear();
-    
-    for (const auto& [vehicleId, neighbors] : m_adjacencyList) {
-        m_transitiveClosure[vehicleId] = bfsReachable(vehicleId);
+void InterferenceGraph::computeComponentsTimed() {
+    const int64_t startNs = Profiler::nowNs();
+    computeComponents();
+    const int64_t durationNs = Profiler::nowNs() - startNs;
+    m_lastComponentsTimeMs = durationNs / 1e6;
+    if (Profiler::isEnabled()) {
+        Profiler::record(Profiler::Stage::Components, startNs, durationNs);
     }
 }
 
-std::unordered_set<int> InterferenceGraph::bfsReachable(int startId) const {
-    std::unordered_set<int> visited;
-    std::queue<int> toVisit;
-    
-    toVisit.push(startId);
-    visited.insert(startId);
-    
-    while (!toVisit.empty()) {
-        int currentId = toVisit.front();
-        toVisit.pop();
-        
-        // Vérifier si ce véhicule existe dans le graphe
-        auto it = m_adjacencyList.find(currentId);
-        if (it == m_adjacencyList.end()) {
-            continue;
-        }
-        
-        // Explorer tous les voisins directs
-        for (int neighborId : it->second) {
-            // Si on n'a pas encore visité ce voisin
-            if (visited.find(neighborId) == visited.end()) {
-                visited.insert(neighborId);
-                toVisit.push(neighborId);
+void InterferenceGraph::computeComponents() {
+    const int n = static_cast<int>(m_vehicleIds.size());
+
+    // Union-find sur les arêtes (chaque arête est vue une fois: j > i)
+    UnionFind uf(n);
+    if (!m_offsets.empty()) {
+        for (int i = 0; i < n; ++i) {
+            for (int k = m_offsets[i]; k < m_offsets[i + 1]; ++k) {
+                if (m_neighbors[k] > i) {
+                    uf.unite(i, m_neighbors[k]);
+                }
             }
         }
     }
-    
-    // Retirer le nœud de départ de l'ensemble des accessibles
-    visited.erase(startId);
-    
-    return visited;
+
+    // Étiquetage à plat et chaînage circulaire des membres de chaque composante
+    m_componentOf.resize(n);
+    m_componentSize.assign(n, 0);
+    m_nextInComponent.resize(n);
+    m_componentCount = 0;
+    for (int i = 0; i < n; ++i) {
+        const int root = uf.find(i);
+        m_componentOf[i] = root;
+        m_componentSize[root]++;
+        if (root == i) {
+            m_nextInComponent[i] = i;
+            m_componentCount++;
+        }
+    }
+    for (int i = 0; i < n; ++i) {
+        const int root = m_componentOf[i];
+        if (root != i) {
+            m_nextInComponent[i] = m_nextInComponent[root];
+            m_nextInComponent[root] = i;
+        }
+    }
+}
+
+bool InterferenceGraph::connectVehicles(int id1, int id2) {
+    auto it1 = m_idToIndex.find(id1);
+    auto it2 = m_idToIndex.find(id2);
+    if (it1 == m_idToIndex.end() || it2 == m_idToIndex.end() || m_componentOf.empty()) {
+        return false;
+    }
+
+    int root1 = m_componentOf[it1->second];
+    int root2 = m_componentOf[it2->second];
+    if (root1 == root2) {
+        return false;
+    }
+
+    // Réétiqueter la plus petite composante (union par taille)
+    if (m_componentSize[root1] < m_componentSize[root2]) {
+        std::swap(root1, root2);
+    }
+    int idx = root2;
+    do {
+        m_componentOf[idx] = root1;
+        idx = m_nextInComponent[idx];
+    } while (idx != root2);
+
+    // Concaténer les deux listes circulaires
+    std::swap(m_nextInComponent[root1], m_nextInComponent[root2]);
+    m_componentSize[root1] += m_componentSize[root2];
+    m_componentSize[root2] = 0;
+    m_componentCount--;
+    return true;
 }
 
 bool InterferenceGraph::canCommunicate(int id1, int id2) const {
-    // Vérifier si id2 est dans l'ensemble des véhicules accessibles depuis id1
-    auto it = m_transitiveClosure.find(id1);
-    if (it == m_transitiveClosure.end()) {
+    // Deux véhicules communiquent s'ils sont dans la même composante connexe
+    if (id1 == id2) {
         return false;
     }
-    
-    return it->second.find(id2) != it->second.end();
+    int component1 = getComponentId(id1);
+    return component1 >= 0 && component1 == getComponentId(id2);
+}
+
+int InterferenceGraph::getComponentId(int vehicleId) const {
+    auto it = m_idToIndex.find(vehicleId);
+    if (it == m_idToIndex.end() || m_componentOf.empty()) {
+        return -1;
+    }
+    return m_componentOf[it->second];
+}
+
+int InterferenceGraph::getComponentSize(int vehicleId) const {
+    int component = getComponentId(vehicleId);
+    return component >= 0 ? m_componentSize[component] : 0;
 }
 
-std::unordered_set<int> InterferenceGraph::getReachableVehicles(int vehicleId) const {
-    auto it = m_transitiveClosure.find(vehicleId);
-    if (it != m_transitiveClosure.end()) {
-        return it->second;
+ReachableRange InterferenceGraph::getReachableVehicles(int vehicleId) const {
+    int component = getComponentId(vehicleId);
+    if (component < 0) {
+        return ReachableRange();
     }
-    return std::unordered_set<int>();
+    return ReachableRange(m_idToIndex.at(vehicleId), m_componentSize[component], m_nextInComponent.data(),
+                          m_vehicleIds.data(), m_componentOf.data(), &m_idToIndex);
 }
 
-std::unordered_set<int> InterferenceGraph::getDirectNeighbors(int vehicleId) const {
-    auto it = m_adjacencyList.find(vehicleId);
-    if (it != m_adjacencyList.end()) {
-        return it->second;
+NeighborRange InterferenceGraph::getDirectNeighbors(int vehicleId) const {
+    auto it = m_idToIndex.find(vehicleId);
+    if (it == m_idToIndex.end() || m_offsets.empty()) {
+        return NeighborRange();
     }
-    return std::unordered_set<int>();
+    const int* base = m_neighbors.data();
+    return NeighborRange(base + m_offsets[it->second], base + m_offsets[it->second + 1],
+                         m_vehicleIds.data(), &m_idToIndex);
 }
 
 void InterferenceGraph::printStats() const {
     std::cout << "\n=== Statistiques du Graphe d'Interférence ===" << std::endl;
-    std::cout << "Nombre de véhicules: " << m_adjacencyList.size() << std::endl;
+    std::cout << "Nombre de véhicules: " << m_vehicleIds.size() << std::endl;
     
-    int totalDirectConnections = 0;
-    int totalTransitiveConnections = 0;
+    int totalDirectConnections = static_cast<int>(m_neighbors.size());
+    long long totalTransitiveConnections = 0;
     
-    for (const auto& [id, neighbors] : m_adjacencyList) {
-        totalDirectConnections += neighbors.size();
-    }
-    
-    for (const auto& [id, reachable] : m_transitiveClosure) {
-        totalTransitiveConnections += reachable.size();
+    for (int i = 0; i < static_cast<int>(m_componentOf.size()); ++i) {
+        if (m_componentOf[i] == i) {
+            long long size = m_componentSize[i];
+            totalTransitiveConnections += size * (size - 1);
+        }
     }
     
     // Diviser par 2 car chaque connexion directe est comptée deux fois (bidirectionnelle)
     std::cout << "Connexions directes: " << totalDirectConnections / 2 << std::endl;
     std::cout << "Connexions totales (avec transitivité): " << totalTransitiveConnections / 2 << std::endl;
+    std::cout << "Composantes connexes: " << m_componentCount << std::endl;
     
     // Afficher quelques exemples de véhicules avec leurs connexions
     int count = 0;
-    for (const auto& [id, reachable] : m_transitiveClosure) {
+    for (int id : m_vehicleIds) {
         if (count++ >= 5) break; // Afficher seulement les 5 premiers
         
         auto directNeighbors = getDirectNeighbors(id);
+        auto reachable = getReachableVehicles(id);
         std::cout << "Véhicule " << id << ": " 
                   << directNeighbors.size() << " voisins directs, "
                   << reachable.size() << " véhicules accessibles" << std::endl;
@@ -465,6 +936,11 @@ void InterferenceGraph::reinitializeSpatialGrid(const std::vector<Vehicule*>& ve
               << numMicro << " micro antennes par macro (portée max: " << maxRange << "m)" << std::endl;
 }
 
+void InterferenceGraph::adoptSpatialGrid(SpatialGrid&& grid) {
+    m_spatialGrid = std::move(grid);
+    m_gridInitialized = true;
+}
+
 void InterferenceGraph::updateTransmissionRange(double range) {
     if (!m_gridInitialized) {
         return;  // La grille n'est pas encore initialisée
@@ -489,4 +965,15 @@ void InterferenceGraph::removeVehicleFromAntenna(int vehicleId) {
         return;
     }
     m_spatialGrid.removeVehicleFromAntenna(vehicleId);
-}
\ No newline at end of file
+}
+
+int InterferenceGraph::updateAntennaAssignments(const std::vector<int>& ids, const std::vector<double>& lats,
+                                                const std::vector<double>& lons) {
+    if (!m_gridInitialized) {
+        return 0;
+    }
+    Profiler::ScopedTimer timer(Profiler::Stage::Handoff);
+    const int handoffs = m_spatialGrid.updateAssignments(ids, lats, lons);
+    Profiler::add(Profiler::Counter::Handoffs, handoffs);
+    return handoffs;
+}
@@ -1,7 +1,31 @@
 #include "interference_graph_test.h"
 #include "graph_builder.h"
+#include "parallel_for.h"
+#include "road_graph_cache.h"
+#include "route_planner.h"
+#include "road_vertex_index.h"
+#include "spatial_grid.h"
+#include "distance_kernel.h"
+#include "vehicle_store.h"
+#include "profiler.h"
+#include "verlet_neighbor_list.h"
+#include "sim_recording.h"
+#include "message_engine.h"
+#include "vehicle_pool.h"
+#include "density_grid.h"
+#include "geo_partition.h"
+#include "shard_protocol.h"
+#include <cstdio>
+#include <fstream>
 #include <iostream>
+#include <algorithm>
 #include <iomanip>
+#include <iterator>
+#include <limits>
+#include <queue>
+#include <random>
+#include <set>
+#include <unordered_set>
 
 using namespace std;
 
@@ -92,6 +116,56 @@ void InterferenceGraphTest::cleanupVehicles(vector<Vehicule*>& vehicles) {
     vehicles.clear();
 }
 
+vector<VehicleSnapshot> InterferenceGraphTest::createRandomSnapshots(int count, double spanDeg, unsigned seed) const {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> offset(0.0, spanDeg);
+    std::uniform_real_distribution<double> range(100.0, 500.0);
+    
+    vector<VehicleSnapshot> snapshots;
+    snapshots.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        snapshots.push_back({i, 7.70 + offset(rng), 48.55 + offset(rng), range(rng), -1});
+    }
+    return snapshots;
+}
+
+RoadGraph InterferenceGraphTest::createRoadGrid(int side) const {
+    RoadGraph roads;
+    for (int y = 0; y < side; ++y) {
+        for (int x = 0; x < side; ++x) {
+            Vertex v = boost::add_vertex(roads);
+            roads[v].id = y * side + x;
+            roads[v].lat = 48.55 + y * 0.001;
+            roads[v].lon = 7.70 + x * 0.0015;
+        }
+    }
+    auto addRoad = [&](int a, int b) {
+        double d = GraphBuilder::distance(roads[a].lat, roads[a].lon, roads[b].lat, roads[b].lon);
+        boost::add_edge(a, b, EdgeData{d, false, RoadClass::Primary}, roads);
+    };
+    for (int y = 0; y < side; ++y) {
+        for (int x = 0; x < side; ++x) {
+            if (x + 1 < side) addRoad(y * side + x, y * side + x + 1);
+            if (y + 1 < side) addRoad(y * side + x, (y + 1) * side + x);
+        }
+    }
+    GraphBuilder::finalizeGraph(roads);
+    return roads;
+}
+
+bool InterferenceGraphTest::sameDirectNeighbors(const InterferenceGraph& a, const InterferenceGraph& b,
+                                                const vector<VehicleSnapshot>& snapshots) const {
+    for (const auto& snap : snapshots) {
+        auto na = a.getDirectNeighbors(snap.id);
+        auto nb = b.getDirectNeighbors(snap.id);
+        if (na.size() != nb.size()) return false;
+        for (int id : na) {
+            if (nb.find(id) == nb.end()) return false;
+        }
+    }
+    return true;
+}
+
 bool InterferenceGraphTest::testEmptyGraph() {
     printTestHeader("Graphe vide");
     
@@ -431,6 +505,669 @@ bool InterferenceGraphTest::testStarTopology() {
     return passed;
 }
 
+bool InterferenceGraphTest::testUniformGridMatchesBruteForce() {
+    printTestHeader("Grille uniforme = force brute");
+    
+    // ~5 km de côté, portées hétérogènes entre 100 et 500 m
+    vector<VehicleSnapshot> snapshots = createRandomSnapshots(800, 0.05, 42);
+    
+    InterferenceGraph bruteForce;
+    bruteForce.buildGraphFromSnapshots(snapshots);  // Sans antennes: O(n²)
+    
+    InterferenceGraph grid;
+    grid.setBroadphaseMode(BroadphaseMode::UniformGrid);
+    grid.buildGraphFromSnapshots(snapshots);
+    
+    cout << "  → Comparaisons force brute: " << bruteForce.getLastComparisons() << endl;
+    cout << "  → Comparaisons grille: " << grid.getLastComparisons() << endl;
+    
+    bool test1 = checkCondition("Mêmes voisins directs", sameDirectNeighbors(bruteForce, grid, snapshots));
+    bool test2 = checkCondition("Moins de comparaisons", grid.getLastComparisons() < bruteForce.getLastComparisons());
+    
+    // ID dupliqué en tête: ignoré, les lignes suivantes restent alignées
+    vector<VehicleSnapshot> duplicated = snapshots;
+    duplicated.insert(duplicated.begin() + 5, snapshots[400]);
+    InterferenceGraph dedupBrute;
+    dedupBrute.buildGraphFromSnapshots(duplicated);
+    InterferenceGraph dedupGrid;
+    dedupGrid.setBroadphaseMode(BroadphaseMode::UniformGrid);
+    dedupGrid.buildGraphFromSnapshots(duplicated);
+    bool test3 = checkCondition("ID dupliqué ignoré, mêmes voisins",
+                                sameDirectNeighbors(bruteForce, dedupBrute, snapshots) &&
+                                sameDirectNeighbors(bruteForce, dedupGrid, snapshots));
+    
+    bool passed = test1 && test2 && test3;
+    printTestResult("Grille uniforme", passed);
+    return passed;
+}
+
+bool InterferenceGraphTest::testParallelBuildMatchesSerial() {
+    printTestHeader("Construction parallèle = séquentielle");
+    
+    vector<VehicleSnapshot> snapshots = createRandomSnapshots(1500, 0.05, 7);
+    
+    // Antennes fictives: cellules de 0.005° voisines des 8 cellules adjacentes
+    AntennaNeighborhood antennaInfo;
+    const int cellsPerRow = 11;
+    for (size_t i = 0; i < snapshots.size(); ++i) {
+        int cx = static_cast<int>((snapshots[i].lon - 7.70) / 0.005);
+        int cy = static_cast<int>((snapshots[i].lat - 48.55) / 0.005);
+        antennaInfo.vehiclesPerAntenna[cy * cellsPerRow + cx].push_back(i);
+    }
+    for (int cy = 0; cy < cellsPerRow; ++cy) {
+        for (int cx = 0; cx < cellsPerRow; ++cx) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    int nx = cx + dx, ny = cy + dy;
+                    if ((dx || dy) && nx >= 0 && ny >= 0 && nx < cellsPerRow && ny < cellsPerRow) {
+                        antennaInfo.neighborAntennas[cy * cellsPerRow + cx].push_back(ny * cellsPerRow + nx);
+                    }
+                }
+            }
+        }
+    }
+    
+    bool allSame = true;
+    const BroadphaseMode modes[] = {BroadphaseMode::Antennas, BroadphaseMode::UniformGrid};
+    for (BroadphaseMode mode : modes) {
+        for (const AntennaNeighborhood* info : {static_cast<const AntennaNeighborhood*>(nullptr),
+                                                static_cast<const AntennaNeighborhood*>(&antennaInfo)}) {
+            InterferenceGraph serial;
+            serial.setBroadphaseMode(mode);
+            serial.buildGraphFromSnapshots(snapshots, info);
+            
+            InterferenceGraph parallel;
+            parallel.setBroadphaseMode(mode);
+            parallel.setBuildThreadCount(4);
+            parallel.buildGraphFromSnapshots(snapshots, info);
+            
+            bool same = sameDirectNeighbors(serial, parallel, snapshots)
+                        && serial.getLastComparisons() == parallel.getLastComparisons();
+            allSame = allSame && same;
+        }
+    }
+    
+    bool test1 = checkCondition("Mêmes voisins et comparaisons (antennes, grille, force brute)", allSame);
+    
+    bool passed = test1;
+    printTestResult("Construction parallèle", passed);
+    return passed;
+}
+
+bool InterferenceGraphTest::testComponentsMatchBfs() {
+    printTestHeader("Composantes connexes = BFS");
+    
+    vector<VehicleSnapshot> snapshots = createRandomSnapshots(600, 0.05, 11);
+    
+    InterferenceGraph graph;
+    graph.buildGraphFromSnapshots(snapshots);
+    
+    // Référence: BFS sur les voisins directs depuis chaque véhicule
+    bool sameReachable = true;
+    for (const auto& snap : snapshots) {
+        unordered_set<int> visited = {snap.id};
+        vector<int> toVisit = {snap.id};
+        while (!toVisit.empty()) {
+            int current = toVisit.back();
+            toVisit.pop_back();
+            for (int neighborId : graph.getDirectNeighbors(current)) {
+                if (visited.insert(neighborId).second) {
+                    toVisit.push_back(neighborId);
+                }
+            }
+        }
+        visited.erase(snap.id);
+        
+        auto reachable = graph.getReachableVehicles(snap.id);
+        size_t iterated = 0;
+        for (int id : reachable) {
+            iterated++;
+            if (!visited.count(id)) sameReachable = false;
+        }
+        if (iterated != visited.size() || reachable.size() != visited.size()) {
+            sameReachable = false;
+        }
+    }
+    cout << "  → Composantes: " << graph.getComponentCount() << endl;
+    
+    // Fusion incrémentale de deux composantes distinctes
+    int idA = snapshots.front().id;
+    int idB = -1;
+    for (const auto& snap : snapshots) {
+        if (!graph.canCommunicate(idA, snap.id) && snap.id != idA) {
+            idB = snap.id;
+            break;
+        }
+    }
+    int expectedSize = graph.getComponentSize(idA) + graph.getComponentSize(idB);
+    int expectedCount = graph.getComponentCount() - 1;
+    bool merged = idB >= 0 && graph.connectVehicles(idA, idB);
+    
+    bool test1 = checkCondition("Véhicules accessibles identiques au BFS", sameReachable);
+    bool test2 = checkCondition("Fusion incrémentale effectuée", merged);
+    bool test3 = checkCondition("A et B communiquent après fusion", idB >= 0 && graph.canCommunicate(idA, idB));
+    bool test4 = checkCondition("Taille et nombre de composantes à jour",
+                                graph.getComponentSize(idA) == expectedSize &&
+                                graph.getReachableVehicles(idB).size() == static_cast<size_t>(expectedSize - 1) &&
+                                graph.getComponentCount() == expectedCount);
+    
+    bool passed = test1 && test2 && test3 && test4;
+    printTestResult("Composantes connexes", passed);
+    return passed;
+}
+
+bool InterferenceGraphTest::testParallelVehicleUpdate() {
+    printTestHeader("Mise à jour parallèle des véhicules");
+    
+    // Réseau routier en grille 12×12 (~110 m entre intersections)
+    RoadGraph roads;
+    const int side = 12;
+    for (int y = 0; y < side; ++y) {
+        for (int x = 0; x < side; ++x) {
+            Vertex v = boost::add_vertex(roads);
+            roads[v].id = y * side + x;
+            roads[v].lat = 48.55 + y * 0.001;
+            roads[v].lon = 7.70 + x * 0.0015;
+        }
+    }
+    auto addRoad = [&](int a, int b) {
+        double d = GraphBuilder::distance(roads[a].lat, roads[a].lon, roads[b].lat, roads[b].lon);
+        boost::add_edge(a, b, EdgeData{d, false, RoadClass::Primary}, roads);
+    };
+    for (int y = 0; y < side; ++y) {
+        for (int x = 0; x < side; ++x) {
+            if (x + 1 < side) addRoad(y * side + x, y * side + x + 1);
+            if (y + 1 < side) addRoad(y * side + x, (y + 1) * side + x);
+        }
+    }
+    GraphBuilder::finalizeGraph(roads);
+    
+    // Deux flottes identiques (même graine), mises à jour en séquentiel et sur 4 threads
+    const int numVehicles = 300;
+    const int numVertices = side * side;
+    vector<Vehicule*> serial, parallel;
+    for (int i = 0; i < numVehicles; ++i) {
+        Vertex start = (i * 7) % numVertices;
+        Vertex goal = (i * 13 + 5) % numVertices;
+        serial.push_back(new Vehicule(i, roads, start, goal, 14.0, 500.0, 5.0));
+        parallel.push_back(new Vehicule(i, roads, start, goal, 14.0, 500.0, 5.0));
+        serial.back()->seedRandom(1234);
+        parallel.back()->seedRandom(1234);
+    }
+    
+    for (int step = 0; step < 400; ++step) {
+        for (auto* v : serial) v->update(0.5);
+        parallelFor(parallel.size(), 4, 16, [&](size_t begin, size_t end, int) {
+            for (size_t i = begin; i < end; ++i) parallel[i]->update(0.5);
+        });
+    }
+    
+    bool samePositions = true;
+    bool moved = false;
+    for (int i = 0; i < numVehicles; ++i) {
+        auto [lat1, lon1] = serial[i]->getPosition();
+        auto [lat2, lon2] = parallel[i]->getPosition();
+        if (lat1 != lat2 || lon1 != lon2) samePositions = false;
+        Vertex start = (i * 7) % numVertices;
+        if (lat1 != roads[start].lat || lon1 != roads[start].lon) moved = true;
+    }
+    
+    bool test1 = checkCondition("Les véhicules se déplacent", moved);
+    bool test2 = checkCondition("Positions identiques (séquentiel / parallèle)", samePositions);
+    
+    cleanupVehicles(serial);
+    cleanupVehicles(parallel);
+    
+    bool passed = test1 && test2;
+    printTestResult("Mise à jour parallèle", passed);
+    return passed;
+}
+
+bool InterferenceGraphTest::testDrivableSegments() {
+    printTestHeader("Tronçons praticables (tracé des routes)");
+    
+    // Route double sens 0-1-2-3-4, bretelle 2-5, sens unique 5→6→4, trottoir 4-7
+    RoadGraph roads;
+    const double coords[8][2] = {
+        {48.5700, 7.7500}, {48.5710, 7.7500}, {48.5720, 7.7500}, {48.5730, 7.7500},
+        {48.5740, 7.7500}, {48.5720, 7.7520}, {48.5730, 7.7520}, {48.5750, 7.7500}
+    };
+    for (int i = 0; i < 8; ++i) {
+        Vertex v = boost::add_vertex(roads);
+        roads[v].id = i;
+        roads[v].lat = coords[i][0];
+        roads[v].lon = coords[i][1];
+    }
+    auto dist = [&](int a, int b) {
+        return GraphBuilder::distance(roads[a].lat, roads[a].lon, roads[b].lat, roads[b].lon);
+    };
+    // Comme GraphBuilder: deux arêtes pour une route double sens, une seule sinon
+    auto addRoad = [&](int a, int b, bool oneway, RoadClass roadClass) {
+        boost::add_edge(a, b, EdgeData{dist(a, b), oneway, roadClass}, roads);
+        if (!oneway) boost::add_edge(b, a, EdgeData{dist(a, b), oneway, roadClass}, roads);
+    };
+    addRoad(0, 1, false, RoadClass::Tertiary);
+    addRoad(1, 2, false, RoadClass::Tertiary);
+    addRoad(2, 3, false, RoadClass::Tertiary);
+    addRoad(3, 4, false, RoadClass::Tertiary);
+    addRoad(2, 5, false, RoadClass::Tertiary);
+    addRoad(5, 6, true, RoadClass::Tertiary);
+    addRoad(6, 4, true, RoadClass::Tertiary);
+    addRoad(4, 7, false, RoadClass::Footway);
+    GraphBuilder::finalizeGraph(roads);
+    
+    vector<pair<Vertex, Vertex>> segments = GraphBuilder::drivableSegments(roads);
+    const vector<pair<Vertex, Vertex>> expected = {{0, 1}, {1, 2}, {2, 3}, {2, 5}, {3, 4}, {4, 6}, {5, 6}};
+    bool test1 = checkCondition("7 tronçons praticables, trottoir exclu", segments == expected);
+    
+    // Arête parallèle en plus (sens inverse): toujours un seul tronçon
+    boost::add_edge(1, 0, EdgeData{dist(0, 1), false, RoadClass::Tertiary}, roads);
+    GraphBuilder::finalizeGraph(roads);
+    bool test2 = checkCondition("Arête parallèle supplémentaire ignorée",
+                                GraphBuilder::drivableSegments(roads) == expected);
+    
+    bool passed = test1 && test2;
+    printTestResult("Tronçons praticables", passed);
+    return passed;
+}
+
+bool InterferenceGraphTest::testRoadGraphCache() {
+    printTestHeader("Cache binaire du graphe routier");
+    
+    // Petit graphe avec une route double sens (deux arêtes) et un sens unique
+    RoadGraph roads;
+    for (int i = 0; i < 4; ++i) {
+        Vertex v = boost::add_vertex(roads);
+        roads[v].id = 1000 + i;
+        roads[v].lat = 48.57 + i * 0.001;
+        roads[v].lon = 7.75 + (i % 2) * 0.001;
+    }
+    boost::add_edge(0, 1, EdgeData{120.5, false, RoadClass::Primary}, roads);
+    boost::add_edge(1, 0, EdgeData{120.5, false, RoadClass::Primary}, roads);
+    boost::add_edge(1, 2, EdgeData{98.0, true, RoadClass::Residential}, roads);
+    boost::add_edge(3, 2, EdgeData{45.25, false, RoadClass::Footway}, roads);
+    
+    const std::string path = "v2v_test_cache.graph";
+    const uint64_t hash = 0x1234abcdULL;
+    bool test1 = checkCondition("Écriture du cache", RoadGraphCache::save(path, roads, hash));
+    
+    RoadGraph loaded;
+    bool test2 = checkCondition("Relecture avec le même hachage", RoadGraphCache::load(path, hash, loaded));
+    
+    bool same = boost::num_vertices(loaded) == boost::num_vertices(roads) &&
+                boost::num_edges(loaded) == boost::num_edges(roads);
+    for (size_t i = 0; same && i < boost::num_vertices(roads); ++i) {
+        same = loaded[i].id == roads[i].id && loaded[i].lat == roads[i].lat && loaded[i].lon == roads[i].lon;
+    }
+    auto a = boost::edges(roads);
+    auto b = boost::edges(loaded);
+    for (; same && a.first != a.second && b.first != b.second; ++a.first, ++b.first) {
+        const EdgeData& ea = roads[*a.first];
+        const EdgeData& eb = loaded[*b.first];
+        same = boost::source(*a.first, roads) == boost::source(*b.first, loaded) &&
+               boost::target(*a.first, roads) == boost::target(*b.first, loaded) &&
+               ea.distance == eb.distance && ea.oneway == eb.oneway && ea.roadClass == eb.roadClass;
+    }
+    bool test3 = checkCondition("Sommets et arêtes identiques (ordre compris)", same);
+    
+    RoadGraph stale;
+    bool test4 = checkCondition("Cache refusé si le fichier source a changé",
+                                !RoadGraphCache::load(path, hash + 1, stale) && boost::num_vertices(stale) == 0);
+    
+    std::remove(path.c_str());
+    
+    bool passed = test1 && test2 && test3 && test4;
+    printTestResult("Cache du graphe", passed);
+    return passed;
+}
+
+bool InterferenceGraphTest::testRoutePlanner() {
+    printTestHeader("Planification d'itinéraires (A*)");
+    
+    // Grille 8×8; la rangée 3 est à sens unique vers l'est, la colonne 5 est un trottoir
+    RoadGraph roads;
+    const int side = 8;
+    for (int y = 0; y < side; ++y) {
+        for (int x = 0; x < side; ++x) {
+            Vertex v = boost::add_vertex(roads);
+            roads[v].id = y * side + x;
+            roads[v].lat = 48.55 + y * 0.001 + (x % 3) * 0.0001;
+            roads[v].lon = 7.70 + x * 0.0015;
+        }
+    }
+    auto addRoad = [&](int a, int b, bool oneway, RoadClass roadClass) {
+        double d = GraphBuilder::distance(roads[a].lat, roads[a].lon, roads[b].lat, roads[b].lon);
+        boost::add_edge(a, b, EdgeData{d, oneway, roadClass}, roads);
+        if (!oneway) boost::add_edge(b, a, EdgeData{d, oneway, roadClass}, roads);
+    };
+    for (int y = 0; y < side; ++y) {
+        for (int x = 0; x < side; ++x) {
+            int v = y * side + x;
+            if (x + 1 < side) addRoad(v, v + 1, y == 3, RoadClass::Secondary);
+            if (y + 1 < side) addRoad(v, v + side, false, x == 5 ? RoadClass::Footway : RoadClass::Secondary);
+        }
+    }
+    GraphBuilder::finalizeGraph(roads);
+    
+    // Dijkstra de référence avec les mêmes règles de parcours
+    auto referenceDistance = [&](Vertex start, Vertex goal) {
+        vector<double> dist(boost::num_vertices(roads), numeric_limits<double>::infinity());
+        using Entry = pair<double, Vertex>;
+        priority_queue<Entry, vector<Entry>, greater<Entry>> open;
+        dist[start] = 0.0;
+        open.push({0.0, start});
+        while (!open.empty()) {
+            auto [d, u] = open.top();
+            open.pop();
+            if (d > dist[u]) continue;
+            for (auto [it, end] = boost::out_edges(u, roads); it != end; ++it) {
+                if (!RoutePlanner::canTraverse(roads, *it, u)) continue;
+                Vertex v = boost::target(*it, roads);
+                if (d + roads[*it].distance < dist[v]) {
+                    dist[v] = d + roads[*it].distance;
+                    open.push({dist[v], v});
+                }
+            }
+        }
+        return dist[goal];
+    };
+    
+    RoutePlanner planner(roads, 64);
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> pick(0, side * side - 1);
+    vector<pair<Vertex, Vertex>> trips;
+    for (int i = 0; i < 40; ++i) {
+        trips.emplace_back(pick(rng), pick(rng));
+    }
+    
+    bool shortest = true;
+    bool endpoints = true;
+    for (const auto& [start, goal] : trips) {
+        RoutePlanner::Route route = planner.findRoute(start, goal);
+        if (route->empty() || route->front() != start || route->back() != goal) {
+            endpoints = false;
+            continue;
+        }
+        // routeLength vérifie aussi que chaque pas suit une arête autorisée
+        if (std::abs(planner.routeLength(*route) - referenceDistance(start, goal)) > 1e-6) {
+            shortest = false;
+        }
+    }
+    bool test1 = checkCondition("Itinéraires de l'origine au but", endpoints);
+    bool test2 = checkCondition("Longueur = plus court chemin (Dijkstra)", shortest);
+    
+    // Le trajet ouest sur la rangée à sens unique doit la contourner
+    RoutePlanner::Route westbound = planner.findRoute(3 * side + 6, 3 * side + 1);
+    bool avoidsOneway = westbound->size() > 6;
+    bool test3 = checkCondition("Sens unique respecté (détour)", avoidsOneway);
+    
+    size_t hitsBefore = planner.cacheHits();
+    RoutePlanner::Route again = planner.findRoute(trips[0].first, trips[0].second);
+    RoutePlanner::Route first = planner.findRoute(trips[0].first, trips[0].second);
+    bool test4 = checkCondition("Cache LRU (même itinéraire partagé)",
+                                again == first && planner.cacheHits() >= hitsBefore + 2);
+    
+    RoutePlanner batchPlanner(roads, 0);
+    vector<RoutePlanner::Route> batch = batchPlanner.planBatch(trips, 4);
+    bool sameBatch = batch.size() == trips.size();
+    for (size_t i = 0; sameBatch && i < trips.size(); ++i) {
+        sameBatch = *batch[i] == *planner.findRoute(trips[i].first, trips[i].second);
+    }
+    bool test5 = checkCondition("Lot parallèle identique aux requêtes une à une", sameBatch);
+    
+    // Un véhicule guidé atteint son but en suivant l'itinéraire
+    Vertex start = 0, goal = side * side - 1;
+    Vehicule car(0, roads, start, goal, 14.0, 500.0, 5.0);
+    car.setRoutePlanner(&planner);
+    double length = planner.routeLength(*planner.findRoute(start, goal));
+    int maxSteps = static_cast<int>(length / (14.0 * 0.5)) + 2;
+    bool reached = false;
+    for (int step = 0; step < maxSteps && !reached; ++step) {
+        car.update(0.5);
+        reached = car.getCurrentVertex() == goal;
+    }
+    bool test6 = checkCondition("Véhicule arrivé au but par le plus court chemin", reached);
+    
+    bool passed = test1 && test2 && test3 && test4 && test5 && test6;
+    printTestResult("Planification d'itinéraires", passed);
+    return passed;
+}
+
+bool InterferenceGraphTest::testRoadVertexIndex() {
+    printTestHeader("Index spatial des sommets routiers");
+    
+    // Grille 20×20 de routes; la colonne 0 n'a que des trottoirs (non praticable)
+    RoadGraph roads;
+    const int side = 20;
+    for (int y = 0; y < side; ++y) {
+        for (int x = 0; x < side; ++x) {
+            Vertex v = boost::add_vertex(roads);
+            roads[v].id = y * side + x;
+            roads[v].lat = 48.55 + y * 0.0007;
+            roads[v].lon = 7.70 + x * 0.001;
+        }
+    }
+    for (int y = 0; y < side; ++y) {
+        for (int x = 0; x < side; ++x) {
+            int v = y * side + x;
+            RoadClass roadClass = x == 0 ? RoadClass::Footway : RoadClass::Primary;
+            if (x + 1 < side) boost::add_edge(v, v + 1, EdgeData{80.0, false, roadClass}, roads);
+            if (y + 1 < side) boost::add_edge(v, v + side, EdgeData{80.0, false, roadClass}, roads);
+        }
+    }
+    GraphBuilder::finalizeGraph(roads);
+    
+    RoadVertexIndex index(roads);
+    bool test1 = checkCondition("Seuls les sommets praticables indexés", index.size() == side * (side - 1));
+    
+    // Plus proche voisin comparé à un parcours complet (distance au sol)
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<double> latDist(48.549, 48.565);
+    std::uniform_real_distribution<double> lonDist(7.699, 7.721);
+    bool nearestOk = true;
+    for (int i = 0; i < 200; ++i) {
+        double lat = latDist(rng), lon = lonDist(rng);
+        double best = numeric_limits<double>::max();
+        for (Vertex v : index.vertices()) {
+            best = std::min(best, GraphBuilder::distance(lat, lon, roads[v].lat, roads[v].lon));
+        }
+        Vertex found;
+        if (!index.nearest(lon, lat, found) ||
+            GraphBuilder::distance(lat, lon, roads[found].lat, roads[found].lon) > best + 0.5) {
+            nearestOk = false;
+        }
+    }
+    bool test2 = checkCondition("Plus proche sommet = parcours complet", nearestOk);
+    
+    // Zone couvrant les colonnes 0..4 et les rangées 0..9: la colonne 0 est exclue
+    double minLon = 7.70 - 1e-6, maxLon = 7.704 + 1e-6;
+    double minLat = 48.55 - 1e-6, maxLat = 48.55 + 9 * 0.0007 + 1e-6;
+    vector<Vertex> region = index.inRegion(minLon, minLat, maxLon, maxLat);
+    bool regionOk = region.size() == 4 * 10;
+    for (Vertex v : region) {
+        if (roads[v].lon < minLon || roads[v].lon > maxLon || roads[v].lat < minLat || roads[v].lat > maxLat ||
+            roads[v].drivableOutDegree == 0) {
+            regionOk = false;
+        }
+    }
+    bool test3 = checkCondition("Requête par zone (40 sommets)", regionOk);
+    
+    Vertex sample;
+    bool sampleOk = index.randomInRegion(minLon, minLat, maxLon, maxLat, 12345u, sample) &&
+                    std::find(region.begin(), region.end(), sample) != region.end();
+    bool emptyOk = !index.randomInRegion(8.0, 49.0, 8.1, 49.1, 1u, sample);
+    bool test4 = checkCondition("Tirage dans une zone (et zone vide)", sampleOk && emptyOk);
+    
+    vector<Vertex> closest = index.nearestK(7.7105, 48.5555, 5);
+    bool sorted = closest.size() == 5;
+    for (size_t i = 1; sorted && i < closest.size(); ++i) {
+        sorted = GraphBuilder::distance(48.5555, 7.7105, roads[closest[i - 1]].lat, roads[closest[i - 1]].lon) <=
+                 GraphBuilder::distance(48.5555, 7.7105, roads[closest[i]].lat, roads[closest[i]].lon) + 1e-6;
+    }
+    bool test5 = checkCondition("k plus proches triés par distance", sorted);
+    
+    bool passed = test1 && test2 && test3 && test4 && test5;
+    printTestResult("Index spatial des sommets", passed);
+    return passed;
+}
+
+bool InterferenceGraphTest::testSpatialGridHandoff() {
+    printTestHeader("Transfert incrémental entre antennes");
+    
+    vector<Vehicule*> vehicles;
+    for (int i = 0; i < 40; ++i) {
+        vehicles.push_back(createTestVehicle(i, 48.5734, 7.7521, 200.0));
+    }
+    SpatialGrid grid;
+    grid.initialize(vehicles, 2, 4);
+    const auto& micros = grid.getMicroAntennas();
+    
+    // Les deux petites antennes les plus proches: près de leur médiatrice,
+    // aucune troisième antenne n'est plus proche
+    const MicroAntenna* a = nullptr;
+    const MicroAntenna* b = nullptr;
+    double closest = numeric_limits<double>::max();
+    for (const auto& [id1, m1] : micros) {
+        for (const auto& [id2, m2] : micros) {
+            if (id1 >= id2) continue;
+            double d = GraphBuilder::distance(m1.centerLat, m1.centerLon, m2.centerLat, m2.centerLon);
+            if (d > 1.0 && d < closest) {
+                closest = d;
+                a = &m1;
+                b = &m2;
+            }
+        }
+    }
+    bool test1 = checkCondition("Au moins deux petites antennes distinctes", a && b);
+    if (!test1) {
+        cleanupVehicles(vehicles);
+        printTestResult("Transfert incrémental entre antennes", false);
+        return false;
+    }
+    
+    vector<int> ids;
+    for (auto* v : vehicles) ids.push_back(v->getId());
+    // Position sur le segment [b, a]: t = 0 en b, t = 1 en a
+    auto placeAll = [&](double t, vector<double>& lats, vector<double>& lons) {
+        lats.assign(ids.size(), b->centerLat + t * (a->centerLat - b->centerLat));
+        lons.assign(ids.size(), b->centerLon + t * (a->centerLon - b->centerLon));
+    };
+    auto allOn = [&](int microId) {
+        for (int id : ids) {
+            if (grid.getMicroAntennaId(id) != microId) return false;
+        }
+        return true;
+    };
+    vector<double> lats, lons;
+    
+    placeAll(0.0, lats, lons);
+    grid.updateAssignments(ids, lats, lons);
+    bool test2 = checkCondition("Tous les véhicules sur l'antenne b", allOn(b->id));
+    
+    // Petit déplacement dans la cellule: aucun transfert
+    placeAll(0.01, lats, lons);
+    bool test3 = checkCondition("Déplacement dans la cellule: 0 transfert",
+                                grid.updateAssignments(ids, lats, lons) == 0 && allOn(b->id));
+    
+    // Juste après la médiatrice, a est plus proche de moins que l'hystérésis: pas de transfert
+    double h = grid.getHandoffHysteresis();
+    placeAll((closest + h / 2.0) / (2.0 * closest), lats, lons);
+    bool test4 = checkCondition("Hystérésis: pas de transfert en bordure",
+                                grid.updateAssignments(ids, lats, lons) == 0 && allOn(b->id));
+    
+    // Au-delà de la marge: tous transférés vers a
+    placeAll((closest + 3.0 * h) / (2.0 * closest), lats, lons);
+    int handoffs = grid.updateAssignments(ids, lats, lons);
+    bool test5 = checkCondition("Au-delà de la marge: 40 transferts vers a",
+                                handoffs == 40 && allOn(a->id) && grid.getLastHandoffCount() == 40);
+    
+    // Retrait par échange avec le dernier: listes et index restent cohérents
+    for (int id = 0; id < 40; id += 3) {
+        grid.removeVehicleFromAntenna(id);
+    }
+    placeAll(0.0, lats, lons);
+    grid.updateAssignments(ids, lats, lons);  // Les véhicules retirés sont réassignés
+    size_t listed = 0;
+    bool consistent = true;
+    for (const auto& [microId, micro] : micros) {
+        for (int id : micro.vehicleIds) {
+            listed++;
+            if (grid.getMicroAntennaId(id) != microId) consistent = false;
+        }
+    }
+    bool test6 = checkCondition("Chaque véhicule listé une seule fois", consistent && listed == ids.size());
+    bool test7 = checkCondition("Cumul des transferts", grid.getTotalHandoffCount() >= 40);
+    
+    cleanupVehicles(vehicles);
+    
+    bool passed = test1 && test2 && test3 && test4 && test5 && test6 && test7;
+    printTestResult("Transfert incrémental entre antennes", passed);
+    return passed;
+}
+
+bool InterferenceGraphTest::testDistanceKernel() {
+    printTestHeader("Noyau de distance vectoriel");
+    cout << "  Jeu d'instructions: " << DistanceKernel::backendName() << endl;
+    
+    // Candidats pseudo-aléatoires dans un carré de 2 km, portées variées
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> coord(-1000.0f, 1000.0f);
+    std::uniform_real_distribution<float> range(50.0f, 600.0f);
+    ProjectedPositions pos;
+    for (int i = 0; i < 203; ++i) {
+        pos.push(coord(rng), coord(rng), range(rng));
+    }
+    
+    // Référence scalaire, pour tous les nombres de candidats de 0 à 64 (fins de bloc)
+    bool maskOk = true;
+    for (size_t count = 0; count <= DistanceKernel::BLOCK_SIZE; ++count) {
+        for (size_t i = 0; i < 10; ++i) {
+            uint64_t expected = 0;
+            for (size_t k = 0; k < count; ++k) {
+                float dx = pos.x[100 + k] - pos.x[i];
+                float dy = pos.y[100 + k] - pos.y[i];
+                float r = std::min(pos.range[i], pos.range[100 + k]);
+                if (dx * dx + dy * dy <= r * r) expected |= uint64_t(1) << k;
+            }
+            uint64_t mask = DistanceKernel::inRangeMask(pos.x[i], pos.y[i], pos.range[i], pos.x.data() + 100,
+                                                        pos.y.data() + 100, pos.range.data() + 100, count);
+            if (mask != expected) maskOk = false;
+        }
+    }
+    bool test1 = checkCondition("Masque = référence scalaire (0 à 64 candidats)", maskOk);
+    
+    // Plusieurs blocs: forEachInRange visite exactement les candidats à portée
+    size_t visited = 0, expectedCount = 0;
+    bool visitOk = true;
+    DistanceKernel::forEachInRange(pos.x[0], pos.y[0], pos.range[0], pos, 1, pos.size(), [&](size_t j) {
+        float dx = pos.x[j] - pos.x[0];
+        float dy = pos.y[j] - pos.y[0];
+        float r = std::min(pos.range[0], pos.range[j]);
+        if (j < 1 || j >= pos.size() || dx * dx + dy * dy > r * r) visitOk = false;
+        visited++;
+    });
+    for (size_t j = 1; j < pos.size(); ++j) {
+        float dx = pos.x[j] - pos.x[0];
+        float dy = pos.y[j] - pos.y[0];
+        float r = std::min(pos.range[0], pos.range[j]);
+        if (dx * dx + dy * dy <= r * r) expectedCount++;
+    }
+    bool test2 = checkCondition("Parcours sur plusieurs blocs (202 candidats)", visitOk && visited == expectedCount);
+    
+    // Portée mutuelle: la plus petite portée décide
+    ProjectedPositions pair;
+    pair.push(0.0f, 0.0f, 1000.0f);
+    pair.push(300.0f, 400.0f, 400.0f);   // 500 m: hors de portée du second
+    pair.push(30.0f, 40.0f, 60.0f);      // 50 m: à portée mutuelle
+    uint64_t mask = DistanceKernel::inRangeMask(pair.x[0], pair.y[0], pair.range[0],
+                                                pair.x.data() + 1, pair.y.data() + 1, pair.range.data() + 1, 2);
+    bool test3 = checkCondition("Portée mutuelle = min des deux portées", mask == 0b10);
+    
+    bool passed = test1 && test2 && test3;
+    printTestResult("Noyau de distance vectoriel", passed);
+    return passed;
+}
+
 bool InterferenceGraphTest::runAllTests() {
     cout << "\n";
     cout << "╔════════════════════════════════════════════════════════════╗" << endl;
@@ -450,6 +1187,25 @@ bool InterferenceGraphTest::runAllTests() {
     testAsymmetricRange();
     testCompleteGraph();
     testStarTopology();
+    testUniformGridMatchesBruteForce();
+    testParallelBuildMatchesSerial();
+    testComponentsMatchBfs();
+    testParallelVehicleUpdate();
+    testDrivableSegments();
+    testRoadGraphCache();
+    testRoutePlanner();
+    testRoadVertexIndex();
+    testSpatialGridHandoff();
+    testDistanceKernel();
+    testDirectEdgeList();
+    testProfiler();
+    testIncrementalGraph();
+    testKMeansPlacement();
+    testRecordingReplay();
+    testMessagePropagation();
+    testVehiclePool();
+    testDensityGrid();
+    testGeoSharding();
     
     return m_failedTests == 0;
 }
@@ -488,3 +1244,933 @@ void InterferenceGraphTest::printReport() const {
     }
     cout << "\n";
 }
+
+
+bool InterferenceGraphTest::testDirectEdgeList() {
+    printTestHeader("Liste d'arêtes et table ID -> ligne");
+    
+    // Liste plate: chaque connexion directe une seule fois, positions du snapshot
+    vector<VehicleSnapshot> snapshots = createRandomSnapshots(400, 0.03, 11);
+    InterferenceGraph graph;
+    graph.buildGraphFromSnapshots(snapshots, nullptr);
+    
+    unordered_map<int, const VehicleSnapshot*> byId;
+    for (const auto& snap : snapshots) byId[snap.id] = &snap;
+    
+    size_t degreeSum = 0;
+    for (const auto& snap : snapshots) degreeSum += graph.getDirectNeighbors(snap.id).size();
+    
+    bool edgesOk = true;
+    set<pair<int, int>> seen;
+    for (const DirectEdge& edge : graph.getDirectEdges()) {
+        auto key = std::minmax(edge.id1, edge.id2);
+        const VehicleSnapshot* a = byId[edge.id1];
+        const VehicleSnapshot* b = byId[edge.id2];
+        if (!seen.insert(key).second) edgesOk = false;
+        if (graph.getDirectNeighbors(edge.id1).count(edge.id2) == 0) edgesOk = false;
+        if (a->lon != edge.lon1 || a->lat != edge.lat1 || b->lon != edge.lon2 || b->lat != edge.lat2) edgesOk = false;
+    }
+    bool test1 = checkCondition("Arêtes uniques, présentes dans le CSR, positions du snapshot", edgesOk);
+    bool test2 = checkCondition("Nombre d'arêtes = somme des degrés / 2",
+                                !seen.empty() && graph.getDirectEdges().size() * 2 == degreeSum);
+    
+    // Table ID -> ligne du store, tenue à jour après une suppression au milieu
+    vector<Vehicule*> vehicles;
+    VehicleStore store;
+    for (int id : {10, 11, 12, 13, 14}) {
+        vehicles.push_back(createTestVehicle(id, 0.0, 0.0, 100.0));
+        store.push(*vehicles.back());
+    }
+    store.erase(1);
+    bool test3 = checkCondition("ID supprimé introuvable", store.rowOf(11) == -1);
+    bool test4 = checkCondition("Lignes suivantes décalées",
+                                store.rowOf(10) == 0 && store.rowOf(12) == 1 && store.rowOf(14) == 3 &&
+                                store.ids[store.rowOf(13)] == 13);
+    store.clear();
+    bool test5 = checkCondition("Table vide après clear()", store.rowOf(10) == -1);
+    cleanupVehicles(vehicles);
+    
+    bool passed = test1 && test2 && test3 && test4 && test5;
+    printTestResult("Liste d'arêtes et table ID -> ligne", passed);
+    return passed;
+}
+
+bool InterferenceGraphTest::testProfiler() {
+    printTestHeader("Profileur (chronomètres, compteurs, trace)");
+    using namespace Profiler;
+    reset();
+    
+    // Un chronomètre arrêté à la main n'est pas enregistré une deuxième fois
+    {
+        ScopedTimer timer(Stage::GraphBuild);
+        timer.stop();
+    }
+    vector<Sample> recorded = samples();
+    bool test1 = checkCondition("Un échantillon par chronomètre",
+                                recorded.size() == 1 && recorded[0].stage == Stage::GraphBuild &&
+                                recorded[0].durationNs >= 0);
+    
+    add(Counter::DistanceComparisons, 40);
+    add(Counter::DistanceComparisons, 2);
+    add(Counter::Ticks);
+    bool test2 = checkCondition("Compteurs cumulés",
+                                counter(Counter::DistanceComparisons) == 42 && counter(Counter::Ticks) == 1 &&
+                                counter(Counter::Frames) == 0);
+    
+    // Au-delà de la capacité, seuls les derniers échantillons sont conservés, dans l'ordre
+    reset();
+    const int64_t total = static_cast<int64_t>(RING_CAPACITY) + 1000;
+    for (int64_t i = 0; i < total; ++i) record(Stage::Paint, i, 1);
+    recorded = samples();
+    bool ordered = recorded.size() == RING_CAPACITY;
+    for (size_t i = 0; ordered && i < recorded.size(); ++i) {
+        ordered = recorded[i].startNs == total - static_cast<int64_t>(RING_CAPACITY) + static_cast<int64_t>(i);
+    }
+    bool test3 = checkCondition("Tampon circulaire: derniers échantillons, dans l'ordre", ordered);
+    
+    // Écritures concurrentes depuis 4 threads
+    reset();
+    const size_t perThread = 5000;
+    parallelFor(4 * perThread, 4, perThread, [](size_t begin, size_t end, int) {
+        for (size_t i = begin; i < end; ++i) record(Stage::Components, static_cast<int64_t>(i), 7);
+    });
+    recorded = samples();
+    bool concurrentOk = recorded.size() == 4 * perThread;
+    unordered_set<int64_t> starts;
+    for (const Sample& s : recorded) {
+        if (s.stage != Stage::Components || s.durationNs != 7) concurrentOk = false;
+        starts.insert(s.startNs);
+    }
+    bool test4 = checkCondition("Écritures concurrentes toutes valides",
+                                concurrentOk && starts.size() == 4 * perThread);
+    
+    const string path = "v2v_test_trace.json";
+    add(Counter::Frames, 3);
+    bool written = writeChromeTrace(path);
+    ifstream in(path);
+    const string json((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    in.close();
+    std::remove(path.c_str());
+    bool test5 = checkCondition("Trace Chrome écrite (événements X et compteurs)",
+                                written && json.find("\"ph\":\"X\"") != string::npos &&
+                                json.find("\"frames\":3") != string::npos);
+    
+    setEnabled(false);
+    reset();
+    {
+        ScopedTimer timer(Stage::Paint);
+    }
+    bool test6 = checkCondition("Rien n'est enregistré si désactivé", samples().empty());
+    setEnabled(true);
+    reset();
+    
+    bool passed = test1 && test2 && test3 && test4 && test5 && test6;
+    printTestResult("Profileur", passed);
+    return passed;
+}
+
+bool InterferenceGraphTest::testIncrementalGraph() {
+    printTestHeader("Graphe incrémental (listes de Verlet)");
+    
+    // Flotte en mouvement rectiligne (0 à 2 m par tick), comparée à chaque tick
+    // à une construction complète par force brute
+    vector<VehicleSnapshot> snapshots = createRandomSnapshots(600, 0.05, 11);
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<double> step(-2.0 / 111000.0, 2.0 / 111000.0);
+    vector<pair<double, double>> velocity(snapshots.size());
+    for (auto& v : velocity) v = {step(rng), step(rng)};
+    
+    VerletNeighborList neighbors;
+    set<pair<int, int>> tracked;  // Connexions reconstituées à partir des seules différences
+    bool sameAsFull = true;
+    bool deltasOk = true;
+    bool fewerComparisons = true;
+    int rebuilds = 0;
+    const int ticks = 80;
+    for (int tick = 0; tick < ticks; ++tick) {
+        for (size_t i = 0; i < snapshots.size(); ++i) {
+            snapshots[i].lon += velocity[i].first;
+            snapshots[i].lat += velocity[i].second;
+        }
+        InterferenceGraph incremental;
+        incremental.buildGraphIncremental(snapshots, neighbors);
+        InterferenceGraph full;
+        full.buildGraphFromSnapshots(snapshots);
+        
+        if (!sameDirectNeighbors(incremental, full, snapshots)) sameAsFull = false;
+        for (const auto& edge : incremental.getRemovedEdges()) {
+            if (tracked.erase(edge) == 0) deltasOk = false;
+        }
+        for (const auto& edge : incremental.getAddedEdges()) {
+            if (!tracked.insert(edge).second) deltasOk = false;
+        }
+        if (tracked.size() != incremental.getDirectEdges().size()) deltasOk = false;
+        if (incremental.wasNeighborListRebuilt()) {
+            rebuilds++;
+        } else if (incremental.getLastComparisons() >= full.getLastComparisons() / 10) {
+            fewerComparisons = false;
+        }
+    }
+    cout << "  → Reconstructions: " << rebuilds << " / " << ticks << " ticks, "
+         << neighbors.candidateCount() << " paires candidates" << endl;
+    
+    bool test1 = checkCondition("Mêmes voisins que la construction complète", sameAsFull);
+    bool test2 = checkCondition("Différences cohérentes (ajouts / retraits)", deltasOk && !tracked.empty());
+    bool test3 = checkCondition("Reconstructions espacées", rebuilds >= 2 && rebuilds < ticks / 4);
+    bool test4 = checkCondition("Entre deux reconstructions, seules les candidates sont testées", fewerComparisons);
+    
+    // Véhicule retiré: reconstruction, ses connexions apparaissent dans les retraits
+    const int removedId = snapshots.back().id;
+    snapshots.pop_back();
+    InterferenceGraph afterRemoval;
+    afterRemoval.buildGraphIncremental(snapshots, neighbors);
+    bool removalOk = afterRemoval.wasNeighborListRebuilt() && afterRemoval.getAddedEdges().empty();
+    size_t removedCount = 0;
+    for (const auto& edge : tracked) {
+        if (edge.first == removedId || edge.second == removedId) removedCount++;
+    }
+    for (const auto& edge : afterRemoval.getRemovedEdges()) {
+        if (edge.first != removedId && edge.second != removedId) removalOk = false;
+    }
+    bool test5 = checkCondition("Suppression d'un véhicule: retraits de ses seules connexions",
+                                removalOk && afterRemoval.getRemovedEdges().size() == removedCount);
+    
+    bool passed = test1 && test2 && test3 && test4 && test5;
+    printTestResult("Graphe incrémental", passed);
+    return passed;
+}
+
+bool InterferenceGraphTest::testKMeansPlacement() {
+    printTestHeader("Placement K-means des antennes");
+    
+    // Flotte répartie en quelques quartiers denses plus un fond uniforme
+    std::mt19937 rng(17);
+    std::normal_distribution<double> spread(0.0, 0.004);
+    std::uniform_real_distribution<double> uniform(0.0, 0.08);
+    vector<int> ids;
+    vector<double> lats, lons;
+    const double hubs[4][2] = {{48.56, 7.71}, {48.60, 7.75}, {48.57, 7.77}, {48.61, 7.72}};
+    for (int i = 0; i < 30000; ++i) {
+        ids.push_back(i);
+        if (i % 4 == 3) {
+            lats.push_back(48.55 + uniform(rng));
+            lons.push_back(7.70 + uniform(rng));
+        } else {
+            lats.push_back(hubs[i % 4][0] + spread(rng));
+            lons.push_back(hubs[i % 4][1] + spread(rng));
+        }
+    }
+    
+    SpatialGrid serial;
+    serial.setMaxTransmissionRange(300.0);
+    serial.setThreadCount(1);
+    serial.initialize(ids, lats, lons, 12, 8);
+    SpatialGrid parallel;
+    parallel.setMaxTransmissionRange(300.0);
+    parallel.setThreadCount(4);
+    parallel.initialize(ids, lats, lons, 12, 8);
+    const int coldIterations = serial.getLastKMeansIterations();
+    
+    bool test1 = checkCondition("12 grandes antennes, tous les véhicules assignés",
+                                serial.getMacroAntennas().size() == 12 &&
+                                serial.assignedVehicleIds().size() == ids.size());
+    bool test2 = checkCondition("Mêmes centres quel que soit le nombre de threads",
+                                serial.getMacroCenters() == parallel.getMacroCenters() &&
+                                coldIterations == parallel.getLastKMeansIterations());
+    
+    // Départ à chaud après un léger déplacement de la flotte
+    for (size_t i = 0; i < lats.size(); ++i) lats[i] += 0.0002;
+    SpatialGrid warm(serial);
+    warm.initialize(ids, lats, lons, 12, 8, serial.getMacroCenters());
+    SpatialGrid cold;
+    cold.setMaxTransmissionRange(300.0);
+    cold.initialize(ids, lats, lons, 12, 8);
+    cout << "  → Itérations: " << coldIterations << " à froid, "
+         << warm.getLastKMeansIterations() << " à chaud" << endl;
+    bool test3 = checkCondition("Départ à chaud: convergence plus rapide",
+                                warm.getLastKMeansIterations() < cold.getLastKMeansIterations());
+    
+    // Voisinages (grille de hachage) et rayons de maintien, comparés au calcul O(M²)
+    auto checkNeighborhoods = [](const SpatialGrid& grid, bool& neighborsOk, bool& radiiOk) {
+        for (const auto& [id1, m1] : grid.getMicroAntennas()) {
+            vector<int> expected;
+            double nearest = numeric_limits<double>::max();
+            for (const auto& [id2, m2] : grid.getMicroAntennas()) {
+                if (id1 == id2) continue;
+                double d = GraphBuilder::distance(m1.centerLat, m1.centerLon, m2.centerLat, m2.centerLon);
+                if (d < 300.0 + m1.radius + m2.radius) expected.push_back(id2);
+                nearest = std::min(nearest, d);
+            }
+            std::sort(expected.begin(), expected.end());
+            if (expected != m1.neighborMicroIds) neighborsOk = false;
+            if (std::abs(m1.handoffRadius - nearest / 2.0) > 1e-6) radiiOk = false;
+        }
+    };
+    bool neighborsOk = true;
+    bool radiiOk = true;
+    checkNeighborhoods(warm, neighborsOk, radiiOk);
+    // Même flotte à l'ouest de Greenwich et au sud de l'équateur: indices de cellules négatifs
+    vector<double> southLats(lats), westLons(lons);
+    for (double& lat : southLats) lat -= 83.17;
+    for (double& lon : westLons) lon -= 66.11;
+    SpatialGrid southWest;
+    southWest.setMaxTransmissionRange(300.0);
+    southWest.initialize(ids, southLats, westLons, 12, 8);
+    checkNeighborhoods(southWest, neighborsOk, radiiOk);
+    bool test4 = checkCondition("Voisinages identiques au calcul exhaustif (aussi en longitude et latitude négatives)",
+                                neighborsOk && warm.getMicroAntennas().size() == 96 &&
+                                southWest.getMicroAntennas().size() == 96);
+    bool test5 = checkCondition("Rayons de maintien identiques au calcul exhaustif", radiiOk);
+    
+    // Plus de grandes antennes que de véhicules: une antenne par véhicule au plus
+    SpatialGrid tiny;
+    tiny.initialize({1, 2, 3}, {48.56, 48.57, 48.58}, {7.71, 7.72, 7.73}, 10, 2);
+    bool test6 = checkCondition("k limité au nombre de véhicules", tiny.getMacroAntennas().size() == 3);
+    
+    bool passed = test1 && test2 && test3 && test4 && test5 && test6;
+    printTestResult("Placement K-means des antennes", passed);
+    return passed;
+}
+
+bool InterferenceGraphTest::testRecordingReplay() {
+    printTestHeader("Enregistrement et relecture");
+    
+    // Marche aléatoire: 400 véhicules, 600 ticks, un véhicule retiré au tick 350
+    const int numVehicles = 400;
+    const int numTicks = 600;
+    const double dt = 0.05;
+    std::mt19937 rng(23);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    VehicleStore store;
+    vector<int> ids;
+    for (int i = 0; i < numVehicles; ++i) ids.push_back(3 * i + 1);
+    store.setIds(ids);
+    for (int i = 0; i < numVehicles; ++i) {
+        store.lat[i] = 48.56 + 0.03 * unit(rng);
+        store.lon[i] = 7.72 + 0.04 * unit(rng);
+        store.edgeSource[i] = static_cast<Vertex>(rng() % 5000);
+        store.edgeTarget[i] = static_cast<Vertex>(rng() % 5000);
+        store.positionOnEdge[i] = 0.0;
+        store.speed[i] = 8.0 + 6.0 * unit(rng);
+        store.heading[i] = 360.0 * unit(rng);
+        store.range[i] = 300.0;
+    }
+    
+    auto quantized = [](double value) { return std::llround(value * 100.0) / 100.0; };
+    const string path = "v2v_test_recording.v2vrec";
+    RecordingOptions options;
+    options.keyframeInterval = 100;
+    options.graph.sourceHash = 0x5eed1234abcdULL;
+    options.graph.vertexCount = 4096;
+    options.graph.edgeCount = 9000;
+    RecordingWriter writer;
+    bool test1 = writer.open(path, options);
+    
+    vector<RecordedFrame> expected;
+    for (int tick = 1; tick <= numTicks; ++tick) {
+        if (tick == 350) {
+            ids.erase(ids.begin() + 7);
+            VehicleStore next;
+            next.setIds(ids);
+            for (size_t j = 0, i = 0; i < store.size(); ++i) {
+                if (i == 7) continue;
+                next.lat[j] = store.lat[i];
+                next.lon[j] = store.lon[i];
+                next.edgeSource[j] = store.edgeSource[i];
+                next.edgeTarget[j] = store.edgeTarget[i];
+                next.positionOnEdge[j] = store.positionOnEdge[i];
+                next.speed[j] = store.speed[i];
+                next.heading[j] = store.heading[i];
+                next.range[j] = store.range[i];
+                j++;
+            }
+            store = next;
+        }
+        for (size_t i = 0; i < store.size(); ++i) {
+            // Changement d'arête de temps en temps, sinon avance à vitesse presque constante
+            if (unit(rng) < 0.01) {
+                store.edgeSource[i] = store.edgeTarget[i];
+                store.edgeTarget[i] = static_cast<Vertex>(rng() % 5000);
+                store.positionOnEdge[i] = 0.0;
+                store.heading[i] = 360.0 * unit(rng);
+            } else {
+                store.positionOnEdge[i] += store.speed[i] * dt;
+            }
+            if (unit(rng) < 0.05) store.speed[i] = 8.0 + 6.0 * unit(rng);
+            const double rad = store.heading[i] * 3.14159265358979323846 / 180.0;
+            store.lat[i] += store.speed[i] * dt * std::cos(rad) / 111000.0;
+            store.lon[i] += store.speed[i] * dt * std::sin(rad) / 74000.0;
+        }
+        
+        vector<VehicleSnapshot> snapshots;
+        for (size_t i = 0; i < store.size(); ++i) {
+            snapshots.push_back({store.ids[i], store.lon[i], store.lat[i], store.range[i], -1});
+        }
+        auto graph = std::make_shared<InterferenceGraph>();
+        graph->setBroadphaseMode(BroadphaseMode::UniformGrid);
+        graph->buildGraphFromSnapshots(snapshots);
+        writer.push(static_cast<uint64_t>(tick), dt, store, graph);
+        
+        RecordedFrame frame;
+        frame.tick = static_cast<uint64_t>(tick);
+        frame.ids = store.ids;
+        for (size_t i = 0; i < store.size(); ++i) {
+            frame.edgeSource.push_back(store.edgeSource[i]);
+            frame.edgeTarget.push_back(store.edgeTarget[i]);
+            frame.positionOnEdge.push_back(quantized(store.positionOnEdge[i]));
+            frame.speed.push_back(quantized(store.speed[i]));
+            frame.heading.push_back(quantized(store.heading[i]));
+            frame.range.push_back(quantized(store.range[i]));
+        }
+        for (const auto& e : graph->getDirectEdges()) {
+            frame.edges.emplace_back(std::min(e.id1, e.id2), std::max(e.id1, e.id2));
+        }
+        std::sort(frame.edges.begin(), frame.edges.end());
+        expected.push_back(std::move(frame));
+    }
+    writer.close();
+    const double bytesPerVehicleTick = static_cast<double>(writer.bytesWritten()) / (numTicks * numVehicles);
+    cout << "  → " << writer.bytesWritten() << " octets, " << bytesPerVehicleTick
+         << " octet(s) par véhicule et par tick" << endl;
+    test1 = checkCondition("Toutes les trames écrites",
+                           test1 && !writer.failed() && writer.framesWritten() == static_cast<uint64_t>(numTicks));
+    
+    auto sameFrame = [](const RecordedFrame& a, const RecordedFrame& b) {
+        return a.tick == b.tick && a.ids == b.ids && a.edgeSource == b.edgeSource &&
+               a.edgeTarget == b.edgeTarget && a.positionOnEdge == b.positionOnEdge &&
+               a.speed == b.speed && a.heading == b.heading && a.range == b.range && a.edges == b.edges;
+    };
+    
+    // Lecture continue: valeurs quantifiées exactes, différences cohérentes avec les listes
+    RecordingReader reader;
+    bool opened = reader.open(path);
+    bool sequentialOk = opened && reader.graphIdentity() == options.graph &&
+                        reader.frameCount() == static_cast<uint64_t>(numTicks) &&
+                        reader.firstTick() == 1 && reader.lastTick() == static_cast<uint64_t>(numTicks);
+    bool deltasOk = true;
+    RecordedFrame frame;
+    EdgeIdList previous;
+    size_t count = 0;
+    while (sequentialOk && reader.next(frame)) {
+        sequentialOk = count < expected.size() && sameFrame(frame, expected[count]) &&
+                       std::abs(frame.dtSeconds - dt) < 1e-6;
+        EdgeIdList rebuilt;
+        std::set_difference(previous.begin(), previous.end(), frame.removed.begin(), frame.removed.end(),
+                            std::back_inserter(rebuilt));
+        rebuilt.insert(rebuilt.end(), frame.added.begin(), frame.added.end());
+        std::sort(rebuilt.begin(), rebuilt.end());
+        if (rebuilt != frame.edges) deltasOk = false;
+        previous = frame.edges;
+        count++;
+    }
+    bool test2 = checkCondition("Lecture continue identique aux valeurs quantifiées",
+                                sequentialOk && count == expected.size());
+    bool test3 = checkCondition("Connexions apparues/disparues cohérentes", deltasOk);
+    
+    // Accès direct au milieu d'un bloc, avant le début et après la fin
+    bool seekOk = reader.seek(247) && reader.next(frame) && sameFrame(frame, expected[246]) &&
+                  reader.next(frame) && sameFrame(frame, expected[247]);
+    seekOk = seekOk && reader.seek(0) && reader.next(frame) && sameFrame(frame, expected[0]);
+    seekOk = seekOk && reader.seek(100000) && reader.next(frame) && sameFrame(frame, expected.back()) &&
+             !reader.next(frame);
+    bool test4 = checkCondition("Seek identique à la lecture continue", seekOk);
+    reader.close();
+    
+    // Fichier tronqué (arrêt brutal): index absent, les blocs complets restent lisibles
+    ifstream in(path, std::ios::binary);
+    const string bytes((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    in.close();
+    {
+        ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size() * 6 / 10));
+    }
+    RecordingReader truncated;
+    bool truncatedOk = truncated.open(path) && truncated.frameCount() > 0 &&
+                       truncated.frameCount() < static_cast<uint64_t>(numTicks);
+    count = 0;
+    while (truncatedOk && truncated.next(frame)) {
+        truncatedOk = sameFrame(frame, expected[count++]);
+    }
+    bool test5 = checkCondition("Fichier tronqué relu jusqu'au dernier bloc complet",
+                                truncatedOk && count == truncated.frameCount());
+    truncated.close();
+    
+    // Taille stockée du premier bloc démesurée: refusé sans allocation
+    string corrupted = bytes;
+    const size_t firstChunk = 8 + 4 + 3 * 8;          // Après l'en-tête du fichier
+    for (size_t b = 0; b < 8; ++b) corrupted[firstChunk + 33 + b] = static_cast<char>(0xFF);
+    {
+        ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(corrupted.data(), static_cast<std::streamsize>(corrupted.size()));
+    }
+    RecordingReader corrupt;
+    bool corruptRejected = !corrupt.open(path);
+    corrupt.close();
+    std::remove(path.c_str());
+    test5 = test5 && checkCondition("Bloc à la taille incohérente refusé", corruptRejected);
+    
+    bool test6 = checkCondition("Moins de 3 octets par véhicule et par tick", bytesPerVehicleTick < 3.0);
+    
+    bool passed = test1 && test2 && test3 && test4 && test5 && test6;
+    printTestResult("Enregistrement et relecture", passed);
+    return passed;
+}
+
+bool InterferenceGraphTest::testMessagePropagation() {
+    printTestHeader("Propagation des messages");
+    
+    // Chaîne de 10 véhicules espacés d'environ 100 m, portée 150 m: un seul chemin
+    vector<VehicleSnapshot> chain;
+    for (int i = 0; i < 10; ++i) {
+        chain.push_back({i, 7.72, 48.56 + i * 0.0009, 150.0, -1});
+    }
+    InterferenceGraph chainGraph;
+    chainGraph.setBroadphaseMode(BroadphaseMode::UniformGrid);
+    chainGraph.buildGraphFromSnapshots(chain);
+    
+    MessageEngineConfig exact;
+    exact.airtimeMs = 0.5;
+    exact.hopDelayMs = 2.0;
+    exact.hopJitterMs = 0.0;
+    exact.lossProbability = 0.0;
+    exact.maxHops = 16;
+    
+    MessageEngine flood(exact);
+    flood.broadcast(0, chain.size());
+    flood.advanceTo(1000.0, chainGraph);
+    auto farthest = flood.inbox(9);
+    bool test1 = checkCondition("Inondation: toute la chaîne atteinte, latence = sauts × (émission + délai)",
+                                flood.stats().meanReach() == 1.0 && flood.stats().deliveries == 9 &&
+                                farthest.size() == 1 && farthest[0].hops == 9 && farthest[0].fromId == 8 &&
+                                std::abs(farthest[0].latencyMs - 9 * 2.5) < 1e-9 && flood.activeMessages() == 0);
+    // Chaque retransmission revient aussi vers le véhicule précédent
+    bool test2 = checkCondition("Doublons comptés (retour vers l'émetteur précédent)",
+                                flood.stats().duplicates == 9 && flood.stats().transmissions == 10);
+    
+    MessageEngineConfig limited = exact;
+    limited.maxHops = 3;
+    MessageEngine ttl(limited);
+    ttl.broadcast(0, chain.size());
+    ttl.advanceTo(1000.0, chainGraph);
+    bool test3 = checkCondition("TTL: 3 sauts au plus", ttl.stats().deliveries == 3 && ttl.inbox(4).empty());
+    
+    MessageEngineConfig lossy = exact;
+    lossy.lossProbability = 1.0;
+    MessageEngine lost(lossy);
+    lost.broadcast(0, chain.size());
+    lost.advanceTo(1000.0, chainGraph);
+    MessageEngineConfig silent = exact;
+    silent.strategy = PropagationStrategy::Gossip;
+    silent.gossipProbability = 0.0;
+    MessageEngine gossip(silent);
+    gossip.broadcast(0, chain.size());
+    gossip.advanceTo(1000.0, chainGraph);
+    bool test4 = checkCondition("Pertes et gossip sans retransmission",
+                                lost.stats().deliveries == 0 && lost.stats().lost == 1 &&
+                                gossip.stats().deliveries == 1 && gossip.stats().transmissions == 1);
+    
+    // Deux diffusions simultanées du même véhicule: la seconde attend la fin de la première
+    MessageEngineConfig small = exact;
+    small.maxHops = 1;
+    small.inboxCapacity = 4;
+    MessageEngine channel(small);
+    channel.broadcast(0, chain.size());
+    channel.broadcast(0, chain.size());
+    channel.advanceTo(1000.0, chainGraph);
+    auto received = channel.inbox(1);
+    bool contentionOk = received.size() == 2 && std::abs(received[0].latencyMs - 2.5) < 1e-9 &&
+                        std::abs(received[1].latencyMs - 3.0) < 1e-9;
+    for (int i = 0; i < 8; ++i) channel.broadcast(0, chain.size());
+    channel.advanceTo(2000.0, chainGraph);
+    received = channel.inbox(1);
+    bool test5 = checkCondition("Canal partagé et boîte de réception circulaire",
+                                contentionOk && received.size() == 4 && received.back().messageId == 10 &&
+                                received.front().messageId == 7);
+    
+    // Charge: 3000 messages sur une flotte de 3000 véhicules, même résultat à graine égale
+    vector<VehicleSnapshot> fleet = createRandomSnapshots(3000, 0.05, 31);
+    vector<int> fleetIds;
+    for (const auto& snap : fleet) fleetIds.push_back(snap.id);
+    InterferenceGraph fleetGraph;
+    fleetGraph.setBroadphaseMode(BroadphaseMode::UniformGrid);
+    fleetGraph.buildGraphFromSnapshots(fleet);
+    MessageEngineConfig load;
+    load.strategy = PropagationStrategy::Gossip;
+    load.maxHops = 4;
+    auto runLoad = [&](MessageStats& stats, double& seconds) {
+        MessageEngine engine(load);
+        auto start = std::chrono::steady_clock::now();
+        engine.broadcastRandom(fleetIds, 3000);
+        engine.advanceTo(1000.0, fleetGraph);
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        stats = engine.stats();
+        return engine.activeMessages() == 0 && engine.pendingEvents() == 0;
+    };
+    MessageStats first, second;
+    double seconds1 = 0.0, seconds2 = 0.0;
+    bool drained = runLoad(first, seconds1) && runLoad(second, seconds2);
+    const uint64_t receptions = first.deliveries + first.duplicates + first.lost;
+    cout << "  → " << first.transmissions << " diffusions, " << receptions << " réceptions en "
+         << seconds1 * 1000.0 << " ms (" << receptions / std::max(seconds1, 1e-9) / 1e6 << " M/s), portée "
+         << first.meanReach() * 100.0 << "%, p99 " << first.latencyPercentileMs(99.0)
+         << " ms, doublons " << first.duplicateRate() * 100.0 << "%" << endl;
+    bool test6 = checkCondition("Charge: tous les messages terminés, résultat déterministe",
+                                drained && first.messagesCompleted == 3000 && first.events == second.events &&
+                                first.deliveries == second.deliveries && first.duplicates == second.duplicates &&
+                                first.deliveries > 0);
+    
+    bool passed = test1 && test2 && test3 && test4 && test5 && test6;
+    printTestResult("Propagation des messages", passed);
+    return passed;
+}
+
+bool InterferenceGraphTest::testVehiclePool() {
+    printTestHeader("Pool de véhicules et suppression en O(1)");
+    
+    auto vertices = boost::vertices(m_testGraph);
+    const Vertex start = *vertices.first;
+    const Vertex goal = *(vertices.first + 1);
+    
+    // Trois blocs pour 600 véhicules, adresses distinctes et stables pendant la croissance
+    VehiclePool pool;
+    vector<Vehicule*> vehicles;
+    for (int i = 0; i < 600; ++i) {
+        vehicles.push_back(pool.create(i, m_testGraph, start, goal, 10.0, 200.0, 5.0));
+    }
+    set<const Vehicule*> addresses(vehicles.begin(), vehicles.end());
+    bool stable = addresses.size() == vehicles.size();
+    for (int i = 0; i < 600; ++i) {
+        stable = stable && pool.owns(vehicles[i]) && vehicles[i]->getId() == i;
+    }
+    bool test1 = checkCondition("600 véhicules dans 3 blocs, adresses stables",
+                                stable && pool.slabCount() == 3 && pool.liveCount() == 600);
+    
+    // Les emplacements libérés sont réutilisés sans nouveau bloc
+    set<const Vehicule*> freed;
+    for (int i = 100; i < 200; ++i) {
+        freed.insert(vehicles[i]);
+        pool.destroy(vehicles[i]);
+    }
+    bool reused = true;
+    for (int i = 100; i < 200; ++i) {
+        vehicles[i] = pool.create(1000 + i, m_testGraph, start, goal, 10.0, 200.0, 5.0);
+        reused = reused && freed.count(vehicles[i]) == 1;
+    }
+    bool test2 = checkCondition("Emplacements libérés réutilisés, pas de nouveau bloc",
+                                reused && pool.slabCount() == 3 && pool.liveCount() == 600);
+    
+    Vehicule* external = createTestVehicle(5000, 0.0, 0.0, 200.0);
+    bool test3 = checkCondition("Véhicule alloué hors du pool non reconnu", !pool.owns(external));
+    delete external;
+    for (Vehicule* v : vehicles) {
+        pool.destroy(v);
+    }
+    
+    // Suppression par échange avec la dernière ligne, table ID -> ligne à jour
+    VehicleStore store;
+    vector<Vehicule*> rows;
+    for (int id : {10, 11, 12, 13, 14}) {
+        rows.push_back(createTestVehicle(id, 0.0, 0.0, 100.0));
+        store.push(*rows.back());
+    }
+    store.swapRemove(1);
+    bool test4 = checkCondition("Dernière ligne déplacée dans la ligne supprimée",
+                                store.size() == 4 && store.rowOf(11) == -1 && store.rowOf(14) == 1 &&
+                                store.ids[1] == 14 && store.rowOf(12) == 2 && store.rowOf(13) == 3);
+    store.swapRemove(3);
+    bool test5 = checkCondition("Suppression de la dernière ligne",
+                                store.size() == 3 && store.rowOf(13) == -1 && store.rowOf(10) == 0);
+    cleanupVehicles(rows);
+    
+    // Les voisinages d'antennes ne sont recopiés par les jobs que s'ils ont changé
+    vector<Vehicule*> fleet;
+    for (int i = 0; i < 40; ++i) {
+        fleet.push_back(createTestVehicle(i, 48.5734, 7.7521, 200.0));
+    }
+    SpatialGrid grid;
+    grid.initialize(fleet, 2, 4);
+    const uint64_t placed = grid.getLayoutVersion();
+    SpatialGrid copy(grid);
+    const bool copied = copy.getLayoutVersion() == placed;
+    grid.updateNeighborhoods();
+    const uint64_t updated = grid.getLayoutVersion();
+    copy.clear();
+    bool test6 = checkCondition("Version de disposition: conservée par copie, changée par recalcul et clear()",
+                                placed != 0 && copied && updated != placed &&
+                                copy.getLayoutVersion() != placed && copy.getLayoutVersion() != updated);
+    cleanupVehicles(fleet);
+    
+    bool passed = test1 && test2 && test3 && test4 && test5 && test6;
+    printTestResult("Pool de véhicules et suppression en O(1)", passed);
+    return passed;
+}
+
+bool InterferenceGraphTest::testDensityGrid() {
+    printTestHeader("Carte de densité (rendu à faible zoom)");
+    
+    // Un groupe de 50 véhicules tous connectés et un véhicule isolé à ~5 km
+    vector<VehicleSnapshot> snapshots;
+    for (int i = 0; i < 50; ++i) {
+        snapshots.push_back({i, 7.7500 + 0.00005 * (i % 7), 48.5800 + 0.00005 * (i / 7), 500.0, -1});
+    }
+    snapshots.push_back({50, 7.8200, 48.5800, 500.0, -1});
+    InterferenceGraph graph;
+    graph.enableTransitiveClosure(true);
+    graph.buildGraphFromSnapshots(snapshots);
+    
+    DensityGrid grid = DensityGrid::build(snapshots, graph, 12);
+    uint32_t total = 0;
+    for (int c = 0; c < grid.cols() * grid.rows(); ++c) total += grid.count(c);
+    bool test1 = checkCondition("Chaque véhicule compté une fois",
+                                total == snapshots.size() && grid.vehicleCount() == snapshots.size() &&
+                                grid.pixels().size() == static_cast<size_t>(grid.cols() * grid.rows()));
+    
+    auto cellOf = [&](const DensityGrid& g, const VehicleSnapshot& snap) {
+        double px, py;
+        DensityGrid::lonLatToWorld(snap.lon, snap.lat, g.zoom(), px, py);
+        return g.cellAt(px, py);
+    };
+    // Le groupe peut chevaucher une frontière de cellules
+    set<int> groupCells;
+    for (int i = 0; i < 50; ++i) groupCells.insert(cellOf(grid, snapshots[i]));
+    uint32_t groupTotal = 0;
+    bool groupOk = !groupCells.count(-1);
+    for (int c : groupCells) {
+        if (c < 0) continue;
+        groupTotal += grid.count(c);
+        groupOk = groupOk && std::abs(grid.meanDegree(c) - 49.0) < 1e-9 && grid.largestComponent(c) == 50;
+    }
+    const int groupCell = cellOf(grid, snapshots[0]);
+    const int isolatedCell = cellOf(grid, snapshots[50]);
+    bool test2 = checkCondition("Groupe: 50 véhicules, degré moyen 49, composante de 50",
+                                groupOk && groupTotal == 50 && grid.maxCount() == grid.count(groupCell));
+    bool test3 = checkCondition("Véhicule isolé: degré 0, composante de 1",
+                                isolatedCell >= 0 && isolatedCell != groupCell && grid.count(isolatedCell) == 1 &&
+                                grid.meanDegree(isolatedCell) == 0.0 && grid.largestComponent(isolatedCell) == 1);
+    
+    // Couleurs: opacité selon la densité, rouge = isolé, vers le cyan = connecté
+    auto alpha = [](uint32_t argb) { return argb >> 24; };
+    auto red = [](uint32_t argb) { return (argb >> 16) & 0xff; };
+    auto blue = [](uint32_t argb) { return argb & 0xff; };
+    const uint32_t groupPixel = grid.pixels()[groupCell];
+    const uint32_t isolatedPixel = grid.pixels()[isolatedCell];
+    int emptyCell = -1;
+    for (int c = 0; c < grid.cols() * grid.rows() && emptyCell < 0; ++c) {
+        if (grid.count(c) == 0) emptyCell = c;
+    }
+    bool test4 = checkCondition("Couleurs: cellule dense opaque et bleutée, isolée rouge, vide transparente",
+                                alpha(groupPixel) > alpha(isolatedPixel) && blue(groupPixel) > red(groupPixel) &&
+                                red(isolatedPixel) == 255 && blue(isolatedPixel) < 64 &&
+                                emptyCell >= 0 && grid.pixels()[emptyCell] == 0);
+    
+    // Zoom maximal: la carte reste bornée en taille, les cellules sont agrandies
+    vector<VehicleSnapshot> spread = snapshots;
+    spread.push_back({51, 7.8200, 48.6200, 500.0, -1});
+    InterferenceGraph spreadGraph;
+    spreadGraph.buildGraphFromSnapshots(spread);
+    DensityGrid fine = DensityGrid::build(spread, spreadGraph, 20);
+    uint32_t fineTotal = 0;
+    for (int c = 0; c < fine.cols() * fine.rows(); ++c) fineTotal += fine.count(c);
+    bool test5 = checkCondition("Zoom 20: au plus MAX_CELLS cellules, tous les véhicules comptés",
+                                static_cast<size_t>(fine.cols()) * fine.rows() <= DensityGrid::MAX_CELLS &&
+                                fine.cellPixels() > DensityGrid::DEFAULT_CELL_PIXELS &&
+                                fineTotal == spread.size());
+    
+    // Charge: 200 000 véhicules sur une ville, zoom de vue d'ensemble
+    vector<VehicleSnapshot> fleet;
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> lonDist(7.70, 7.82), latDist(48.54, 48.62);
+    for (int i = 0; i < 200000; ++i) {
+        fleet.push_back({i, lonDist(rng), latDist(rng), 1.0, -1});
+    }
+    InterferenceGraph sparse;
+    sparse.setBroadphaseMode(BroadphaseMode::UniformGrid);
+    sparse.buildGraphFromSnapshots(fleet);
+    DensityGrid city = DensityGrid::build(fleet, sparse, 12);
+    cout << "  → " << fleet.size() << " véhicules, " << city.cols() << "×" << city.rows()
+         << " cellules en " << city.buildTimeMs() << " ms" << endl;
+    uint32_t cityTotal = 0;
+    for (int c = 0; c < city.cols() * city.rows(); ++c) cityTotal += city.count(c);
+    bool test6 = checkCondition("Ville: image de quelques milliers de cellules",
+                                cityTotal == fleet.size() && city.cols() * city.rows() < 100000);
+    
+    bool passed = test1 && test2 && test3 && test4 && test5 && test6;
+    printTestResult("Carte de densité (rendu à faible zoom)", passed);
+    return passed;
+}
+
+bool InterferenceGraphTest::testGeoSharding() {
+    printTestHeader("Découpage géographique et protocole des shards");
+    
+    // 16 régions en grille 4×4 (~2 km), la moitié ouest deux fois plus chargée
+    vector<pair<double, double>> centers;
+    vector<double> weights;
+    for (int y = 0; y < 4; ++y) {
+        for (int x = 0; x < 4; ++x) {
+            centers.push_back({48.55 + y * 0.02, 7.70 + x * 0.03});
+            weights.push_back(x < 2 ? 200.0 : 100.0);
+        }
+    }
+    GeoPartition partition = GeoPartition::fromCenters(centers, weights, 4);
+    vector<double> shardWeights = partition.shardWeights();
+    bool allUsed = partition.shardCount() == 4 && shardWeights.size() == 4;
+    for (double w : shardWeights) allUsed = allUsed && w > 0.0;
+    auto [minWeight, maxWeight] = std::minmax_element(shardWeights.begin(), shardWeights.end());
+    bool test1 = checkCondition("4 shards non vides, charge équilibrée (écart < 50 %)",
+                                allUsed && *maxWeight <= 1.5 * *minWeight &&
+                                partition.shardOf(centers[5].first, centers[5].second) ==
+                                    partition.regions()[5].shard);
+    
+    // Zone frontière: tout voisin à portée dans un autre shard est signalé
+    const double range = 500.0;
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<double> latDist(48.54, 48.62), lonDist(7.69, 7.80);
+    vector<pair<double, double>> points;
+    for (int i = 0; i < 3000; ++i) points.push_back({latDist(rng), lonDist(rng)});
+    int crossPairs = 0;
+    bool conservative = true;
+    vector<int> nearby;
+    for (size_t i = 0; i < points.size(); ++i) {
+        const int own = partition.shardOf(points[i].first, points[i].second);
+        partition.nearbyShards(points[i].first, points[i].second, range * 1.02, nearby);
+        if (std::find(nearby.begin(), nearby.end(), own) != nearby.end()) conservative = false;
+        for (size_t j = 0; j < points.size(); ++j) {
+            const int other = partition.shardOf(points[j].first, points[j].second);
+            if (other == own) continue;
+            if (GraphBuilder::distance(points[i].first, points[i].second,
+                                       points[j].first, points[j].second) > range) continue;
+            crossPairs++;
+            if (!std::binary_search(nearby.begin(), nearby.end(), other)) conservative = false;
+        }
+    }
+    cout << "  → " << crossPairs << " paires à portée entre deux shards" << endl;
+    bool test2 = checkCondition("Voisins à portée dans un autre shard tous dans la zone frontière",
+                                crossPairs > 0 && conservative);
+    
+    // Trames: en-tête, trame incomplète, magic invalide
+    vector<uint8_t> stream;
+    size_t frame = beginShardFrame(stream, ShardMessage::Step, SHARD_COORDINATOR, 3, 77);
+    encodeShardStep(stream, ShardStep{0.5, 10});
+    endShardFrame(stream, frame);
+    appendShardFrame(stream, ShardMessage::Flush, 3, SHARD_COORDINATOR, 77);
+    ShardFrameHeader header;
+    ShardStep decodedStep;
+    bool headerOk = parseShardFrame(stream.data(), stream.size(), header) == ShardFrameStatus::Ok &&
+                    header.type == ShardMessage::Step && header.source == SHARD_COORDINATOR &&
+                    header.target == 3 && header.tick == 77 &&
+                    decodeShardStep(stream.data() + SHARD_FRAME_HEADER_SIZE, header.length, decodedStep) &&
+                    decodedStep.dtSeconds == 0.5 && decodedStep.viewStride == 10;
+    const size_t second = SHARD_FRAME_HEADER_SIZE + header.length;
+    headerOk = headerOk && parseShardFrame(stream.data() + second, stream.size() - second, header) ==
+                               ShardFrameStatus::Ok && header.type == ShardMessage::Flush && header.length == 0;
+    bool needMore = parseShardFrame(stream.data(), SHARD_FRAME_HEADER_SIZE - 1, header) == ShardFrameStatus::NeedMore &&
+                    parseShardFrame(stream.data(), second - 1, header) == ShardFrameStatus::NeedMore;
+    vector<uint8_t> corrupted = stream;
+    corrupted[0] ^= 0xFF;
+    bool invalid = parseShardFrame(corrupted.data(), corrupted.size(), header) == ShardFrameStatus::Invalid;
+    bool test3 = checkCondition("Trames: en-tête relu, incomplète (NeedMore), magic faux (Invalid)",
+                                headerOk && needMore && invalid);
+    
+    // Boundary: positions au 1e-7 degré, portée au cm
+    vector<VehicleSnapshot> boundary;
+    for (int i = 0; i < 200; ++i) {
+        boundary.push_back({i * 3 + 1, lonDist(rng), latDist(rng), 300.0 + i * 0.37, -1});
+    }
+    vector<uint8_t> payload;
+    encodeBoundary(payload, boundary);
+    vector<VehicleSnapshot> decodedBoundary;
+    bool boundaryOk = decodeBoundary(payload.data(), payload.size(), decodedBoundary) &&
+                      decodedBoundary.size() == boundary.size();
+    for (size_t i = 0; boundaryOk && i < boundary.size(); ++i) {
+        boundaryOk = decodedBoundary[i].id == boundary[i].id &&
+                     std::abs(decodedBoundary[i].lat - boundary[i].lat) <= 1e-7 &&
+                     std::abs(decodedBoundary[i].lon - boundary[i].lon) <= 1e-7 &&
+                     std::abs(decodedBoundary[i].transmissionRange - boundary[i].transmissionRange) <= 0.01;
+    }
+    cout << "  → Boundary: " << payload.size() / static_cast<double>(boundary.size()) << " octets par véhicule" << endl;
+    vector<VehicleSnapshot> truncatedBoundary;
+    bool boundaryTruncated = !decodeBoundary(payload.data(), payload.size() - 1, truncatedBoundary);
+    
+    // Stats et vue
+    ShardTickStats stats;
+    stats.vehicles = 1200;
+    stats.ghosts = 85;
+    stats.crossEdges = 42;
+    stats.localEdges = 1u << 20;
+    stats.graphMs = 3.25;
+    payload.clear();
+    encodeShardStats(payload, stats);
+    ShardTickStats decodedStats;
+    bool statsOk = decodeShardStats(payload.data(), payload.size(), decodedStats) &&
+                   decodedStats.vehicles == 1200 && decodedStats.ghosts == 85 && decodedStats.crossEdges == 42 &&
+                   decodedStats.localEdges == (1u << 20) && decodedStats.graphMs == 3.25 &&
+                   !decodeShardStats(payload.data(), payload.size() - 1, decodedStats);
+    vector<ShardViewRow> view = {{10, 4, 5, 12.345, 13.9, 271.5, 500.0}, {20, 7, 3, 0.0, 0.0, 0.0, 300.0}};
+    payload.clear();
+    encodeShardView(payload, view);
+    vector<ShardViewRow> decodedView;
+    bool viewOk = decodeShardView(payload.data(), payload.size(), decodedView) && decodedView.size() == 2 &&
+                  decodedView[0].id == 10 && decodedView[0].edgeTarget == 5 &&
+                  std::abs(decodedView[0].positionOnEdge - 12.345) <= 0.01 && decodedView[1].edgeSource == 7;
+    bool test4 = checkCondition("Boundary (1 cm), Stats et View décodés; charge tronquée refusée",
+                                boundaryOk && boundaryTruncated && statsOk && viewOk);
+    
+    // Migration: un véhicule repris ailleurs continue exactement la même trajectoire
+    const int side = 12;
+    RoadGraph roads = createRoadGrid(side);
+    RoutePlanner planner(roads);
+    
+    // Une moitié suit un itinéraire planifié, l'autre marche au hasard
+    const int numVehicles = 120;
+    const int numVertices = side * side;
+    vector<Vehicule*> original;
+    for (int i = 0; i < numVehicles; ++i) {
+        original.push_back(new Vehicule(i, roads, (i * 7) % numVertices, (i * 13 + 5) % numVertices, 14.0, 500.0, 5.0));
+        original.back()->seedRandom(99);
+        if (i % 2 == 0) original.back()->setRoutePlanner(&planner);
+    }
+    for (int step = 0; step < 150; ++step) {
+        for (auto* v : original) v->update(0.5);
+    }
+    
+    vector<VehicleMotionState> states;
+    for (auto* v : original) states.push_back(v->getMotionState());
+    payload.clear();
+    encodeMigrations(payload, states);
+    vector<VehicleMotionState> received;
+    bool migrationsDecoded = decodeMigrations(payload.data(), payload.size(), received) &&
+                             received.size() == states.size();
+    vector<VehicleMotionState> truncatedMigrations;
+    bool migrationsTruncated = !decodeMigrations(payload.data(), payload.size() - 1, truncatedMigrations);
+    cout << "  → Migration: " << payload.size() / static_cast<double>(states.size()) << " octets par véhicule" << endl;
+    
+    vector<Vehicule*> migrated;
+    bool restored = migrationsDecoded;
+    for (size_t i = 0; restored && i < received.size(); ++i) {
+        const VehicleMotionState& state = received[i];
+        migrated.push_back(new Vehicule(state.id, roads, state.start, state.goal, state.speed,
+                                        state.transmissionRange, state.collisionDist));
+        if (state.id % 2 == 0) migrated.back()->setRoutePlanner(&planner);
+        restored = migrated.back()->restoreMotionState(state);
+    }
+    bool samePositions = restored && migrated.size() == original.size();
+    for (int step = 0; samePositions && step < 300; ++step) {
+        for (size_t i = 0; i < original.size(); ++i) {
+            original[i]->update(0.5);
+            migrated[i]->update(0.5);
+            if (original[i]->getPosition() != migrated[i]->getPosition() ||
+                original[i]->getHeading() != migrated[i]->getHeading()) {
+                samePositions = false;
+            }
+        }
+    }
+    bool test5 = checkCondition("Migration: état décodé bit à bit, trajectoires identiques ensuite",
+                                migrationsTruncated && samePositions);
+    
+    cleanupVehicles(original);
+    cleanupVehicles(migrated);
+    
+    bool passed = test1 && test2 && test3 && test4 && test5;
+    printTestResult("Découpage géographique et protocole des shards", passed);
+    return passed;
+}
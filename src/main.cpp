@@ -3,12 +3,18 @@
 #include <QStatusBar>
 #include <QProcessEnvironment>
 #include <QObject>
+#include <QCommandLineParser>
 #include <iostream>
 
+#ifdef V2V_OPENGL
+#include <QSurfaceFormat>
+#endif
+
 #include "map_view.h"
 #include "simulator.h"
 #include "graph_builder.h"
 #include "osm_reader.h"
+#include "road_graph_cache.h"
 #include "interference_graph_test.h"
 
 #define DELTA_TIME 0.5
@@ -24,6 +30,7 @@ int main(int argc, char** argv){
     
     InterferenceGraphTest tester;
     tester.runAllTests();
+    tester.runSimulatorTests();
     tester.printReport();
     
     std::cout << "\nAppuyez sur Entrée pour continuer vers l'application..." << std::endl;
@@ -33,17 +40,39 @@ int main(int argc, char** argv){
     // ----------------------
     // Mode normal : Application graphique
     // ----------------------
+#ifdef V2V_OPENGL
+    // Contexte OpenGL 3.3 core (quads instanciés de GpuMapLayer), avant QApplication
+    QSurfaceFormat format;
+    format.setVersion(3, 3);
+    format.setProfile(QSurfaceFormat::CoreProfile);
+    QSurfaceFormat::setDefaultFormat(format);
+#endif
     QApplication app(argc, argv);
 
+    // Enregistrement / relecture (voir sim_recording.h)
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption recordOption("record", "Enregistre la simulation dans <fichier>.", "fichier");
+    QCommandLineOption replayOption("replay", "Rejoue l'enregistrement <fichier> au lieu de simuler.", "fichier");
+    parser.addOption(recordOption);
+    parser.addOption(replayOption);
+    parser.process(app);
+
     // ----------------------
     //  Load OSM data
-    OSMReader reader("../data/strasbourg.osm.pbf");
-    reader.read();
-    reader.printSummary();
+    const std::string osmPath = "../data/strasbourg.osm.pbf";
+    const std::string cachePath = RoadGraphCache::defaultCachePath(osmPath);
+    const uint64_t osmHash = RoadGraphCache::hashFile(osmPath);
+    OSMReader reader(osmPath, OSMReader::ReadMode::DrivableOnly);
 
-    // 2. Construction du graphe
+    // 2. Construction du graphe (ou chargement du cache binaire s'il est à jour)
     GraphBuilder builder(reader.nodes, reader.ways);
-    builder.buildGraph();
+    if (!builder.loadCache(cachePath, osmHash)) {
+        reader.read();
+        reader.printSummary();
+        builder.buildGraph();
+        builder.saveCache(cachePath, osmHash);
+    }
     builder.printSummary();
     const RoadGraph& graph = builder.getGraph();
 
@@ -66,39 +95,43 @@ int main(int argc, char** argv){
     win.show();
 
     // --- Create simulator ---
-    Simulator simulator(const_cast<RoadGraph&>(graph), map);
+    Simulator simulator(const_cast<RoadGraph&>(graph));
+    simulator.setRoadGraphSourceHash(osmHash);
     map->setSimulator(&simulator);
     QObject::connect(&simulator, &Simulator::ticked, map, [map](double){
         map->update();
     });
+    QObject::connect(&simulator, &Simulator::graphUpdated, map, [map](){
+        map->update();
+    });
+    QObject::connect(&simulator, &Simulator::antennasPlaced, map, [map](){
+        map->update();
+    });
 
 
-    //GENERATE RANDOM CARS
-    std::vector<Vertex> vertices;
-    for (auto vp = boost::vertices(graph); vp.first != vp.second; ++vp.first) {
-        vertices.push_back(*vp.first);
+    if (parser.isSet(replayOption)) {
+        // La flotte vient du fichier: pas de véhicules générés
+        if (!simulator.openReplay(parser.value(replayOption).toStdString())) {
+            return 1;
+        }
+        simulator.start(50);
+        return app.exec();
     }
 
-    const int NUM_CARS = 2000;
-    for (int i = 0; i < NUM_CARS; ++i) {
-        Vertex start, goal;
-
-        // Pick valid start vertex
-        do {
-            start = vertices[rand() % vertices.size()];
-        } while (!Vehicule::isValidVertex(start, graph) && !Vehicule::hasValidOutgoingEdge(start, graph));
+    //GENERATE RANDOM CARS
+    // Départs et buts tirés parmi les sommets praticables de l'index spatial
+    const RoadVertexIndex& vertexIndex = simulator.vertexIndex();
 
-        // Pick valid goal vertex
-        do {
-            goal = vertices[rand() % vertices.size()];
-        } while (!Vehicule::isValidVertex(start, graph) && !Vehicule::hasValidOutgoingEdge(start, graph));
+    const int NUM_CARS = 2000;
+    for (int i = 0; i < NUM_CARS && !vertexIndex.empty(); ++i) {
+        Vertex start = vertexIndex.randomVertex(rand());
+        Vertex goal = vertexIndex.randomVertex(rand());
 
         double speed = 14;          // 50 km/h in m/s
         double range = 500.0;        // transmission range
         double collisionDist = 5.0;   // 5 meters
 
-        Vehicule* car = new Vehicule(i, graph, start, goal, speed, range, collisionDist);
-        simulator.addVehicle(car);
+        simulator.createVehicle(i, start, goal, speed, range, collisionDist);
 
 
        // qDebug() << "Vehicle created:" << i << "start" << start << "goal" << goal;
@@ -106,6 +139,13 @@ int main(int argc, char** argv){
 
     }
 
+    // Itinéraires de toute la flotte calculés en parallèle avant le départ
+    simulator.planRoutes();
+
+    if (parser.isSet(recordOption)) {
+        simulator.startRecording(parser.value(recordOption).toStdString());
+    }
+
     simulator.start(50); // 20 FPSS
 
         return app.exec();
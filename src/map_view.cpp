@@ -3,6 +3,7 @@
 #include "overlay_ui.h"
 #include "vehicule.h"
 #include <QPainter>
+#include <QImage>
 #include <QWheelEvent>
 #include <QMouseEvent>
 #include <QKeyEvent>
@@ -11,12 +12,19 @@
 #include <QUrl>
 #include <QNetworkRequest>
 #include <QDateTime>
+#include <QStandardPaths>
 #include <QtMath>
-#include <QRandomGenerator>
 #include <algorithm>
 #include <cmath>
 
 #include "simulator.h"
+#include "gpu_map_layer.h"
+#include "profiler.h"
+
+#ifdef V2V_OPENGL
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#endif
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -26,7 +34,7 @@ static inline double deg2rad(double d){ return d * M_PI / 180.0; }
 static inline double rad2deg(double r){ return r * 180.0 / M_PI; }
 
 MapView::MapView(QWidget* parent)
-    : QWidget(parent), m_darkCache(1024), m_lightCache(1024) {
+    : MapViewBase(parent), m_darkCache(1024), m_lightCache(1024) {
     setFocusPolicy(Qt::StrongFocus);
     setMouseTracking(true);
     setAutoFillBackground(true);
@@ -40,6 +48,9 @@ MapView::MapView(QWidget* parent)
     // Initialiser le template de tuiles avec le thème sombre par défaut
     m_tilesTemplate = m_darkTilesTemplate;
 
+    // Cache disque: les tuiles déjà vues restent disponibles après un redémarrage ou hors ligne
+    setDiskCacheDirectory(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/tiles");
+
     // Créer l'overlay UI
     m_uiOverlay = new UIOverlay(this);
     m_uiOverlay->raise();  // S'assurer qu'il est au-dessus de la carte
@@ -134,6 +145,15 @@ MapView::MapView(QWidget* parent)
     });
 }
 
+MapView::~MapView() {
+#ifdef V2V_OPENGL
+    // Les tampons OpenGL se libèrent avec le contexte courant
+    makeCurrent();
+    m_gpuLayer.reset();
+    doneCurrent();
+#endif
+}
+
 void MapView::setSimulator(Simulator* sim) {
     m_simulator = sim;
     if (m_uiOverlay) {
@@ -164,9 +184,9 @@ void MapView::setSimulator(Simulator* sim) {
             
             // Connecter le bouton supprimer véhicule
             connect(m_uiOverlay, &UIOverlay::deleteTrackedVehicle, this, [this]() {
-                if (m_trackedVehicle && m_simulator) {
-                    Vehicule* toDelete = m_trackedVehicle;
-                    m_trackedVehicle = nullptr;
+                if (m_trackedVehicleId >= 0 && m_simulator) {
+                    Vehicule* toDelete = m_simulator->findVehicle(m_trackedVehicleId);
+                    m_trackedVehicleId = -1;
                     m_followingVehicle = false;
                     m_uiOverlay->showDeleteVehicleButton(false);
                     m_simulator->removeVehicle(toDelete);
@@ -196,6 +216,11 @@ bool MapView::loadImage(const QString& path){
 
 void MapView::setTilesTemplate(const QString& pattern){
     m_tilesTemplate = pattern;
+    // Le cache mémoire est indexé par (thème, z, x, y), pas par URL: repartir de zéro
+    m_darkCache.clear();
+    m_lightCache.clear();
+    m_tileQueue.clear();
+    m_onDisk.clear();
     update();
 }
 
@@ -212,24 +237,86 @@ void MapView::setCenterLonLat(double lonDeg, double latDeg, int zoom){
     setCenterWorld(px, py, zoom);
 }
 
-void MapView::paintEvent(QPaintEvent*){
-    // Vérifier que le véhicule suivi existe toujours
-    if (m_followingVehicle && m_trackedVehicle && m_simulator) {
-        const auto& vehicles = m_simulator->vehicles();
-        bool found = std::find(vehicles.begin(), vehicles.end(), m_trackedVehicle) != vehicles.end();
-        if (!found) {
+#ifdef V2V_OPENGL
+void MapView::initializeGL() {
+    m_gpuLayer = std::make_unique<GpuMapLayer>();
+    if (!m_gpuLayer->initialize()) {
+        m_gpuLayer.reset();  // Repli sur le rendu QPainter
+    }
+    m_gpuRoadsUploaded = false;
+}
+
+void MapView::paintGL() {
+    QOpenGLFunctions* gl = context()->functions();
+    gl->glClearColor(30 / 255.0f, 30 / 255.0f, 30 / 255.0f, 1.0f);
+    gl->glClear(GL_COLOR_BUFFER_BIT);
+    renderFrame();
+}
+
+bool MapView::drawRoadsGpu(QPainter& p) {
+    if (!m_gpuLayer) return false;
+    if (!m_gpuRoadsUploaded) {
+        m_gpuLayer->setRoads(m_validRoads);  // VBO statique, envoyé une seule fois
+        m_gpuRoadsUploaded = true;
+    }
+    p.beginNativePainting();
+    m_gpuLayer->drawRoads({m_zoom, m_offsetX, m_offsetY, width(), height(), devicePixelRatioF()},
+                          QColor(138, 43, 226, 100));
+    p.endNativePainting();
+    return true;
+}
+
+bool MapView::drawRangesAndConnectionsGpu(QPainter& p, const InterferenceGraph& connections, double vehicleSize) {
+    if (!m_gpuLayer || !m_simulator) return false;
+    const GpuMapLayer::View view{m_zoom, m_offsetX, m_offsetY, width(), height(), devicePixelRatioF()};
+    const GpuMapLayer::VehicleStyle style{vehicleSize, m_darkTheme, m_showRanges, m_drawDirectConnections};
+    p.beginNativePainting();
+    m_gpuLayer->prepareVehicles(view, m_simulator->vehicleStore(), &connections, style);
+    m_gpuLayer->drawRangesAndConnections(view, style);
+    p.endNativePainting();
+    return true;
+}
+
+bool MapView::drawVehiclesGpu(QPainter& p, double vehicleSize) {
+    if (!m_gpuLayer) return false;
+    const GpuMapLayer::View view{m_zoom, m_offsetX, m_offsetY, width(), height(), devicePixelRatioF()};
+    const GpuMapLayer::VehicleStyle style{vehicleSize, m_darkTheme, m_showRanges, m_drawDirectConnections};
+    p.beginNativePainting();
+    m_gpuLayer->drawVehicles(view, style);
+    p.endNativePainting();
+    return true;
+}
+#else
+void MapView::paintEvent(QPaintEvent*) {
+    renderFrame();
+}
+
+bool MapView::drawRoadsGpu(QPainter&) { return false; }
+bool MapView::drawRangesAndConnectionsGpu(QPainter&, const InterferenceGraph&, double) { return false; }
+bool MapView::drawVehiclesGpu(QPainter&, double) { return false; }
+#endif
+
+void MapView::renderFrame(){
+    Profiler::ScopedTimer frameTimer(Profiler::Stage::Paint);
+    Profiler::add(Profiler::Counter::Frames);
+
+    // Vérifier que le véhicule suivi existe toujours (recherche O(1) par ID dans le store)
+    int trackedRow = -1;
+    if (m_followingVehicle && m_trackedVehicleId >= 0 && m_simulator) {
+        trackedRow = m_simulator->vehicleStore().rowOf(m_trackedVehicleId);
+        if (trackedRow < 0) {
             // Le véhicule a été supprimé
-            m_trackedVehicle = nullptr;
+            m_trackedVehicleId = -1;
             m_followingVehicle = false;
             if (m_uiOverlay) m_uiOverlay->showDeleteVehicleButton(false);
         }
     }
     
     // Update camera to follow tracked vehicle
-    if (m_followingVehicle && m_trackedVehicle) {
-        auto [vLat, vLon] = m_trackedVehicle->getPosition();  // getPosition retourne {lat, lon}
+    if (m_followingVehicle && trackedRow >= 0) {
+        const VehicleStore& store = m_simulator->vehicleStore();
         double px, py;
-        lonlatToPixel(vLon, vLat, m_zoom, px, py);
+        lonlatToPixel(store.lon[trackedRow], store.lat[trackedRow], m_zoom, px, py);
         m_offsetX = px - width() / 2.0;
         m_offsetY = py - height() / 2.0;
     }
@@ -254,25 +341,17 @@ void MapView::paintEvent(QPaintEvent*){
 
     // Dessiner les routes du graphe si activé
     if (m_showRoads && m_simulator) {
+        Profiler::ScopedTimer roadsTimer(Profiler::Stage::PaintRoads);
         // Pré-calculer les routes valides une seule fois
         if (!m_roadsPrecomputed) {
             const auto& graph = m_simulator->getGraph();
             m_validRoads.clear();
-            m_validRoads.reserve(boost::num_edges(graph) / 2);  // Estimation
-            
-            for (auto ep = boost::edges(graph); ep.first != ep.second; ++ep.first) {
-                Edge e = *ep.first;
-                if (!Vehicule::isValidRoad(graph[e].type)) continue;
-                
-                Vertex s = boost::source(e, graph);
-                Vertex t = boost::target(e, graph);
-                
-                RoadSegment seg;
-                seg.lon1 = graph[s].lon;
-                seg.lat1 = graph[s].lat;
-                seg.lon2 = graph[t].lon;
-                seg.lat2 = graph[t].lat;
-                m_validRoads.push_back(seg);
+
+            // Une route double sens a deux arêtes dans le graphe: ne la tracer qu'une fois
+            const auto segments = GraphBuilder::drivableSegments(graph);
+            m_validRoads.reserve(segments.size());
+            for (const auto& [from, to] : segments) {
+                m_validRoads.push_back({graph[from].lon, graph[from].lat, graph[to].lon, graph[to].lat});
             }
             m_roadsPrecomputed = true;
         }
@@ -286,19 +365,21 @@ void MapView::paintEvent(QPaintEvent*){
         p.setPen(QPen(QColor(138, 43, 226, 100), 2));
         p.setRenderHint(QPainter::Antialiasing, false);  // Désactiver AA pour performance
         
-        // Dessiner les routes visibles
-        for (const auto& seg : m_validRoads) {
-            // Test de visibilité rapide
-            if ((seg.lon1 < minLon && seg.lon2 < minLon) || 
-                (seg.lon1 > maxLon && seg.lon2 > maxLon) ||
-                (seg.lat1 < minLat && seg.lat2 < minLat) || 
-                (seg.lat1 > maxLat && seg.lat2 > maxLat)) {
-                continue;
-            }
+        // Dessiner les routes visibles (le GPU les trace toutes depuis son VBO)
+        if (!drawRoadsGpu(p)) {
+            for (const auto& seg : m_validRoads) {
+                // Test de visibilité rapide
+                if ((seg.lon1 < minLon && seg.lon2 < minLon) || 
+                    (seg.lon1 > maxLon && seg.lon2 > maxLon) ||
+                    (seg.lat1 < minLat && seg.lat2 < minLat) || 
+                    (seg.lat1 > maxLat && seg.lat2 > maxLat)) {
+                    continue;
+                }
             
-            QPointF p1 = lonLatToScreen(seg.lon1, seg.lat1);
-            QPointF p2 = lonLatToScreen(seg.lon2, seg.lat2);
-            p.drawLine(p1, p2);
+                QPointF p1 = lonLatToScreen(seg.lon1, seg.lat1);
+                QPointF p2 = lonLatToScreen(seg.lon2, seg.lat2);
+                p.drawLine(p1, p2);
+            }
         }
     }
 
@@ -384,36 +465,66 @@ void MapView::paintEvent(QPaintEvent*){
 
     //Draw vehicules on map
     if (m_simulator) {
-        const auto& vehicles = m_simulator->vehicles();
         const auto& interfGraph = m_simulator->interferenceGraph();
+        // Snapshot immuable du dernier graphe calculé (gardé en vie pendant le rendu)
+        std::shared_ptr<const InterferenceGraph> graphSnapshot = m_simulator->currentGraph();
+        const InterferenceGraph& connections = *graphSnapshot;
         
         // Calculer les limites de l'écran pour ne dessiner que les véhicules visibles
         double minLat, maxLat, minLon, maxLon;
         screenToLonLat(0, 0, minLon, maxLat);  // Coin haut-gauche
         screenToLonLat(width(), height(), maxLon, minLat);  // Coin bas-droit
         
-        // Filtrer les véhicules visibles
-        std::vector<Vehicule*> visibleVehicles;
-        for (auto* v : vehicles) {
-            if (!v) continue;
-            auto [lat, lon] = v->getPosition();
-            if (lat >= minLat && lat <= maxLat && lon >= minLon && lon <= maxLon) {
-                visibleVehicles.push_back(v);
+        // Vue d'ensemble: carte de densité construite par le worker avec le graphe.
+        // Ni filtrage ni dessin par véhicule: le coût ne dépend que du nombre de pixels.
+        // Sans carte publiée (juste après l'activation), rendu détaillé habituel.
+        const bool lod = m_densityLod && m_zoom <= LOD_MAX_ZOOM;
+        m_simulator->setDensityMap(lod);
+        m_simulator->setDensityZoom(m_zoom);
+        std::shared_ptr<const DensityGrid> density = lod ? m_simulator->currentDensity() : nullptr;
+        const bool heatmap = density && !density->empty();
+        
+        // Filtrer les véhicules visibles (positions lues dans les tableaux contigus du store)
+        const VehicleStore& store = m_simulator->vehicleStore();
+        auto isVisible = [&](size_t row) {
+            const double lat = store.lat[row];
+            const double lon = store.lon[row];
+            return lat >= minLat && lat <= maxLat && lon >= minLon && lon <= maxLon;
+        };
+        std::vector<int>& visibleRows = m_visibleRows;
+        visibleRows.clear();
+        for (size_t i = 0; i < store.size() && !heatmap; ++i) {
+            if (isVisible(i)) {
+                visibleRows.push_back(static_cast<int>(i));
             }
         }
         
         // Seuil: ne dessiner les détails que s'il y a moins de 500 véhicules visibles
-        bool drawDetails = visibleVehicles.size() < 500;
+        bool drawDetails = !heatmap && visibleRows.size() < 500;
+
+        // Taille des véhicules: points pour zoom <= 12, SVG orientés au-delà
+        double pointSize = std::max(2.0, 3.0 + (m_zoom - 8) * 0.5);  // 2-5 pixels selon zoom
+        double zoomFactor = std::pow(1.15, m_zoom - 16);  // Zoom 14 = taille normale
+        double vehicleSize = m_zoom <= 12 ? 2.0 * pointSize
+                                          : std::clamp(16.0 * zoomFactor, 6.0, 100.0);  // Min 6, Max 100 pixels
+
+        Profiler::ScopedTimer connectionsTimer(Profiler::Stage::PaintConnections);
+
+        if (heatmap) {
+            drawDensityMap(p, *density);
+        }
+
+        // Rendu OpenGL: rayons et connexions directes de toute la flotte, sans seuil
+        const bool gpu = !heatmap && drawRangesAndConnectionsGpu(p, connections, vehicleSize);
 
         // Dessiner les rayons de transmission si activé et peu de véhicules visibles
-        if (m_showRanges && drawDetails) {
+        if (m_showRanges && drawDetails && !gpu) {
             QColor rangeColor = m_darkTheme ? QColor(100, 200, 220, 80) : QColor(0, 180, 255, 110); // cyan vif
             QColor rangeFill = m_darkTheme ? QColor(100, 200, 220, 5) : QColor(0, 180, 255, 40);
-            for (auto* v : visibleVehicles) {
-                auto [lat, lon] = v->getPosition();
-                QPointF pt = lonLatToScreen(lon, lat);
-                double range = v->getTransmissionRange();
-                double mpp = metersPerPixelAtLat(lat);
+            for (int row : visibleRows) {
+                QPointF pt = lonLatToScreen(store.lon[row], store.lat[row]);
+                double range = store.range[row];
+                double mpp = metersPerPixelAtLat(store.lat[row]);
                 double radiusPixels = range / mpp;
                 QPen rangePen(rangeColor);
                 rangePen.setWidth(1);
@@ -424,7 +535,7 @@ void MapView::paintEvent(QPaintEvent*){
         }
 
         // Dessiner les connexions si peu de véhicules visibles (augmenté à 500)
-        if (drawDetails && visibleVehicles.size() < 500) {
+        if (drawDetails && visibleRows.size() < 500) {
             // Dessiner d'abord les connexions transitives (lignes bleues pointillées) si activé
             if (m_showTransitiveConnections) {
                 QColor transitiveColor = m_darkTheme ? QColor(147, 112, 219, 120) : QColor(180, 0, 255, 140); // violet vif
@@ -432,57 +543,49 @@ void MapView::paintEvent(QPaintEvent*){
                 transitivePen.setWidth(1);
                 transitivePen.setStyle(Qt::DashLine);
                 p.setPen(transitivePen);
-                for (auto* v : visibleVehicles) {
-                    auto directNeighbors = interfGraph.getDirectNeighbors(v->getId());
-                    auto allReachable = interfGraph.getReachableVehicles(v->getId());
-                    auto [lat1, lon1] = v->getPosition();
-                    QPointF pt1 = lonLatToScreen(lon1, lat1);
+                std::vector<QLineF> transitiveLines;
+                for (int visibleRow : visibleRows) {
+                    const int id = store.ids[visibleRow];
+                    auto directNeighbors = connections.getDirectNeighbors(id);
+                    auto allReachable = connections.getReachableVehicles(id);
+                    QPointF pt1 = lonLatToScreen(store.lon[visibleRow], store.lat[visibleRow]);
                     for (int reachableId : allReachable) {
-                        if (directNeighbors.find(reachableId) != directNeighbors.end()) {
+                        if (id >= reachableId || directNeighbors.find(reachableId) != directNeighbors.end()) {
                             continue;
                         }
-                        for (auto* reachable : vehicles) {
-                            if (reachable && reachable->getId() == reachableId) {
-                                auto [lat2, lon2] = reachable->getPosition();
-                                QPointF pt2 = lonLatToScreen(lon2, lat2);
-                                if (v->getId() < reachableId) {
-                                    p.drawLine(pt1, pt2);
-                                }
-                                break;
-                            }
-                        }
+                        const int row = store.rowOf(reachableId);
+                        if (row < 0) continue;  // Supprimé depuis le calcul du graphe
+                        transitiveLines.emplace_back(pt1, lonLatToScreen(store.lon[row], store.lat[row]));
                     }
                 }
+                p.drawLines(transitiveLines.data(), static_cast<int>(transitiveLines.size()));
             }
 
-            // Dessiner ensuite les connexions directes (lignes bleues) si activé
-            if (m_drawDirectConnections) {
+            // Dessiner ensuite les connexions directes (lignes bleues) si activé:
+            // liste d'arêtes à plat du graphe, positions courantes lues dans le store
+            if (m_drawDirectConnections && !gpu) {
                 QColor connectionColor = m_darkTheme ? QColor(135, 206, 235, 150) : QColor(0, 120, 255, 200); // bleu vif
                 QPen connectionPen(connectionColor);
                 connectionPen.setWidth(2);
                 p.setPen(connectionPen);
-                for (auto* v : visibleVehicles) {
-                    auto directNeighbors = interfGraph.getDirectNeighbors(v->getId());
-                    auto [lat1, lon1] = v->getPosition();
-                    QPointF pt1 = lonLatToScreen(lon1, lat1);
-                    for (int neighborId : directNeighbors) {
-                        for (auto* neighbor : vehicles) {
-                            if (neighbor && neighbor->getId() == neighborId) {
-                                auto [lat2, lon2] = neighbor->getPosition();
-                                QPointF pt2 = lonLatToScreen(lon2, lat2);
-                                if (v->getId() < neighborId) {
-                                    p.drawLine(pt1, pt2);
-                                }
-                                break;
-                            }
-                        }
-                    }
+                std::vector<QLineF> connectionLines;
+                for (const DirectEdge& edge : connections.getDirectEdges()) {
+                    const int row1 = store.rowOf(edge.id1);
+                    const int row2 = store.rowOf(edge.id2);
+                    if (row1 < 0 || row2 < 0) continue;  // Supprimé depuis le calcul du graphe
+                    if (!isVisible(row1) && !isVisible(row2)) continue;
+                    connectionLines.emplace_back(lonLatToScreen(store.lon[row1], store.lat[row1]),
+                                                 lonLatToScreen(store.lon[row2], store.lat[row2]));
                 }
+                p.drawLines(connectionLines.data(), static_cast<int>(connectionLines.size()));
             }
         }
 
+        connectionsTimer.stop();
+
         // Dessiner les antennes DERRIÈRE les véhicules
         if (interfGraph.isSpatialOptimizationEnabled()) {
+            Profiler::ScopedTimer antennasTimer(Profiler::Stage::PaintAntennas);
             const auto& spatialGrid = interfGraph.getSpatialGrid();
             const auto& macroAntennas = spatialGrid.getMacroAntennas();
             const auto& microAntennas = spatialGrid.getMicroAntennas();
@@ -540,39 +643,38 @@ void MapView::paintEvent(QPaintEvent*){
         // Dessiner les véhicules
         // Si zoom <= 12, dessiner en simples points colorés pour performance
         // Sinon, utiliser les SVG orientés
-        if (m_zoom <= 12) {
+        Profiler::ScopedTimer vehiclesTimer(Profiler::Stage::PaintVehicles);
+        const bool gpuVehicles = !heatmap && drawVehiclesGpu(p, vehicleSize);
+        Profiler::add(Profiler::Counter::VehiclesDrawn,
+                      static_cast<int64_t>(gpuVehicles ? store.size() : visibleRows.size()));
+        if (heatmap) {
+            // Véhicules représentés par la carte de densité
+        } else if (gpuVehicles) {
+            // Quads instanciés préparés avec les connexions
+        } else if (m_zoom <= 12) {
             // Mode points simples pour zoom faible
-            double pointSize = std::max(2.0, 3.0 + (m_zoom - 8) * 0.5);  // 2-5 pixels selon zoom
-            for (auto* v : visibleVehicles) {
-                auto [lat, lon] = v->getPosition();
-                QPointF pt = lonLatToScreen(lon, lat);
-                QRandomGenerator gen(v->getId());
-                QColor vehicleColor = m_darkTheme
-                    ? QColor(gen.bounded(120, 220), gen.bounded(120, 220), gen.bounded(120, 220), 255)
-                    : QColor(gen.bounded(200, 255), gen.bounded(80, 255), gen.bounded(0, 255), 255); // couleurs vives
+            for (int row : visibleRows) {
+                QPointF pt = lonLatToScreen(store.lon[row], store.lat[row]);
+                QColor vehicleColor = VehicleRenderer::paletteColor(VehicleRenderer::paletteIndex(store.ids[row]), m_darkTheme);
                 p.setPen(Qt::NoPen);
                 p.setBrush(vehicleColor);
                 p.drawEllipse(pt, pointSize, pointSize);
             }
         } else {
             // Mode SVG orientés pour zoom >= 13
-            double baseSize = 16.0;  // Taille de base
-            double zoomFactor = std::pow(1.15, m_zoom - 16);  // Zoom 14 = taille normale
-            double vehicleSize = std::clamp(baseSize * zoomFactor, 6.0, 100.0);  // Min 6, Max 40 pixels
-            for (auto* v : visibleVehicles) {
-                auto [lat, lon] = v->getPosition();
-                QPointF pt = lonLatToScreen(lon, lat);
-                double heading = v->getHeading();
-                QRandomGenerator gen(v->getId());
-                QColor vehicleColor = m_darkTheme
-                    ? QColor(gen.bounded(120, 220), gen.bounded(120, 220), gen.bounded(120, 220), 255)
-                    : QColor(gen.bounded(200, 255), gen.bounded(80, 255), gen.bounded(0, 255), 255); // couleurs vives
-                VehicleRenderer::drawVehicle(p, pt, heading, vehicleColor, vehicleSize);
+            // Un seul blit depuis l'atlas des teintes pour tous les véhicules visibles
+            std::vector<VehicleRenderer::Sprite> sprites;
+            sprites.reserve(visibleRows.size());
+            for (int row : visibleRows) {
+                sprites.push_back({lonLatToScreen(store.lon[row], store.lat[row]), store.heading[row],
+                                   VehicleRenderer::paletteIndex(store.ids[row])});
             }
+            VehicleRenderer::drawVehicles(p, sprites, m_darkTheme, vehicleSize);
         }
     }
 
     // Mettre à jour les stats et infos de l'UI overlay
+    Profiler::ScopedTimer hudTimer(Profiler::Stage::PaintHud);
     if (m_uiOverlay) {
         m_uiOverlay->updateStats();
         
@@ -585,6 +687,19 @@ void MapView::paintEvent(QPaintEvent*){
     drawHUD(p);
 }
 
+void MapView::drawDensityMap(QPainter& p, const DensityGrid& grid){
+    // Cellules de cellPixels pixels au zoom de la grille: mise à l'échelle si le zoom a changé depuis
+    const double scale = std::pow(2.0, m_zoom - grid.zoom());
+    const double cell = grid.cellPixels() * scale;
+    const QRectF target(grid.originX() * scale - m_offsetX, grid.originY() * scale - m_offsetY,
+                        grid.cols() * cell, grid.rows() * cell);
+    // Image sur les couleurs précalculées par le worker, sans copie (la grille
+    // reste en vie pendant le dessin); lissage bilinéaire entre cellules
+    const QImage image(reinterpret_cast<const uchar*>(grid.pixels().data()), grid.cols(), grid.rows(),
+                       grid.cols() * static_cast<int>(sizeof(uint32_t)), QImage::Format_ARGB32);
+    p.drawImage(target, image);
+}
+
 void MapView::zoomAt(const QPoint& screenPos, double factor){
     int newZ = m_zoom + (factor > 1.0 ? +1 : -1);
     newZ = std::clamp(newZ, 0, 20);
@@ -627,7 +742,7 @@ void MapView::mouseMoveEvent(QMouseEvent* ev){
                 // Stop following vehicle when user drags the map
                 if (m_followingVehicle) {
                     m_followingVehicle = false;
-                    m_trackedVehicle = nullptr;
+                    m_trackedVehicleId = -1;
                     if (m_uiOverlay) m_uiOverlay->showDeleteVehicleButton(false);
                 }
             }
@@ -661,21 +776,22 @@ void MapView::mouseReleaseEvent(QMouseEvent* ev){
             double clickRadiusMeters = clickRadiusPx * metersPerPx;
             double CLICK_THRESHOLD = clickRadiusMeters / 111000.0;
             
-            Vehicule* closestVehicle = nullptr;
+            // Positions lues dans le store, véhicule retenu par son ID
+            const VehicleStore& store = m_simulator->vehicleStore();
+            int closestId = -1;
             double minDist = CLICK_THRESHOLD;
             
-            for (auto* v : m_simulator->vehicles()) {
-                auto [vLat, vLon] = v->getPosition();
-                double dist = std::hypot(vLon - clickLon, vLat - clickLat);
+            for (size_t i = 0; i < store.size(); ++i) {
+                double dist = std::hypot(store.lon[i] - clickLon, store.lat[i] - clickLat);
                 if (dist < minDist) {
                     minDist = dist;
-                    closestVehicle = v;
+                    closestId = store.ids[i];
                 }
             }
             
-            if (closestVehicle) {
+            if (closestId >= 0) {
                 // Clic sur un véhicule existant -> le suivre
-                m_trackedVehicle = closestVehicle;
+                m_trackedVehicleId = closestId;
                 m_followingVehicle = true;
                 if (m_uiOverlay) m_uiOverlay->showDeleteVehicleButton(true);
             } else {
@@ -710,6 +826,94 @@ void MapView::keyPressEvent(QKeyEvent* ev){
             update();
             break;
         }
+        case Qt::Key_G: {
+            // Basculer la broadphase: antennes K-means <-> grille uniforme
+            if (m_simulator) {
+                auto& interfGraph = m_simulator->interferenceGraph();
+                bool useGrid = interfGraph.getBroadphaseMode() != BroadphaseMode::UniformGrid;
+                interfGraph.setBroadphaseMode(useGrid ? BroadphaseMode::UniformGrid : BroadphaseMode::Antennas);
+                std::cout << "[MapView] Broadphase "
+                          << (useGrid ? "grille uniforme" : "antennes K-means") << std::endl;
+            }
+            update();
+            break;
+        }
+        case Qt::Key_I: {
+            // Graphe incrémental (listes de Verlet) <-> construction complète à chaque tick
+            if (m_simulator) {
+                bool incremental = !m_simulator->incrementalGraph();
+                m_simulator->setIncrementalGraph(incremental);
+                std::cout << "[MapView] Graphe "
+                          << (incremental ? "incrémental (listes de Verlet)" : "reconstruit à chaque tick") << std::endl;
+            }
+            break;
+        }
+        case Qt::Key_P: {
+            // Politique du pipeline quand le graphe est en retard: Coalesce -> Drop -> Block
+            if (m_simulator) {
+                BackpressurePolicy policy = m_simulator->backpressurePolicy();
+                const char* name = "coalesce";
+                if (policy == BackpressurePolicy::Coalesce) {
+                    policy = BackpressurePolicy::Drop;
+                    name = "drop";
+                } else if (policy == BackpressurePolicy::Drop) {
+                    policy = BackpressurePolicy::Block;
+                    name = "block";
+                } else {
+                    policy = BackpressurePolicy::Coalesce;
+                }
+                m_simulator->setBackpressurePolicy(policy);
+                std::cout << "[MapView] Pipeline du graphe: " << name << std::endl;
+            }
+            break;
+        }
+        case Qt::Key_M: {
+            // Propagation des messages: désactivée -> inondation -> gossip -> désactivée
+            if (m_simulator) {
+                MessageEngine& engine = m_simulator->messageEngine();
+                MessageEngineConfig config = engine.config();
+                const char* name = "désactivée";
+                bool enable = true;
+                if (!m_simulator->messagePropagationEnabled()) {
+                    config.strategy = PropagationStrategy::Flooding;
+                    name = "inondation";
+                } else if (config.strategy == PropagationStrategy::Flooding) {
+                    config.strategy = PropagationStrategy::Gossip;
+                    name = "gossip";
+                } else {
+                    enable = false;
+                }
+                // Changer de stratégie repart de statistiques vierges
+                m_simulator->setMessagePropagation(false);
+                engine.setConfig(config);
+                m_simulator->setMessagePropagation(enable);
+                std::cout << "[MapView] Propagation des messages: " << name << std::endl;
+            }
+            break;
+        }
+        case Qt::Key_BracketLeft:
+        case Qt::Key_BracketRight: {
+            // Relecture: reculer / avancer de 200 ticks (trame complète la plus proche + différences)
+            if (m_simulator && m_simulator->isReplaying()) {
+                const uint64_t current = m_simulator->tickSequence();
+                const uint64_t jump = 200;
+                const uint64_t target = ev->key() == Qt::Key_BracketLeft
+                    ? (current > jump ? current - jump : 0)
+                    : current + jump;
+                m_simulator->seekReplay(target);
+                std::cout << "[MapView] Relecture au tick " << m_simulator->tickSequence() << std::endl;
+                update();
+            }
+            break;
+        }
+        case Qt::Key_H: {
+            // Carte de densité à faible zoom (zoom <= LOD_MAX_ZOOM) ou véhicules à tous les zooms
+            m_densityLod = !m_densityLod;
+            std::cout << "[MapView] Carte de densité à faible zoom "
+                      << (m_densityLod ? "activée" : "désactivée") << std::endl;
+            update();
+            break;
+        }
         case Qt::Key_L: {
             // Toggle low quality tiles mode
             m_lowQualityMode = !m_lowQualityMode;
@@ -755,128 +959,231 @@ QString MapView::buildUrl(int z,int x,int y) const{
     return u;
 }
 
-void MapView::requestTile(int z,int x,int y){
-    if(m_tilesTemplate.isEmpty()) return;
-    const QString url = buildUrl(z,x,y);
+void MapView::setDiskCacheDirectory(const QString& path, qint64 maxBytes){
+    if(!m_diskCache){
+        m_diskCache = new QNetworkDiskCache(this);
+        m_net.setCache(m_diskCache);  // m_net en prend possession
+    }
+    m_diskCache->setCacheDirectory(path);
+    m_diskCache->setMaximumCacheSize(maxBytes);
+    m_onDisk.clear();
+    std::cout << "[MapView] Cache disque des tuiles: " << path.toStdString()
+              << " (" << maxBytes / (1024 * 1024) << " Mo max)" << std::endl;
+}
+
+void MapView::queueTile(const TileKey& key, bool visible){
+    if(cacheFor(key.dark).contains(key.packed()) || m_inflight.contains(key)) return;
+    m_tileQueue.push_back({key, visible});
+}
+
+bool MapView::isTileOnDisk(const TileKey& key, const QString& url){
+    if(!m_diskCache) return false;
+    // metaData() lit le disque: une seule sonde par tuile, pas une par image
+    auto it = m_onDisk.constFind(key);
+    if(it != m_onDisk.constEnd()) return it.value();
+    if(m_onDisk.size() >= 16384) m_onDisk.clear();
+    const bool onDisk = m_diskCache->metaData(QUrl(url)).isValid();
+    m_onDisk.insert(key, onDisk);
+    return onDisk;
+}
 
-    if(QPixmap* cached = getActiveCache().object(url)){
+void MapView::pumpTileRequests(){
+    if(m_tilesTemplate.isEmpty()){
+        m_tileQueue.clear();
         return;
     }
 
-    TileKey key{z,x,y};
-    if(m_inflight.contains(key)) return;
+    // Le préchargement laisse toujours deux places libres pour les tuiles visibles
+    const int prefetchLimit = std::max(1, m_maxInflightRequests - 2);
+    std::vector<TileRequest> remaining;
+    for(const TileRequest& request : m_tileQueue){
+        const TileKey& key = request.key;
+        if(cacheFor(key.dark).contains(key.packed()) || m_inflight.contains(key)) continue;
+        if(key.dark != m_darkTheme) continue;  // Demande d'avant un changement de thème
+
+        const int limit = request.visible ? m_maxInflightRequests : prefetchLimit;
+        if(m_inflight.size() >= limit){
+            remaining.push_back(request);
+            continue;
+        }
 
-    if(url.startsWith("file://")){
-        const QString path = QUrl(url).toLocalFile();
-        if(QFileInfo::exists(path)){
-            QPixmap* px = new QPixmap();
-            if(px->load(path)){
-                getActiveCache().insert(url, px);
-                update();
-            } else delete px;
+        const QString url = buildUrl(key.z, key.x, key.y);
+        if(url.startsWith("file://")){
+            const QString path = QUrl(url).toLocalFile();
+            if(QFileInfo::exists(path)){
+                QPixmap* px = new QPixmap();
+                if(px->load(path)){
+                    cacheFor(key.dark).insert(key.packed(), px);
+                    update();
+                } else delete px;
+            }
+            continue;
         }
-        return;
-    }
 
-    const qint64 now  = QDateTime::currentMSecsSinceEpoch();
-    const qint64 wait = m_minRequestIntervalMs - (now - m_lastRequestMs);
-    if (wait > 0) {
-        QTimer::singleShot(int(wait), this, [this, z, x, y](){ requestTile(z, x, y); });
-        return;
+        // Limite de débit réservée au réseau: une tuile du cache disque part tout de suite
+        const bool onDisk = isTileOnDisk(key, url);
+        if(!onDisk){
+            const qint64 now  = QDateTime::currentMSecsSinceEpoch();
+            const qint64 wait = m_minRequestIntervalMs - (now - m_lastRequestMs);
+            if(wait > 0){
+                remaining.push_back(request);
+                if(!m_tilePumpScheduled){
+                    m_tilePumpScheduled = true;
+                    QTimer::singleShot(int(wait), this, [this](){
+                        m_tilePumpScheduled = false;
+                        pumpTileRequests();
+                    });
+                }
+                continue;
+            }
+            m_lastRequestMs = now;
+        }
+        startTileRequest(request, url, QNetworkRequest::PreferCache);
     }
-    m_lastRequestMs = now;
+    m_tileQueue.swap(remaining);
+}
 
+void MapView::startTileRequest(const TileRequest& request, const QString& url,
+                               QNetworkRequest::CacheLoadControl cacheControl){
     QNetworkRequest req{ QUrl{url} };
     req.setHeader(QNetworkRequest::UserAgentHeader, m_userAgent);
     req.setRawHeader("Referer", m_referer.toUtf8());
     req.setRawHeader("Cache-Control", "max-age=86400");
+    req.setAttribute(QNetworkRequest::CacheLoadControlAttribute, cacheControl);
+    req.setAttribute(QNetworkRequest::CacheSaveControlAttribute, true);
 
     QNetworkReply* rep = m_net.get(req);
-    m_inflight.insert(key, rep);
-
-    connect(rep, &QNetworkReply::finished, this, [this, url, key, rep](){
-        m_inflight.remove(key);
+    m_inflight.insert(request.key, rep);
+    Profiler::add(Profiler::Counter::TileRequests);
+    const int64_t startNs = Profiler::nowNs();
+
+    connect(rep, &QNetworkReply::finished, this, [this, request, url, cacheControl, rep, startNs](){
+        m_inflight.remove(request.key);
+        if (Profiler::isEnabled()) {
+            Profiler::record(Profiler::Stage::TileFetch, startNs, Profiler::nowNs() - startNs);
+        }
         if(rep->error()==QNetworkReply::NoError){
             QByteArray data = rep->readAll();
             QPixmap* px = new QPixmap();
             if(px->loadFromData(data)){
-                getActiveCache().insert(url, px);
+                m_onDisk.remove(request.key);  // Maintenant écrite au cache disque
+                cacheFor(request.key.dark).insert(request.key.packed(), px);
                 update();
             } else delete px;
+        } else {
+            Profiler::add(Profiler::Counter::TileErrors);
+            if(cacheControl != QNetworkRequest::AlwaysCache && isTileOnDisk(request.key, url)){
+                // Réseau indisponible: servir la copie du cache disque, même expirée
+                startTileRequest(request, url, QNetworkRequest::AlwaysCache);
+            }
         }
         rep->deleteLater();
+        pumpTileRequests();
     });
 }
 
-void MapView::drawTiles(QPainter& p){
-    const int T = 256;
-    
-    // Choisir le niveau de zoom des tuiles selon le mode
-    int tileZoom;
-    if (m_lowQualityMode) {
-        // Mode low quality : limiter les niveaux de zoom
-        if (m_zoom >= 13) {
-            tileZoom = 13;
-        } else if (m_zoom >= 10) {
-            tileZoom = 10;
-        } else if (m_zoom >= 8) {
-            tileZoom = 8;
-        } else if (m_zoom >= 4) {
-            tileZoom = 4;
-        } else {
-            tileZoom = (int)m_zoom;  // Zoom normal en dessous de 4
-        }
-    } else {
+int MapView::tileZoomFor(int zoom) const{
+    if (!m_lowQualityMode) {
         // Mode normal : utiliser le zoom actuel
-        tileZoom = (int)m_zoom;
+        return zoom;
     }
-    
-    const int n = 1 << tileZoom;
-    
+    // Mode low quality : limiter les niveaux de zoom
+    if (zoom >= 13) return 13;
+    if (zoom >= 10) return 10;
+    if (zoom >= 8) return 8;
+    if (zoom >= 4) return 4;
+    return zoom;  // Zoom normal en dessous de 4
+}
+
+void MapView::tileRange(int zoom, double offsetX, double offsetY, int tileZoom,
+                        int& x0, int& y0, int& x1, int& y1) const{
+    const int T = 256;
+
     // Adapter les coordonnées en fonction de la différence de zoom
-    int zoomDiff = (int)m_zoom - tileZoom;
+    int zoomDiff = zoom - tileZoom;
     int scale = 1 << std::abs(zoomDiff);
     
     int scaledOffsetX, scaledOffsetY;
     if (zoomDiff >= 0) {
-        // m_zoom >= tileZoom : diviser
-        scaledOffsetX = m_offsetX / scale;
-        scaledOffsetY = m_offsetY / scale;
+        // zoom >= tileZoom : diviser
+        scaledOffsetX = offsetX / scale;
+        scaledOffsetY = offsetY / scale;
     } else {
-        // m_zoom < tileZoom : multiplier
-        scaledOffsetX = m_offsetX * scale;
-        scaledOffsetY = m_offsetY * scale;
+        // zoom < tileZoom : multiplier
+        scaledOffsetX = offsetX * scale;
+        scaledOffsetY = offsetY * scale;
     }
 
-    int x0 = int(std::floor(scaledOffsetX / T));
-    int y0 = int(std::floor(scaledOffsetY / T));
-    int nx = int(std::ceil((scaledOffsetX + width() / scale) / T)) - x0;
-    int ny = int(std::ceil((scaledOffsetY + height() / scale) / T)) - y0;
+    // Bornes incluses
+    x0 = int(std::floor(scaledOffsetX / T));
+    y0 = int(std::floor(scaledOffsetY / T));
+    x1 = int(std::ceil((scaledOffsetX + width() / scale) / T));
+    y1 = int(std::ceil((scaledOffsetY + height() / scale) / T));
+}
+
+void MapView::drawTiles(QPainter& p){
+    Profiler::ScopedTimer timer(Profiler::Stage::PaintTiles);
+    const int T = 256;
+    
+    // Choisir le niveau de zoom des tuiles selon le mode
+    const int tileZoom = tileZoomFor(m_zoom);
+    const int n = 1 << tileZoom;
+    const int scale = 1 << std::abs(m_zoom - tileZoom);
+
+    int x0, y0, x1, y1;
+    tileRange(m_zoom, m_offsetX, m_offsetY, tileZoom, x0, y0, x1, y1);
 
     p.fillRect(rect(), QColor(20,20,20));
 
-    for(int dy=0; dy<=ny; ++dy){
-        for(int dx=0; dx<=nx; ++dx){
-            int tx = x0 + dx;
-            int ty = y0 + dy;
+    // File reconstruite à chaque image: les demandes devenues inutiles sont abandonnées
+    m_tileQueue.clear();
 
+    for(int ty = y0; ty <= y1; ++ty){
+        for(int tx = x0; tx <= x1; ++tx){
             int txWrap = ((tx % n) + n) % n;
             if(ty < 0 || ty >= n) continue;
 
-            const QString url = buildUrl(tileZoom, txWrap, ty);
-            QPixmap* cached = getActiveCache().object(url);
+            const TileKey key{tileZoom, txWrap, ty, m_darkTheme};
+            QPixmap* cached = getActiveCache().object(key.packed());
             
             // Afficher la tuile à la taille correcte selon le zoom actuel
             QRectF target(tx*T*scale - m_offsetX, ty*T*scale - m_offsetY, T*scale, T*scale);
 
             if(!cached){
-                requestTile(tileZoom, txWrap, ty);
+                queueTile(key, true);
                 p.fillRect(target, QColor(60,60,60));
             } else {
                 p.drawPixmap(target, *cached, QRectF(0,0,T,T));
             }
         }
     }
+
+    // Préchargement: couronne d'une tuile autour de la vue
+    for(int ty = y0 - 1; ty <= y1 + 1; ++ty){
+        for(int tx = x0 - 1; tx <= x1 + 1; ++tx){
+            const bool inside = ty >= y0 && ty <= y1 && tx >= x0 && tx <= x1;
+            if(inside || ty < 0 || ty >= n) continue;
+            queueTile({tileZoom, ((tx % n) + n) % n, ty, m_darkTheme}, false);
+        }
+    }
+
+    // Puis le niveau de zoom suivant, autour du même centre
+    const int nextTileZoom = m_zoom < 20 ? tileZoomFor(m_zoom + 1) : tileZoom;
+    if(nextTileZoom != tileZoom){
+        const int nextN = 1 << nextTileZoom;
+        const double nextOffsetX = (m_offsetX + width() / 2.0) * 2.0 - width() / 2.0;
+        const double nextOffsetY = (m_offsetY + height() / 2.0) * 2.0 - height() / 2.0;
+        int nx0, ny0, nx1, ny1;
+        tileRange(m_zoom + 1, nextOffsetX, nextOffsetY, nextTileZoom, nx0, ny0, nx1, ny1);
+        for(int ty = ny0; ty <= ny1; ++ty){
+            if(ty < 0 || ty >= nextN) continue;
+            for(int tx = nx0; tx <= nx1; ++tx){
+                queueTile({nextTileZoom, ((tx % nextN) + nextN) % nextN, ty, m_darkTheme}, false);
+            }
+        }
+    }
+
+    pumpTileRequests();
 }
 
 void MapView::drawHUD(QPainter& p){
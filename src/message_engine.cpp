@@ -0,0 +1,248 @@
+#include "message_engine.h"
+#include <algorithm>
+#include <cmath>
+#include "profiler.h"
+
+double MessageStats::latencyPercentileMs(double p) const {
+    uint64_t total = 0;
+    for (uint64_t count : latencyHistogram) total += count;
+    if (total == 0) return 0.0;
+
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(p / 100.0 * total)));
+    uint64_t cumulative = 0;
+    for (int bin = 0; bin < HISTOGRAM_BINS; ++bin) {
+        cumulative += latencyHistogram[bin];
+        if (cumulative >= rank) return (bin + 1) * histogramBinMs;
+    }
+    return HISTOGRAM_BINS * histogramBinMs;
+}
+
+MessageEngine::MessageEngine(const MessageEngineConfig& config)
+    : m_rng(config.seed) {
+    setConfig(config);
+    resetStats();
+}
+
+uint64_t MessageEngine::probabilityThreshold(double p) {
+    if (!(p > 0.0)) return 0;
+    if (p >= 1.0) return UINT64_MAX;
+    return static_cast<uint64_t>(std::ldexp(p, 64));
+}
+
+void MessageEngine::setConfig(const MessageEngineConfig& config) {
+    const bool inboxChanged = config.inboxCapacity != m_config.inboxCapacity;
+    const bool binsChanged = config.histogramBinMs != m_config.histogramBinMs;
+    m_config = config;
+    m_config.inboxCapacity = std::max(1, m_config.inboxCapacity);
+    drawNextLoss();
+    m_gossipThreshold = m_config.strategy == PropagationStrategy::Flooding
+        ? UINT64_MAX : probabilityThreshold(m_config.gossipProbability);
+    if (inboxChanged) {
+        m_inboxes.assign(m_inboxCounts.size() * m_config.inboxCapacity, InboxEntry());
+        std::fill(m_inboxCounts.begin(), m_inboxCounts.end(), 0);
+    }
+    if (binsChanged) {
+        resetStats();
+    }
+}
+
+void MessageEngine::clear() {
+    m_events = decltype(m_events)();
+    for (uint32_t slot = 0; slot < m_messages.size(); ++slot) {
+        if (m_messages[slot].pending > 0) {
+            m_messages[slot].pending = 0;
+            releaseMessage(slot);
+        }
+    }
+    m_active = 0;
+    m_channelFreeMs.clear();
+    m_inboxes.clear();
+    m_inboxCounts.clear();
+    m_rng.seed(m_config.seed);
+    drawNextLoss();
+    m_now = 0.0;
+    m_nextMessageId = 1;
+    m_nextSequence = 0;
+    resetStats();
+}
+
+void MessageEngine::resetStats() {
+    m_stats = MessageStats();
+    m_stats.histogramBinMs = m_config.histogramBinMs;
+}
+
+void MessageEngine::drawNextLoss() {
+    const double p = m_config.lossProbability;
+    if (!(p > 0.0)) {
+        m_receptionsUntilLoss = UINT64_MAX;
+    } else if (p >= 1.0) {
+        m_receptionsUntilLoss = 0;
+    } else {
+        m_receptionsUntilLoss = std::geometric_distribution<uint64_t>(p)(m_rng);
+    }
+}
+
+bool MessageEngine::nextReceptionLost() {
+    if (m_receptionsUntilLoss == UINT64_MAX) return false;
+    if (m_receptionsUntilLoss > 0) {
+        m_receptionsUntilLoss--;
+        return false;
+    }
+    drawNextLoss();
+    return true;
+}
+
+uint32_t MessageEngine::acquireMessage() {
+    if (!m_freeSlots.empty()) {
+        const uint32_t slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+        return slot;
+    }
+    m_messages.emplace_back();
+    return static_cast<uint32_t>(m_messages.size() - 1);
+}
+
+void MessageEngine::releaseMessage(uint32_t slot) {
+    // Le bitset garde sa capacité pour le prochain message
+    Message& message = m_messages[slot];
+    std::fill(message.seen.begin(), message.seen.end(), 0);
+    message.reached = 0;
+    m_freeSlots.push_back(slot);
+}
+
+bool MessageEngine::markSeen(Message& message, int vehicleId) {
+    const size_t word = static_cast<size_t>(vehicleId) >> 6;
+    const uint64_t bit = uint64_t(1) << (vehicleId & 63);
+    if (word >= message.seen.size()) {
+        message.seen.resize(word + 1, 0);
+    }
+    if (message.seen[word] & bit) return false;
+    message.seen[word] |= bit;
+    return true;
+}
+
+uint64_t MessageEngine::broadcast(int originId, size_t fleetSize) {
+    if (originId < 0) return 0;
+
+    const uint32_t slot = acquireMessage();
+    Message& message = m_messages[slot];
+    message.id = m_nextMessageId++;
+    message.originId = originId;
+    message.createdMs = m_now;
+    message.fleetSize = fleetSize;
+    message.reached = 0;
+    message.pending = 0;
+    markSeen(message, originId);
+    m_active++;
+    m_stats.messagesCreated++;
+
+    transmit(slot, originId, 1);
+    return message.id;
+}
+
+void MessageEngine::broadcastRandom(const std::vector<int>& vehicleIds, int count) {
+    if (vehicleIds.empty()) return;
+    for (int i = 0; i < count; ++i) {
+        broadcast(vehicleIds[m_rng() % vehicleIds.size()], vehicleIds.size());
+    }
+}
+
+void MessageEngine::finishEvent(uint32_t slot) {
+    Message& message = m_messages[slot];
+    if (--message.pending > 0) return;
+
+    // Plus rien en vol: la portée du message est définitive
+    m_stats.messagesCompleted++;
+    if (message.fleetSize > 1) {
+        m_stats.reachSum += static_cast<double>(message.reached) / (message.fleetSize - 1);
+    }
+    m_active--;
+    releaseMessage(slot);
+}
+
+size_t MessageEngine::advanceTo(double timeMs, const InterferenceGraph& graph) {
+    Profiler::ScopedTimer timer(Profiler::Stage::MessagePropagation);
+    size_t processed = 0;
+    while (!m_events.empty() && m_events.top().timeMs <= timeMs) {
+        const Event event = m_events.top();
+        m_events.pop();
+        m_now = event.timeMs;
+        deliver(event, graph);
+        finishEvent(event.slot);
+        processed++;
+    }
+    m_now = std::max(m_now, timeMs);
+    m_stats.events += processed;
+    return processed;
+}
+
+void MessageEngine::transmit(uint32_t slot, int sender, int hops) {
+    if (static_cast<size_t>(sender) >= m_channelFreeMs.size()) {
+        m_channelFreeMs.resize(std::max<size_t>(sender + 1, 2 * m_channelFreeMs.size()), 0.0);
+    }
+
+    // Canal occupé par une diffusion précédente du même véhicule: attendre la fin
+    const double startMs = std::max(m_now, m_channelFreeMs[sender]);
+    const double endMs = startMs + m_config.airtimeMs;
+    m_channelFreeMs[sender] = endMs;
+    m_stats.transmissions++;
+
+    const double arrivalMs = endMs + m_config.hopDelayMs + m_config.hopJitterMs * m_unit(m_rng);
+    m_messages[slot].pending++;
+    m_events.push({arrivalMs, m_nextSequence++, slot, sender, hops});
+}
+
+void MessageEngine::deliver(const Event& event, const InterferenceGraph& graph) {
+    Message& message = m_messages[event.slot];
+    const int hops = event.hops;
+    const double latencyMs = event.timeMs - message.createdMs;
+    const bool canForward = hops < m_config.maxHops;
+
+    for (int neighbor : graph.getDirectNeighbors(event.senderId)) {
+        if (nextReceptionLost()) {
+            m_stats.lost++;
+            continue;
+        }
+        if (!markSeen(message, neighbor)) {
+            m_stats.duplicates++;
+            continue;
+        }
+
+        message.reached++;
+        m_stats.deliveries++;
+        m_stats.latencySumMs += latencyMs;
+        const int bin = std::min(MessageStats::HISTOGRAM_BINS - 1,
+                                 static_cast<int>(latencyMs / m_config.histogramBinMs));
+        m_stats.latencyHistogram[bin]++;
+        storeInInbox(neighbor, {message.id, message.originId, event.senderId, hops, latencyMs});
+
+        if (canForward && m_gossipThreshold != 0 && draw(m_gossipThreshold)) {
+            transmit(event.slot, neighbor, hops + 1);
+        }
+    }
+}
+
+void MessageEngine::storeInInbox(int vehicleId, const InboxEntry& entry) {
+    const size_t capacity = static_cast<size_t>(m_config.inboxCapacity);
+    if (static_cast<size_t>(vehicleId) >= m_inboxCounts.size()) {
+        const size_t size = std::max<size_t>(vehicleId + 1, 2 * m_inboxCounts.size());
+        m_inboxCounts.resize(size, 0);
+        m_inboxes.resize(size * capacity);
+    }
+    uint32_t& count = m_inboxCounts[vehicleId];
+    m_inboxes[vehicleId * capacity + count % capacity] = entry;
+    count++;
+}
+
+std::vector<InboxEntry> MessageEngine::inbox(int vehicleId) const {
+    std::vector<InboxEntry> entries;
+    if (vehicleId < 0 || static_cast<size_t>(vehicleId) >= m_inboxCounts.size()) return entries;
+
+    const size_t capacity = static_cast<size_t>(m_config.inboxCapacity);
+    const uint32_t count = m_inboxCounts[vehicleId];
+    const uint32_t kept = static_cast<uint32_t>(std::min<size_t>(count, capacity));
+    for (uint32_t k = count - kept; k < count; ++k) {
+        entries.push_back(m_inboxes[vehicleId * capacity + k % capacity]);
+    }
+    return entries;
+}
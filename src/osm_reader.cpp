@@ -1,11 +1,50 @@
 #include "osm_reader.h"
+#include "parallel_for.h"   // pour resolveThreadCount
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <osmium/io/any_input.hpp>
 #include <osmium/handler.hpp>
 #include <osmium/visitor.hpp>
+#include <osmium/index/id_set.hpp>
+#include <osmium/thread/pool.hpp>
 
 using namespace std;
 
+// ==========================================================
+// Fonctions utilitaires
+// ==========================================================
+
+// Sens de circulation d'un way: 1 = sens des nœuds, -1 = sens inverse, 0 = double sens
+static int parseOneway(const osmium::TagList& tags) {
+    const char* value = tags.get_value_by_key("oneway");
+    if (!value) return 0;
+    if (!strcmp(value, "yes") || !strcmp(value, "true") || !strcmp(value, "1")) return 1;
+    if (!strcmp(value, "-1") || !strcmp(value, "reverse")) return -1;
+    return 0;
+}
+
+// Remplit un OSMWay à partir d'un way osmium (sens unique inversé si oneway=-1)
+static OSMWay makeWay(const osmium::Way& w, RoadClass roadClass) {
+    OSMWay way;
+    way.id = w.id();
+    way.roadClass = roadClass;
+
+    // On stocke la liste des identifiants de nœuds qui composent la route
+    way.nodeRefs.reserve(w.nodes().size());
+    for (const auto& nr : w.nodes()) {
+        way.nodeRefs.push_back(nr.ref());
+    }
+
+    // oneway=-1: on inverse les nœuds pour que GraphBuilder insère v1 -> v2
+    int oneway = parseOneway(w.tags());
+    if (oneway < 0) {
+        reverse(way.nodeRefs.begin(), way.nodeRefs.end());
+    }
+    way.oneway = oneway != 0;
+    return way;
+}
+
 // ==========================================================
 // Classe interne : MyHandler
 // Sert à traiter les objets lus dans le fichier OSM
@@ -29,27 +68,61 @@ public:
 
     // Appelée automatiquement pour chaque <way> (route ou chemin)
     void way(const osmium::Way& w) noexcept {
-        OSMWay way;
-        way.id = w.id();
+        // type de route (Other si pas de tag highway)
+        const char* highway = w.tags().get_value_by_key("highway");
+        RoadClass roadClass = highway ? roadClassFromString(highway) : RoadClass::Other;
+
+        // On ajoute la route à la liste des ways
+        ways.push_back(makeWay(w, roadClass));
+    }
+};
+
+// ==========================================================
+// Classe interne : DrivableWayHandler (passe 1)
+// Garde uniquement les routes praticables et note leurs nœuds
+// ==========================================================
+class DrivableWayHandler : public osmium::handler::Handler {
+public:
+    vector<OSMWay>& ways;
+    osmium::index::IdSetDense<osmium::unsigned_object_id_type>& neededNodes;
+
+    DrivableWayHandler(vector<OSMWay>& w, osmium::index::IdSetDense<osmium::unsigned_object_id_type>& needed)
+        : ways(w), neededNodes(needed) {}
+
+    void way(const osmium::Way& w) {
+        const char* highway = w.tags().get_value_by_key("highway");
+        if (!highway) return;
+
+        RoadClass roadClass = roadClassFromString(highway);
+        if (!isDrivableRoad(roadClass)) return;
 
-        // On stocke la liste des identifiants de nœuds qui composent la route
         for (const auto& nr : w.nodes()) {
-            way.nodeRefs.push_back(nr.ref());
+            neededNodes.set(nr.positive_ref());
         }
+        ways.push_back(makeWay(w, roadClass));
+    }
+};
 
-        // On vérifie si la route est à sens unique
-        way.oneway = w.tags().has_tag("oneway", "yes");
+// ==========================================================
+// Classe interne : ReferencedNodeHandler (passe 2)
+// Garde uniquement les nœuds référencés par les routes de la passe 1
+// ==========================================================
+class ReferencedNodeHandler : public osmium::handler::Handler {
+public:
+    vector<OSMNode>& nodes;
+    const osmium::index::IdSetDense<osmium::unsigned_object_id_type>& neededNodes;
 
-        // type de route
-        if (w.tags().has_key("highway")) {
-            way.highwayType = w.tags().get_value_by_key("highway");
-        } else {
-            way.highwayType = "unknown";
-        }
-       // std::cout << "Way ID: " << way.id << " type: " << way.highwayType << std::endl;
+    ReferencedNodeHandler(vector<OSMNode>& n, const osmium::index::IdSetDense<osmium::unsigned_object_id_type>& needed)
+        : nodes(n), neededNodes(needed) {}
 
-        // On ajoute la route à la liste des ways
-        ways.push_back(way);
+    void node(const osmium::Node& n) {
+        if (!neededNodes.get(n.positive_id()) || !n.location().valid()) return;
+
+        OSMNode node;
+        node.id = n.id();
+        node.lat = n.location().lat();
+        node.lon = n.location().lon();
+        nodes.push_back(node);
     }
 };
 
@@ -57,24 +130,60 @@ public:
 // Méthodes de la classe OSMReader
 // ==========================================================
 
-// Constructeur : enregistre le chemin du fichier
-OSMReader::OSMReader(const string& path) : filePath(path) {}
+// Constructeur : enregistre le chemin du fichier et le mode de lecture
+OSMReader::OSMReader(const string& path, ReadMode readMode) : filePath(path), mode(readMode) {}
 
-// Lecture complète du fichier OSM
+// Lecture du fichier OSM selon le mode choisi
 void OSMReader::read() {
     try {
-        osmium::io::File file(filePath);
-        osmium::io::Reader reader(file);
+        if (mode == ReadMode::DrivableOnly) {
+            readDrivable();
+        } else {
+            readFull();
+        }
+        cout << "Lecture terminée sans erreur" << endl;
+    } catch (const exception& e) {
+        cerr << "Erreur lors de la lecture OSM : " << e.what() << endl;
+    }
+}
+
+// Lecture complète : tous les nodes et ways
+void OSMReader::readFull() {
+    osmium::thread::Pool pool(resolveThreadCount(threadCount));
+    osmium::io::File file(filePath);
+    osmium::io::Reader reader(file, pool, osmium::io::read_meta::no);
 
-        MyHandler handler(nodes, ways);
+    MyHandler handler(nodes, ways);
+
+    // Lance la lecture : appelle handler.node() et handler.way() automatiquement
+    osmium::apply(reader, handler);
+
+    reader.close();
+}
 
-        // Lance la lecture : appelle handler.node() et handler.way() automatiquement
+// Lecture filtrée en deux passes : routes praticables, puis leurs nœuds.
+// Le décodage des blocs PBF est réparti sur le pool de threads d'osmium;
+// les handlers restent appelés dans l'ordre du fichier, dans ce thread.
+void OSMReader::readDrivable() {
+    osmium::thread::Pool pool(resolveThreadCount(threadCount));
+    osmium::io::File file(filePath);
+    osmium::index::IdSetDense<osmium::unsigned_object_id_type> neededNodes;
+
+    // Passe 1 : ways seulement (les nodes ne sont pas décodés)
+    {
+        osmium::io::Reader reader(file, pool, osmium::osm_entity_bits::way, osmium::io::read_meta::no);
+        DrivableWayHandler handler(ways, neededNodes);
         osmium::apply(reader, handler);
+        reader.close();
+    }
 
+    // Passe 2 : nodes référencés seulement
+    nodes.reserve(neededNodes.size());
+    {
+        osmium::io::Reader reader(file, pool, osmium::osm_entity_bits::node, osmium::io::read_meta::no);
+        ReferencedNodeHandler handler(nodes, neededNodes);
+        osmium::apply(reader, handler);
         reader.close();
-        cout << "Lecture terminée sans erreur" << endl;
-    } catch (const exception& e) {
-        cerr << "Erreur lors de la lecture OSM : " << e.what() << endl;
     }
 }
 
@@ -1,12 +1,15 @@
 #include "overlay_ui.h"
 #include "simulator.h"
 #include "vehicule.h"
+#include "profiler.h"
 #include <QPainter>
 #include <QPainterPath>
 #include <QGraphicsBlurEffect>
 #include <QFile>
+#include <QFileDialog>
 #include <QCoreApplication>
 #include <QTransform>
+#include <iostream>
 
 // ============================================================================
 // Styles CSS globaux
@@ -491,6 +494,34 @@ void StatsPanel::setupUI() {
     layout->addWidget(createStatRow("Comparaisons/tick", m_comparisons, "#fbbf24"));
     layout->addWidget(createStatRow("Moy. voisins/véhicule", m_avgNeighbors, "#60a5fa"));
     layout->addWidget(createStatRow("Temps de calcul", m_buildTime, "#a78bfa"));
+    layout->addWidget(createStatRow("Retard du graphe", m_graphLatency, "#94a3b8"));
+    layout->addWidget(createStatRow("Handoffs/tick", m_handoffs, "#34d399"));
+    layout->addWidget(createStatRow("Liens +/−", m_edgeChanges, "#2dd4bf"));
+    layout->addWidget(createStatRow("Temps par image", m_frameTime, "#f87171"));
+    
+    // Répartition du temps par étape (moyennes glissantes du profileur)
+    m_frameBreakdown = new QLabel(this);
+    m_frameBreakdown->setStyleSheet("color: rgba(255,255,255,0.5); font-size: 11px; background: transparent; border: none;");
+    m_frameBreakdown->setWordWrap(true);
+    layout->addWidget(m_frameBreakdown);
+    
+    // Propagation des messages (touche M)
+    layout->addWidget(createStatRow("Portée des messages", m_messageReach, "#facc15"));
+    layout->addWidget(createStatRow("Latence p50 / p99", m_messageLatency, "#fb923c"));
+    layout->addWidget(createStatRow("Doublons", m_messageDuplicates, "#e879f9"));
+    m_messageReach->setText("désactivée");
+    m_messageLatency->setText("-");
+    m_messageDuplicates->setText("-");
+    m_messageHistogram = new QLabel(this);
+    m_messageHistogram->setStyleSheet("color: rgba(255,255,255,0.5); font-size: 11px; background: transparent; border: none;");
+    m_messageHistogram->setWordWrap(true);
+    layout->addWidget(m_messageHistogram);
+    
+    m_exportTraceBtn = new QPushButton("Exporter la trace (Chrome)", this);
+    m_exportTraceBtn->setStyleSheet(BUTTON_STYLE);
+    m_exportTraceBtn->setCursor(Qt::PointingHandCursor);
+    connect(m_exportTraceBtn, &QPushButton::clicked, this, &StatsPanel::exportTraceRequested);
+    layout->addWidget(m_exportTraceBtn);
     
     layout->addStretch();
 }
@@ -516,7 +547,7 @@ QWidget* StatsPanel::createStatRow(const QString& title, QLabel*& valueLabel, co
 
 void StatsPanel::updateStats(int activeVehicles, int connectedVehicles,
                              int totalConnections, double connectionRate,
-                             int comparisons, double avgNeighbors, double buildTimeMs) {
+                             qint64 comparisons, double avgNeighbors, double buildTimeMs) {
     m_activeVehicles->setText(QString::number(activeVehicles));
     m_connectedVehicles->setText(QString::number(connectedVehicles));
     m_totalConnections->setText(QString::number(totalConnections));
@@ -535,6 +566,53 @@ void StatsPanel::updateStats(int activeVehicles, int connectedVehicles,
     m_buildTime->setText(QString::number(buildTimeMs, 'f', 2) + " ms");
 }
 
+void StatsPanel::updateGraphLatency(int latencyTicks) {
+    m_graphLatency->setText(QString::number(latencyTicks) + (latencyTicks > 1 ? " ticks" : " tick"));
+}
+
+void StatsPanel::updateHandoffs(int handoffs) {
+    m_handoffs->setText(QString::number(handoffs));
+}
+
+void StatsPanel::updateEdgeChanges(int added, int removed) {
+    m_edgeChanges->setText(QString("+%1 / −%2").arg(added).arg(removed));
+}
+
+void StatsPanel::updateFrameProfile(double frameMs, const QString& breakdown) {
+    m_frameTime->setText(QString::number(frameMs, 'f', 2) + " ms");
+    m_frameBreakdown->setText(breakdown);
+}
+
+void StatsPanel::updateMessages(bool enabled, const QString& strategy, const MessageStats& stats) {
+    if (!enabled) {
+        m_messageReach->setText("désactivée");
+        m_messageLatency->setText("-");
+        m_messageDuplicates->setText("-");
+        m_messageHistogram->clear();
+        return;
+    }
+    
+    m_messageReach->setText(QString("%1% (%2)").arg(stats.meanReach() * 100.0, 0, 'f', 1).arg(strategy));
+    m_messageLatency->setText(QString("%1 / %2 ms").arg(stats.latencyPercentileMs(50.0), 0, 'f', 0)
+                                                    .arg(stats.latencyPercentileMs(99.0), 0, 'f', 0));
+    m_messageDuplicates->setText(QString::number(stats.duplicateRate() * 100.0, 'f', 1) + "%");
+    
+    // Histogramme des latences en barres de hauteur relative (une classe par caractère)
+    static const QString bars = QString::fromUtf8("▁▂▃▄▅▆▇█");
+    uint64_t peak = 0;
+    for (uint64_t count : stats.latencyHistogram) peak = std::max(peak, count);
+    QString histogram;
+    for (uint64_t count : stats.latencyHistogram) {
+        histogram += count == 0 ? QString(" ") : QString(bars[static_cast<int>((count * 7) / std::max<uint64_t>(peak, 1))]);
+    }
+    m_messageHistogram->setText(QString("Latences 0–%1 ms: %2\n%3 messages · %4 diffusions · %5 perdus")
+                                    .arg(MessageStats::HISTOGRAM_BINS * stats.histogramBinMs, 0, 'f', 0)
+                                    .arg(histogram)
+                                    .arg(stats.messagesCreated)
+                                    .arg(stats.transmissions)
+                                    .arg(stats.lost));
+}
+
 // ============================================================================
 // BottomMenu Implementation
 // ============================================================================
@@ -707,6 +785,18 @@ void UIOverlay::setupUI() {
     
     connect(m_deleteVehicleBtn, &QPushButton::clicked, this, &UIOverlay::deleteTrackedVehicle);
     
+    // Export des derniers échantillons du profileur (chrome://tracing, Perfetto)
+    connect(m_bottomMenu->statsPanel(), &StatsPanel::exportTraceRequested, this, [this]() {
+        const QString path = QFileDialog::getSaveFileName(this, "Exporter la trace", "v2v_trace.json",
+                                                          "Trace Chrome (*.json)");
+        if (path.isEmpty()) return;
+        if (Profiler::writeChromeTrace(path.toStdString())) {
+            std::cout << "[UIOverlay] Trace écrite dans " << path.toStdString() << std::endl;
+        } else {
+            std::cout << "[UIOverlay] Impossible d'écrire " << path.toStdString() << std::endl;
+        }
+    });
+    
     connect(m_menuToggleBtn, &QPushButton::clicked, m_bottomMenu, &BottomMenu::toggle);
     connect(m_bottomMenu, &BottomMenu::expansionChanged, this, [this](bool expanded) {
         updateToggleButtonIcon(expanded);
@@ -758,15 +848,17 @@ void UIOverlay::repositionElements() {
 void UIOverlay::updateStats() {
     if (!m_simulator) return;
     
-    const auto& vehicles = m_simulator->vehicles();
-    int active = vehicles.size();
+    // IDs du store: aussi valables en relecture, où vehicles() est vide
+    const auto& vehicleIds = m_simulator->vehicleStore().ids;
+    int active = vehicleIds.size();
     int connected = 0;
     int totalConnections = 0;
     
-    // Calculer les stats depuis le graphe d'interférence
-    const auto& interfGraph = m_simulator->getInterferenceGraph();
-    for (const auto* v : vehicles) {
-        auto neighbors = interfGraph.getDirectNeighbors(v->getId());
+    // Calculer les stats depuis le dernier graphe publié (sans copie)
+    std::shared_ptr<const InterferenceGraph> graphSnapshot = m_simulator->currentGraph();
+    const InterferenceGraph& interfGraph = *graphSnapshot;
+    for (int vehicleId : vehicleIds) {
+        auto neighbors = interfGraph.getDirectNeighbors(vehicleId);
         if (!neighbors.empty()) connected++;
         totalConnections += neighbors.size();
     }
@@ -775,12 +867,38 @@ void UIOverlay::updateStats() {
     double rate = active > 0 ? (connected * 100.0 / active) : 0;
     
     // Statistiques de performance
-    int comparisons = interfGraph.getLastComparisons();
+    qint64 comparisons = interfGraph.getLastComparisons();
     double avgNeighbors = interfGraph.getLastAvgNeighbors();
     double buildTimeMs = interfGraph.getLastBuildTimeMs();
     
     m_bottomMenu->statsPanel()->updateStats(active, connected, totalConnections, rate,
                                             comparisons, avgNeighbors, buildTimeMs);
+    m_bottomMenu->statsPanel()->updateGraphLatency(m_simulator->graphLatencyTicks());
+    m_bottomMenu->statsPanel()->updateHandoffs(m_simulator->lastHandoffCount());
+    m_bottomMenu->statsPanel()->updateEdgeChanges(static_cast<int>(interfGraph.getAddedEdges().size()),
+                                                  static_cast<int>(interfGraph.getRemovedEdges().size()));
+
+    // Répartition du temps: sections de l'image (GUI) puis étapes du tick et du worker
+    using Profiler::Stage;
+    auto stageList = [](std::initializer_list<Stage> stages) {
+        QStringList parts;
+        for (Stage stage : stages) {
+            parts << QString("%1 %2").arg(QString::fromUtf8(Profiler::stageName(stage)))
+                                     .arg(Profiler::averageMs(stage), 0, 'f', 1);
+        }
+        return parts.join(" · ");
+    };
+    const QString breakdown =
+        "Image: " + stageList({Stage::PaintTiles, Stage::PaintRoads, Stage::PaintConnections,
+                               Stage::PaintAntennas, Stage::PaintVehicles, Stage::PaintHud}) +
+        " ms\nTick: " + stageList({Stage::VehicleUpdate, Stage::Handoff, Stage::Snapshot, Stage::MessagePropagation}) +
+        " ms\nWorker: " + stageList({Stage::GraphBuild, Stage::Components, Stage::DensityGrid, Stage::GraphPublish}) + " ms";
+    m_bottomMenu->statsPanel()->updateFrameProfile(Profiler::averageMs(Stage::Paint), breakdown);
+
+    const MessageEngine& messages = m_simulator->messageEngine();
+    const bool gossip = messages.config().strategy == PropagationStrategy::Gossip;
+    m_bottomMenu->statsPanel()->updateMessages(m_simulator->messagePropagationEnabled(),
+                                               gossip ? "gossip" : "inondation", messages.stats());
 }
 
 void UIOverlay::updateMapInfo(int zoom, double lon, double lat) {
@@ -0,0 +1,206 @@
+#include "profiler.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+
+namespace Profiler {
+
+namespace {
+
+// Case du tampon circulaire: numéro de séquence impair pendant l'écriture,
+// 2 × (index + 1) une fois l'échantillon index écrit (principe du seqlock)
+struct Slot {
+    std::atomic<uint64_t> sequence{0};
+    std::atomic<int64_t> startNs{0};
+    std::atomic<int64_t> durationNs{0};
+    std::atomic<uint32_t> stageAndThread{0};
+};
+
+constexpr size_t RING_MASK = RING_CAPACITY - 1;
+static_assert((RING_CAPACITY & RING_MASK) == 0, "RING_CAPACITY doit être une puissance de deux");
+
+// Poids du dernier échantillon dans la moyenne glissante
+constexpr double AVERAGE_WEIGHT = 0.1;
+
+std::atomic<bool> g_enabled{true};
+std::atomic<uint64_t> g_head{0};
+std::array<Slot, RING_CAPACITY> g_ring;
+std::array<std::atomic<int64_t>, COUNTER_COUNT> g_counters{};
+std::array<std::atomic<int64_t>, STAGE_COUNT> g_lastNs{};
+std::array<std::atomic<double>, STAGE_COUNT> g_averageMs{};
+std::atomic<int> g_nextThread{0};
+
+const auto g_clockOrigin = std::chrono::steady_clock::now();
+
+int currentThread() {
+    thread_local const int thread = g_nextThread.fetch_add(1, std::memory_order_relaxed);
+    return thread;
+}
+
+} // namespace
+
+const char* stageName(Stage stage) {
+    switch (stage) {
+        case Stage::VehicleUpdate:    return "Mise à jour";
+        case Stage::Handoff:          return "Handoffs";
+        case Stage::Snapshot:         return "Snapshot";
+        case Stage::GraphBuild:       return "Graphe";
+        case Stage::Components:       return "Composantes";
+        case Stage::GraphPublish:     return "Publication";
+        case Stage::DensityGrid:      return "Densité";
+        case Stage::MessagePropagation: return "Messages";
+        case Stage::Paint:            return "Image";
+        case Stage::PaintTiles:       return "Tuiles";
+        case Stage::PaintRoads:       return "Routes";
+        case Stage::PaintConnections: return "Connexions";
+        case Stage::PaintAntennas:    return "Antennes";
+        case Stage::PaintVehicles:    return "Véhicules";
+        case Stage::PaintHud:         return "HUD";
+        case Stage::TileFetch:        return "Téléchargement tuile";
+        case Stage::Count:            break;
+    }
+    return "?";
+}
+
+const char* counterName(Counter counter) {
+    switch (counter) {
+        case Counter::Ticks:               return "ticks";
+        case Counter::DistanceComparisons: return "comparisons";
+        case Counter::Handoffs:            return "handoffs";
+        case Counter::DroppedGraphJobs:    return "dropped_graph_jobs";
+        case Counter::Frames:              return "frames";
+        case Counter::VehiclesDrawn:       return "vehicles_drawn";
+        case Counter::TileRequests:        return "tile_requests";
+        case Counter::TileErrors:          return "tile_errors";
+        case Counter::Count:               break;
+    }
+    return "?";
+}
+
+void setEnabled(bool enabled) {
+    g_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool isEnabled() {
+    return g_enabled.load(std::memory_order_relaxed);
+}
+
+int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - g_clockOrigin).count();
+}
+
+void record(Stage stage, int64_t startNs, int64_t durationNs) {
+    if (stage >= Stage::Count) return;
+    const size_t s = static_cast<size_t>(stage);
+
+    // Réserver une case puis l'écrire sans verrou
+    const uint64_t index = g_head.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = g_ring[index & RING_MASK];
+    slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.startNs.store(startNs, std::memory_order_relaxed);
+    slot.durationNs.store(durationNs, std::memory_order_relaxed);
+    slot.stageAndThread.store(static_cast<uint32_t>(s) | (static_cast<uint32_t>(currentThread()) << 8),
+                              std::memory_order_relaxed);
+    slot.sequence.store(2 * index + 2, std::memory_order_release);
+
+    g_lastNs[s].store(durationNs, std::memory_order_relaxed);
+    const double ms = durationNs / 1e6;
+    double average = g_averageMs[s].load(std::memory_order_relaxed);
+    double updated;
+    do {
+        updated = average == 0.0 ? ms : average + AVERAGE_WEIGHT * (ms - average);
+    } while (!g_averageMs[s].compare_exchange_weak(average, updated, std::memory_order_relaxed));
+}
+
+void add(Counter c, int64_t delta) {
+    if (c >= Counter::Count) return;
+    g_counters[static_cast<size_t>(c)].fetch_add(delta, std::memory_order_relaxed);
+}
+
+int64_t counter(Counter c) {
+    if (c >= Counter::Count) return 0;
+    return g_counters[static_cast<size_t>(c)].load(std::memory_order_relaxed);
+}
+
+double lastMs(Stage stage) {
+    if (stage >= Stage::Count) return 0.0;
+    return g_lastNs[static_cast<size_t>(stage)].load(std::memory_order_relaxed) / 1e6;
+}
+
+double averageMs(Stage stage) {
+    if (stage >= Stage::Count) return 0.0;
+    return g_averageMs[static_cast<size_t>(stage)].load(std::memory_order_relaxed);
+}
+
+std::vector<Sample> samples() {
+    const uint64_t head = g_head.load(std::memory_order_acquire);
+    const uint64_t first = head > RING_CAPACITY ? head - RING_CAPACITY : 0;
+
+    std::vector<Sample> result;
+    result.reserve(static_cast<size_t>(head - first));
+    for (uint64_t index = first; index < head; ++index) {
+        const Slot& slot = g_ring[index & RING_MASK];
+        const uint64_t before = slot.sequence.load(std::memory_order_acquire);
+        if (before != 2 * index + 2) continue;  // Pas encore écrite ou déjà recouverte
+
+        Sample sample;
+        sample.startNs = slot.startNs.load(std::memory_order_relaxed);
+        sample.durationNs = slot.durationNs.load(std::memory_order_relaxed);
+        const uint32_t packed = slot.stageAndThread.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != before) continue;
+
+        sample.stage = static_cast<Stage>(packed & 0xFFu);
+        sample.thread = static_cast<int>(packed >> 8);
+        result.push_back(sample);
+    }
+    return result;
+}
+
+bool writeChromeTrace(const std::string& path) {
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) return false;
+
+    const std::vector<Sample> events = samples();
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    // Événements complets ("X"), horodatés en microsecondes
+    int64_t lastNs = 0;
+    bool first = true;
+    for (const Sample& e : events) {
+        out << (first ? "\n" : ",\n");
+        first = false;
+        out << "{\"name\":\"" << stageName(e.stage) << "\",\"cat\":\"v2v\",\"ph\":\"X\""
+            << ",\"ts\":" << e.startNs / 1e3 << ",\"dur\":" << e.durationNs / 1e3
+            << ",\"pid\":1,\"tid\":" << e.thread << "}";
+        lastNs = std::max(lastNs, e.startNs + e.durationNs);
+    }
+
+    // Valeurs finales des compteurs ("C")
+    out << (first ? "\n" : ",\n") << "{\"name\":\"counters\",\"ph\":\"C\",\"ts\":" << lastNs / 1e3
+        << ",\"pid\":1,\"args\":{";
+    for (size_t c = 0; c < COUNTER_COUNT; ++c) {
+        out << (c > 0 ? "," : "") << "\"" << counterName(static_cast<Counter>(c)) << "\":"
+            << g_counters[c].load(std::memory_order_relaxed);
+    }
+    out << "}}\n]}\n";
+    return static_cast<bool>(out);
+}
+
+void reset() {
+    // Invalider les cases existantes, puis repartir d'un tampon vide
+    for (Slot& slot : g_ring) slot.sequence.store(0, std::memory_order_relaxed);
+    g_head.store(0, std::memory_order_release);
+    for (auto& c : g_counters) c.store(0, std::memory_order_relaxed);
+    for (auto& v : g_lastNs) v.store(0, std::memory_order_relaxed);
+    for (auto& v : g_averageMs) v.store(0.0, std::memory_order_relaxed);
+}
+
+} // namespace Profiler
@@ -0,0 +1,31 @@
+#include "road_class.h"
+#include <unordered_map>
+
+// Noms OSM, dans l'ordre de l'enum RoadClass
+static const char* const ROAD_CLASS_NAMES[] = {
+    "motorway", "trunk", "primary", "secondary", "tertiary",
+    "motorway_link", "trunk_link", "primary_link", "secondary_link", "tertiary_link",
+    "unclassified", "road", "residential", "living_street", "service", "track",
+    "footway", "cycleway", "path", "pedestrian", "steps", "other"
+};
+static_assert(sizeof(ROAD_CLASS_NAMES) / sizeof(ROAD_CLASS_NAMES[0]) == static_cast<size_t>(RoadClass::Count),
+              "ROAD_CLASS_NAMES doit suivre l'enum RoadClass");
+
+RoadClass roadClassFromString(const std::string& highwayType) {
+    // Appelé une seule fois par way lors de la construction du graphe
+    static const std::unordered_map<std::string, RoadClass> lookup = [] {
+        std::unordered_map<std::string, RoadClass> table;
+        for (size_t i = 0; i < static_cast<size_t>(RoadClass::Other); ++i) {
+            table.emplace(ROAD_CLASS_NAMES[i], static_cast<RoadClass>(i));
+        }
+        return table;
+    }();
+
+    auto it = lookup.find(highwayType);
+    return it != lookup.end() ? it->second : RoadClass::Other;
+}
+
+const char* roadClassName(RoadClass c) {
+    size_t index = static_cast<size_t>(c);
+    return index < static_cast<size_t>(RoadClass::Count) ? ROAD_CLASS_NAMES[index] : "other";
+}
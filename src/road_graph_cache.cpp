@@ -0,0 +1,239 @@
+#include "road_graph_cache.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace {
+
+const char CACHE_MAGIC[8] = {'V', '2', 'V', 'G', 'R', 'P', 'H', '\0'};
+
+// Fichier projeté en lecture seule, libéré à la destruction
+class MappedFile {
+public:
+    explicit MappedFile(const string& path) {
+        m_fd = ::open(path.c_str(), O_RDONLY);
+        if (m_fd < 0) return;
+
+        struct stat st;
+        if (::fstat(m_fd, &st) != 0 || st.st_size <= 0) return;
+        m_size = static_cast<size_t>(st.st_size);
+
+        void* addr = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+        if (addr == MAP_FAILED) {
+            m_size = 0;
+            return;
+        }
+        m_data = static_cast<const unsigned char*>(addr);
+        ::madvise(addr, m_size, MADV_SEQUENTIAL);
+    }
+
+    ~MappedFile() {
+        if (m_data) ::munmap(const_cast<unsigned char*>(m_data), m_size);
+        if (m_fd >= 0) ::close(m_fd);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const unsigned char* data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+private:
+    int m_fd = -1;
+    const unsigned char* m_data = nullptr;
+    size_t m_size = 0;
+};
+
+} // namespace
+
+namespace {
+
+void fnv1a(uint64_t& hash, const unsigned char* p, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= p[i];
+        hash *= 1099511628211ull;             // FNV prime
+    }
+}
+
+template <typename T>
+void fnv1aValue(uint64_t& hash, T value) {
+    fnv1a(hash, reinterpret_cast<const unsigned char*>(&value), sizeof(value));
+}
+
+// Lecture complète de size octets à offset (false si fin de fichier ou erreur)
+bool readAt(int fd, unsigned char* data, size_t size, off_t offset) {
+    while (size > 0) {
+        const ssize_t got = ::pread(fd, data, size, offset);
+        if (got <= 0) return false;
+        data += got;
+        size -= static_cast<size_t>(got);
+        offset += got;
+    }
+    return true;
+}
+
+} // namespace
+
+uint64_t RoadGraphCache::hashFile(const string& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return 0;
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        return 0;
+    }
+    const uint64_t size = static_cast<uint64_t>(st.st_size);
+
+    uint64_t hash = 14695981039346656037ull;  // FNV offset basis
+    fnv1aValue(hash, size);
+    fnv1aValue(hash, static_cast<int64_t>(st.st_mtime));
+
+    // Blocs répartis du début à la fin (tout le fichier s'il est petit)
+    vector<unsigned char> block(SAMPLE_BLOCK_SIZE);
+    bool ok = true;
+    if (size <= SAMPLE_BLOCK_COUNT * SAMPLE_BLOCK_SIZE) {
+        block.resize(size);
+        ok = readAt(fd, block.data(), block.size(), 0);
+        fnv1a(hash, block.data(), block.size());
+    } else {
+        const uint64_t stride = (size - SAMPLE_BLOCK_SIZE) / (SAMPLE_BLOCK_COUNT - 1);
+        for (uint64_t b = 0; ok && b < SAMPLE_BLOCK_COUNT; ++b) {
+            ok = readAt(fd, block.data(), block.size(), static_cast<off_t>(b * stride));
+            fnv1a(hash, block.data(), block.size());
+        }
+    }
+    ::close(fd);
+    return ok ? hash : 0;
+}
+
+string RoadGraphCache::defaultCachePath(const string& sourcePath) {
+    return sourcePath + ".graph";
+}
+
+bool RoadGraphCache::save(const string& cachePath, const RoadGraph& graph, uint64_t sourceHash) {
+    CacheHeader header{};
+    memcpy(header.magic, CACHE_MAGIC, sizeof(header.magic));
+    header.version = FORMAT_VERSION;
+    header.headerSize = sizeof(CacheHeader);
+    header.sourceHash = sourceHash;
+    header.vertexCount = boost::num_vertices(graph);
+    header.edgeCount = boost::num_edges(graph);
+
+    vector<CachedVertex> vertices;
+    vertices.reserve(header.vertexCount);
+    for (auto vp = boost::vertices(graph); vp.first != vp.second; ++vp.first) {
+        const VertexData& data = graph[*vp.first];
+        vertices.push_back({static_cast<int64_t>(data.id), data.lat, data.lon});
+    }
+
+    // boost::edges parcourt les arêtes dans leur ordre d'insertion: le graphe
+    // rechargé a donc les mêmes listes d'adjacence que l'original
+    vector<CachedEdge> edges;
+    edges.reserve(header.edgeCount);
+    for (auto ep = boost::edges(graph); ep.first != ep.second; ++ep.first) {
+        const Edge e = *ep.first;
+        const EdgeData& data = graph[e];
+        CachedEdge cached{};
+        cached.source = static_cast<uint32_t>(boost::source(e, graph));
+        cached.target = static_cast<uint32_t>(boost::target(e, graph));
+        cached.distance = data.distance;
+        cached.roadClass = static_cast<uint8_t>(data.roadClass);
+        cached.oneway = data.oneway ? 1 : 0;
+        edges.push_back(cached);
+    }
+
+    // Écriture dans un fichier temporaire puis renommage: un lancement
+    // concurrent ne voit jamais un cache à moitié écrit
+    const string tmpPath = cachePath + ".tmp";
+    {
+        ofstream out(tmpPath, ios::binary | ios::trunc);
+        if (!out) {
+            cerr << "[RoadGraphCache] Impossible d'écrire " << tmpPath << endl;
+            return false;
+        }
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(vertices.data()), vertices.size() * sizeof(CachedVertex));
+        out.write(reinterpret_cast<const char*>(edges.data()), edges.size() * sizeof(CachedEdge));
+        if (!out) {
+            cerr << "[RoadGraphCache] Erreur d'écriture dans " << tmpPath << endl;
+            std::remove(tmpPath.c_str());
+            return false;
+        }
+    }
+    if (std::rename(tmpPath.c_str(), cachePath.c_str()) != 0) {
+        cerr << "[RoadGraphCache] Impossible de renommer " << tmpPath << endl;
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+
+    cout << "[RoadGraphCache] Cache écrit : " << cachePath
+         << " (" << header.vertexCount << " sommets, " << header.edgeCount << " arêtes)" << endl;
+    return true;
+}
+
+bool RoadGraphCache::load(const string& cachePath, uint64_t sourceHash, RoadGraph& graph) {
+    MappedFile file(cachePath);
+    if (!file.data() || file.size() < sizeof(CacheHeader)) return false;
+
+    CacheHeader header;
+    memcpy(&header, file.data(), sizeof(header));
+    if (memcmp(header.magic, CACHE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != FORMAT_VERSION || header.headerSize != sizeof(CacheHeader)) {
+        cout << "[RoadGraphCache] Format de cache incompatible, reconstruction" << endl;
+        return false;
+    }
+    if (header.sourceHash != sourceHash) {
+        cout << "[RoadGraphCache] Fichier source modifié, reconstruction" << endl;
+        return false;
+    }
+
+    // Comptes bornés par la taille du fichier avant toute multiplication:
+    // un en-tête corrompu ne peut pas faire déborder expectedSize
+    const uint64_t payloadSize = file.size() - sizeof(CacheHeader);
+    const bool countsFit = header.vertexCount <= payloadSize / sizeof(CachedVertex) &&
+                           header.edgeCount <= payloadSize / sizeof(CachedEdge);
+    const uint64_t expectedSize = countsFit
+        ? sizeof(CacheHeader) + header.vertexCount * sizeof(CachedVertex) + header.edgeCount * sizeof(CachedEdge)
+        : 0;
+    if (!countsFit || file.size() != expectedSize) {
+        cout << "[RoadGraphCache] Cache tronqué, reconstruction" << endl;
+        return false;
+    }
+
+    const auto* vertices = reinterpret_cast<const CachedVertex*>(file.data() + sizeof(CacheHeader));
+    const auto* edges = reinterpret_cast<const CachedEdge*>(vertices + header.vertexCount);
+
+    RoadGraph loaded(header.vertexCount);
+    for (uint64_t i = 0; i < header.vertexCount; ++i) {
+        VertexData& data = loaded[i];
+        data.id = static_cast<long>(vertices[i].id);
+        data.lat = vertices[i].lat;
+        data.lon = vertices[i].lon;
+    }
+    for (uint64_t i = 0; i < header.edgeCount; ++i) {
+        const CachedEdge& cached = edges[i];
+        if (cached.source >= header.vertexCount || cached.target >= header.vertexCount ||
+            cached.roadClass >= static_cast<uint8_t>(RoadClass::Count)) {
+            cout << "[RoadGraphCache] Arête invalide dans le cache, reconstruction" << endl;
+            return false;
+        }
+        EdgeData data;
+        data.distance = cached.distance;
+        data.oneway = cached.oneway != 0;
+        data.roadClass = static_cast<RoadClass>(cached.roadClass);
+        boost::add_edge(cached.source, cached.target, data, loaded);
+    }
+
+    graph = std::move(loaded);
+    cout << "[RoadGraphCache] Graphe chargé depuis " << cachePath
+         << " (" << header.vertexCount << " sommets, " << header.edgeCount << " arêtes)" << endl;
+    return true;
+}
@@ -0,0 +1,77 @@
+#include "road_vertex_index.h"
+#include <cmath>
+#include <algorithm>
+#include <iterator>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace bgi = boost::geometry::index;
+
+void RoadVertexIndex::build(const RoadGraph& graph) {
+    m_vertices.clear();
+    double latSum = 0.0;
+    for (auto vp = boost::vertices(graph); vp.first != vp.second; ++vp.first) {
+        if (graph[*vp.first].drivableOutDegree > 0) {
+            m_vertices.push_back(*vp.first);
+            latSum += graph[*vp.first].lat;
+        }
+    }
+    m_lonScale = m_vertices.empty() ? 1.0 : std::cos(latSum / m_vertices.size() * M_PI / 180.0);
+
+    std::vector<Entry> entries;
+    entries.reserve(m_vertices.size());
+    for (Vertex v : m_vertices) {
+        entries.emplace_back(project(graph[v].lon, graph[v].lat), v);
+    }
+    // Constructeur par intervalle: chargement en bloc (packing), plus rapide et
+    // plus compact que des insertions successives
+    m_tree = Tree(entries.begin(), entries.end());
+}
+
+bool RoadVertexIndex::nearest(double lon, double lat, Vertex& vertex) const {
+    std::vector<Entry> result;
+    m_tree.query(bgi::nearest(project(lon, lat), 1), std::back_inserter(result));
+    if (result.empty()) return false;
+    vertex = result.front().second;
+    return true;
+}
+
+std::vector<Vertex> RoadVertexIndex::nearestK(double lon, double lat, size_t k) const {
+    const Point query = project(lon, lat);
+    std::vector<Entry> result;
+    m_tree.query(bgi::nearest(query, static_cast<unsigned>(k)), std::back_inserter(result));
+
+    // L'ordre des résultats de bgi::nearest n'est pas garanti
+    std::sort(result.begin(), result.end(), [&](const Entry& a, const Entry& b) {
+        return boost::geometry::comparable_distance(a.first, query) <
+               boost::geometry::comparable_distance(b.first, query);
+    });
+    std::vector<Vertex> vertices;
+    vertices.reserve(result.size());
+    for (const auto& entry : result) {
+        vertices.push_back(entry.second);
+    }
+    return vertices;
+}
+
+std::vector<Vertex> RoadVertexIndex::inRegion(double minLon, double minLat, double maxLon, double maxLat) const {
+    std::vector<Entry> result;
+    m_tree.query(bgi::intersects(Box(project(minLon, minLat), project(maxLon, maxLat))),
+                 std::back_inserter(result));
+    std::vector<Vertex> vertices;
+    vertices.reserve(result.size());
+    for (const auto& entry : result) {
+        vertices.push_back(entry.second);
+    }
+    return vertices;
+}
+
+bool RoadVertexIndex::randomInRegion(double minLon, double minLat, double maxLon, double maxLat,
+                                     uint32_t random, Vertex& vertex) const {
+    std::vector<Vertex> candidates = inRegion(minLon, minLat, maxLon, maxLat);
+    if (candidates.empty()) return false;
+    vertex = candidates[random % candidates.size()];
+    return true;
+}
@@ -0,0 +1,182 @@
+#include "route_planner.h"
+#include "graph_builder.h"
+#include "parallel_for.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <tuple>
+
+namespace {
+
+// Tableaux de recherche réutilisés d'une requête à l'autre (un jeu par thread).
+// stamp[v] == generation indique que dist/parent de v sont valides pour la
+// requête courante: pas de réinitialisation en O(V) à chaque A*.
+struct SearchScratch {
+    std::vector<double> dist;
+    std::vector<Vertex> parent;
+    std::vector<uint32_t> stamp;
+    uint32_t generation = 0;
+
+    void prepare(size_t n) {
+        if (stamp.size() != n) {
+            dist.assign(n, 0.0);
+            parent.assign(n, 0);
+            stamp.assign(n, 0);
+            generation = 0;
+        }
+        if (++generation == 0) {
+            // Débordement du compteur: repartir de zéro
+            std::fill(stamp.begin(), stamp.end(), 0);
+            generation = 1;
+        }
+    }
+};
+
+thread_local SearchScratch t_scratch;
+
+} // namespace
+
+RoutePlanner::RoutePlanner(const RoadGraph& graph, size_t cacheCapacity)
+    : m_graph(graph), m_cacheCapacity(cacheCapacity)
+{
+    for (auto vp = boost::vertices(graph); vp.first != vp.second; ++vp.first) {
+        if (graph[*vp.first].drivableOutDegree > 0) {
+            m_validVertices.push_back(*vp.first);
+        }
+    }
+}
+
+bool RoutePlanner::findEdge(const RoadGraph& graph, Vertex u, Vertex v, Edge& edge) {
+    bool found = false;
+    double best = std::numeric_limits<double>::max();
+    for (auto [it, end] = boost::out_edges(u, graph); it != end; ++it) {
+        if (boost::target(*it, graph) != v || !canTraverse(graph, *it, u)) continue;
+        if (graph[*it].distance < best) {
+            best = graph[*it].distance;
+            edge = *it;
+            found = true;
+        }
+    }
+    return found;
+}
+
+std::vector<Vertex> RoutePlanner::computeRoute(Vertex start, Vertex goal) const {
+    const size_t n = boost::num_vertices(m_graph);
+    if (start >= n || goal >= n) return {};
+    if (start == goal) return {start};
+
+    SearchScratch& s = t_scratch;
+    s.prepare(n);
+
+    const double goalLat = m_graph[goal].lat;
+    const double goalLon = m_graph[goal].lon;
+    auto heuristic = [&](Vertex v) {
+        return GraphBuilder::distance(m_graph[v].lat, m_graph[v].lon, goalLat, goalLon);
+    };
+
+    // File de priorité (f = g + h, g, sommet); les entrées périmées sont ignorées
+    using Entry = std::tuple<double, double, Vertex>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+
+    s.stamp[start] = s.generation;
+    s.dist[start] = 0.0;
+    s.parent[start] = start;
+    open.emplace(heuristic(start), 0.0, start);
+
+    bool reached = false;
+    while (!open.empty()) {
+        auto [f, g, u] = open.top();
+        open.pop();
+        if (g > s.dist[u]) continue;
+        if (u == goal) {
+            reached = true;
+            break;
+        }
+
+        for (auto [it, end] = boost::out_edges(u, m_graph); it != end; ++it) {
+            if (!canTraverse(m_graph, *it, u)) continue;
+            Vertex v = boost::target(*it, m_graph);
+            double candidate = g + m_graph[*it].distance;
+            if (s.stamp[v] != s.generation || candidate < s.dist[v]) {
+                s.stamp[v] = s.generation;
+                s.dist[v] = candidate;
+                s.parent[v] = u;
+                open.emplace(candidate + heuristic(v), candidate, v);
+            }
+        }
+    }
+    if (!reached) return {};
+
+    std::vector<Vertex> route;
+    for (Vertex v = goal; v != start; v = s.parent[v]) {
+        route.push_back(v);
+    }
+    route.push_back(start);
+    std::reverse(route.begin(), route.end());
+    return route;
+}
+
+RoutePlanner::Route RoutePlanner::findRoute(Vertex start, Vertex goal) {
+    const uint64_t key = cacheKey(start, goal);
+
+    if (m_cacheCapacity > 0) {
+        std::lock_guard<std::mutex> lock(m_cacheMutex);
+        auto it = m_cacheIndex.find(key);
+        if (it != m_cacheIndex.end()) {
+            // Remonter l'entrée en tête (plus récemment utilisée)
+            m_lru.splice(m_lru.begin(), m_lru, it->second);
+            m_cacheHits.fetch_add(1, std::memory_order_relaxed);
+            return it->second->second;
+        }
+    }
+    m_cacheMisses.fetch_add(1, std::memory_order_relaxed);
+
+    // Calcul hors verrou: plusieurs threads peuvent chercher en même temps
+    Route route = std::make_shared<const std::vector<Vertex>>(computeRoute(start, goal));
+
+    if (m_cacheCapacity > 0) {
+        std::lock_guard<std::mutex> lock(m_cacheMutex);
+        auto it = m_cacheIndex.find(key);
+        if (it != m_cacheIndex.end()) {
+            // Calculé entre-temps par un autre thread: garder un seul exemplaire
+            return it->second->second;
+        }
+        m_lru.emplace_front(key, route);
+        m_cacheIndex[key] = m_lru.begin();
+        if (m_lru.size() > m_cacheCapacity) {
+            m_cacheIndex.erase(m_lru.back().first);
+            m_lru.pop_back();
+        }
+    }
+    return route;
+}
+
+std::vector<RoutePlanner::Route> RoutePlanner::planBatch(const std::vector<std::pair<Vertex, Vertex>>& trips,
+                                                         int threadCount) {
+    std::vector<Route> routes(trips.size());
+    parallelFor(trips.size(), threadCount, 16, [&](size_t begin, size_t end, int) {
+        for (size_t i = begin; i < end; ++i) {
+            routes[i] = findRoute(trips[i].first, trips[i].second);
+        }
+    });
+    return routes;
+}
+
+double RoutePlanner::routeLength(const std::vector<Vertex>& route) const {
+    double length = 0.0;
+    for (size_t i = 1; i < route.size(); ++i) {
+        Edge e;
+        if (!findEdge(m_graph, route[i - 1], route[i], e)) {
+            return std::numeric_limits<double>::infinity();
+        }
+        length += m_graph[e].distance;
+    }
+    return length;
+}
+
+void RoutePlanner::clearCache() {
+    std::lock_guard<std::mutex> lock(m_cacheMutex);
+    m_lru.clear();
+    m_cacheIndex.clear();
+}
@@ -0,0 +1,410 @@
+#include "shard_coordinator.h"
+#include <algorithm>
+#include <cerrno>
+#include <iostream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define V2V_SHARD_PROCESSES 1
+#include <csignal>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+// Parcourt les trames complètes d'un tampon (en-tête lu, charge utile à data + SHARD_FRAME_HEADER_SIZE)
+template <typename Visitor>
+static bool forEachFrame(const std::vector<uint8_t>& buffer, Visitor visit) {
+    size_t pos = 0;
+    while (pos < buffer.size()) {
+        ShardFrameHeader header;
+        if (parseShardFrame(buffer.data() + pos, buffer.size() - pos, header) != ShardFrameStatus::Ok) {
+            return false;
+        }
+        const size_t frameSize = SHARD_FRAME_HEADER_SIZE + header.length;
+        if (!visit(header, buffer.data() + pos, frameSize)) return false;
+        pos += frameSize;
+    }
+    return true;
+}
+
+// ----------------------
+// Shards dans le processus du coordinateur: les trames sont traitées à l'envoi
+// ----------------------
+
+class LocalShardLink : public ShardLink {
+public:
+    explicit LocalShardLink(std::unique_ptr<ShardNode> node) : m_node(std::move(node)) {}
+
+    bool send(const std::vector<uint8_t>& frames) override {
+        return forEachFrame(frames, [this](const ShardFrameHeader& header, const uint8_t* frame, size_t) {
+            return m_node->handleFrame(header, frame + SHARD_FRAME_HEADER_SIZE, m_inbox) ||
+                   header.type == ShardMessage::Shutdown;
+        });
+    }
+
+    bool receiveUntil(ShardMessage last, std::vector<uint8_t>& frames) override {
+        size_t end = 0;
+        bool found = false;
+        forEachFrame(m_inbox, [&](const ShardFrameHeader& header, const uint8_t*, size_t frameSize) {
+            end += frameSize;
+            found = header.type == last;
+            return !found;
+        });
+        if (!found) return false;
+        frames.insert(frames.end(), m_inbox.begin(), m_inbox.begin() + end);
+        m_inbox.erase(m_inbox.begin(), m_inbox.begin() + end);
+        return true;
+    }
+
+private:
+    std::unique_ptr<ShardNode> m_node;
+    std::vector<uint8_t> m_inbox;  // Réponses pas encore lues
+};
+
+#ifdef V2V_SHARD_PROCESSES
+
+// ----------------------
+// Shards dans des processus fils, reliés par une paire de sockets Unix
+// ----------------------
+
+static bool writeAll(int fd, const uint8_t* data, size_t size) {
+    while (size > 0) {
+        const ssize_t written = ::write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+static bool readExact(int fd, uint8_t* data, size_t size) {
+    while (size > 0) {
+        const ssize_t got = ::read(fd, data, size);
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) return false;  // Erreur ou fin du flux
+        data += got;
+        size -= static_cast<size_t>(got);
+    }
+    return true;
+}
+
+// Ajoute une trame complète lue sur fd à la fin de out
+static bool readFrame(int fd, std::vector<uint8_t>& out, ShardFrameHeader& header) {
+    const size_t start = out.size();
+    out.resize(start + SHARD_FRAME_HEADER_SIZE);
+    if (!readExact(fd, out.data() + start, SHARD_FRAME_HEADER_SIZE)) return false;
+    if (parseShardFrame(out.data() + start, SHARD_FRAME_HEADER_SIZE, header) == ShardFrameStatus::Invalid) {
+        return false;
+    }
+    out.resize(start + SHARD_FRAME_HEADER_SIZE + header.length);
+    return readExact(fd, out.data() + start + SHARD_FRAME_HEADER_SIZE, header.length);
+}
+
+class ProcessShardLink : public ShardLink {
+public:
+    ProcessShardLink(int fd, pid_t pid) : m_fd(fd), m_pid(pid) {}
+    ~ProcessShardLink() override {
+        ::close(m_fd);
+        int status = 0;
+        ::waitpid(m_pid, &status, 0);
+    }
+
+    bool send(const std::vector<uint8_t>& frames) override {
+        return writeAll(m_fd, frames.data(), frames.size());
+    }
+
+    bool receiveUntil(ShardMessage last, std::vector<uint8_t>& frames) override {
+        ShardFrameHeader header;
+        do {
+            if (!readFrame(m_fd, frames, header)) return false;
+        } while (header.type != last);
+        return true;
+    }
+
+    int fd() const { return m_fd; }
+
+private:
+    int m_fd;
+    pid_t m_pid;
+};
+
+// Boucle d'un processus fils: une trame à la fois, réponses écrites aussitôt
+static void runShardProcess(int fd, ShardNode& node) {
+    std::vector<uint8_t> frame;
+    std::vector<uint8_t> replies;
+    for (;;) {
+        frame.clear();
+        ShardFrameHeader header;
+        if (!readFrame(fd, frame, header)) return;
+        replies.clear();
+        const bool keepRunning = node.handleFrame(header, frame.data() + SHARD_FRAME_HEADER_SIZE, replies);
+        if (!replies.empty() && !writeAll(fd, replies.data(), replies.size())) return;
+        if (!keepRunning) return;
+    }
+}
+
+#endif // V2V_SHARD_PROCESSES
+
+// ----------------------
+// Coordinateur
+// ----------------------
+
+ShardCoordinator::ShardCoordinator(RoadGraph& graph, GeoPartition partition, const ShardRunOptions& options)
+    : m_graph(graph), m_partition(std::move(partition)), m_options(options)
+{
+    const size_t shards = static_cast<size_t>(m_partition.shardCount());
+    m_received.resize(shards);
+    m_outgoing.resize(shards);
+    m_lastStats.resize(shards);
+    m_options.viewInterval = std::max(1, m_options.viewInterval);
+}
+
+ShardCoordinator::~ShardCoordinator() {
+    shutdown();
+}
+
+static void configureNode(ShardNode& node, const ShardRunOptions& options) {
+    Simulator& simulator = node.simulator();
+    simulator.setRandomSeed(options.seed);
+    simulator.setUpdateThreadCount(options.threadsPerShard);
+    simulator.interferenceGraph().setBuildThreadCount(options.threadsPerShard);
+}
+
+bool ShardCoordinator::start(const std::vector<ShardVehicleSeed>& fleet) {
+    if (m_running || m_partition.empty()) return false;
+
+#ifdef V2V_SHARD_PROCESSES
+    m_processes = m_options.processes;
+    // Un shard arrêté ne doit pas tuer le coordinateur pendant une écriture
+    std::signal(SIGPIPE, SIG_IGN);
+#else
+    if (m_options.processes) {
+        std::cout << "[ShardCoordinator] Processus fils indisponibles: shards dans ce processus" << std::endl;
+    }
+    m_processes = false;
+#endif
+
+    for (int shard = 0; shard < m_partition.shardCount(); ++shard) {
+        if (m_processes) {
+            if (!startProcess(shard, fleet)) {
+                shutdown();
+                return false;
+            }
+        } else {
+            auto node = std::make_unique<ShardNode>(m_graph, m_partition, shard, m_options.range);
+            configureNode(*node, m_options);
+            node->populate(fleet, m_options.speed, m_options.range, m_options.collisionDist);
+            m_links.push_back(std::make_unique<LocalShardLink>(std::move(node)));
+        }
+    }
+
+    if (!m_options.viewPath.empty()) {
+        // Même identité de graphe qu'un enregistrement du Simulator: relisible avec --replay
+        RecordingOptions viewOptions;
+        viewOptions.graph.sourceHash = m_options.graphSourceHash;
+        viewOptions.graph.vertexCount = boost::num_vertices(m_graph);
+        viewOptions.graph.edgeCount = boost::num_edges(m_graph);
+        m_view = std::make_unique<RecordingWriter>();
+        if (!m_view->open(m_options.viewPath, viewOptions)) {
+            std::cerr << "[ShardCoordinator] Impossible d'écrire la vue " << m_options.viewPath << std::endl;
+            m_view.reset();
+        }
+    }
+    m_running = true;
+    std::cout << "[ShardCoordinator] " << m_partition.shardCount() << " shards ("
+              << (m_processes ? "processus" : "même processus") << "), "
+              << m_partition.regions().size() << " régions" << std::endl;
+    return true;
+}
+
+bool ShardCoordinator::startProcess(int shard, const std::vector<ShardVehicleSeed>& fleet) {
+#ifdef V2V_SHARD_PROCESSES
+    int fds[2];
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+        std::cerr << "[ShardCoordinator] socketpair impossible pour le shard " << shard << std::endl;
+        return false;
+    }
+    // Sorties vidées avant fork: sinon le fils réécrirait le tampon du parent
+    std::cout.flush();
+    std::cerr.flush();
+    const pid_t pid = ::fork();
+    if (pid < 0) {
+        std::cerr << "[ShardCoordinator] fork impossible pour le shard " << shard << std::endl;
+        ::close(fds[0]);
+        ::close(fds[1]);
+        return false;
+    }
+    if (pid == 0) {
+        // Fils: garder uniquement sa propre extrémité (le graphe routier est partagé par copie sur écriture)
+        ::close(fds[0]);
+        for (const auto& link : m_links) {
+            ::close(static_cast<const ProcessShardLink&>(*link).fd());
+        }
+        {
+            ShardNode node(m_graph, m_partition, shard, m_options.range);
+            configureNode(node, m_options);
+            node.populate(fleet, m_options.speed, m_options.range, m_options.collisionDist);
+            runShardProcess(fds[1], node);
+        }
+        ::close(fds[1]);
+        std::cout.flush();
+        std::cerr.flush();
+        // Pas de destructeurs statiques ni de nettoyage Qt hérités du parent
+        ::_exit(0);
+    }
+    ::close(fds[1]);
+    m_links.push_back(std::make_unique<ProcessShardLink>(fds[0], pid));
+    return true;
+#else
+    (void)shard;
+    (void)fleet;
+    return false;
+#endif
+}
+
+bool ShardCoordinator::step(double dtSeconds) {
+    if (!m_running) return false;
+    m_tick++;
+    const int shards = m_partition.shardCount();
+    const bool wantView = m_view && m_tick % static_cast<uint32_t>(m_options.viewInterval) == 0;
+    m_viewSeconds += dtSeconds;
+
+    // Phase 1: tous les shards avancent en même temps
+    ShardStep stepMessage{dtSeconds, wantView ? std::max<uint32_t>(1, m_options.viewStride) : 0};
+    for (int s = 0; s < shards; ++s) {
+        m_outgoing[s].clear();
+        const size_t frame = beginShardFrame(m_outgoing[s], ShardMessage::Step, SHARD_COORDINATOR,
+                                             static_cast<uint16_t>(s), m_tick);
+        encodeShardStep(m_outgoing[s], stepMessage);
+        endShardFrame(m_outgoing[s], frame);
+        if (!m_links[s]->send(m_outgoing[s])) {
+            std::cerr << "[ShardCoordinator] Shard " << s << " injoignable" << std::endl;
+            m_running = false;
+            return false;
+        }
+    }
+
+    // Relais des zones frontières et des migrations vers leur destinataire
+    for (auto& frames : m_outgoing) frames.clear();
+    m_lastExchangeBytes = 0;
+    for (int s = 0; s < shards; ++s) {
+        m_received[s].clear();
+        const bool ok = m_links[s]->receiveUntil(ShardMessage::Flush, m_received[s]) &&
+            forEachFrame(m_received[s], [&](const ShardFrameHeader& header, const uint8_t* frame, size_t frameSize) {
+                if (header.type == ShardMessage::Flush) return true;
+                if ((header.type != ShardMessage::Boundary && header.type != ShardMessage::Migration) ||
+                    header.target >= shards) {
+                    return false;
+                }
+                m_outgoing[header.target].insert(m_outgoing[header.target].end(), frame, frame + frameSize);
+                m_lastExchangeBytes += frameSize;
+                return true;
+            });
+        if (!ok) {
+            std::cerr << "[ShardCoordinator] Échange invalide du shard " << s << " au tick " << m_tick << std::endl;
+            m_running = false;
+            return false;
+        }
+    }
+    m_totalExchangeBytes += m_lastExchangeBytes;
+    for (int s = 0; s < shards; ++s) {
+        appendShardFrame(m_outgoing[s], ShardMessage::Flush, SHARD_COORDINATOR, static_cast<uint16_t>(s), m_tick);
+        if (!m_links[s]->send(m_outgoing[s])) {
+            std::cerr << "[ShardCoordinator] Shard " << s << " injoignable" << std::endl;
+            m_running = false;
+            return false;
+        }
+    }
+
+    // Phase 2: vues et compteurs
+    m_viewRows.clear();
+    for (int s = 0; s < shards; ++s) {
+        if (!collectReplies(s)) {
+            std::cerr << "[ShardCoordinator] Compteurs invalides du shard " << s << " au tick " << m_tick << std::endl;
+            m_running = false;
+            return false;
+        }
+    }
+
+    if (wantView) {
+        // Même ordre d'un tick à l'autre: les trames différentielles de l'enregistrement restent compactes
+        std::sort(m_viewRows.begin(), m_viewRows.end(),
+                  [](const ShardViewRow& a, const ShardViewRow& b) { return a.id < b.id; });
+        std::vector<int> ids(m_viewRows.size());
+        for (size_t i = 0; i < m_viewRows.size(); ++i) ids[i] = m_viewRows[i].id;
+        m_viewStore.setIds(ids);
+        for (size_t i = 0; i < m_viewRows.size(); ++i) {
+            const ShardViewRow& row = m_viewRows[i];
+            m_viewStore.edgeSource[i] = row.edgeSource;
+            m_viewStore.edgeTarget[i] = row.edgeTarget;
+            m_viewStore.positionOnEdge[i] = row.positionOnEdge;
+            m_viewStore.speed[i] = row.speed;
+            m_viewStore.heading[i] = row.heading;
+            m_viewStore.range[i] = row.range;
+        }
+        // Positions seules: les connexions entre shards ne sont pas rassemblées
+        m_view->push(m_tick, m_viewSeconds, m_viewStore, nullptr);
+        m_viewSeconds = 0.0;
+    }
+    return true;
+}
+
+bool ShardCoordinator::collectReplies(int shard) {
+    m_received[shard].clear();
+    bool hasStats = false;
+    const bool ok = m_links[shard]->receiveUntil(ShardMessage::Stats, m_received[shard]) &&
+        forEachFrame(m_received[shard], [&](const ShardFrameHeader& header, const uint8_t* frame, size_t) {
+            const uint8_t* payload = frame + SHARD_FRAME_HEADER_SIZE;
+            if (header.type == ShardMessage::View) {
+                return decodeShardView(payload, header.length, m_viewRows);
+            }
+            if (header.type == ShardMessage::Stats) {
+                hasStats = decodeShardStats(payload, header.length, m_lastStats[shard]);
+                return hasStats;
+            }
+            return false;
+        });
+    return ok && hasStats;
+}
+
+void ShardCoordinator::shutdown() {
+    if (!m_links.empty()) {
+        for (int s = 0; s < static_cast<int>(m_links.size()); ++s) {
+            std::vector<uint8_t> frame;
+            appendShardFrame(frame, ShardMessage::Shutdown, SHARD_COORDINATOR, static_cast<uint16_t>(s), m_tick);
+            m_links[s]->send(frame);
+        }
+        // Fermeture des sockets et attente des processus fils
+        m_links.clear();
+    }
+    if (m_view) {
+        m_view->close();
+    }
+    m_running = false;
+}
+
+ShardTickStats ShardCoordinator::totals() const {
+    ShardTickStats total;
+    for (const ShardTickStats& s : m_lastStats) {
+        total.vehicles += s.vehicles;
+        total.ghosts += s.ghosts;
+        total.immigrants += s.immigrants;
+        total.emigrants += s.emigrants;
+        total.boundaryRows += s.boundaryRows;
+        total.localEdges += s.localEdges;
+        total.crossEdges += s.crossEdges;
+        total.comparisons += s.comparisons;
+        total.updateMs = std::max(total.updateMs, s.updateMs);  // Le shard le plus lent fixe le tick
+        total.graphMs = std::max(total.graphMs, s.graphMs);
+    }
+    return total;
+}
+
+uint64_t ShardCoordinator::totalEdges() const {
+    const ShardTickStats total = totals();
+    return total.localEdges + total.crossEdges;
+}
@@ -0,0 +1,76 @@
+#include "interference_graph_test.h"
+#include "shard_coordinator.h"
+#include <iostream>
+
+// Tests qui font tourner des Simulator (QObject): séparés de interference_graph_test.cpp,
+// compilé aussi dans V2VMicrobench sans Qt
+
+using namespace std;
+
+bool InterferenceGraphTest::runSimulatorTests() {
+    testShardedRun();
+
+    return m_failedTests == 0;
+}
+
+bool InterferenceGraphTest::testShardedRun() {
+    printTestHeader("Simulation répartie (2 shards)");
+    
+    const int side = 12;
+    RoadGraph roads = createRoadGrid(side);
+    
+    // Deux shards dans ce processus: la flotte reste complète malgré les
+    // migrations et les connexions sont celles d'un seul Simulator
+    vector<pair<double, double>> quadrants;
+    for (int y = 0; y < 2; ++y) {
+        for (int x = 0; x < 2; ++x) {
+            quadrants.push_back({48.5525 + y * 0.0055, 7.7041 + x * 0.0083});
+        }
+    }
+    GeoPartition partition = GeoPartition::fromCenters(quadrants, vector<double>(4, 1.0), 2);
+    const int numVehicles = 120;
+    const int numVertices = side * side;
+    vector<ShardVehicleSeed> fleet(numVehicles);
+    for (int i = 0; i < numVehicles; ++i) {
+        fleet[i].id = i;
+        fleet[i].start = (i * 7) % numVertices;
+        fleet[i].goal = (i * 13 + 5) % numVertices;
+    }
+    ShardRunOptions options;
+    options.processes = false;
+    options.seed = 99;
+    options.speed = 14.0;
+    options.range = 300.0;
+    ShardCoordinator coordinator(roads, partition, options);
+    bool shardedOk = partition.shardCount() == 2 && coordinator.start(fleet);
+    
+    Simulator reference(roads);
+    reference.setRandomSeed(options.seed);
+    reference.interferenceGraph().setBroadphaseMode(BroadphaseMode::UniformGrid);
+    for (const ShardVehicleSeed& seed : fleet) {
+        reference.createVehicle(seed.id, seed.start, seed.goal, options.speed, options.range, options.collisionDist);
+    }
+    reference.planRoutes();
+    
+    uint64_t migrations = 0;
+    bool sameFleet = shardedOk;
+    bool sameEdges = shardedOk;
+    for (int tick = 0; shardedOk && tick < 60; ++tick) {
+        shardedOk = coordinator.step(0.5);
+        reference.stepVehicles(0.5);
+        reference.completeStep(0.5);
+        const ShardTickStats total = coordinator.totals();
+        migrations += total.emigrants;
+        sameFleet = sameFleet && total.vehicles == fleet.size();
+        sameEdges = sameEdges && coordinator.totalEdges() == reference.currentGraph()->getDirectEdges().size();
+    }
+    cout << "  → " << migrations << " migrations, " << coordinator.totalEdges() << " connexions au dernier tick ("
+         << reference.currentGraph()->getDirectEdges().size() << " pour un seul Simulator)" << endl;
+    coordinator.shutdown();
+    bool test1 = checkCondition("Flotte complète après migrations", shardedOk && migrations > 0 && sameFleet);
+    bool test2 = checkCondition("Connexions identiques à celles d'un seul Simulator", shardedOk && sameEdges);
+    
+    bool passed = test1 && test2;
+    printTestResult("Simulation répartie (2 shards)", passed);
+    return passed;
+}
@@ -0,0 +1,163 @@
+#include "shard_node.h"
+#include <algorithm>
+#include <iostream>
+
+ShardNode::ShardNode(RoadGraph& graph, const GeoPartition& partition, int shardId, double maxRange)
+    : m_simulator(graph), m_partition(partition), m_shardId(shardId), m_margin(maxRange * BOUNDARY_SLACK)
+{
+    // Les fantômes n'ont pas de petite antenne dans ce processus
+    m_simulator.interferenceGraph().setBroadphaseMode(BroadphaseMode::UniformGrid);
+    m_outBoundary.resize(partition.shardCount());
+    m_outMigrations.resize(partition.shardCount());
+}
+
+void ShardNode::populate(const std::vector<ShardVehicleSeed>& fleet, double speed, double range,
+                         double collisionDist) {
+    const RoadGraph& graph = m_simulator.getGraph();
+    for (const ShardVehicleSeed& seed : fleet) {
+        const auto& start = graph[seed.start];
+        if (m_partition.shardOf(start.lat, start.lon) == m_shardId) {
+            m_simulator.createVehicle(seed.id, seed.start, seed.goal, speed, range, collisionDist);
+        }
+    }
+    m_simulator.planRoutes();
+}
+
+bool ShardNode::handleFrame(const ShardFrameHeader& header, const uint8_t* payload, std::vector<uint8_t>& out) {
+    bool ok = true;
+    switch (header.type) {
+    case ShardMessage::Step:
+        ok = decodeShardStep(payload, header.length, m_step);
+        if (ok) advance(header.tick, out);
+        break;
+    case ShardMessage::Boundary:
+        ok = decodeBoundary(payload, header.length, m_ghosts);
+        break;
+    case ShardMessage::Migration:
+        ok = decodeMigrations(payload, header.length, m_immigrants);
+        break;
+    case ShardMessage::Flush:
+        complete(header.tick, out);
+        break;
+    case ShardMessage::Shutdown:
+        return false;
+    default:
+        ok = false;
+        break;
+    }
+    if (!ok) {
+        std::cerr << "[ShardNode] Shard " << m_shardId << ": trame " << static_cast<int>(header.type)
+                  << " invalide au tick " << header.tick << std::endl;
+    }
+    return ok;
+}
+
+void ShardNode::advance(uint32_t tick, std::vector<uint8_t>& out) {
+    m_simulator.stepVehicles(m_step.dtSeconds);
+
+    for (auto& rows : m_outBoundary) rows.clear();
+    for (auto& states : m_outMigrations) states.clear();
+    m_emigrants.clear();
+    m_ghosts.clear();
+    m_immigrants.clear();
+
+    const VehicleStore& store = m_simulator.vehicleStore();
+    for (size_t i = 0; i < store.size(); ++i) {
+        const int owner = m_partition.shardOf(store.lat[i], store.lon[i]);
+        m_partition.nearbyShards(store.lat[i], store.lon[i], m_margin, m_nearby);
+        const VehicleSnapshot row{store.ids[i], store.lon[i], store.lat[i], store.range[i], -1};
+        for (int shard : m_nearby) {
+            if (shard == m_shardId) {
+                // Véhicule qui vient de sortir, encore à portée: fantôme local
+                m_ghosts.push_back(row);
+            } else {
+                m_outBoundary[shard].push_back(row);
+            }
+        }
+        if (owner != m_shardId) {
+            m_emigrants.emplace_back(store.ids[i], owner);
+        }
+    }
+
+    // Retrait après le parcours: removeVehicle déplace les lignes du store
+    for (const auto& [id, owner] : m_emigrants) {
+        Vehicule* v = m_simulator.findVehicle(id);
+        if (!v) continue;
+        m_outMigrations[owner].push_back(v->getMotionState());
+        m_simulator.removeVehicle(v);
+    }
+
+    m_stats = ShardTickStats();
+    m_stats.emigrants = static_cast<uint32_t>(m_emigrants.size());
+    const uint16_t self = static_cast<uint16_t>(m_shardId);
+    for (int shard = 0; shard < m_partition.shardCount(); ++shard) {
+        const uint16_t target = static_cast<uint16_t>(shard);
+        if (!m_outBoundary[shard].empty()) {
+            const size_t frame = beginShardFrame(out, ShardMessage::Boundary, self, target, tick);
+            encodeBoundary(out, m_outBoundary[shard]);
+            endShardFrame(out, frame);
+            m_stats.boundaryRows += static_cast<uint32_t>(m_outBoundary[shard].size());
+        }
+        if (!m_outMigrations[shard].empty()) {
+            const size_t frame = beginShardFrame(out, ShardMessage::Migration, self, target, tick);
+            encodeMigrations(out, m_outMigrations[shard]);
+            endShardFrame(out, frame);
+        }
+    }
+    appendShardFrame(out, ShardMessage::Flush, self, SHARD_COORDINATOR, tick);
+}
+
+void ShardNode::complete(uint32_t tick, std::vector<uint8_t>& out) {
+    for (const VehicleMotionState& state : m_immigrants) {
+        m_simulator.adoptVehicle(state);
+    }
+    m_simulator.setGhostVehicles(m_ghosts);
+    m_simulator.completeStep(m_step.dtSeconds);
+
+    const TickTimings& timings = m_simulator.lastTickTimings();
+    m_stats.vehicles = static_cast<uint32_t>(m_simulator.vehicleStore().size());
+    m_stats.ghosts = static_cast<uint32_t>(m_ghosts.size());
+    m_stats.immigrants = static_cast<uint32_t>(m_immigrants.size());
+    m_stats.comparisons = static_cast<uint64_t>(std::max<int64_t>(0, timings.comparisons));
+    m_stats.components = static_cast<uint64_t>(std::max(0, m_simulator.currentGraph()->getComponentCount()));
+    m_stats.updateMs = timings.updateMs;
+    m_stats.graphMs = timings.graphBuildMs + timings.closureMs;
+    countEdges(m_stats);
+
+    if (m_step.viewStride > 0) {
+        appendView(tick, out);
+    }
+    const size_t frame = beginShardFrame(out, ShardMessage::Stats, static_cast<uint16_t>(m_shardId),
+                                         SHARD_COORDINATOR, tick);
+    encodeShardStats(out, m_stats);
+    endShardFrame(out, frame);
+}
+
+void ShardNode::countEdges(ShardTickStats& stats) const {
+    const VehicleStore& store = m_simulator.vehicleStore();
+    for (const DirectEdge& edge : m_simulator.currentGraph()->getDirectEdges()) {
+        const bool owns1 = store.rowOf(edge.id1) >= 0;
+        const bool owns2 = store.rowOf(edge.id2) >= 0;
+        if (owns1 && owns2) {
+            stats.localEdges++;
+        } else if (owns1 != owns2) {
+            // Comptée par le shard du plus petit ID (l'autre shard la voit aussi)
+            const int owned = owns1 ? edge.id1 : edge.id2;
+            if (owned == std::min(edge.id1, edge.id2)) stats.crossEdges++;
+        }
+    }
+}
+
+void ShardNode::appendView(uint32_t tick, std::vector<uint8_t>& out) {
+    const VehicleStore& store = m_simulator.vehicleStore();
+    m_viewRows.clear();
+    for (size_t i = 0; i < store.size(); ++i) {
+        if (store.ids[i] % m_step.viewStride != 0) continue;
+        m_viewRows.push_back({store.ids[i], store.edgeSource[i], store.edgeTarget[i], store.positionOnEdge[i],
+                              store.speed[i], store.heading[i], store.range[i]});
+    }
+    const size_t frame = beginShardFrame(out, ShardMessage::View, static_cast<uint16_t>(m_shardId),
+                                         SHARD_COORDINATOR, tick);
+    encodeShardView(out, m_viewRows);
+    endShardFrame(out, frame);
+}
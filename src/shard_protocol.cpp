@@ -0,0 +1,257 @@
+#include "shard_protocol.h"
+#include <algorithm>
+#include <cmath>
+#include "byte_codec.h"
+
+static constexpr uint16_t FRAME_MAGIC = 0x5356;  // "VS"
+static constexpr uint8_t PROTOCOL_VERSION = 1;
+
+// Quantification des lignes de frontière et de la vue
+static constexpr double DEGREE_SCALE = 1e7;       // 1e-7 degré (~1 cm)
+static constexpr double CENTI_SCALE = 100.0;      // cm, cm/s, centièmes de degré
+
+// Borne des tailles lues (un élément fait au moins un octet)
+static constexpr uint64_t MIN_ROW_BYTES = 1;
+
+static int64_t quantizeScaled(double value, double scale) {
+    return std::isfinite(value) ? std::llround(value * scale) : 0;
+}
+
+static bool plausibleCount(uint64_t count, const ByteReader& in) {
+    return count <= (in.size - in.pos) / MIN_ROW_BYTES;
+}
+
+size_t beginShardFrame(std::vector<uint8_t>& out, ShardMessage type, uint16_t source, uint16_t target,
+                       uint32_t tick) {
+    const size_t start = out.size();
+    putFixed<uint16_t>(out, FRAME_MAGIC);
+    out.push_back(PROTOCOL_VERSION);
+    out.push_back(static_cast<uint8_t>(type));
+    putFixed<uint16_t>(out, source);
+    putFixed<uint16_t>(out, target);
+    putFixed<uint32_t>(out, tick);
+    putFixed<uint32_t>(out, 0);  // Taille, réécrite par endShardFrame
+    return start;
+}
+
+void endShardFrame(std::vector<uint8_t>& out, size_t frameStart) {
+    const uint32_t length = static_cast<uint32_t>(out.size() - frameStart - SHARD_FRAME_HEADER_SIZE);
+    for (size_t i = 0; i < 4; ++i) {
+        out[frameStart + 12 + i] = static_cast<uint8_t>(length >> (8 * i));
+    }
+}
+
+void appendShardFrame(std::vector<uint8_t>& out, ShardMessage type, uint16_t source, uint16_t target,
+                      uint32_t tick) {
+    endShardFrame(out, beginShardFrame(out, type, source, target, tick));
+}
+
+ShardFrameStatus parseShardFrame(const uint8_t* data, size_t size, ShardFrameHeader& header) {
+    if (size < SHARD_FRAME_HEADER_SIZE) return ShardFrameStatus::NeedMore;
+    if (getFixed<uint16_t>(data) != FRAME_MAGIC || data[2] != PROTOCOL_VERSION) {
+        return ShardFrameStatus::Invalid;
+    }
+    const uint8_t type = data[3];
+    if (type < static_cast<uint8_t>(ShardMessage::Step) || type > static_cast<uint8_t>(ShardMessage::Shutdown)) {
+        return ShardFrameStatus::Invalid;
+    }
+    header.type = static_cast<ShardMessage>(type);
+    header.source = getFixed<uint16_t>(data + 4);
+    header.target = getFixed<uint16_t>(data + 6);
+    header.tick = getFixed<uint32_t>(data + 8);
+    header.length = getFixed<uint32_t>(data + 12);
+    if (header.length > SHARD_MAX_PAYLOAD) return ShardFrameStatus::Invalid;
+    if (size - SHARD_FRAME_HEADER_SIZE < header.length) return ShardFrameStatus::NeedMore;
+    return ShardFrameStatus::Ok;
+}
+
+void encodeShardStep(std::vector<uint8_t>& out, const ShardStep& step) {
+    putVarint(out, static_cast<uint64_t>(std::llround(std::max(0.0, step.dtSeconds) * 1e6)));
+    putVarint(out, step.viewStride);
+}
+
+bool decodeShardStep(const uint8_t* data, size_t size, ShardStep& step) {
+    ByteReader in{data, size, 0};
+    step.dtSeconds = in.varint() / 1e6;
+    step.viewStride = static_cast<uint32_t>(in.varint());
+    return in.ok;
+}
+
+void encodeBoundary(std::vector<uint8_t>& out, const std::vector<VehicleSnapshot>& rows) {
+    putVarint(out, rows.size());
+    int64_t previousId = 0;
+    int64_t previousLat = 0;
+    int64_t previousLon = 0;
+    for (const VehicleSnapshot& row : rows) {
+        const int64_t lat = quantizeScaled(row.lat, DEGREE_SCALE);
+        const int64_t lon = quantizeScaled(row.lon, DEGREE_SCALE);
+        putSigned(out, row.id - previousId);
+        putSigned(out, lat - previousLat);
+        putSigned(out, lon - previousLon);
+        putVarint(out, static_cast<uint64_t>(std::max<int64_t>(0, quantizeScaled(row.transmissionRange, CENTI_SCALE))));
+        previousId = row.id;
+        previousLat = lat;
+        previousLon = lon;
+    }
+}
+
+bool decodeBoundary(const uint8_t* data, size_t size, std::vector<VehicleSnapshot>& result) {
+    ByteReader in{data, size, 0};
+    const uint64_t count = in.varint();
+    if (!in.ok || !plausibleCount(count, in)) return false;
+    result.reserve(result.size() + count);
+    int64_t id = 0;
+    int64_t lat = 0;
+    int64_t lon = 0;
+    for (uint64_t i = 0; i < count && in.ok; ++i) {
+        id += in.signedVarint();
+        lat += in.signedVarint();
+        lon += in.signedVarint();
+        const double range = in.varint() / CENTI_SCALE;
+        // Pas d'antenne dans ce processus: -1 (broadphase par grille uniforme)
+        result.push_back({static_cast<int>(id), lon / DEGREE_SCALE, lat / DEGREE_SCALE, range, -1});
+    }
+    return in.ok && in.pos == in.size;
+}
+
+void encodeMigrations(std::vector<uint8_t>& out, const std::vector<VehicleMotionState>& states) {
+    putVarint(out, states.size());
+    for (const VehicleMotionState& s : states) {
+        putSigned(out, s.id);
+        putVarint(out, static_cast<uint64_t>(s.start));
+        putVarint(out, static_cast<uint64_t>(s.goal));
+        putVarint(out, static_cast<uint64_t>(s.currVertex));
+        putVarint(out, static_cast<uint64_t>(s.nextVertex));
+        putVarint(out, static_cast<uint64_t>(s.previousVertex));
+        putDouble(out, s.positionOnEdge);
+        putDouble(out, s.speed);
+        putDouble(out, s.transmissionRange);
+        putDouble(out, s.collisionDist);
+        putDouble(out, s.heading);
+        putFixed<uint64_t>(out, s.rngState);
+        out.push_back(s.onEdge ? 1 : 0);
+        putVarint(out, static_cast<uint64_t>(s.recentCount));
+        putVarint(out, static_cast<uint64_t>(s.recentHead));
+        putVarint(out, static_cast<uint64_t>(s.stuckCounter));
+        for (int i = 0; i < s.recentCount; ++i) {
+            putVarint(out, static_cast<uint64_t>(s.recentVertices[i]));
+        }
+        // Itinéraire restant: sommets voisins, donc écarts souvent petits
+        out.push_back(s.routeRequested ? 1 : 0);
+        putVarint(out, s.route.size());
+        int64_t previous = 0;
+        for (Vertex v : s.route) {
+            putSigned(out, static_cast<int64_t>(v) - previous);
+            previous = static_cast<int64_t>(v);
+        }
+    }
+}
+
+bool decodeMigrations(const uint8_t* data, size_t size, std::vector<VehicleMotionState>& result) {
+    ByteReader in{data, size, 0};
+    const uint64_t count = in.varint();
+    if (!in.ok || !plausibleCount(count, in)) return false;
+    result.reserve(result.size() + count);
+    for (uint64_t i = 0; i < count && in.ok; ++i) {
+        VehicleMotionState s;
+        s.id = static_cast<int>(in.signedVarint());
+        s.start = static_cast<Vertex>(in.varint());
+        s.goal = static_cast<Vertex>(in.varint());
+        s.currVertex = static_cast<Vertex>(in.varint());
+        s.nextVertex = static_cast<Vertex>(in.varint());
+        s.previousVertex = static_cast<Vertex>(in.varint());
+        s.positionOnEdge = in.float64();
+        s.speed = in.float64();
+        s.transmissionRange = in.float64();
+        s.collisionDist = in.float64();
+        s.heading = in.float64();
+        s.rngState = in.fixed64();
+        s.onEdge = in.byte() != 0;
+        s.recentCount = static_cast<int>(in.varint());
+        s.recentHead = static_cast<int>(in.varint());
+        s.stuckCounter = static_cast<int>(in.varint());
+        if (s.recentCount > VehicleMotionState::HISTORY_SIZE || s.recentHead >= VehicleMotionState::HISTORY_SIZE) {
+            return false;
+        }
+        for (int i = 0; i < s.recentCount; ++i) {
+            s.recentVertices[i] = static_cast<Vertex>(in.varint());
+        }
+        s.routeRequested = in.byte() != 0;
+        const uint64_t routeLength = in.varint();
+        if (!in.ok || !plausibleCount(routeLength, in)) return false;
+        s.route.resize(routeLength);
+        int64_t previous = 0;
+        for (uint64_t j = 0; j < routeLength; ++j) {
+            previous += in.signedVarint();
+            s.route[j] = static_cast<Vertex>(previous);
+        }
+        result.push_back(std::move(s));
+    }
+    return in.ok && in.pos == in.size;
+}
+
+void encodeShardStats(std::vector<uint8_t>& out, const ShardTickStats& stats) {
+    putVarint(out, stats.vehicles);
+    putVarint(out, stats.ghosts);
+    putVarint(out, stats.immigrants);
+    putVarint(out, stats.emigrants);
+    putVarint(out, stats.boundaryRows);
+    putVarint(out, stats.localEdges);
+    putVarint(out, stats.crossEdges);
+    putVarint(out, stats.comparisons);
+    putVarint(out, stats.components);
+    putDouble(out, stats.updateMs);
+    putDouble(out, stats.graphMs);
+}
+
+bool decodeShardStats(const uint8_t* data, size_t size, ShardTickStats& stats) {
+    ByteReader in{data, size, 0};
+    stats.vehicles = static_cast<uint32_t>(in.varint());
+    stats.ghosts = static_cast<uint32_t>(in.varint());
+    stats.immigrants = static_cast<uint32_t>(in.varint());
+    stats.emigrants = static_cast<uint32_t>(in.varint());
+    stats.boundaryRows = static_cast<uint32_t>(in.varint());
+    stats.localEdges = in.varint();
+    stats.crossEdges = in.varint();
+    stats.comparisons = in.varint();
+    stats.components = in.varint();
+    stats.updateMs = in.float64();
+    stats.graphMs = in.float64();
+    return in.ok && in.pos == in.size;
+}
+
+void encodeShardView(std::vector<uint8_t>& out, const std::vector<ShardViewRow>& rows) {
+    putVarint(out, rows.size());
+    int64_t previousId = 0;
+    for (const ShardViewRow& row : rows) {
+        putSigned(out, row.id - previousId);
+        putVarint(out, static_cast<uint64_t>(row.edgeSource));
+        putVarint(out, static_cast<uint64_t>(row.edgeTarget));
+        putSigned(out, quantizeScaled(row.positionOnEdge, CENTI_SCALE));
+        putSigned(out, quantizeScaled(row.speed, CENTI_SCALE));
+        putSigned(out, quantizeScaled(row.heading, CENTI_SCALE));
+        putSigned(out, quantizeScaled(row.range, CENTI_SCALE));
+        previousId = row.id;
+    }
+}
+
+bool decodeShardView(const uint8_t* data, size_t size, std::vector<ShardViewRow>& result) {
+    ByteReader in{data, size, 0};
+    const uint64_t count = in.varint();
+    if (!in.ok || !plausibleCount(count, in)) return false;
+    result.reserve(result.size() + count);
+    int64_t id = 0;
+    for (uint64_t i = 0; i < count && in.ok; ++i) {
+        ShardViewRow row;
+        id += in.signedVarint();
+        row.id = static_cast<int>(id);
+        row.edgeSource = static_cast<Vertex>(in.varint());
+        row.edgeTarget = static_cast<Vertex>(in.varint());
+        row.positionOnEdge = in.signedVarint() / CENTI_SCALE;
+        row.speed = in.signedVarint() / CENTI_SCALE;
+        row.heading = in.signedVarint() / CENTI_SCALE;
+        row.range = in.signedVarint() / CENTI_SCALE;
+        result.push_back(row);
+    }
+    return in.ok && in.pos == in.size;
+}
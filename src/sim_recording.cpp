@@ -0,0 +1,700 @@
+#include "sim_recording.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include "byte_codec.h"
+
+#ifdef V2V_ZSTD
+#include <zstd.h>
+#endif
+
+// Signatures du fichier
+static const char FILE_MAGIC[8] = {'V', '2', 'V', 'R', 'E', 'C', '\0', '\0'};
+// 2: identité du graphe routier dans l'en-tête
+static constexpr uint32_t FILE_VERSION = 2;
+static constexpr uint32_t CHUNK_MAGIC = 0x4B4E4843;  // "CHNK"
+static constexpr uint32_t INDEX_MAGIC = 0x58444E49;  // "INDX"
+static constexpr uint32_t END_MAGIC = 0x444E4556;    // "VEND"
+
+// Taille des en-têtes: magic, codec, trames, premier et dernier tick, tailles brute et stockée
+static constexpr size_t CHUNK_HEADER_SIZE = 4 + 1 + 4 + 8 + 8 + 8 + 8;
+// En-tête du fichier: magic, version, empreinte de la source, sommets, arêtes
+static constexpr size_t FILE_HEADER_SIZE = sizeof(FILE_MAGIC) + 4 + 8 + 8 + 8;
+static constexpr size_t FOOTER_SIZE = 8 + 4;
+
+// Codecs des blocs
+static constexpr uint8_t CODEC_RAW = 0;
+static constexpr uint8_t CODEC_ZSTD = 1;
+static constexpr int ZSTD_LEVEL = 3;
+// Au-delà, un bloc est tenu pour corrompu (pas d'allocation démesurée à la lecture)
+static constexpr uint64_t MAX_CHUNK_RAW_SIZE = 1ull << 30;
+
+// Quantification: centièmes (cm, cm/s, centièmes de degré, cm)
+static constexpr double QUANTUM_SCALE = 100.0;
+
+// Drapeaux d'un véhicule dans une trame différentielle
+static constexpr uint8_t FLAG_EDGE = 1 << 0;      // Nouvelle arête: source, cible, position absolue
+static constexpr uint8_t FLAG_POSITION = 1 << 1;  // Écart à la position prédite non nul
+static constexpr uint8_t FLAG_SPEED = 1 << 2;
+static constexpr uint8_t FLAG_HEADING = 1 << 3;
+static constexpr uint8_t FLAG_RANGE = 1 << 4;
+
+// Drapeaux d'une trame
+static constexpr uint8_t FRAME_KEY = 1 << 0;
+
+static int64_t quantize(double value) {
+    return std::isfinite(value) ? std::llround(value * QUANTUM_SCALE) : 0;
+}
+
+static double dequantize(int64_t value) {
+    return value / QUANTUM_SCALE;
+}
+
+// Paires triées: écart au premier ID précédent, puis écart entre les deux IDs
+static void putEdges(std::vector<uint8_t>& out, const EdgeIdList& edges) {
+    putVarint(out, edges.size());
+    int previous = 0;
+    for (const auto& [a, b] : edges) {
+        putSigned(out, static_cast<int64_t>(a) - previous);
+        putVarint(out, static_cast<uint64_t>(b - a));
+        previous = a;
+    }
+}
+
+static bool getEdges(ByteReader& in, EdgeIdList& edges) {
+    const uint64_t count = in.varint();
+    if (!in.ok || count > in.size) return false;  // Au moins un octet par paire
+    edges.resize(count);
+    int previous = 0;
+    for (auto& edge : edges) {
+        edge.first = static_cast<int>(previous + in.signedVarint());
+        edge.second = static_cast<int>(edge.first + in.varint());
+        previous = edge.first;
+    }
+    return in.ok;
+}
+
+// ---- Écriture ----
+
+RecordingWriter::~RecordingWriter() {
+    close();
+}
+
+bool RecordingWriter::compressionAvailable() {
+#ifdef V2V_ZSTD
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool RecordingWriter::open(const std::string& path, const RecordingOptions& options) {
+    close();
+
+    m_file.open(path, std::ios::binary | std::ios::trunc);
+    if (!m_file) {
+        std::cerr << "[RecordingWriter] Impossible de créer " << path << std::endl;
+        return false;
+    }
+
+    m_options = options;
+    m_options.keyframeInterval = std::max(1, m_options.keyframeInterval);
+    m_options.frameInterval = std::max(1, m_options.frameInterval);
+    m_options.maxQueuedFrames = std::max<size_t>(1, m_options.maxQueuedFrames);
+    if (m_options.compress && !compressionAvailable()) {
+        std::cout << "[RecordingWriter] Compilé sans zstd: blocs non compressés" << std::endl;
+        m_options.compress = false;
+    }
+
+    std::vector<uint8_t> header(FILE_MAGIC, FILE_MAGIC + sizeof(FILE_MAGIC));
+    putFixed<uint32_t>(header, FILE_VERSION);
+    putFixed<uint64_t>(header, m_options.graph.sourceHash);
+    putFixed<uint64_t>(header, m_options.graph.vertexCount);
+    putFixed<uint64_t>(header, m_options.graph.edgeCount);
+    m_file.write(reinterpret_cast<const char*>(header.data()), header.size());
+
+    m_state = RecordingCodecState();
+    m_chunk.clear();
+    m_chunkFrames = 0;
+    m_index.clear();
+    m_lastGraph = nullptr;
+    m_pushCount = 0;
+    m_skippedSeconds = 0.0;
+    m_queue.clear();
+    m_stopping = false;
+    m_framesWritten = 0;
+    m_bytesWritten = header.size();
+    m_failed = !m_file;
+
+    m_thread = std::thread(&RecordingWriter::run, this);
+    return true;
+}
+
+void RecordingWriter::push(uint64_t tick, double dtSeconds, const VehicleStore& store,
+                           std::shared_ptr<const InterferenceGraph> graph) {
+    if (!isOpen()) return;
+
+    // Ticks non enregistrés: leur durée est reportée sur la trame suivante
+    m_skippedSeconds += dtSeconds;
+    if (m_pushCount++ % m_options.frameInterval != 0) return;
+
+    Capture capture;
+    capture.tick = tick;
+    capture.dtSeconds = m_skippedSeconds;
+    m_skippedSeconds = 0.0;
+    capture.ids = store.ids;
+    capture.source = store.edgeSource;
+    capture.target = store.edgeTarget;
+    capture.position = store.positionOnEdge;
+    capture.speed = store.speed;
+    capture.heading = store.heading;
+    capture.range = store.range;
+    capture.graph = std::move(graph);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_notFull.wait(lock, [this] { return m_queue.size() < m_options.maxQueuedFrames; });
+    m_queue.push_back(std::move(capture));
+    m_notEmpty.notify_one();
+}
+
+void RecordingWriter::close() {
+    if (!m_thread.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_notEmpty.notify_one();
+    m_thread.join();
+    m_file.close();
+}
+
+bool RecordingWriter::failed() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_failed;
+}
+
+uint64_t RecordingWriter::framesWritten() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_framesWritten;
+}
+
+uint64_t RecordingWriter::bytesWritten() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_bytesWritten;
+}
+
+void RecordingWriter::run() {
+    while (true) {
+        Capture capture;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_notEmpty.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+            if (m_queue.empty()) break;  // Arrêt demandé et file vidée
+            capture = std::move(m_queue.front());
+            m_queue.pop_front();
+        }
+        m_notFull.notify_one();
+        encode(capture);
+    }
+
+    flushChunk();
+    writeIndex();
+    m_file.flush();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_failed = m_failed || !m_file;
+}
+
+void RecordingWriter::encode(const Capture& capture) {
+    const size_t n = capture.ids.size();
+
+    // Connexions du graphe publié, en paires d'IDs triées (inchangées si c'est le même graphe)
+    EdgeIdList edges;
+    if (capture.graph && capture.graph == m_lastGraph) {
+        edges = m_state.edges;
+    } else if (capture.graph) {
+        const auto& direct = capture.graph->getDirectEdges();
+        edges.reserve(direct.size());
+        for (const auto& e : direct) {
+            edges.emplace_back(std::min(e.id1, e.id2), std::max(e.id1, e.id2));
+        }
+        std::sort(edges.begin(), edges.end());
+    }
+    m_lastGraph = capture.graph;
+
+    // Nouveau bloc si le bloc courant est plein (trames ou octets, voir
+    // MAX_CHUNK_RAW_SIZE) ou si la flotte a changé (les trames différentielles
+    // supposent les mêmes véhicules dans le même ordre)
+    const bool sameFleet = m_state.valid && m_state.ids == capture.ids;
+    if (m_chunkFrames >= static_cast<uint32_t>(m_options.keyframeInterval) ||
+        m_chunk.size() >= MAX_CHUNK_RAW_SIZE / 2 || (m_chunkFrames > 0 && !sameFleet)) {
+        flushChunk();
+    }
+    const bool keyframe = m_chunkFrames == 0;
+    if (keyframe) {
+        m_chunkFirstTick = capture.tick;
+    }
+
+    std::vector<uint8_t>& out = m_chunk;
+    out.push_back(keyframe ? FRAME_KEY : 0);
+    putVarint(out, keyframe ? 0 : capture.tick - m_state.tick);
+    putVarint(out, static_cast<uint64_t>(std::llround(std::max(0.0, capture.dtSeconds) * 1e6)));
+
+    RecordingCodecState& s = m_state;
+    if (keyframe) {
+        putVarint(out, n);
+        s.ids = capture.ids;
+        s.source.resize(n);
+        s.target.resize(n);
+        s.position.resize(n);
+        s.positionStep.assign(n, 0);
+        s.speed.resize(n);
+        s.heading.resize(n);
+        s.range.resize(n);
+        int previousId = 0;
+        for (size_t i = 0; i < n; ++i) {
+            s.source[i] = static_cast<int64_t>(capture.source[i]);
+            s.target[i] = static_cast<int64_t>(capture.target[i]);
+            s.position[i] = quantize(capture.position[i]);
+            s.speed[i] = quantize(capture.speed[i]);
+            s.heading[i] = quantize(capture.heading[i]);
+            s.range[i] = quantize(capture.range[i]);
+            putSigned(out, static_cast<int64_t>(capture.ids[i]) - previousId);
+            putVarint(out, static_cast<uint64_t>(s.source[i]));
+            putVarint(out, static_cast<uint64_t>(s.target[i]));
+            putSigned(out, s.position[i]);
+            putSigned(out, s.speed[i]);
+            putSigned(out, s.heading[i]);
+            putSigned(out, s.range[i]);
+            previousId = capture.ids[i];
+        }
+        putEdges(out, edges);
+    } else {
+        for (size_t i = 0; i < n; ++i) {
+            const int64_t source = static_cast<int64_t>(capture.source[i]);
+            const int64_t target = static_cast<int64_t>(capture.target[i]);
+            const int64_t position = quantize(capture.position[i]);
+            const int64_t speed = quantize(capture.speed[i]);
+            const int64_t heading = quantize(capture.heading[i]);
+            const int64_t range = quantize(capture.range[i]);
+
+            // Position prédite: même déplacement qu'au tick précédent sur la même arête
+            const bool newEdge = source != s.source[i] || target != s.target[i];
+            const int64_t residual = position - s.position[i] - s.positionStep[i];
+            uint8_t flags = 0;
+            if (newEdge) flags |= FLAG_EDGE;
+            else if (residual != 0) flags |= FLAG_POSITION;
+            if (speed != s.speed[i]) flags |= FLAG_SPEED;
+            if (heading != s.heading[i]) flags |= FLAG_HEADING;
+            if (range != s.range[i]) flags |= FLAG_RANGE;
+            out.push_back(flags);
+
+            if (newEdge) {
+                putVarint(out, static_cast<uint64_t>(source));
+                putVarint(out, static_cast<uint64_t>(target));
+                putSigned(out, position);
+                s.positionStep[i] = 0;
+            } else {
+                if (flags & FLAG_POSITION) putSigned(out, residual);
+                s.positionStep[i] = position - s.position[i];
+            }
+            if (flags & FLAG_SPEED) putSigned(out, speed - s.speed[i]);
+            if (flags & FLAG_HEADING) putSigned(out, heading - s.heading[i]);
+            if (flags & FLAG_RANGE) putSigned(out, range - s.range[i]);
+
+            s.source[i] = source;
+            s.target[i] = target;
+            s.position[i] = position;
+            s.speed[i] = speed;
+            s.heading[i] = heading;
+            s.range[i] = range;
+        }
+
+        EdgeIdList added, removed;
+        std::set_difference(edges.begin(), edges.end(), s.edges.begin(), s.edges.end(),
+                            std::back_inserter(added));
+        std::set_difference(s.edges.begin(), s.edges.end(), edges.begin(), edges.end(),
+                            std::back_inserter(removed));
+        putEdges(out, added);
+        putEdges(out, removed);
+    }
+
+    s.edges = std::move(edges);
+    s.tick = capture.tick;
+    s.valid = true;
+    m_chunkLastTick = capture.tick;
+    m_chunkFrames++;
+}
+
+void RecordingWriter::flushChunk() {
+    if (m_chunkFrames == 0) return;
+
+    const uint8_t* payload = m_chunk.data();
+    size_t payloadSize = m_chunk.size();
+    uint8_t codec = CODEC_RAW;
+#ifdef V2V_ZSTD
+    std::vector<uint8_t> compressed;
+    if (m_options.compress) {
+        compressed.resize(ZSTD_compressBound(m_chunk.size()));
+        const size_t size = ZSTD_compress(compressed.data(), compressed.size(),
+                                          m_chunk.data(), m_chunk.size(), ZSTD_LEVEL);
+        if (!ZSTD_isError(size) && size < m_chunk.size()) {
+            payload = compressed.data();
+            payloadSize = size;
+            codec = CODEC_ZSTD;
+        }
+    }
+#endif
+
+    std::vector<uint8_t> header;
+    header.reserve(CHUNK_HEADER_SIZE);
+    putFixed<uint32_t>(header, CHUNK_MAGIC);
+    header.push_back(codec);
+    putFixed<uint32_t>(header, m_chunkFrames);
+    putFixed<uint64_t>(header, m_chunkFirstTick);
+    putFixed<uint64_t>(header, m_chunkLastTick);
+    putFixed<uint64_t>(header, m_chunk.size());
+    putFixed<uint64_t>(header, payloadSize);
+
+    uint64_t offset;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        offset = m_bytesWritten;
+    }
+    m_file.write(reinterpret_cast<const char*>(header.data()), header.size());
+    m_file.write(reinterpret_cast<const char*>(payload), static_cast<std::streamsize>(payloadSize));
+    m_index.push_back({m_chunkFirstTick, m_chunkLastTick, offset, m_chunkFrames});
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_bytesWritten += header.size() + payloadSize;
+        m_framesWritten += m_chunkFrames;
+        m_failed = m_failed || !m_file;
+    }
+    m_chunk.clear();
+    m_chunkFrames = 0;
+}
+
+void RecordingWriter::writeIndex() {
+    uint64_t offset;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        offset = m_bytesWritten;
+    }
+    std::vector<uint8_t> index;
+    putFixed<uint32_t>(index, INDEX_MAGIC);
+    putFixed<uint32_t>(index, static_cast<uint32_t>(m_index.size()));
+    for (const ChunkInfo& chunk : m_index) {
+        putFixed<uint64_t>(index, chunk.firstTick);
+        putFixed<uint64_t>(index, chunk.lastTick);
+        putFixed<uint64_t>(index, chunk.offset);
+        putFixed<uint32_t>(index, chunk.frameCount);
+    }
+    putFixed<uint64_t>(index, offset);
+    putFixed<uint32_t>(index, END_MAGIC);
+    m_file.write(reinterpret_cast<const char*>(index.data()), index.size());
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_bytesWritten += index.size();
+}
+
+// ---- Lecture ----
+
+bool RecordingReader::open(const std::string& path) {
+    close();
+    m_file.open(path, std::ios::binary);
+    if (!m_file) {
+        std::cerr << "[RecordingReader] Impossible d'ouvrir " << path << std::endl;
+        return false;
+    }
+
+    uint8_t header[FILE_HEADER_SIZE];
+    m_file.read(reinterpret_cast<char*>(header), sizeof(header));
+    if (!m_file || std::memcmp(header, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0 ||
+        getFixed<uint32_t>(header + sizeof(FILE_MAGIC)) != FILE_VERSION) {
+        std::cerr << "[RecordingReader] " << path << " n'est pas un enregistrement V2V" << std::endl;
+        close();
+        return false;
+    }
+    const uint8_t* identity = header + sizeof(FILE_MAGIC) + 4;
+    m_graph.sourceHash = getFixed<uint64_t>(identity);
+    m_graph.vertexCount = getFixed<uint64_t>(identity + 8);
+    m_graph.edgeCount = getFixed<uint64_t>(identity + 16);
+
+    m_file.seekg(0, std::ios::end);
+    const uint64_t fileSize = static_cast<uint64_t>(m_file.tellg());
+    m_fileSize = fileSize;
+    if (!readIndex(fileSize)) {
+        // Fichier interrompu avant l'écriture de l'index: parcourir les blocs complets
+        std::cout << "[RecordingReader] Index absent, parcours des blocs de " << path << std::endl;
+        if (!scanChunks(fileSize)) {
+            close();
+            return false;
+        }
+    }
+
+    m_frameCount = 0;
+    for (const ChunkInfo& chunk : m_chunks) m_frameCount += chunk.frameCount;
+    m_chunkIndex = m_chunks.size();
+    return rewind();
+}
+
+void RecordingReader::close() {
+    m_file.close();
+    m_file.clear();
+    m_fileSize = 0;
+    m_graph = RecordingGraphIdentity();
+    m_chunks.clear();
+    m_frameCount = 0;
+    m_chunkIndex = 0;
+    m_chunk.clear();
+    m_cursor = 0;
+    m_framesLeft = 0;
+    m_state = RecordingCodecState();
+    m_hasPending = false;
+}
+
+bool RecordingReader::readIndex(uint64_t fileSize) {
+    if (fileSize < FILE_HEADER_SIZE + FOOTER_SIZE) return false;
+
+    uint8_t footer[FOOTER_SIZE];
+    m_file.clear();
+    m_file.seekg(static_cast<std::streamoff>(fileSize - FOOTER_SIZE));
+    m_file.read(reinterpret_cast<char*>(footer), sizeof(footer));
+    if (!m_file || getFixed<uint32_t>(footer + 8) != END_MAGIC) return false;
+
+    const uint64_t indexOffset = getFixed<uint64_t>(footer);
+    if (indexOffset < FILE_HEADER_SIZE || indexOffset + 8 > fileSize - FOOTER_SIZE) return false;
+    std::vector<uint8_t> index(fileSize - FOOTER_SIZE - indexOffset);
+    m_file.seekg(static_cast<std::streamoff>(indexOffset));
+    m_file.read(reinterpret_cast<char*>(index.data()), static_cast<std::streamsize>(index.size()));
+    if (!m_file || getFixed<uint32_t>(index.data()) != INDEX_MAGIC) return false;
+
+    const uint32_t count = getFixed<uint32_t>(index.data() + 4);
+    constexpr size_t ENTRY_SIZE = 8 + 8 + 8 + 4;
+    if (index.size() != 8 + count * ENTRY_SIZE) return false;
+    m_chunks.resize(count);
+    for (uint32_t c = 0; c < count; ++c) {
+        const uint8_t* entry = index.data() + 8 + c * ENTRY_SIZE;
+        m_chunks[c] = {getFixed<uint64_t>(entry), getFixed<uint64_t>(entry + 8),
+                       getFixed<uint64_t>(entry + 16), getFixed<uint32_t>(entry + 24)};
+        if (m_chunks[c].offset > indexOffset - CHUNK_HEADER_SIZE) return false;
+    }
+    return true;
+}
+
+bool RecordingReader::scanChunks(uint64_t fileSize) {
+    m_chunks.clear();
+    uint64_t offset = FILE_HEADER_SIZE;
+    uint8_t header[CHUNK_HEADER_SIZE];
+    while (offset + CHUNK_HEADER_SIZE <= fileSize) {
+        m_file.clear();
+        m_file.seekg(static_cast<std::streamoff>(offset));
+        m_file.read(reinterpret_cast<char*>(header), sizeof(header));
+        if (!m_file || getFixed<uint32_t>(header) != CHUNK_MAGIC) break;
+
+        const uint64_t storedSize = getFixed<uint64_t>(header + 33);
+        if (offset + CHUNK_HEADER_SIZE + storedSize > fileSize) break;  // Bloc tronqué
+        m_chunks.push_back({getFixed<uint64_t>(header + 9), getFixed<uint64_t>(header + 17),
+                            offset, getFixed<uint32_t>(header + 5)});
+        offset += CHUNK_HEADER_SIZE + storedSize;
+    }
+    return !m_chunks.empty();
+}
+
+bool RecordingReader::loadChunk(size_t index) {
+    m_chunkIndex = m_chunks.size();
+    if (index >= m_chunks.size()) return false;
+
+    uint8_t header[CHUNK_HEADER_SIZE];
+    m_file.clear();
+    m_file.seekg(static_cast<std::streamoff>(m_chunks[index].offset));
+    m_file.read(reinterpret_cast<char*>(header), sizeof(header));
+    if (!m_file || getFixed<uint32_t>(header) != CHUNK_MAGIC) return false;
+
+    const uint8_t codec = header[4];
+    const uint64_t rawSize = getFixed<uint64_t>(header + 25);
+    const uint64_t storedSize = getFixed<uint64_t>(header + 33);
+    // Tailles lues dans le fichier: vérifiées avant d'allouer
+    const uint64_t available = m_fileSize - std::min(m_fileSize, m_chunks[index].offset + CHUNK_HEADER_SIZE);
+    if (storedSize > available || rawSize > MAX_CHUNK_RAW_SIZE ||
+        (codec == CODEC_RAW && rawSize != storedSize)) {
+        std::cerr << "[RecordingReader] Bloc " << index << " corrompu (tailles incohérentes)" << std::endl;
+        return false;
+    }
+    std::vector<uint8_t> stored(storedSize);
+    m_file.read(reinterpret_cast<char*>(stored.data()), static_cast<std::streamsize>(storedSize));
+    if (!m_file) return false;
+
+    if (codec == CODEC_RAW) {
+        m_chunk = std::move(stored);
+    } else if (codec == CODEC_ZSTD) {
+#ifdef V2V_ZSTD
+        m_chunk.resize(rawSize);
+        const size_t size = ZSTD_decompress(m_chunk.data(), m_chunk.size(), stored.data(), stored.size());
+        if (ZSTD_isError(size) || size != rawSize) return false;
+#else
+        (void)rawSize;
+        std::cerr << "[RecordingReader] Bloc compressé avec zstd: recompiler avec V2V_ZSTD" << std::endl;
+        return false;
+#endif
+    } else {
+        return false;
+    }
+
+    m_chunkIndex = index;
+    m_cursor = 0;
+    m_framesLeft = getFixed<uint32_t>(header + 5);
+    return true;
+}
+
+bool RecordingReader::next(RecordedFrame& frame) {
+    if (m_hasPending) {
+        m_hasPending = false;
+        frame = std::move(m_pending);
+        return true;
+    }
+    if (!isOpen()) return false;
+    while (m_framesLeft == 0) {
+        // Bloc suivant (l'état courant reste valide: sa trame complète se compare à la précédente)
+        const size_t nextChunk = m_chunkIndex < m_chunks.size() ? m_chunkIndex + 1 : m_chunks.size();
+        if (!loadChunk(nextChunk)) return false;
+    }
+    return decodeFrame(frame);
+}
+
+bool RecordingReader::seek(uint64_t tick) {
+    m_hasPending = false;
+    if (m_chunks.empty()) return false;
+
+    // Dernier bloc commençant au plus tard à tick
+    auto it = std::upper_bound(m_chunks.begin(), m_chunks.end(), tick,
+                               [](uint64_t t, const ChunkInfo& chunk) { return t < chunk.firstTick; });
+    const size_t index = it == m_chunks.begin() ? 0 : static_cast<size_t>(it - m_chunks.begin()) - 1;
+    m_state = RecordingCodecState();
+    if (!loadChunk(index)) return false;
+
+    // Décoder jusqu'à la dernière trame <= tick (la première est une trame complète)
+    if (!decodeFrame(m_pending)) return false;
+    while (m_framesLeft > 0 && peekTick() <= tick) {
+        if (!decodeFrame(m_pending)) return false;
+    }
+    m_hasPending = true;
+    return true;
+}
+
+uint64_t RecordingReader::peekTick() const {
+    // Drapeaux puis écart de tick: lisibles sans décoder la trame
+    ByteReader in{m_chunk.data(), m_chunk.size(), m_cursor};
+    const bool keyframe = in.byte() & FRAME_KEY;
+    const uint64_t tickDelta = in.varint();
+    return keyframe ? m_chunks[m_chunkIndex].firstTick : m_state.tick + tickDelta;
+}
+
+bool RecordingReader::decodeFrame(RecordedFrame& frame) {
+    ByteReader in{m_chunk.data(), m_chunk.size(), m_cursor};
+    RecordingCodecState& s = m_state;
+
+    const uint8_t frameFlags = in.byte();
+    const bool keyframe = frameFlags & FRAME_KEY;
+    const uint64_t tickDelta = in.varint();
+    const uint64_t dtMicros = in.varint();
+    if (!in.ok || (!keyframe && !s.valid)) return false;
+
+    frame.keyframe = keyframe;
+    frame.tick = keyframe ? m_chunks[m_chunkIndex].firstTick : s.tick + tickDelta;
+    frame.dtSeconds = dtMicros / 1e6;
+    frame.added.clear();
+    frame.removed.clear();
+
+    if (keyframe) {
+        const uint64_t n = in.varint();
+        if (!in.ok || n > in.size) return false;
+        s.ids.resize(n);
+        s.source.resize(n);
+        s.target.resize(n);
+        s.position.resize(n);
+        s.positionStep.assign(n, 0);
+        s.speed.resize(n);
+        s.heading.resize(n);
+        s.range.resize(n);
+        int previousId = 0;
+        for (size_t i = 0; i < n; ++i) {
+            s.ids[i] = static_cast<int>(previousId + in.signedVarint());
+            s.source[i] = static_cast<int64_t>(in.varint());
+            s.target[i] = static_cast<int64_t>(in.varint());
+            s.position[i] = in.signedVarint();
+            s.speed[i] = in.signedVarint();
+            s.heading[i] = in.signedVarint();
+            s.range[i] = in.signedVarint();
+            previousId = s.ids[i];
+        }
+        EdgeIdList edges;
+        if (!getEdges(in, edges)) return false;
+
+        // Différences avec la trame précédente si elle a été lue, sinon tout est nouveau
+        if (s.valid) {
+            std::set_difference(edges.begin(), edges.end(), s.edges.begin(), s.edges.end(),
+                                std::back_inserter(frame.added));
+            std::set_difference(s.edges.begin(), s.edges.end(), edges.begin(), edges.end(),
+                                std::back_inserter(frame.removed));
+        } else {
+            frame.added = edges;
+        }
+        s.edges = std::move(edges);
+    } else {
+        const size_t n = s.ids.size();
+        for (size_t i = 0; i < n; ++i) {
+            const uint8_t flags = in.byte();
+            if (flags & FLAG_EDGE) {
+                s.source[i] = static_cast<int64_t>(in.varint());
+                s.target[i] = static_cast<int64_t>(in.varint());
+                s.position[i] = in.signedVarint();
+                s.positionStep[i] = 0;
+            } else {
+                const int64_t residual = (flags & FLAG_POSITION) ? in.signedVarint() : 0;
+                s.positionStep[i] += residual;
+                s.position[i] += s.positionStep[i];
+            }
+            if (flags & FLAG_SPEED) s.speed[i] += in.signedVarint();
+            if (flags & FLAG_HEADING) s.heading[i] += in.signedVarint();
+            if (flags & FLAG_RANGE) s.range[i] += in.signedVarint();
+        }
+        if (!getEdges(in, frame.added) || !getEdges(in, frame.removed)) return false;
+
+        // Appliquer les différences (listes triées)
+        EdgeIdList kept;
+        kept.reserve(s.edges.size() + frame.added.size());
+        std::set_difference(s.edges.begin(), s.edges.end(), frame.removed.begin(), frame.removed.end(),
+                            std::back_inserter(kept));
+        s.edges.clear();
+        std::merge(kept.begin(), kept.end(), frame.added.begin(), frame.added.end(),
+                   std::back_inserter(s.edges));
+    }
+    if (!in.ok) return false;
+
+    s.tick = frame.tick;
+    s.valid = true;
+    m_cursor = in.pos;
+    m_framesLeft--;
+
+    const size_t n = s.ids.size();
+    frame.ids = s.ids;
+    frame.edgeSource.resize(n);
+    frame.edgeTarget.resize(n);
+    frame.positionOnEdge.resize(n);
+    frame.speed.resize(n);
+    frame.heading.resize(n);
+    frame.range.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        frame.edgeSource[i] = static_cast<uint64_t>(s.source[i]);
+        frame.edgeTarget[i] = static_cast<uint64_t>(s.target[i]);
+        frame.positionOnEdge[i] = dequantize(s.position[i]);
+        frame.speed[i] = dequantize(s.speed[i]);
+        frame.heading[i] = dequantize(s.heading[i]);
+        frame.range[i] = dequantize(s.range[i]);
+    }
+    frame.edges = s.edges;
+    return true;
+}
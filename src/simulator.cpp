@@ -6,19 +6,36 @@
 #include <QtConcurrent>
 #include <limits>
 #include <algorithm>
+#include <memory>
+#include <chrono>
+#include "parallel_for.h"
+#include "profiler.h"
 
-// Fonction statique pour calculer le graphe dans un thread séparé
-static InterferenceGraph calculateGraphAsync(const std::vector<VehicleSnapshot>& snapshots, 
-                                              bool computeTransitive,
-                                              const AntennaNeighborhood& antennaInfo) {
-    InterferenceGraph tempGraph;
-    tempGraph.enableTransitiveClosure(computeTransitive);
-    tempGraph.buildGraphFromSnapshots(snapshots, &antennaInfo);
+// En dessous de ce nombre de véhicules, la mise à jour reste séquentielle
+// (le lancement des threads coûterait plus que la mise à jour elle-même)
+static constexpr size_t PARALLEL_UPDATE_MIN_VEHICLES = 2048;
+
+// Jobs de graphe gardés pour réutilisation (un en cours, un en attente, un en capture)
+static constexpr size_t MAX_FREE_GRAPH_JOBS = 3;
+
+// Fonction statique pour calculer le graphe dans un thread séparé (ou dans le thread appelant pour stepOnce)
+// Le résultat est immuable une fois construit: il est partagé tel quel avec l'UI
+static std::shared_ptr<const InterferenceGraph> calculateGraphAsync(const GraphJob& job) {
+    auto tempGraph = std::make_shared<InterferenceGraph>();
+    tempGraph->enableTransitiveClosure(job.computeTransitive);
+    tempGraph->setBroadphaseMode(job.broadphaseMode);
+    tempGraph->setBuildThreadCount(job.threadCount);
+    if (job.neighborList) {
+        tempGraph->buildGraphIncremental(job.snapshots, *job.neighborList);
+    } else {
+        tempGraph->buildGraphFromSnapshots(job.snapshots, &job.antennaInfo);
+    }
+    tempGraph->setTickSequence(job.tickSequence);
     return tempGraph;
 }
 
-Simulator::Simulator(RoadGraph& graph, MapView* mapView, QObject* parent)
-    :graph(graph), m_mapView(mapView), QObject(parent)
+Simulator::Simulator(RoadGraph& graph, QObject* parent)
+    :QObject(parent), graph(graph), m_routePlanner(graph), m_vertexIndex(graph)
 {
     // initialize elapsed timer
     m_elapsed.start();
@@ -27,24 +44,37 @@ Simulator::Simulator(RoadGraph& graph, MapView* mapView, QObject* parent)
     m_timer = new QTimer(this);
     connect(m_timer, &QTimer::timeout, this, &Simulator::onTick);
     
-    // Initialiser la liste des vertices pour la création dynamique
-    for (auto vp = boost::vertices(graph); vp.first != vp.second; ++vp.first) {
-        m_vertices.push_back(*vp.first);
-    }
+    // Construction du graphe parallélisée sur tous les cœurs par défaut
+    m_interferenceGraph.setBuildThreadCount(0);
+    
+    // Graphe publié initial (vide): currentGraph() ne renvoie jamais nullptr
+    m_publishedGraph = std::make_shared<const InterferenceGraph>();
     
     // Créer le watcher pour les calculs asynchrones
-    m_futureWatcher = new QFutureWatcher<InterferenceGraph>(this);
-    connect(m_futureWatcher, &QFutureWatcher<InterferenceGraph>::finished, 
+    m_futureWatcher = new QFutureWatcher<void>(this);
+    connect(m_futureWatcher, &QFutureWatcher<void>::finished, 
             this, &Simulator::onGraphCalculationFinished);
+    
+    m_antennaWatcher = new QFutureWatcher<std::shared_ptr<SpatialGrid>>(this);
+    connect(m_antennaWatcher, &QFutureWatcher<std::shared_ptr<SpatialGrid>>::finished,
+            this, &Simulator::onAntennaPlacementFinished);
+    
+    m_freeGraphJobs.reserve(MAX_FREE_GRAPH_JOBS);
 }
 
 Simulator::~Simulator() {
     stop();
+    stopRecording();
     
     // Attendre la fin du calcul en cours
     if (m_futureWatcher && m_futureWatcher->isRunning()) {
         m_futureWatcher->waitForFinished();
     }
+    if (m_antennaWatcher && m_antennaWatcher->isRunning()) {
+        m_antennaWatcher->waitForFinished();
+    }
+    // Les véhicules du pool doivent être détruits avant lui
+    clearVehicles();
 }
 
 void Simulator::start(int tickIntervalMs) {
@@ -95,18 +125,32 @@ void Simulator::togglePause() {
 
 void Simulator::clearVehicles() {
     for (Vehicule* v : m_vehicles) {
-        delete v;
+        releaseVehicle(v);
     }
     m_vehicles.clear();
+    m_vehicleStore.clear();
+    m_ghostSnapshots.clear();
+    // La carte de densité publiée décrit la flotte qui vient d'être libérée
+    std::atomic_store(&m_publishedDensity, std::shared_ptr<const DensityGrid>());
 }
 
 void Simulator::reset() {
     pause();
+    m_replay.reset();
+    m_replayNextReady = false;
+    // Un calcul en cours publierait le graphe de l'ancienne flotte après le reset
+    finishGraphJobs();
     clearVehicles();
-    m_interferenceGraph.clear();
-    if (m_mapView) {
-        m_mapView->update();
+    // Un placement d'antennes en cours ne doit pas réinstaller l'ancienne flotte
+    if (m_antennaWatcher->isRunning()) {
+        m_antennaWatcher->waitForFinished();
     }
+    m_antennaResultPending = false;
+    m_pendingMacroAntennas = m_pendingMicroAntennas = -1;
+    m_interferenceGraph.clear();
+    publishGraph(std::make_shared<const InterferenceGraph>());
+    std::atomic_store(&m_publishedDensity, std::shared_ptr<const DensityGrid>());
+    emit graphUpdated();
 }
 
 void Simulator::stop() {
@@ -119,89 +163,341 @@ void Simulator::onTick() {
     double deltaTime = m_elapsed.restart() / 1000.0; // seconds
     deltaTime *= m_speedMultiplier;
 
-    // Mise à jour de la position des véhicules
-    for (Vehicule* v : m_vehicles) {
-        if(v) v->update(deltaTime);
+    // Relecture: les positions et le graphe viennent du fichier
+    if (m_replay) {
+        advanceReplay(deltaTime);
+        advanceMessages(deltaTime);
+        emit ticked(deltaTime);
+        return;
     }
 
-    // Lancer le calcul du graphe en arrière-plan si pas déjà en cours
-    if (!m_calculationInProgress && !m_vehicles.empty()) {
+    // Mise à jour de la position des véhicules (pendant que le worker
+    // construit le graphe du tick précédent)
+    updateSimulation(deltaTime);
+    m_tickSequence++;
+    Profiler::add(Profiler::Counter::Ticks);
+
+    // Réaffecter aux antennes uniquement les véhicules sortis de leur cellule
+    m_lastHandoffCount = m_interferenceGraph.updateAntennaAssignments(
+        m_vehicleStore.ids, m_vehicleStore.lat, m_vehicleStore.lon);
+
+    // Soumettre les nouvelles positions au calcul du graphe
+    if (!m_vehicles.empty()) {
         startGraphCalculation();
     }
 
+    // Le graphe enregistré est le dernier publié (en retard d'un tick ou plus sur les positions)
+    if (m_recorder) {
+        m_recorder->push(m_tickSequence, deltaTime, m_vehicleStore, currentGraph());
+    }
+
+    advanceMessages(deltaTime);
+
     emit ticked(deltaTime);
 }
 
+void Simulator::stepOnce(double deltaSeconds) {
+    if (m_replay) {
+        finishGraphJobs();
+        advanceReplay(deltaSeconds);
+        TickTimings replayTimings;
+        auto messagesStart = std::chrono::steady_clock::now();
+        replayTimings.messageEvents = static_cast<int>(advanceMessages(deltaSeconds));
+        replayTimings.messagesMs = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - messagesStart).count();
+        m_lastTickTimings = replayTimings;
+        emit ticked(deltaSeconds);
+        return;
+    }
+    stepVehicles(deltaSeconds);
+    completeStep(deltaSeconds);
+}
+
+void Simulator::finishGraphJobs() {
+    // Un calcul lancé par le timer ne doit pas publier après celui-ci
+    if (m_futureWatcher->isRunning()) {
+        m_futureWatcher->waitForFinished();
+    }
+    recycleGraphJob(std::move(m_runningJob));
+    recycleGraphJob(std::move(m_pendingJob));
+}
+
+void Simulator::stepVehicles(double deltaSeconds) {
+    if (m_replay) return;
+    finishGraphJobs();
+
+    auto stageStart = std::chrono::steady_clock::now();
+    updateSimulation(deltaSeconds);
+    m_tickSequence++;
+    Profiler::add(Profiler::Counter::Ticks);
+    m_lastTickTimings = TickTimings();
+    m_lastTickTimings.updateMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - stageStart).count();
+}
+
+void Simulator::completeStep(double deltaSeconds) {
+    if (m_replay) return;
+    using Clock = std::chrono::steady_clock;
+    auto elapsedMs = [](Clock::time_point from) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - from).count();
+    };
+
+    TickTimings timings = m_lastTickTimings;
+    auto stageStart = Clock::now();
+    m_lastHandoffCount = m_interferenceGraph.updateAntennaAssignments(
+        m_vehicleStore.ids, m_vehicleStore.lat, m_vehicleStore.lon);
+    std::shared_ptr<GraphJob> job = acquireGraphJob();
+    captureGraphJob(*job);
+    timings.snapshotMs = elapsedMs(stageStart);
+    timings.handoffs = m_lastHandoffCount;
+
+    if (!job->snapshots.empty()) {
+        std::shared_ptr<const InterferenceGraph> built = calculateGraphAsync(*job);
+        timings.closureMs = built->getLastComponentsTimeMs();
+        timings.graphBuildMs = built->getLastBuildTimeMs() - timings.closureMs;
+        timings.comparisons = built->getLastComparisons();
+        timings.edgesAdded = static_cast<int>(built->getAddedEdges().size());
+        timings.edgesRemoved = static_cast<int>(built->getRemovedEdges().size());
+        timings.neighborListRebuilt = built->wasNeighborListRebuilt();
+        if (job->buildDensity) publishDensity(job->snapshots, *built, job->densityZoom);
+        publishGraph(std::move(built));
+    }
+    recycleGraphJob(std::move(job));
+
+    stageStart = Clock::now();
+    timings.messageEvents = static_cast<int>(advanceMessages(deltaSeconds));
+    timings.messagesMs = elapsedMs(stageStart);
+    m_lastTickTimings = timings;
+
+    if (m_recorder) {
+        m_recorder->push(m_tickSequence, deltaSeconds, m_vehicleStore, currentGraph());
+    }
+
+    emit ticked(deltaSeconds);
+}
+
+void Simulator::updateSimulation(double deltaSeconds) {
+    // Chaque véhicule ne modifie que son propre état et tire ses nombres
+    // aléatoires de son propre générateur: découpage par blocs sans verrou.
+    // La ligne i du VehicleStore est réécrite par le thread qui met à jour m_vehicles[i].
+    Profiler::ScopedTimer timer(Profiler::Stage::VehicleUpdate);
+    int threads = m_vehicles.size() >= PARALLEL_UPDATE_MIN_VEHICLES ? m_updateThreadCount : 1;
+    parallelFor(m_vehicles.size(), threads, 512, [&](size_t begin, size_t end, int) {
+        for (size_t i = begin; i < end; ++i) {
+            m_vehicles[i]->update(deltaSeconds);
+            m_vehicleStore.write(i, *m_vehicles[i]);
+        }
+    });
+}
+
 void Simulator::startGraphCalculation() {
-    if (m_calculationInProgress) return;
+    if (m_calculationInProgress) {
+        switch (m_backpressurePolicy) {
+        case BackpressurePolicy::Drop:
+            // Le worker est en retard: ces positions ne seront jamais calculées
+            m_droppedGraphJobs++;
+            Profiler::add(Profiler::Counter::DroppedGraphJobs);
+            return;
+        case BackpressurePolicy::Coalesce:
+            // Remplacer le snapshot en attente par le plus récent (mêmes tampons)
+            if (m_pendingJob) {
+                m_droppedGraphJobs++;
+                Profiler::add(Profiler::Counter::DroppedGraphJobs);
+            } else {
+                m_pendingJob = acquireGraphJob();
+            }
+            captureGraphJob(*m_pendingJob);
+            if (m_pendingJob->snapshots.empty()) {
+                recycleGraphJob(std::move(m_pendingJob));
+            }
+            return;
+        case BackpressurePolicy::Block:
+            // Attendre le worker: la simulation ralentit au rythme du calcul
+            m_futureWatcher->waitForFinished();
+            m_calculationInProgress = false;
+            recycleGraphJob(std::move(m_runningJob));
+            break;
+        }
+    }
     
-    // Créer les snapshots des véhicules avec leurs infos d'antenne
-    std::vector<VehicleSnapshot> snapshots;
-    snapshots.reserve(m_vehicles.size());
+    std::shared_ptr<GraphJob> job = acquireGraphJob();
+    captureGraphJob(*job);
+    launchGraphJob(std::move(job));
+}
+
+std::shared_ptr<GraphJob> Simulator::acquireGraphJob() {
+    if (m_freeGraphJobs.empty()) {
+        return std::make_shared<GraphJob>();
+    }
+    std::shared_ptr<GraphJob> job = std::move(m_freeGraphJobs.back());
+    m_freeGraphJobs.pop_back();
+    return job;
+}
+
+void Simulator::recycleGraphJob(std::shared_ptr<GraphJob> job) {
+    if (!job) return;
+    // Ne pas prolonger la vie des listes de Verlet d'un mode désactivé entre-temps
+    job->neighborList = nullptr;
+    if (m_freeGraphJobs.size() < MAX_FREE_GRAPH_JOBS) {
+        m_freeGraphJobs.push_back(std::move(job));
+    }
+}
+
+void Simulator::captureGraphJob(GraphJob& job) const {
+    Profiler::ScopedTimer timer(Profiler::Stage::Snapshot);
+    job.tickSequence = m_tickSequence;
+    job.computeTransitive = m_interferenceGraph.isTransitiveClosureEnabled();
+    job.broadphaseMode = m_interferenceGraph.getBroadphaseMode();
+    job.threadCount = m_interferenceGraph.getBuildThreadCount();
+    job.buildDensity = m_densityEnabled;
+    job.densityZoom = m_densityZoom;
+    job.neighborList = m_neighborList;
+    
+    // Créer les snapshots des véhicules avec leurs infos d'antenne,
+    // en lisant les tableaux contigus du VehicleStore (pas de Vehicule*).
+    // Les tableaux du job précédent sont réécrits sur place (capacité conservée).
+    const VehicleStore& store = m_vehicleStore;
+    std::vector<VehicleSnapshot>& snapshots = job.snapshots;
+    snapshots.resize(store.size());
     
     // Récupérer la grille spatiale pour les infos d'antennes
     const SpatialGrid& spatialGrid = m_interferenceGraph.getSpatialGrid();
     
-    for (size_t i = 0; i < m_vehicles.size(); ++i) {
-        const Vehicule* v = m_vehicles[i];
-        if (v) {
-            auto [lat, lon] = v->getPosition();
-            int microAntennaId = spatialGrid.getMicroAntennaId(v->getId());
-            snapshots.push_back({
-                v->getId(),
-                lon,
-                lat,
-                v->getTransmissionRange(),
-                microAntennaId
-            });
-        }
+    for (size_t i = 0; i < store.size(); ++i) {
+        snapshots[i] = {
+            store.ids[i],
+            store.lon[i],
+            store.lat[i],
+            store.range[i],
+            spatialGrid.getMicroAntennaId(store.ids[i])
+        };
     }
-    
-    if (snapshots.empty()) return;
-    
-    // Créer les infos de voisinage d'antennes
-    AntennaNeighborhood antennaInfo;
-    
-    // Remplir les véhicules par antenne (utiliser l'index dans snapshots)
-    for (size_t i = 0; i < snapshots.size(); ++i) {
-        int antennaId = snapshots[i].microAntennaId;
-        if (antennaId >= 0) {
-            antennaInfo.vehiclesPerAntenna[antennaId].push_back(i);
+    // Véhicules des shards voisins (mode réparti): positions seules, sans antenne
+    snapshots.insert(snapshots.end(), m_ghostSnapshots.begin(), m_ghostSnapshots.end());
+    
+    // Créer les infos de voisinage d'antennes (inutiles avec la grille uniforme
+    // et en mode incrémental, qui a sa propre grille)
+    AntennaNeighborhood& antennaInfo = job.antennaInfo;
+    if (!snapshots.empty() && job.broadphaseMode == BroadphaseMode::Antennas && !job.neighborList) {
+        if (job.antennaLayout != spatialGrid.getLayoutVersion()) {
+            // Antennes replacées (ou portée changée): recopier leurs voisinages
+            // depuis la grille spatiale, les listes des anciennes antennes disparaissent
+            antennaInfo.vehiclesPerAntenna.clear();
+            antennaInfo.neighborAntennas.clear();
+            for (const auto& [antennaId, micro] : spatialGrid.getMicroAntennas()) {
+                antennaInfo.neighborAntennas[antennaId] = micro.neighborMicroIds;
+            }
+            job.antennaLayout = spatialGrid.getLayoutVersion();
+        } else {
+            // Mêmes antennes: seules les listes de véhicules sont à refaire
+            for (auto& [antennaId, vehicleIndices] : antennaInfo.vehiclesPerAntenna) {
+                vehicleIndices.clear();
+            }
+        }
+        
+        // Remplir les véhicules par antenne (utiliser l'index dans snapshots)
+        for (size_t i = 0; i < snapshots.size(); ++i) {
+            int antennaId = snapshots[i].microAntennaId;
+            if (antennaId >= 0) {
+                antennaInfo.vehiclesPerAntenna[antennaId].push_back(i);
+            }
         }
+    } else if (!antennaInfo.vehiclesPerAntenna.empty()) {
+        // Infos d'antennes inutilisées: oublier celles d'un tick précédent
+        antennaInfo.vehiclesPerAntenna.clear();
+        antennaInfo.neighborAntennas.clear();
+        job.antennaLayout = 0;
     }
-    
-    // Copier les voisinages d'antennes depuis la grille spatiale
-    const auto& microAntennas = spatialGrid.getMicroAntennas();
-    for (const auto& [antennaId, micro] : microAntennas) {
-        antennaInfo.neighborAntennas[antennaId] = micro.neighborMicroIds;
+}
+
+void Simulator::launchGraphJob(std::shared_ptr<GraphJob> job) {
+    if (job->snapshots.empty()) {
+        recycleGraphJob(std::move(job));
+        return;
     }
     
     m_calculationInProgress = true;
-    
-    // Récupérer le flag de fermeture transitive
-    bool computeTransitive = m_interferenceGraph.isTransitiveClosureEnabled();
-    
-    // Lancer le calcul dans un thread séparé
-    QFuture<InterferenceGraph> future = QtConcurrent::run(calculateGraphAsync, snapshots, computeTransitive, antennaInfo);
+    m_runningJob = job;
+    
+    // Lancer le calcul dans un thread séparé; le worker publie lui-même le
+    // résultat par échange de pointeur, sans copie sur le thread GUI.
+    // QtConcurrent copie le foncteur: seul le shared_ptr est copié, pas le job.
+    QFuture<void> future = QtConcurrent::run([this, job = std::move(job)]() {
+        std::shared_ptr<const InterferenceGraph> built = calculateGraphAsync(*job);
+        if (job->buildDensity) publishDensity(job->snapshots, *built, job->densityZoom);
+        publishGraph(std::move(built));
+    });
     m_futureWatcher->setFuture(future);
 }
 
+void Simulator::setIncrementalGraph(bool enabled, double skinFraction) {
+    // Nouvelles listes à chaque changement: un job en cours garde sa propre
+    // référence sur les anciennes et les libère en se terminant
+    m_neighborList = nullptr;
+    if (enabled) {
+        m_neighborList = std::make_shared<VerletNeighborList>();
+        m_neighborList->setSkinFraction(skinFraction);
+    }
+}
+
+int Simulator::graphLatencyTicks() const {
+    return static_cast<int>(m_tickSequence - currentGraph()->getTickSequence());
+}
+
+std::shared_ptr<const InterferenceGraph> Simulator::currentGraph() const {
+    return std::atomic_load(&m_publishedGraph);
+}
+
+void Simulator::publishGraph(std::shared_ptr<const InterferenceGraph> graph) {
+    // L'ancien graphe est libéré quand le dernier lecteur relâche sa référence
+    // (ici même si l'interface ne le lit plus: la mesure inclut alors sa libération)
+    Profiler::ScopedTimer timer(Profiler::Stage::GraphPublish);
+    std::atomic_store(&m_publishedGraph, std::move(graph));
+}
+
+void Simulator::publishDensity(const std::vector<VehicleSnapshot>& snapshots, const InterferenceGraph& graph,
+                               int zoom) {
+    auto density = std::make_shared<const DensityGrid>(DensityGrid::build(snapshots, graph, zoom));
+    std::atomic_store(&m_publishedDensity, std::move(density));
+}
+
+std::shared_ptr<const DensityGrid> Simulator::currentDensity() const {
+    return std::atomic_load(&m_publishedDensity);
+}
+
+void Simulator::setDensityMap(bool enabled) {
+    if (enabled == m_densityEnabled) return;
+    m_densityEnabled = enabled;
+    if (!enabled) {
+        // Un job déjà lancé peut encore publier une carte: la vue ne la lit plus
+        std::atomic_store(&m_publishedDensity, std::shared_ptr<const DensityGrid>());
+    }
+}
+
 void Simulator::onGraphCalculationFinished() {
-    // Récupérer le résultat et le copier dans le graphe principal
-    InterferenceGraph result = m_futureWatcher->result();
-    m_interferenceGraph.copyFrom(result);
+    // Signal d'un calcul déjà attendu (Block) alors qu'un autre tourne: ignorer
+    if (!m_futureWatcher->isFinished()) return;
     
+    // Le résultat est déjà publié par le worker: il ne reste qu'à redessiner.
+    // Le worker ne lit plus son job: ses tampons servent au prochain tick.
     m_calculationInProgress = false;
+    recycleGraphJob(std::move(m_runningJob));
     
-    // Redessiner la vue
-    if (m_mapView) {
-        m_mapView->update();
+    // Coalesce: lancer immédiatement le snapshot le plus récent en attente
+    if (m_pendingJob) {
+        launchGraphJob(std::move(m_pendingJob));
     }
+    
+    // Redessiner la vue
+    emit graphUpdated();
 }
 
 void Simulator::addVehicle(Vehicule* v) {
     if(v) {
+        v->seedRandom(m_randomSeed);
+        v->setRoutePlanner(&m_routePlanner);
         m_vehicles.push_back(v);
+        m_vehicleStore.push(*v);
         // Assigner le nouveau véhicule à son antenne
         m_interferenceGraph.assignVehicleToAntenna(v);
         emit vehicleCountChanged(m_vehicles.size());
@@ -211,12 +507,16 @@ void Simulator::addVehicle(Vehicule* v) {
 bool Simulator::removeVehicle(Vehicule* v) {
     if (!v) return false;
     
-    auto it = std::find(m_vehicles.begin(), m_vehicles.end(), v);
-    if (it != m_vehicles.end()) {
+    // Ligne du véhicule via la table ID -> ligne du store (plus de parcours linéaire)
+    const int row = m_vehicleStore.rowOf(v->getId());
+    if (row >= 0 && m_vehicles[row] == v) {
         // Retirer le véhicule de son antenne avant de le supprimer
         m_interferenceGraph.removeVehicleFromAntenna(v->getId());
-        m_vehicles.erase(it);
-        delete v;
+        // Le dernier véhicule prend sa ligne (O(1), l'ordre des lignes n'est pas conservé)
+        m_vehicles[row] = m_vehicles.back();
+        m_vehicles.pop_back();
+        m_vehicleStore.swapRemove(row);
+        releaseVehicle(v);
         // Le graphe sera recalculé au prochain tick par le worker thread
         emit vehicleCountChanged(m_vehicles.size());
         return true;
@@ -224,49 +524,78 @@ bool Simulator::removeVehicle(Vehicule* v) {
     return false;
 }
 
-Vehicule* Simulator::createVehicleNear(double lon, double lat) {
-    if (m_vertices.empty()) return nullptr;
-    
-    // Trouver le vertex le plus proche de la position cliquée
-    Vertex nearestVertex = m_vertices[0];
-    double minDist = std::numeric_limits<double>::max();
-    
-    // Parcourir tous les vertices pour trouver le plus proche
-    for (const Vertex& v : m_vertices) {
-        double vLat = graph[v].lat;
-        double vLon = graph[v].lon;
-        double dist = (vLon - lon) * (vLon - lon) + (vLat - lat) * (vLat - lat);  // Distance² (plus rapide)
-        if (dist < minDist) {
-            // Vérifier la validité seulement pour les candidats proches
-            if (Vehicule::isValidVertex(v, graph) && Vehicule::hasValidOutgoingEdge(v, graph)) {
-                minDist = dist;
-                nearestVertex = v;
-            }
+Vehicule* Simulator::createVehicle(int id, Vertex start, Vertex goal, double speed,
+                                   double range, double collisionDist) {
+    Vehicule* v = m_vehiclePool.create(id, graph, start, goal, speed, range, collisionDist);
+    addVehicle(v);
+    return v;
+}
+
+Vehicule* Simulator::adoptVehicle(const VehicleMotionState& state) {
+    Vehicule* v = m_vehiclePool.create(state.id, graph, state.start, state.goal, state.speed,
+                                       state.transmissionRange, state.collisionDist);
+    addVehicle(v);
+    // Après addVehicle (qui réinitialise le générateur): reprendre l'état exact,
+    // puis réécrire la ligne du store avec la position restaurée
+    v->restoreMotionState(state);
+    m_vehicleStore.write(m_vehicleStore.rowOf(state.id), *v);
+    return v;
+}
+
+void Simulator::setGhostVehicles(const std::vector<VehicleSnapshot>& ghosts) {
+    m_ghostSnapshots.assign(ghosts.begin(), ghosts.end());
+}
+
+void Simulator::releaseVehicle(Vehicule* v) {
+    if (m_vehiclePool.owns(v)) {
+        m_vehiclePool.destroy(v);
+    } else {
+        delete v;
+    }
+}
+
+void Simulator::planRoutes() {
+    std::vector<Vehicule*> pending;
+    std::vector<std::pair<Vertex, Vertex>> trips;
+    for (Vehicule* v : m_vehicles) {
+        if (!v->hasRoute()) {
+            pending.push_back(v);
+            trips.emplace_back(v->getCurrentVertex(), v->getGoal());
         }
     }
-    
-    // Choisir un goal aléatoire
-    Vertex goal = m_vertices[rand() % m_vertices.size()];
-    int attempts = 0;
-    while ((!Vehicule::isValidVertex(goal, graph) || !Vehicule::hasValidOutgoingEdge(goal, graph)) && attempts < 100) {
-        goal = m_vertices[rand() % m_vertices.size()];
-        attempts++;
+    if (trips.empty()) return;
+
+    std::vector<RoutePlanner::Route> routes = m_routePlanner.planBatch(trips, m_updateThreadCount);
+    for (size_t i = 0; i < pending.size(); ++i) {
+        pending[i]->setRoute(routes[i]);
     }
+    std::cout << "[Simulator] " << trips.size() << " itinéraires planifiés ("
+              << m_routePlanner.cacheHits() << " trouvés dans le cache)" << std::endl;
+}
+
+Vehicule* Simulator::createVehicleNear(double lon, double lat) {
+    if (m_vertexIndex.empty() || m_replay) return nullptr;
+    
+    // Sommet praticable le plus proche de la position cliquée (R-tree, O(log n))
+    Vertex nearestVertex;
+    m_vertexIndex.nearest(lon, lat, nearestVertex);
+    
+    // Choisir un goal aléatoire parmi les sommets praticables
+    Vertex goal = m_vertexIndex.randomVertex(rand());
     
     // Créer le véhicule
     double speed = 14;          // 50 km/h en m/s
     double range = 500.0;
     double collisionDist = 5.0;
     
-    Vehicule* car = new Vehicule(m_nextVehicleId++, graph, nearestVertex, goal,
-                                 speed, range, collisionDist);
-    // Utiliser addVehicle pour assigner le véhicule à une antenne
-    addVehicle(car);
-    
-    return car;
+    // createVehicle passe par addVehicle pour assigner le véhicule à une antenne
+    return createVehicle(m_nextVehicleId++, nearestVertex, goal, speed, range, collisionDist);
 }
 
 void Simulator::setVehicleCount(int count) {
+    // En relecture, la flotte est celle du fichier
+    if (m_replay) return;
+
     int currentCount = m_vehicles.size();
     
     if (count == currentCount) {
@@ -281,39 +610,30 @@ void Simulator::setVehicleCount(int count) {
             // Retirer le véhicule de son antenne avant de le supprimer
             m_interferenceGraph.removeVehicleFromAntenna(v->getId());
             m_vehicles.pop_back();
-            delete v;
+            m_vehicleStore.popBack();
+            releaseVehicle(v);
         }
     } else {
         // Ajouter des véhicules
         int toAdd = count - currentCount;
         
         for (int i = 0; i < toAdd; ++i) {
-            if (m_vertices.empty()) break;
-            
-            // Choisir aléatoirement start et goal
-            Vertex start = m_vertices[rand() % m_vertices.size()];
-            Vertex goal = m_vertices[rand() % m_vertices.size()];
+            if (m_vertexIndex.empty()) break;
             
-            // Vérifier que les vertices sont valides
-            while (!Vehicule::isValidVertex(start, graph) && 
-                   !Vehicule::hasValidOutgoingEdge(start, graph)) {
-                start = m_vertices[rand() % m_vertices.size()];
-            }
-            
-            while (!Vehicule::isValidVertex(goal, graph) && 
-                   !Vehicule::hasValidOutgoingEdge(goal, graph)) {
-                goal = m_vertices[rand() % m_vertices.size()];
-            }
+            // Choisir aléatoirement start et goal parmi les sommets praticables
+            Vertex start = m_vertexIndex.randomVertex(rand());
+            Vertex goal = m_vertexIndex.randomVertex(rand());
             
             // Créer le nouveau véhicule avec les mêmes paramètres
             double speed = 14;          // 50 km/h in m/s
             double range = 500.0;        // transmission range
             double collisionDist = 5.0;   // 5 meters
             
-            Vehicule* car = new Vehicule(m_nextVehicleId++, graph, start, goal, 
-                                        speed, range, collisionDist);
-            addVehicle(car);
+            createVehicle(m_nextVehicleId++, start, goal, speed, range, collisionDist);
         }
+        
+        // Itinéraires des nouveaux véhicules calculés en lot
+        planRoutes();
     }
     
     // Le graphe sera recalculé au prochain tick par le worker thread
@@ -322,17 +642,293 @@ void Simulator::setVehicleCount(int count) {
     emit vehicleCountChanged(m_vehicles.size());
 }
 
+RecordingGraphIdentity Simulator::roadGraphIdentity() const {
+    RecordingGraphIdentity identity;
+    identity.sourceHash = m_roadGraphSourceHash;
+    identity.vertexCount = boost::num_vertices(graph);
+    identity.edgeCount = boost::num_edges(graph);
+    return identity;
+}
+
+bool Simulator::startRecording(const std::string& path, const RecordingOptions& options) {
+    stopRecording();
+    auto recorder = std::make_unique<RecordingWriter>();
+    RecordingOptions recordingOptions = options;
+    recordingOptions.graph = roadGraphIdentity();
+    if (!recorder->open(path, recordingOptions)) {
+        std::cerr << "[Simulator] Impossible de créer l'enregistrement " << path << std::endl;
+        return false;
+    }
+    m_recorder = std::move(recorder);
+    std::cout << "[Simulator] Enregistrement dans " << path
+              << (options.compress && RecordingWriter::compressionAvailable() ? " (zstd)" : "") << std::endl;
+    return true;
+}
+
+void Simulator::stopRecording() {
+    if (!m_recorder) return;
+    m_recorder->close();
+    std::cout << "[Simulator] Enregistrement terminé: " << m_recorder->framesWritten() << " trames, "
+              << m_recorder->bytesWritten() << " octets" << std::endl;
+    m_recorder.reset();
+}
+
+bool Simulator::openReplay(const std::string& path) {
+    auto reader = std::make_unique<RecordingReader>();
+    if (!reader->open(path) || reader->frameCount() == 0) {
+        std::cerr << "[Simulator] Enregistrement illisible: " << path << std::endl;
+        return false;
+    }
+    // Les arêtes enregistrées sont des indices de sommets: autre graphe, autres routes
+    const RecordingGraphIdentity expected = roadGraphIdentity();
+    const RecordingGraphIdentity& recorded = reader->graphIdentity();
+    if (recorded != expected) {
+        std::cerr << "[Simulator] " << path << " a été enregistré sur un autre graphe routier ("
+                  << recorded.vertexCount << " sommets, " << recorded.edgeCount << " arêtes, empreinte "
+                  << std::hex << recorded.sourceHash << " au lieu de " << expected.sourceHash << std::dec
+                  << ", " << expected.vertexCount << " sommets, " << expected.edgeCount << " arêtes)" << std::endl;
+        return false;
+    }
+
+    // Plus aucun véhicule simulé: attendre les calculs qui les utilisent encore
+    stopRecording();
+    if (m_futureWatcher->isRunning()) {
+        m_futureWatcher->waitForFinished();
+    }
+    m_calculationInProgress = false;
+    recycleGraphJob(std::move(m_runningJob));
+    recycleGraphJob(std::move(m_pendingJob));
+    if (m_antennaWatcher->isRunning()) {
+        m_antennaWatcher->waitForFinished();
+    }
+    m_antennaResultPending = false;
+    m_pendingMacroAntennas = m_pendingMicroAntennas = -1;
+    clearVehicles();
+    m_interferenceGraph.clear();
+
+    m_replay = std::move(reader);
+    m_replayNextReady = false;
+    m_replayClock = 0.0;
+    std::cout << "[Simulator] Relecture de " << path << ": " << m_replay->frameCount() << " trames (ticks "
+              << m_replay->firstTick() << " à " << m_replay->lastTick() << ", "
+              << m_replay->chunkCount() << " blocs)" << std::endl;
+    return stepReplayFrame();
+}
+
+void Simulator::closeReplay() {
+    if (!m_replay) return;
+    m_replay.reset();
+    m_replayNextReady = false;
+    m_vehicleStore.clear();
+    publishGraph(std::make_shared<const InterferenceGraph>());
+    emit vehicleCountChanged(0);
+    emit graphUpdated();
+}
+
+bool Simulator::seekReplay(uint64_t tick) {
+    if (!m_replay || !m_replay->seek(tick)) return false;
+    m_replayNextReady = false;
+    m_replayClock = 0.0;
+    return stepReplayFrame();
+}
+
+bool Simulator::stepReplayFrame() {
+    if (!m_replay) return false;
+    if (!m_replayNextReady && !m_replay->next(m_replayNext)) return false;
+    m_replayNextReady = false;
+    applyReplayFrame(m_replayNext);
+    return true;
+}
+
+void Simulator::advanceReplay(double deltaSeconds) {
+    // Les trames suivent le temps simulé enregistré; si plusieurs sont dues
+    // dans le même tick, seule la dernière est affichée
+    m_replayClock += deltaSeconds;
+    RecordedFrame due;
+    bool hasDue = false;
+    while (true) {
+        if (!m_replayNextReady) {
+            m_replayNextReady = m_replay->next(m_replayNext);
+            if (!m_replayNextReady) {
+                // Fin du fichier: la dernière trame reste affichée
+                m_replayClock = 0.0;
+                break;
+            }
+        }
+        if (m_replayNext.dtSeconds > m_replayClock) break;
+        m_replayClock -= m_replayNext.dtSeconds;
+        std::swap(due, m_replayNext);
+        m_replayNextReady = false;
+        hasDue = true;
+    }
+    if (hasDue) {
+        applyReplayFrame(due);
+    }
+}
+
+void Simulator::applyReplayFrame(const RecordedFrame& frame) {
+    const size_t previousCount = m_vehicleStore.size();
+    const size_t n = frame.ids.size();
+    const size_t numVertices = boost::num_vertices(graph);
+    m_vehicleStore.setIds(frame.ids);
+
+    std::vector<VehicleSnapshot> snapshots(n);
+    for (size_t i = 0; i < n; ++i) {
+        const Vertex source = static_cast<Vertex>(frame.edgeSource[i]);
+        const Vertex target = static_cast<Vertex>(frame.edgeTarget[i]);
+        m_vehicleStore.edgeSource[i] = source;
+        m_vehicleStore.edgeTarget[i] = target;
+        m_vehicleStore.positionOnEdge[i] = frame.positionOnEdge[i];
+        m_vehicleStore.speed[i] = frame.speed[i];
+        m_vehicleStore.heading[i] = frame.heading[i];
+        m_vehicleStore.range[i] = frame.range[i];
+
+        // Même interpolation que Vehicule::getPosition (source = sommet de départ)
+        double lat = 0.0, lon = 0.0;
+        if (source < numVertices && target < numVertices) {
+            lat = graph[source].lat;
+            lon = graph[source].lon;
+            if (source != target) {
+                auto [roadEdge, exists] = boost::edge(source, target, graph);
+                const double length = exists ? graph[roadEdge].distance : 0.0;
+                if (length > 0.0) {
+                    const double t = std::clamp(frame.positionOnEdge[i] / length, 0.0, 1.0);
+                    lat += t * (graph[target].lat - graph[source].lat);
+                    lon += t * (graph[target].lon - graph[source].lon);
+                }
+            }
+        }
+        m_vehicleStore.lat[i] = lat;
+        m_vehicleStore.lon[i] = lon;
+        snapshots[i] = {frame.ids[i], lon, lat, frame.range[i], -1};
+    }
+
+    auto built = std::make_shared<InterferenceGraph>();
+    built->enableTransitiveClosure(m_interferenceGraph.isTransitiveClosureEnabled());
+    built->buildGraphFromEdges(snapshots, frame.edges, frame.added, frame.removed);
+    built->setTickSequence(frame.tick);
+    m_tickSequence = frame.tick;
+    if (m_densityEnabled) {
+        publishDensity(snapshots, *built, m_densityZoom);
+    }
+    publishGraph(std::move(built));
+
+    if (n != previousCount) {
+        emit vehicleCountChanged(static_cast<int>(n));
+    }
+    emit graphUpdated();
+}
+
+void Simulator::setMessagePropagation(bool enabled) {
+    if (enabled == m_messagesEnabled) return;
+    m_messagesEnabled = enabled;
+    // Repartir de zéro: les statistiques affichées couvrent la période active
+    m_messageEngine.clear();
+    m_messageBacklog = 0.0;
+    m_simulatedMs = 0.0;
+}
+
+size_t Simulator::advanceMessages(double deltaSeconds) {
+    if (!m_messagesEnabled) return 0;
+
+    m_simulatedMs += deltaSeconds * 1000.0;
+    m_messageBacklog += m_messageRate * deltaSeconds;
+    const int count = static_cast<int>(m_messageBacklog);
+    m_messageBacklog -= count;
+    m_messageEngine.broadcastRandom(m_vehicleStore.ids, count);
+
+    // Les diffusions du tick suivent le dernier graphe publié
+    std::shared_ptr<const InterferenceGraph> graphSnapshot = currentGraph();
+    return m_messageEngine.advanceTo(m_simulatedMs, *graphSnapshot);
+}
+
 void Simulator::placeAntennas(int numLarge, int numSmall) {
     if (m_vehicles.empty()) {
         std::cout << "[Simulator] Pas de véhicules pour placer les antennes" << std::endl;
         return;
     }
     
+    if (m_antennaWatcher->isRunning()) {
+        // Un seul K-means à la fois: garder la demande la plus récente pour la suite
+        m_pendingMacroAntennas = numLarge;
+        m_pendingMicroAntennas = numSmall;
+        return;
+    }
+    
+    launchAntennaPlacement(numLarge, numSmall);
+}
+
+void Simulator::launchAntennaPlacement(int numLarge, int numSmall) {
+    if (m_vehicleStore.size() < 20) {
+        std::cout << "[Simulator] Pas assez de véhicules pour la grille spatiale" << std::endl;
+        return;
+    }
+    
     std::cout << "[Simulator] Placement des antennes: " << numLarge << " grandes, " 
               << numSmall << " petites par grande" << std::endl;
     
-    // Réinitialiser la grille avec les nouveaux paramètres
-    m_interferenceGraph.reinitializeSpatialGrid(m_vehicles, numLarge, numSmall);
+    // Copie de la grille courante: réglages conservés (hystérésis, threads) et
+    // centres actuels comme départ à chaud. Le worker ne touche qu'à ses copies.
+    auto grid = std::make_shared<SpatialGrid>(m_interferenceGraph.getSpatialGrid());
+    grid->setMaxTransmissionRange(m_vehicleStore.range[0]);  // Tous les véhicules ont la même portée
+    grid->setThreadCount(m_interferenceGraph.getBuildThreadCount());
+    std::vector<int> ids = m_vehicleStore.ids;
+    std::vector<double> lats = m_vehicleStore.lat;
+    std::vector<double> lons = m_vehicleStore.lon;
+    
+    m_antennaResultPending = true;
+    QFuture<std::shared_ptr<SpatialGrid>> future = QtConcurrent::run(
+        [grid, ids = std::move(ids), lats = std::move(lats), lons = std::move(lons), numLarge, numSmall]() {
+        auto startTime = std::chrono::steady_clock::now();
+        grid->initialize(ids, lats, lons, numLarge, numSmall, grid->getMacroCenters());
+        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - startTime);
+        std::cout << "[Simulator] Antennes placées en " << duration.count() << " ms ("
+                  << grid->getLastKMeansIterations() << " itérations K-means)" << std::endl;
+        return grid;
+    });
+    m_antennaWatcher->setFuture(future);
+}
+
+void Simulator::applyAntennaPlacement() {
+    if (!m_antennaResultPending) return;
+    m_antennaResultPending = false;
+    
+    std::shared_ptr<SpatialGrid> grid = m_antennaWatcher->result();
+    m_interferenceGraph.adoptSpatialGrid(std::move(*grid));
+    
+    // Véhicules supprimés pendant le calcul: les retirer de leur antenne.
+    // Ceux ajoutés entre-temps sont assignés au prochain tick.
+    for (int vehicleId : m_interferenceGraph.getSpatialGrid().assignedVehicleIds()) {
+        if (m_vehicleStore.rowOf(vehicleId) < 0) {
+            m_interferenceGraph.removeVehicleFromAntenna(vehicleId);
+        }
+    }
     
+    // Les listes de Verlet ne dépendent pas des antennes: rien à invalider.
     // Le graphe sera recalculé au prochain tick par le worker thread
-}
\ No newline at end of file
+    emit antennasPlaced();
+}
+
+void Simulator::onAntennaPlacementFinished() {
+    // Signal d'un placement déjà appliqué par waitForAntennas alors qu'un autre tourne
+    if (!m_antennaWatcher->isFinished()) return;
+    
+    applyAntennaPlacement();
+    
+    if (m_pendingMacroAntennas >= 0) {
+        const int numLarge = m_pendingMacroAntennas;
+        const int numSmall = m_pendingMicroAntennas;
+        m_pendingMacroAntennas = m_pendingMicroAntennas = -1;
+        placeAntennas(numLarge, numSmall);
+    }
+}
+
+void Simulator::waitForAntennas() {
+    while (m_antennaWatcher->isRunning() || m_antennaResultPending) {
+        m_antennaWatcher->waitForFinished();
+        // Le signal finished arrivera plus tard dans la boucle d'événements:
+        // appliquer ici (applyAntennaPlacement ne s'exécute qu'une fois)
+        onAntennaPlacementFinished();
+    }
+}
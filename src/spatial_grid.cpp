@@ -2,13 +2,30 @@
 #include "vehicule.h"
 #include <iostream>
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <limits>
+#include <random>
+#include "parallel_for.h"
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
 
+// Mètres par degré de latitude (projection locale du K-means et de la grille des voisinages)
+static constexpr double METERS_PER_DEG = 111000.0;
+
+// K-means: plafond d'itérations de Lloyd, arrêt quand aucun centre ne bouge de plus de
+// KMEANS_TOLERANCE × rayon moyen des grandes antennes, taille des blocs de véhicules
+// (unité de travail et de réduction)
+static constexpr int KMEANS_MAX_ITERATIONS = 100;
+static constexpr double KMEANS_TOLERANCE = 0.01;
+static constexpr size_t KMEANS_BLOCK = 4096;
+static constexpr uint64_t KMEANS_SEED = 0x5eed;
+
+// Source des identifiants de disposition (getLayoutVersion), partagée par toutes les grilles
+static std::atomic<uint64_t> s_nextLayoutVersion{1};
+
 SpatialGrid::SpatialGrid() 
     : m_numMacroAntennas(0), m_microPerMacro(0) {}
 
@@ -20,6 +37,7 @@ void SpatialGrid::clear() {
     m_macroAntennas.clear();
     m_microAntennas.clear();
     m_vehicleToMicroAntenna.clear();
+    m_layoutVersion = s_nextLayoutVersion++;
 }
 
 double SpatialGrid::distance(double lat1, double lon1, double lat2, double lon2) {
@@ -36,9 +54,29 @@ double SpatialGrid::distance(double lat1, double lon1, double lat2, double lon2)
 void SpatialGrid::initialize(const std::vector<Vehicule*>& vehicles, 
                              int numMacroAntennas, 
                              int microPerMacro) {
+    std::vector<int> ids;
+    std::vector<double> lats, lons;
+    ids.reserve(vehicles.size());
+    lats.reserve(vehicles.size());
+    lons.reserve(vehicles.size());
+    for (auto* v : vehicles) {
+        if (!v) continue;
+        auto [lat, lon] = v->getPosition();
+        ids.push_back(v->getId());
+        lats.push_back(lat);
+        lons.push_back(lon);
+    }
+    
+    // Repartir des grandes antennes actuelles (réglage des sliders)
+    initialize(ids, lats, lons, numMacroAntennas, microPerMacro, getMacroCenters());
+}
+
+void SpatialGrid::initialize(const std::vector<int>& ids, const std::vector<double>& lats,
+                             const std::vector<double>& lons, int numMacroAntennas, int microPerMacro,
+                             const std::vector<std::pair<double, double>>& warmStart) {
     clear();
     
-    if (vehicles.empty()) {
+    if (ids.empty()) {
         std::cout << "Aucun véhicule pour initialiser la grille" << std::endl;
         return;
     }
@@ -47,111 +85,182 @@ void SpatialGrid::initialize(const std::vector<Vehicule*>& vehicles,
     m_microPerMacro = microPerMacro;
     
     // Afficher seulement pour debug (première fois)
-    static bool firstTime = true;
-    if (firstTime) {
+    static std::atomic<bool> firstTime{true};
+    if (firstTime.exchange(false)) {
         std::cout << "\n=== Initialisation de la grille spatiale ===" << std::endl;
-        std::cout << "Véhicules: " << vehicles.size() << std::endl;
+        std::cout << "Véhicules: " << ids.size() << std::endl;
         std::cout << "Grandes antennes: " << numMacroAntennas << std::endl;
         std::cout << "Petites antennes par grande: " << microPerMacro << std::endl;
-        firstTime = false;
     }
     
     // Étape 1: Placer les grandes antennes selon la densité
-    placeMacroAntennas(vehicles, numMacroAntennas);
+    placeMacroAntennas(lats, lons, numMacroAntennas, warmStart);
     
     // Étape 2: Placer les petites antennes uniformément dans chaque grande
     placeMicroAntennas(microPerMacro);
     
-    // Étape 3: Calculer les voisinages
+    // Étape 3: Calculer les voisinages et les rayons de maintien
     computeNeighborhoods();
+    computeHandoffRadii();
     
     // Étape 4: Assigner les véhicules
-    assignVehiclesToAntennas(vehicles);
+    assignVehiclesToAntennas(ids, lats, lons);
     
     // Ne plus afficher les stats à chaque fois (trop verbeux)
     // printStats();
 }
 
-void SpatialGrid::placeMacroAntennas(const std::vector<Vehicule*>& vehicles, int numMacro) {
-    // Algorithme K-means simplifié pour placer les antennes selon la densité
+std::vector<std::pair<double, double>> SpatialGrid::getMacroCenters() const {
+    std::vector<int> macroIds;
+    macroIds.reserve(m_macroAntennas.size());
+    for (const auto& [id, macro] : m_macroAntennas) macroIds.push_back(id);
+    std::sort(macroIds.begin(), macroIds.end());
     
-    // Calculer les limites de la zone
-    double minLat = std::numeric_limits<double>::max();
-    double maxLat = std::numeric_limits<double>::lowest();
-    double minLon = std::numeric_limits<double>::max();
-    double maxLon = std::numeric_limits<double>::lowest();
+    std::vector<std::pair<double, double>> centers;
+    centers.reserve(macroIds.size());
+    for (int id : macroIds) {
+        const MacroAntenna& macro = m_macroAntennas.at(id);
+        centers.push_back({macro.centerLat, macro.centerLon});
+    }
+    return centers;
+}
+
+void SpatialGrid::placeMacroAntennas(const std::vector<double>& lats, const std::vector<double>& lons,
+                                     int numMacro, const std::vector<std::pair<double, double>>& warmStart) {
+    // K-means sur toutes les positions, en mètres autour du centre de l'emprise
+    m_lastKMeansIterations = 0;
+    const size_t n = lats.size();
+    const int k = static_cast<int>(std::min<size_t>(std::max(0, numMacro), n));
+    if (k == 0) return;
+    
+    double minLat = lats[0], maxLat = lats[0];
+    double minLon = lons[0], maxLon = lons[0];
+    for (size_t i = 0; i < n; ++i) {
+        minLat = std::min(minLat, lats[i]);
+        maxLat = std::max(maxLat, lats[i]);
+        minLon = std::min(minLon, lons[i]);
+        maxLon = std::max(maxLon, lons[i]);
+    }
+    const double originLat = (minLat + maxLat) / 2.0;
+    const double originLon = (minLon + maxLon) / 2.0;
+    const double metersPerDegLon = METERS_PER_DEG * std::cos(originLat * M_PI / 180.0);
     
-    std::vector<std::pair<double, double>> positions;
+    const double avgRadius = distance(minLat, minLon, maxLat, maxLon) / (2.0 * std::sqrt(k));
+    const double tolerance = KMEANS_TOLERANCE * avgRadius;
     
-    // OPTIMISATION: Pour beaucoup de véhicules, échantillonner seulement 1000 positions
-    int sampleSize = std::min(1000, (int)vehicles.size());
-    int step = vehicles.size() / sampleSize;
-    if (step < 1) step = 1;
+    std::vector<double> xs(n), ys(n);
+    for (size_t i = 0; i < n; ++i) {
+        xs[i] = (lons[i] - originLon) * metersPerDegLon;
+        ys[i] = (lats[i] - originLat) * METERS_PER_DEG;
+    }
     
-    for (size_t i = 0; i < vehicles.size(); i += step) {
-        auto* v = vehicles[i];
-        if (!v) continue;
-        auto [lat, lon] = v->getPosition();
-        positions.push_back({lat, lon});
-        
-        minLat = std::min(minLat, lat);
-        maxLat = std::max(maxLat, lat);
-        minLon = std::min(minLon, lon);
-        maxLon = std::max(maxLon, lon);
+    // Départ à chaud: centres précédents (les k premiers)
+    std::vector<double> cx, cy;
+    for (size_t c = 0; c < warmStart.size() && static_cast<int>(c) < k; ++c) {
+        cx.push_back((warmStart[c].second - originLon) * metersPerDegLon);
+        cy.push_back((warmStart[c].first - originLat) * METERS_PER_DEG);
     }
     
-    // Initialiser les centres uniformément dans la zone
-    std::vector<std::pair<double, double>> centers;
-    int sqrtNum = (int)std::ceil(std::sqrt(numMacro));
-    for (int i = 0; i < numMacro; ++i) {
-        int row = i / sqrtNum;
-        int col = i % sqrtNum;
-        double lat = minLat + (maxLat - minLat) * row / (sqrtNum - 1.0);
-        double lon = minLon + (maxLon - minLon) * col / (sqrtNum - 1.0);
-        centers.push_back({lat, lon});
+    // Distance² de chaque véhicule au centre le plus proche parmi cx/cy
+    std::vector<double> nearestSq(n, std::numeric_limits<double>::max());
+    auto updateNearest = [&](size_t firstCenter) {
+        parallelFor(n, m_threadCount, KMEANS_BLOCK, [&](size_t begin, size_t end, int) {
+            for (size_t i = begin; i < end; ++i) {
+                for (size_t c = firstCenter; c < cx.size(); ++c) {
+                    const double dx = xs[i] - cx[c];
+                    const double dy = ys[i] - cy[c];
+                    nearestSq[i] = std::min(nearestSq[i], dx * dx + dy * dy);
+                }
+            }
+        });
+    };
+    updateNearest(0);
+    
+    // k-means++: chaque nouveau centre est tiré avec une probabilité proportionnelle
+    // à la distance² au centre existant le plus proche (graine fixe: placement reproductible)
+    std::mt19937_64 rng(KMEANS_SEED);
+    while (static_cast<int>(cx.size()) < k) {
+        double total = 0.0;
+        if (!cx.empty()) {
+            for (double d : nearestSq) total += d;
+        }
+        size_t chosen = 0;
+        if (total <= 0.0) {
+            chosen = std::uniform_int_distribution<size_t>(0, n - 1)(rng);
+        } else {
+            double target = std::uniform_real_distribution<double>(0.0, total)(rng);
+            while (chosen + 1 < n && target >= nearestSq[chosen]) {
+                target -= nearestSq[chosen];
+                chosen++;
+            }
+        }
+        cx.push_back(xs[chosen]);
+        cy.push_back(ys[chosen]);
+        updateNearest(cx.size() - 1);
     }
     
-    // K-means: seulement 3 itérations pour la vitesse
-    for (int iter = 0; iter < 3; ++iter) {
-        // Assigner chaque véhicule au centre le plus proche
-        std::vector<std::vector<std::pair<double, double>>> clusters(numMacro);
-        
-        for (const auto& [lat, lon] : positions) {
-            int nearestCenter = 0;
-            double minDist = std::numeric_limits<double>::max();
-            
-            for (int i = 0; i < numMacro; ++i) {
-                double dist = distance(lat, lon, centers[i].first, centers[i].second);
-                if (dist < minDist) {
-                    minDist = dist;
-                    nearestCenter = i;
+    // Lloyd: affectation en parallèle, sommes partielles par bloc de KMEANS_BLOCK
+    // véhicules réduites dans l'ordre des blocs (même résultat quel que soit le nombre de threads)
+    const size_t numBlocks = (n + KMEANS_BLOCK - 1) / KMEANS_BLOCK;
+    std::vector<double> partial(numBlocks * k * 3);
+    for (int iter = 0; iter < KMEANS_MAX_ITERATIONS; ++iter) {
+        std::fill(partial.begin(), partial.end(), 0.0);
+        parallelFor(n, m_threadCount, KMEANS_BLOCK, [&](size_t begin, size_t end, int) {
+            for (size_t blockBegin = begin; blockBegin < end; blockBegin += KMEANS_BLOCK) {
+                double* sums = &partial[(blockBegin / KMEANS_BLOCK) * k * 3];
+                const size_t blockEnd = std::min(end, blockBegin + KMEANS_BLOCK);
+                for (size_t i = blockBegin; i < blockEnd; ++i) {
+                    int best = 0;
+                    double bestSq = std::numeric_limits<double>::max();
+                    for (int c = 0; c < k; ++c) {
+                        const double dx = xs[i] - cx[c];
+                        const double dy = ys[i] - cy[c];
+                        const double d = dx * dx + dy * dy;
+                        if (d < bestSq) {
+                            bestSq = d;
+                            best = c;
+                        }
+                    }
+                    nearestSq[i] = bestSq;
+                    sums[best * 3] += xs[i];
+                    sums[best * 3 + 1] += ys[i];
+                    sums[best * 3 + 2] += 1.0;
                 }
             }
-            
-            clusters[nearestCenter].push_back({lat, lon});
+        });
+        
+        std::vector<double> total(k * 3, 0.0);
+        for (size_t b = 0; b < numBlocks; ++b) {
+            for (int j = 0; j < k * 3; ++j) total[j] += partial[b * k * 3 + j];
         }
         
-        // Recalculer les centres (moyenne des positions)
-        for (int i = 0; i < numMacro; ++i) {
-            if (clusters[i].empty()) continue;
-            
-            double sumLat = 0.0, sumLon = 0.0;
-            for (const auto& [lat, lon] : clusters[i]) {
-                sumLat += lat;
-                sumLon += lon;
+        double maxShift = 0.0;
+        for (int c = 0; c < k; ++c) {
+            double nx, ny;
+            if (total[c * 3 + 2] > 0.0) {
+                nx = total[c * 3] / total[c * 3 + 2];
+                ny = total[c * 3 + 1] / total[c * 3 + 2];
+            } else {
+                // Centre sans véhicule: déplacé sur le véhicule le plus éloigné de son centre
+                const size_t farthest = std::max_element(nearestSq.begin(), nearestSq.end()) - nearestSq.begin();
+                nx = xs[farthest];
+                ny = ys[farthest];
+                nearestSq[farthest] = 0.0;
             }
-            centers[i] = {sumLat / clusters[i].size(), sumLon / clusters[i].size()};
+            maxShift = std::max(maxShift, std::hypot(nx - cx[c], ny - cy[c]));
+            cx[c] = nx;
+            cy[c] = ny;
         }
+        m_lastKMeansIterations = iter + 1;
+        if (maxShift <= tolerance) break;
     }
     
     // Créer les grandes antennes aux centres calculés
-    double avgRadius = distance(minLat, minLon, maxLat, maxLon) / (2.0 * std::sqrt(numMacro));
-    
-    for (int i = 0; i < numMacro; ++i) {
+    for (int i = 0; i < k; ++i) {
         MacroAntenna macro;
         macro.id = i;
-        macro.centerLat = centers[i].first;
-        macro.centerLon = centers[i].second;
+        macro.centerLat = originLat + cy[i] / METERS_PER_DEG;
+        macro.centerLon = originLon + cx[i] / metersPerDegLon;
         macro.radius = avgRadius * 1.5; // 50% de marge
         
         m_macroAntennas[i] = macro;
@@ -189,7 +298,7 @@ void SpatialGrid::placeMicroAntennas(int microPerMacro) {
 }
 
 void SpatialGrid::computeNeighborhoods() {
-    // Calculer les voisinages entre grandes antennes
+    // Calculer les voisinages entre grandes antennes (quelques dizaines: comparaison directe)
     for (auto& [id1, macro1] : m_macroAntennas) {
         for (auto& [id2, macro2] : m_macroAntennas) {
             if (id1 >= id2) continue;
@@ -199,36 +308,124 @@ void SpatialGrid::computeNeighborhoods() {
             
             // Voisines si distance < somme des rayons * 1.5 (marge)
             if (dist < (macro1.radius + macro2.radius) * 1.5) {
-                macro1.neighborMacroIds.insert(id2);
-                macro2.neighborMacroIds.insert(id1);
+                macro1.neighborMacroIds.push_back(id2);
+                macro2.neighborMacroIds.push_back(id1);
             }
         }
     }
+    for (auto& [id, macro] : m_macroAntennas) {
+        std::sort(macro.neighborMacroIds.begin(), macro.neighborMacroIds.end());
+    }
     
-    // OPTIMISATION CRITIQUE: Pour chaque micro, ne prendre QUE les micros 
-    // où les véhicules peuvent potentiellement communiquer.
-    // Distance max entre centres = portée transmission + 2 × rayon micro
+    computeMicroNeighborhoods();
+}
+
+void SpatialGrid::computeMicroNeighborhoods() {
+    // Pour chaque micro, ne prendre QUE les micros où les véhicules peuvent
+    // potentiellement communiquer: distance entre centres < portée + rayon1 + rayon2
+    // (cas extrême: véhicules aux bords opposés)
+    std::vector<MicroAntenna*> micros;
+    micros.reserve(m_microAntennas.size());
+    double maxRadius = 0.0;
+    double maxAbsLat = 0.0;
+    m_layoutVersion = s_nextLayoutVersion++;
+    for (auto& [id, micro] : m_microAntennas) {
+        micro.neighborMicroIds.clear();
+        micros.push_back(&micro);
+        maxRadius = std::max(maxRadius, micro.radius);
+        maxAbsLat = std::max(maxAbsLat, std::abs(micro.centerLat));
+    }
+    if (micros.empty()) return;
+    
+    // Projection avec le plus petit cos(lat) de la zone: les distances projetées
+    // ne dépassent pas les distances réelles, deux antennes voisines sont donc
+    // toujours dans des cellules adjacentes (marge de 5% pour l'approximation)
+    const double metersPerDegLon = METERS_PER_DEG * std::cos(maxAbsLat * M_PI / 180.0);
+    const double cellSize = (m_maxTransmissionRange + 2.0 * maxRadius) * 1.05 + 1.0;
+    // Décalage en non signé: x est négatif à l'ouest du méridien de Greenwich
+    auto cellKey = [](long long x, long long y) {
+        return (static_cast<uint64_t>(x) << 32) ^ static_cast<uint32_t>(y);
+    };
+    
+    std::unordered_map<uint64_t, std::vector<int>> cells;
+    std::vector<std::pair<long long, long long>> cellOf(micros.size());
+    for (size_t i = 0; i < micros.size(); ++i) {
+        const long long x = static_cast<long long>(std::floor(micros[i]->centerLon * metersPerDegLon / cellSize));
+        const long long y = static_cast<long long>(std::floor(micros[i]->centerLat * METERS_PER_DEG / cellSize));
+        cellOf[i] = {x, y};
+        cells[cellKey(x, y)].push_back(static_cast<int>(i));
+    }
+    
+    for (size_t i = 0; i < micros.size(); ++i) {
+        MicroAntenna& micro1 = *micros[i];
+        for (long long dy = -1; dy <= 1; ++dy) {
+            for (long long dx = -1; dx <= 1; ++dx) {
+                auto it = cells.find(cellKey(cellOf[i].first + dx, cellOf[i].second + dy));
+                if (it == cells.end()) continue;
+                for (int j : it->second) {
+                    MicroAntenna& micro2 = *micros[j];
+                    if (micro1.id >= micro2.id) continue;
+                    
+                    double dist = distance(micro1.centerLat, micro1.centerLon,
+                                           micro2.centerLat, micro2.centerLon);
+                    double maxCommDistance = m_maxTransmissionRange + micro1.radius + micro2.radius;
+                    if (dist < maxCommDistance) {
+                        micro1.neighborMicroIds.push_back(micro2.id);
+                        micro2.neighborMicroIds.push_back(micro1.id);
+                    }
+                }
+            }
+        }
+    }
+    for (MicroAntenna* micro : micros) {
+        std::sort(micro->neighborMicroIds.begin(), micro->neighborMicroIds.end());
+    }
+}
+
+void SpatialGrid::computeHandoffRadii() {
+    double minRadius = std::numeric_limits<double>::max();
+    for (const auto& [id, micro] : m_microAntennas) minRadius = std::min(minRadius, micro.radius);
     
     for (auto& [id1, micro1] : m_microAntennas) {
-        for (auto& [id2, micro2] : m_microAntennas) {
-            if (id1 >= id2) continue;
-            
-            // Calculer la distance entre les centres des micros
-            double dist = distance(micro1.centerLat, micro1.centerLon, 
-                                 micro2.centerLat, micro2.centerLon);
-            
-            // Voisines SEULEMENT si un véhicule de micro1 peut communiquer avec un de micro2
-            // Distance max = portée + rayon1 + rayon2 (cas extrême: véhicules aux bords opposés)
-            double maxCommDistance = m_maxTransmissionRange + micro1.radius + micro2.radius;
-            
-            if (dist < maxCommDistance) {
-                micro1.neighborMicroIds.insert(id2);
-                micro2.neighborMicroIds.insert(id1);
+        // Une antenne plus proche que la plus proche voisine serait elle-même voisine:
+        // si la voisine la plus proche est sous le seuil de voisinage, c'est la plus proche de toutes
+        double minDist = std::numeric_limits<double>::max();
+        for (int id2 : micro1.neighborMicroIds) {
+            const MicroAntenna& micro2 = m_microAntennas.at(id2);
+            minDist = std::min(minDist, distance(micro1.centerLat, micro1.centerLon,
+                                                 micro2.centerLat, micro2.centerLon));
+        }
+        if (minDist >= m_maxTransmissionRange + micro1.radius + minRadius) {
+            // Antenne isolée: parcours complet
+            for (const auto& [id2, micro2] : m_microAntennas) {
+                if (id1 == id2) continue;
+                minDist = std::min(minDist, distance(micro1.centerLat, micro1.centerLon,
+                                                     micro2.centerLat, micro2.centerLon));
             }
         }
+        // Dans ce disque, micro1 est l'antenne la plus proche (inégalité triangulaire)
+        micro1.handoffRadius = (minDist == std::numeric_limits<double>::max()) ? minDist : minDist / 2.0;
     }
 }
 
+void SpatialGrid::addToMicro(int vehicleId, int microId) {
+    auto& vehicleIds = m_microAntennas[microId].vehicleIds;
+    m_vehicleToMicroAntenna[vehicleId] = {microId, static_cast<int>(vehicleIds.size())};
+    vehicleIds.push_back(vehicleId);
+}
+
+void SpatialGrid::removeFromMicro(const AntennaSlot& slot) {
+    auto microIt = m_microAntennas.find(slot.microId);
+    if (microIt == m_microAntennas.end()) return;
+    
+    // Échange avec le dernier puis pop_back: O(1) au lieu de std::remove
+    auto& vehicleIds = microIt->second.vehicleIds;
+    int movedId = vehicleIds.back();
+    vehicleIds[slot.index] = movedId;
+    m_vehicleToMicroAntenna[movedId].index = slot.index;
+    vehicleIds.pop_back();
+}
+
 void SpatialGrid::assignVehiclesToAntennas(const std::vector<Vehicule*>& vehicles) {
     // Effacer les anciennes assignations
     m_vehicleToMicroAntenna.clear();
@@ -244,8 +441,29 @@ void SpatialGrid::assignVehiclesToAntennas(const std::vector<Vehicule*>& vehicle
         int nearestMicro = findNearestMicroAntenna(lat, lon);
         
         if (nearestMicro >= 0) {
-            m_vehicleToMicroAntenna[v->getId()] = nearestMicro;
-            m_microAntennas[nearestMicro].vehicleIds.push_back(v->getId());
+            addToMicro(v->getId(), nearestMicro);
+        }
+    }
+}
+
+void SpatialGrid::assignVehiclesToAntennas(const std::vector<int>& ids, const std::vector<double>& lats,
+                                           const std::vector<double>& lons) {
+    m_vehicleToMicroAntenna.clear();
+    for (auto& [id, micro] : m_microAntennas) {
+        micro.vehicleIds.clear();
+    }
+    
+    // Recherche de l'antenne la plus proche en parallèle (lecture seule),
+    // puis insertion dans l'ordre des véhicules: listes identiques quel que soit le nombre de threads
+    std::vector<int> nearestMicro(ids.size());
+    parallelFor(ids.size(), m_threadCount, 1024, [&](size_t begin, size_t end, int) {
+        for (size_t i = begin; i < end; ++i) {
+            nearestMicro[i] = findNearestMicroAntenna(lats[i], lons[i]);
+        }
+    });
+    for (size_t i = 0; i < ids.size(); ++i) {
+        if (nearestMicro[i] >= 0) {
+            addToMicro(ids[i], nearestMicro[i]);
         }
     }
 }
@@ -258,8 +476,8 @@ void SpatialGrid::assignVehicleToAntenna(Vehicule* vehicle) {
     int nearestMicro = findNearestMicroAntenna(lat, lon);
     
     if (nearestMicro >= 0) {
-        m_vehicleToMicroAntenna[vehicle->getId()] = nearestMicro;
-        m_microAntennas[nearestMicro].vehicleIds.push_back(vehicle->getId());
+        removeVehicleFromAntenna(vehicle->getId());  // Pas de doublon si déjà assigné
+        addToMicro(vehicle->getId(), nearestMicro);
     }
 }
 
@@ -267,15 +485,48 @@ void SpatialGrid::removeVehicleFromAntenna(int vehicleId) {
     auto it = m_vehicleToMicroAntenna.find(vehicleId);
     if (it == m_vehicleToMicroAntenna.end()) return;
     
-    int microId = it->second;
-    m_vehicleToMicroAntenna.erase(it);
-    
-    // Retirer le véhicule de la liste de l'antenne
-    auto microIt = m_microAntennas.find(microId);
-    if (microIt != m_microAntennas.end()) {
-        auto& vehicleIds = microIt->second.vehicleIds;
-        vehicleIds.erase(std::remove(vehicleIds.begin(), vehicleIds.end(), vehicleId), vehicleIds.end());
+    AntennaSlot slot = it->second;
+    removeFromMicro(slot);
+    m_vehicleToMicroAntenna.erase(vehicleId);
+}
+
+int SpatialGrid::updateAssignments(const std::vector<int>& ids, const std::vector<double>& lats,
+                                   const std::vector<double>& lons) {
+    m_lastHandoffCount = 0;
+    if (m_microAntennas.empty()) return 0;
+    
+    int handoffs = 0;
+    for (size_t i = 0; i < ids.size(); ++i) {
+        const int vehicleId = ids[i];
+        auto it = m_vehicleToMicroAntenna.find(vehicleId);
+        if (it == m_vehicleToMicroAntenna.end()) {
+            // Véhicule pas encore assigné: simple affectation, pas un transfert
+            int nearestMicro = findNearestMicroAntenna(lats[i], lons[i]);
+            if (nearestMicro >= 0) addToMicro(vehicleId, nearestMicro);
+            continue;
+        }
+        
+        // Cas courant: toujours dans le disque de maintien de son antenne
+        const MicroAntenna& current = m_microAntennas.at(it->second.microId);
+        double currentDist = distance(lats[i], lons[i], current.centerLat, current.centerLon);
+        if (currentDist <= current.handoffRadius) continue;
+        
+        int nearestMicro = findNearestMicroAntenna(lats[i], lons[i]);
+        if (nearestMicro < 0 || nearestMicro == current.id) continue;
+        
+        const MicroAntenna& candidate = m_microAntennas.at(nearestMicro);
+        double candidateDist = distance(lats[i], lons[i], candidate.centerLat, candidate.centerLon);
+        if (candidateDist + m_handoffHysteresis >= currentDist) continue;
+        
+        AntennaSlot slot = it->second;
+        removeFromMicro(slot);
+        addToMicro(vehicleId, nearestMicro);
+        handoffs++;
     }
+    
+    m_lastHandoffCount = handoffs;
+    m_totalHandoffCount += handoffs;
+    return handoffs;
 }
 
 int SpatialGrid::findNearestMicroAntenna(double lat, double lon) const {
@@ -332,7 +583,7 @@ std::vector<int> SpatialGrid::getNearbyVehicles(int vehicleId) const {
         return nearby; // Véhicule non trouvé
     }
     
-    int microId = it->second;
+    int microId = it->second.microId;
     const auto& micro = m_microAntennas.at(microId);
     
     // Ajouter les véhicules de la même antenne
@@ -355,7 +606,14 @@ std::vector<int> SpatialGrid::getNearbyVehicles(int vehicleId) const {
 
 int SpatialGrid::getMicroAntennaId(int vehicleId) const {
     auto it = m_vehicleToMicroAntenna.find(vehicleId);
-    return (it != m_vehicleToMicroAntenna.end()) ? it->second : -1;
+    return (it != m_vehicleToMicroAntenna.end()) ? it->second.microId : -1;
+}
+
+std::vector<int> SpatialGrid::assignedVehicleIds() const {
+    std::vector<int> ids;
+    ids.reserve(m_vehicleToMicroAntenna.size());
+    for (const auto& [id, slot] : m_vehicleToMicroAntenna) ids.push_back(id);
+    return ids;
 }
 
 int SpatialGrid::getMacroAntennaId(int vehicleId) const {
@@ -385,27 +643,7 @@ void SpatialGrid::printStats() const {
 }
 
 void SpatialGrid::updateNeighborhoods() {
-    // Recalculer les voisinages entre antennes avec la nouvelle portée
-    // D'abord effacer les anciens voisinages des micro antennes
-    for (auto& [id, micro] : m_microAntennas) {
-        micro.neighborMicroIds.clear();
-    }
-    
     // Recalculer seulement les voisinages des micro antennes
     // (les macro antennes ne dépendent pas de la portée de transmission)
-    for (auto& [id1, micro1] : m_microAntennas) {
-        for (auto& [id2, micro2] : m_microAntennas) {
-            if (id1 >= id2) continue;
-            
-            double dist = distance(micro1.centerLat, micro1.centerLon, 
-                                 micro2.centerLat, micro2.centerLon);
-            
-            double maxCommDistance = m_maxTransmissionRange + micro1.radius + micro2.radius;
-            
-            if (dist < maxCommDistance) {
-                micro1.neighborMicroIds.insert(id2);
-                micro2.neighborMicroIds.insert(id1);
-            }
-        }
-    }
-}
\ No newline at end of file
+    computeMicroNeighborhoods();
+}
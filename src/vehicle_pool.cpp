@@ -0,0 +1,37 @@
+#include "vehicle_pool.h"
+#include <algorithm>
+#include <functional>
+
+void* VehiclePool::acquireSlot() {
+    if (m_freeSlots.empty()) {
+        // Nouveau bloc: ses emplacements sont empilés pour être servis dans l'ordre des adresses
+        m_slabs.emplace_back(new Slot[SLAB_SIZE]);
+        Slot* slab = m_slabs.back().get();
+        m_slabBases.insert(std::upper_bound(m_slabBases.begin(), m_slabBases.end(), slab,
+                                            std::less<const Slot*>()), slab);
+        m_freeSlots.reserve(capacity());
+        for (size_t i = SLAB_SIZE; i-- > 0; ) {
+            m_freeSlots.push_back(slab + i);
+        }
+    }
+    Slot* slot = m_freeSlots.back();
+    m_freeSlots.pop_back();
+    return slot;
+}
+
+void VehiclePool::destroy(Vehicule* v) {
+    if (!v) return;
+    v->~Vehicule();
+    m_freeSlots.push_back(reinterpret_cast<Slot*>(v));
+    m_live--;
+}
+
+bool VehiclePool::owns(const Vehicule* v) const {
+    // Comparaison d'adresses entre blocs distincts: std::less donne un ordre total
+    const Slot* slot = reinterpret_cast<const Slot*>(v);
+    std::less<const Slot*> before;
+    // Dernier bloc qui commence au plus tard à slot
+    auto next = std::upper_bound(m_slabBases.begin(), m_slabBases.end(), slot, before);
+    if (next == m_slabBases.begin()) return false;
+    return before(slot, *(next - 1) + SLAB_SIZE);
+}
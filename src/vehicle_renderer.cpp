@@ -10,10 +10,36 @@
 std::unique_ptr<QSvgRenderer> VehicleRenderer::svgRenderer = nullptr;
 QString VehicleRenderer::cachedSvgPath;
 bool VehicleRenderer::initialized = false;
+QHash<quint64, QImage> VehicleRenderer::spriteCache;
+QHash<quint64, QPixmap> VehicleRenderer::atlasCache;
+
+// Disposition de l'atlas: PALETTE_SIZE cellules carrées sur ATLAS_COLUMNS colonnes
+static constexpr int ATLAS_COLUMNS = 8;
+
+// Bornes des caches (couleurs arbitraires de drawVehicle, tailles selon le zoom)
+static constexpr int MAX_CACHED_SPRITES = 512;
+static constexpr int MAX_CACHED_ATLASES = 64;
 
 void VehicleRenderer::setSvgPath(const QString& path) {
     cachedSvgPath = path;
     initialized = false;  // Reset initialization flag so lazy init happens on first draw
+    spriteCache.clear();
+    atlasCache.clear();
+}
+
+QColor VehicleRenderer::paletteColor(int index, bool darkTheme) {
+    // Tirages successifs (l'ordre d'évaluation des arguments n'est pas garanti)
+    QRandomGenerator gen(static_cast<quint32>(index));
+    if (darkTheme) {
+        int r = gen.bounded(120, 220);
+        int g = gen.bounded(120, 220);
+        int b = gen.bounded(120, 220);
+        return QColor(r, g, b, 255);
+    }
+    int r = gen.bounded(200, 255);
+    int g = gen.bounded(80, 255);
+    int b = gen.bounded(0, 255);
+    return QColor(r, g, b, 255);  // couleurs vives
 }
 
 void VehicleRenderer::lazyInitialize() {
@@ -65,6 +91,97 @@ void VehicleRenderer::lazyInitialize() {
     initialized = true;
 }
 
+const QImage& VehicleRenderer::tintedSprite(const QColor& color, int pixelSize) {
+    const quint64 key = (static_cast<quint64>(color.rgba()) << 32) | static_cast<quint32>(pixelSize);
+    auto it = spriteCache.constFind(key);
+    if (it != spriteCache.constEnd()) {
+        return *it;
+    }
+    if (spriteCache.size() >= MAX_CACHED_SPRITES) {
+        spriteCache.clear();
+    }
+
+    // Rastériser le SVG une seule fois pour cette teinte et cette taille
+    QImage sprite(pixelSize, pixelSize, QImage::Format_ARGB32_Premultiplied);
+    sprite.fill(Qt::transparent);
+    QPainter spritePainter(&sprite);
+    spritePainter.setRenderHint(QPainter::Antialiasing);
+    svgRenderer->render(&spritePainter);
+
+    // Coloriser: garder l'alpha du SVG, remplacer la couleur (sans boucle par pixel)
+    spritePainter.setCompositionMode(QPainter::CompositionMode_SourceIn);
+    spritePainter.fillRect(sprite.rect(), QColor(color.red(), color.green(), color.blue()));
+    spritePainter.end();
+
+    return *spriteCache.insert(key, sprite);
+}
+
+const QPixmap* VehicleRenderer::paletteAtlas(bool darkTheme, int pixelSize) {
+    if (!svgRenderer || !svgRenderer->isValid()) {
+        return nullptr;
+    }
+
+    const quint64 key = (static_cast<quint64>(darkTheme) << 32) | static_cast<quint32>(pixelSize);
+    auto it = atlasCache.constFind(key);
+    if (it != atlasCache.constEnd()) {
+        return &*it;
+    }
+    if (atlasCache.size() >= MAX_CACHED_ATLASES) {
+        atlasCache.clear();
+    }
+
+    const int rows = (PALETTE_SIZE + ATLAS_COLUMNS - 1) / ATLAS_COLUMNS;
+    QImage atlas(ATLAS_COLUMNS * pixelSize, rows * pixelSize, QImage::Format_ARGB32_Premultiplied);
+    atlas.fill(Qt::transparent);
+    QPainter atlasPainter(&atlas);
+    for (int i = 0; i < PALETTE_SIZE; ++i) {
+        QPoint cell((i % ATLAS_COLUMNS) * pixelSize, (i / ATLAS_COLUMNS) * pixelSize);
+        atlasPainter.drawImage(cell, tintedSprite(paletteColor(i, darkTheme), pixelSize));
+    }
+    atlasPainter.end();
+
+    return &*atlasCache.insert(key, QPixmap::fromImage(atlas));
+}
+
+void VehicleRenderer::drawVehicles(QPainter& painter,
+                                   const std::vector<Sprite>& sprites,
+                                   bool darkTheme,
+                                   double size) {
+    if (sprites.empty()) {
+        return;
+    }
+    if (!initialized) {
+        lazyInitialize();
+    }
+
+    const int pixelSize = spritePixelSize(size, painter.device()->devicePixelRatioF());
+    const QPixmap* atlas = paletteAtlas(darkTheme, pixelSize);
+    if (!atlas) {
+        // Pas de SVG: forme vectorielle, véhicule par véhicule
+        for (const auto& sprite : sprites) {
+            drawVehicle(painter, sprite.position, sprite.heading, paletteColor(sprite.tint, darkTheme), size);
+        }
+        return;
+    }
+
+    // Un fragment par véhicule: cellule de sa teinte, mise à l'échelle et rotation
+    const qreal scale = size / pixelSize;
+    std::vector<QPainter::PixmapFragment> fragments;
+    fragments.reserve(sprites.size());
+    for (const auto& sprite : sprites) {
+        const int tint = paletteIndex(sprite.tint);
+        QRectF source((tint % ATLAS_COLUMNS) * pixelSize, (tint / ATLAS_COLUMNS) * pixelSize,
+                      pixelSize, pixelSize);
+        fragments.push_back(QPainter::PixmapFragment::create(sprite.position, source, scale, scale,
+                                                             sprite.heading));
+    }
+
+    painter.save();
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+    painter.drawPixmapFragments(fragments.data(), static_cast<int>(fragments.size()), *atlas);
+    painter.restore();
+}
+
 void VehicleRenderer::drawVehicle(QPainter& painter,
                                  const QPointF& position,
                                  double heading,
@@ -82,34 +199,11 @@ void VehicleRenderer::drawVehicle(QPainter& painter,
     painter.rotate(heading);
 
     if (svgRenderer && svgRenderer->isValid()) {
-        // Rendu du SVG avec couleur
+        // Sprite teinté depuis le cache (rastérisé une fois par couleur et par taille)
         QRectF svgRect(-size / 2, -size / 2, size, size);
-        
-        // Créer un pixmap pour le rendu
-        int pixelSize = qMax(1, static_cast<int>(size * 2));  // Plus grande résolution
-        QPixmap vehiclePixmap(pixelSize, pixelSize);
-        vehiclePixmap.fill(Qt::transparent);
-        
-        // Renderer le SVG sur le pixmap
-        QPainter pixmapPainter(&vehiclePixmap);
-        pixmapPainter.setRenderHint(QPainter::Antialiasing);
-        svgRenderer->render(&pixmapPainter);
-        pixmapPainter.end();
-        
-        // Coloriser: remplacer les pixels noirs par la couleur
-        QImage img = vehiclePixmap.toImage();
-        for (int y = 0; y < img.height(); ++y) {
-            for (int x = 0; x < img.width(); ++x) {
-                QColor pixel = img.pixelColor(x, y);
-                if (pixel.alpha() > 0) {
-                    // Garder l'alpha, appliquer la couleur
-                    img.setPixelColor(x, y, QColor(color.red(), color.green(), color.blue(), pixel.alpha()));
-                }
-            }
-        }
-        
-        // Dessiner l'image colorisée
-        painter.drawImage(svgRect, img);
+        const int pixelSize = spritePixelSize(size, painter.device()->devicePixelRatioF());
+        painter.setRenderHint(QPainter::SmoothPixmapTransform);
+        painter.drawImage(svgRect, tintedSprite(color, pixelSize));
     } else {
         // Fallback: dessiner une forme de voiture simple
         painter.setBrush(QBrush(color));
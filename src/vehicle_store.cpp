@@ -0,0 +1,125 @@
+#include "vehicle_store.h"
+#include "vehicule.h"
+
+void VehicleStore::push(const Vehicule& v) {
+    m_rowOfId[v.getId()] = static_cast<int>(ids.size());
+    ids.push_back(v.getId());
+    lat.push_back(0.0);
+    lon.push_back(0.0);
+    heading.push_back(0.0);
+    speed.push_back(0.0);
+    range.push_back(0.0);
+    edgeSource.push_back(Vertex());
+    edgeTarget.push_back(Vertex());
+    positionOnEdge.push_back(0.0);
+    write(ids.size() - 1, v);
+}
+
+void VehicleStore::write(size_t i, const Vehicule& v) {
+    auto [vLat, vLon] = v.getPosition();
+    auto [source, target] = v.getEdgeEndpoints();
+    ids[i] = v.getId();
+    lat[i] = vLat;
+    lon[i] = vLon;
+    heading[i] = v.getHeading();
+    speed[i] = v.getSpeed();
+    range[i] = v.getTransmissionRange();
+    edgeSource[i] = source;
+    edgeTarget[i] = target;
+    positionOnEdge[i] = v.getPositionOnEdge();
+}
+
+void VehicleStore::erase(size_t i) {
+    m_rowOfId.erase(ids[i]);
+    ids.erase(ids.begin() + i);
+    lat.erase(lat.begin() + i);
+    lon.erase(lon.begin() + i);
+    heading.erase(heading.begin() + i);
+    speed.erase(speed.begin() + i);
+    range.erase(range.begin() + i);
+    edgeSource.erase(edgeSource.begin() + i);
+    edgeTarget.erase(edgeTarget.begin() + i);
+    positionOnEdge.erase(positionOnEdge.begin() + i);
+
+    // Les lignes suivantes ont été décalées d'un cran
+    for (size_t j = i; j < ids.size(); ++j) {
+        m_rowOfId[ids[j]] = static_cast<int>(j);
+    }
+}
+
+void VehicleStore::swapRemove(size_t i) {
+    const size_t last = ids.size() - 1;
+    m_rowOfId.erase(ids[i]);
+    if (i != last) {
+        ids[i] = ids[last];
+        lat[i] = lat[last];
+        lon[i] = lon[last];
+        heading[i] = heading[last];
+        speed[i] = speed[last];
+        range[i] = range[last];
+        edgeSource[i] = edgeSource[last];
+        edgeTarget[i] = edgeTarget[last];
+        positionOnEdge[i] = positionOnEdge[last];
+        m_rowOfId[ids[i]] = static_cast<int>(i);
+    }
+    ids.pop_back();
+    lat.pop_back();
+    lon.pop_back();
+    heading.pop_back();
+    speed.pop_back();
+    range.pop_back();
+    edgeSource.pop_back();
+    edgeTarget.pop_back();
+    positionOnEdge.pop_back();
+}
+
+void VehicleStore::setIds(const std::vector<int>& newIds) {
+    const size_t n = newIds.size();
+    lat.resize(n);
+    lon.resize(n);
+    heading.resize(n);
+    speed.resize(n);
+    range.resize(n);
+    edgeSource.resize(n);
+    edgeTarget.resize(n);
+    positionOnEdge.resize(n);
+    if (ids == newIds) return;
+
+    ids = newIds;
+    m_rowOfId.clear();
+    m_rowOfId.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        m_rowOfId[ids[i]] = static_cast<int>(i);
+    }
+}
+
+void VehicleStore::popBack() {
+    if (empty()) return;
+    swapRemove(size() - 1);
+}
+
+void VehicleStore::clear() {
+    m_rowOfId.clear();
+    ids.clear();
+    lat.clear();
+    lon.clear();
+    heading.clear();
+    speed.clear();
+    range.clear();
+    edgeSource.clear();
+    edgeTarget.clear();
+    positionOnEdge.clear();
+}
+
+void VehicleStore::reserve(size_t n) {
+    m_rowOfId.reserve(n);
+    ids.reserve(n);
+    lat.reserve(n);
+    lon.reserve(n);
+    heading.reserve(n);
+    speed.reserve(n);
+    range.reserve(n);
+    edgeSource.reserve(n);
+    edgeTarget.reserve(n);
+    positionOnEdge.reserve(n);
+}
@@ -1,5 +1,6 @@
 #include "vehicule.h"
 #include "graph_builder.h"
+#include <algorithm>
 #include <cmath>
 
 #ifndef M_PI
@@ -12,55 +13,127 @@ Vehicule::Vehicule(int id, const RoadGraph& graph, Vertex start, Vertex goal, do
     graph(graph),
     start(start),
     goal(goal),
+    nextVertex(start),
+    previousVertex(start),  // aucun retour arrière possible au premier choix
     currVertex(start),
     transmissionRange(range),
     speed(speed),
     collisionDist(collisionDist)
-{}
+{
+    seedRandom(0);
+}
 
 
 //Destructor
 Vehicule::~Vehicule(void) {}
 
-bool Vehicule::isValidRoad(const std::string& type) {
-    static const std::vector<std::string> valid = {
-        "motorway","trunk","primary","secondary","tertiary",
-        "motorway_link","trunk_link","primary_link","secondary_link","tertiary_link",
-        "unclassified","road"
-    };
-    return std::find(valid.begin(), valid.end(), type) != valid.end();
-}
-
 bool Vehicule::isValidVertex(Vertex v, const RoadGraph& graph) {
-    auto [itStart, itEnd] = boost::out_edges(v, graph);
     // vertex must have at least one valid outgoing edge
-    for (auto it = itStart; it != itEnd; ++it) {
-        const Edge e = *it;
-        if (Vehicule::isValidRoad(graph[e].type)) return true;
-    }
-    return false;
+    return graph[v].drivableOutDegree > 0;
 }
 
 bool Vehicule::hasValidOutgoingEdge(Vertex v, const RoadGraph& graph) {
-    auto [itStart, itEnd] = boost::out_edges(v, graph);
-    for (auto it = itStart; it != itEnd; ++it) {
-        const Edge e = *it;
-        if (isValidRoad(graph[e].type)) {
-            // Edge exists and is valid road type - it's usable
-            // (Direction is already enforced by graph structure for one-way roads)
-            return true;
-        }
-    }
-    return false; // no valid outgoing road — not usable
+    // (Direction is already enforced by graph structure for one-way roads)
+    return graph[v].drivableOutDegree > 0;
 }
 
 
+void Vehicule::seedRandom(uint64_t seed) {
+    // Mélange graine / id pour décorréler les véhicules voisins
+    rngState = seed ^ (static_cast<uint64_t>(id) * 0x9E3779B97F4A7C15ULL);
+}
+
+uint32_t Vehicule::nextRandom(uint32_t bound) {
+    // splitmix64: 8 octets d'état, suffisant pour choisir une arête
+    uint64_t z = (rngState += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+    return bound > 0 ? static_cast<uint32_t>(z % bound) : 0;
+}
+
+void Vehicule::rememberVertex(Vertex v) {
+    recentVertices[recentHead] = v;
+    recentHead = (recentHead + 1) % MAX_HISTORY;
+    if (recentCount < MAX_HISTORY) recentCount++;
+}
+
+bool Vehicule::wasRecentlyVisited(Vertex v) const {
+    // L'ordre n'importe pas: on parcourt simplement les entrées valides
+    for (int i = 0; i < recentCount; ++i) {
+        if (recentVertices[i] == v) return true;
+    }
+    return false;
+}
+
 void Vehicule::DestReached() {
     std::swap(start, goal);
     edgeLength = 0.0;
+    // Nouveau trajet: l'itinéraire sera demandé au prochain choix d'arête
+    route.reset();
+    routeRequested = false;
+}
+
+void Vehicule::setRoute(RoutePlanner::Route newRoute) {
+    route = std::move(newRoute);
+    routeIndex = 0;
+    routeRequested = true;
+}
+
+bool Vehicule::followRoute(Edge& edge) {
+    if (routePlanner && !routeRequested) {
+        setRoute(routePlanner->findRoute(currVertex, goal));
+    }
+    if (!route || routeIndex + 1 >= route->size()) return false;
+
+    // Le véhicule a quitté son itinéraire (ex: demi-tour forcé): en redemander un
+    if ((*route)[routeIndex] != currVertex) {
+        route.reset();
+        routeRequested = false;
+        return false;
+    }
+
+    if (!RoutePlanner::findEdge(graph, currVertex, (*route)[routeIndex + 1], edge)) {
+        route.reset();
+        return false;
+    }
+    routeIndex++;
+    return true;
+}
+
+void Vehicule::applyEdge(Edge e) {
+    // Update visit history (the oldest entry is overwritten once full)
+    rememberVertex(currVertex);
+
+    // Apply selected edge
+    currEdge = e;
+    previousVertex = currVertex;
+    nextVertex = boost::target(currEdge, graph);
+    edgeLength = graph[currEdge].distance;
+    positionOnEdge = 0.0;
+
+    // Copier la géométrie de l'arête dans le sens de parcours
+    const EdgeData& edgeData = graph[currEdge];
+    const auto& fromData = graph[currVertex];
+    const auto& toData = graph[nextVertex];
+    const double sign = (edgeData.from == currVertex) ? 1.0 : -1.0;
+    edgeFromLat = fromData.lat;
+    edgeFromLon = fromData.lon;
+    edgeToLat = toData.lat;
+    edgeToLon = toData.lon;
+    edgeDirEast = sign * edgeData.dirEast;
+    edgeDirNorth = sign * edgeData.dirNorth;
 }
 
 Vertex Vehicule::pickNextEdge() {
+    // Trajet planifié: suivre l'itinéraire tant qu'il est valide
+    Edge routeEdge;
+    if (followRoute(routeEdge)) {
+        stuckCounter = 0;
+        applyEdge(routeEdge);
+        return nextVertex;
+    }
+
     auto [itStart, itEnd] = boost::out_edges(currVertex, graph);
 
     std::vector<Edge> validEdges;
@@ -72,16 +145,10 @@ Vertex Vehicule::pickNextEdge() {
         Edge e = *it;
         Vertex target = boost::target(e, graph);
 
-        if (!isValidRoad(graph[e].type)) continue;
+        if (!graph[e].drivable) continue;
 
         // Check if this leads to a recently visited vertex (loop detection)
-        bool isRecentlyVisited = false;
-        for (const auto& recentV : recentVertices) {
-            if (target == recentV) {
-                isRecentlyVisited = true;
-                break;
-            }
-        }
+        bool isRecentlyVisited = wasRecentlyVisited(target);
 
         if (target == previousVertex) {
             // Immediate backtrack - only use as last resort
@@ -99,10 +166,10 @@ Vertex Vehicule::pickNextEdge() {
     // Selection priority: fresh edges > recently visited > immediate backtrack
     Edge selectedEdge;
     if (!validEdges.empty()) {
-        selectedEdge = validEdges[rand() % validEdges.size()];
+        selectedEdge = validEdges[nextRandom(validEdges.size())];
         stuckCounter = 0;  // Reset stuck counter
     } else if (!lessPreferredEdges.empty()) {
-        selectedEdge = lessPreferredEdges[rand() % lessPreferredEdges.size()];
+        selectedEdge = lessPreferredEdges[nextRandom(lessPreferredEdges.size())];
         stuckCounter++;
     } else if (hasBackEdge) {
         selectedEdge = backEdge;
@@ -112,21 +179,12 @@ Vertex Vehicule::pickNextEdge() {
         stuckCounter++;
         
         // If stuck multiple times, pick a completely new random goal
-        if (stuckCounter > 3) {
-            // Find any valid vertex with outgoing edges
-            std::vector<Vertex> candidateGoals;
-            for (auto vp = boost::vertices(graph); vp.first != vp.second; ++vp.first) {
-                Vertex candidate = *vp.first;
-                if (hasValidOutgoingEdge(candidate, graph)) {
-                    candidateGoals.push_back(candidate);
-                }
-            }
-            
-            if (!candidateGoals.empty()) {
-                goal = candidateGoals[rand() % candidateGoals.size()];
-                stuckCounter = 0;
-                recentVertices.clear();
-            }
+        // among the planner's precomputed valid vertices (no O(V) scan)
+        if (stuckCounter > 3 && routePlanner && !routePlanner->validVertices().empty()) {
+            const auto& candidateGoals = routePlanner->validVertices();
+            goal = candidateGoals[nextRandom(candidateGoals.size())];
+            stuckCounter = 0;
+            clearHistory();
         }
         
         // Reset and try from start
@@ -134,23 +192,13 @@ Vertex Vehicule::pickNextEdge() {
         nextVertex = start;
         edgeLength = 0.0;
         previousVertex = currVertex;
-        recentVertices.clear();
+        clearHistory();
+        route.reset();
+        routeRequested = false;
         return nextVertex;
     }
 
-    // Update visit history
-    recentVertices.push_back(currVertex);
-    if (recentVertices.size() > MAX_HISTORY) {
-        recentVertices.pop_front();
-    }
-
-    // Apply selected edge
-    currEdge = selectedEdge;
-    previousVertex = currVertex;
-    nextVertex = boost::target(currEdge, graph);
-    edgeLength = graph[currEdge].distance;
-    positionOnEdge = 0.0;
-
+    applyEdge(selectedEdge);
     return nextVertex;
 }
 
@@ -165,23 +213,17 @@ void Vehicule::update(double deltaTime) {
         pickNextEdge();
     }
 
-    // Stocker la position actuelle avant le mouvement
-    auto [prevLat, prevLon] = getPosition();
+    // Position sur l'arête avant le mouvement (pour savoir si le véhicule avance)
+    double prevPositionOnEdge = positionOnEdge;
 
     // advance along the current edge
     positionOnEdge += speed * deltaTime;
-
-    // Récupérer la nouvelle position après le mouvement
-    auto [currLat, currLon] = getPosition();
-    
-    // Calculer le heading basé sur le vecteur de mouvement réel
-    double dLat = currLat - prevLat;
-    double dLon = currLon - prevLon;
     
-    // Vérifier qu'il y a eu un mouvement significatif
-    if (std::abs(dLat) > 1e-10 || std::abs(dLon) > 1e-10) {
+    // Heading = direction précalculée de l'arête courante (sans relire le graphe)
+    bool moving = edgeLength > 0.0 && prevPositionOnEdge < edgeLength && positionOnEdge > prevPositionOnEdge;
+    if (moving && (edgeDirEast != 0.0 || edgeDirNorth != 0.0)) {
         // Calculer l'angle : 0° = north, 90° = east
-        double angleRad = std::atan2(dLon, dLat);
+        double angleRad = std::atan2(edgeDirEast, edgeDirNorth);
         targetHeading = angleRad * 180.0 / M_PI;
         
         // Normaliser l'angle entre 0 et 360
@@ -232,21 +274,85 @@ std::pair<double,double> Vehicule::getPosition() const {
         return {vd.lat, vd.lon};
     }
 
-    Vertex s = boost::source(currEdge, graph);
-    Vertex t = boost::target(currEdge, graph);
-    const auto& sd = graph[s];
-    const auto& td = graph[t];
-
     double tparam = positionOnEdge / edgeLength;
     if (tparam < 0) tparam = 0;
     if (tparam > 1) tparam = 1;
 
-    double lat = sd.lat + tparam * (td.lat - sd.lat);
-    double lon = sd.lon + tparam * (td.lon - sd.lon);
+    double lat = edgeFromLat + tparam * (edgeToLat - edgeFromLat);
+    double lon = edgeFromLon + tparam * (edgeToLon - edgeFromLon);
     return {lat, lon};
 }
 
-double Vehicule::calculateDist(Vehicule from) const{
+std::pair<Vertex, Vertex> Vehicule::getEdgeEndpoints() const {
+    if (edgeLength <= 0.0) {
+        return {currVertex, currVertex};
+    }
+    return {boost::source(currEdge, graph), boost::target(currEdge, graph)};
+}
+
+VehicleMotionState Vehicule::getMotionState() const {
+    VehicleMotionState state;
+    state.id = id;
+    state.start = start;
+    state.goal = goal;
+    state.currVertex = currVertex;
+    state.nextVertex = nextVertex;
+    state.previousVertex = previousVertex;
+    state.onEdge = edgeLength > 0.0;
+    state.positionOnEdge = positionOnEdge;
+    state.speed = speed;
+    state.transmissionRange = transmissionRange;
+    state.collisionDist = collisionDist;
+    state.heading = currentHeading;
+    state.rngState = rngState;
+    state.recentVertices = recentVertices;
+    state.recentCount = recentCount;
+    state.recentHead = recentHead;
+    state.stuckCounter = stuckCounter;
+    if (route && routeIndex < route->size()) {
+        state.route.assign(route->begin() + routeIndex, route->end());
+    }
+    state.routeRequested = routeRequested;
+    return state;
+}
+
+bool Vehicule::restoreMotionState(const VehicleMotionState& state) {
+    start = state.start;
+    goal = state.goal;
+    currVertex = state.currVertex;
+    speed = state.speed;
+    transmissionRange = state.transmissionRange;
+    collisionDist = state.collisionDist;
+    currentHeading = targetHeading = state.heading;
+    rngState = state.rngState;
+    if (!state.route.empty()) {
+        setRoute(std::make_shared<const std::vector<Vertex>>(state.route));
+    } else {
+        route.reset();
+        routeIndex = 0;
+        routeRequested = state.routeRequested;
+    }
+
+    Edge e;
+    const bool edgeFound = state.onEdge && RoutePlanner::findEdge(graph, currVertex, state.nextVertex, e);
+    if (edgeFound) {
+        applyEdge(e);
+    } else {
+        // No edge selected yet (or edge missing): one is picked at the next update
+        nextVertex = state.onEdge ? currVertex : state.nextVertex;
+        edgeLength = 0.0;
+    }
+    positionOnEdge = state.positionOnEdge;
+    previousVertex = state.previousVertex;
+    // After applyEdge, which records currVertex in the history
+    recentVertices = state.recentVertices;
+    recentCount = std::clamp(state.recentCount, 0, MAX_HISTORY);
+    recentHead = std::clamp(state.recentHead, 0, MAX_HISTORY - 1);
+    stuckCounter = state.stuckCounter;
+    return edgeFound || !state.onEdge;
+}
+
+double Vehicule::calculateDist(const Vehicule& from) const {
     auto [lat1, lon1] = getPosition();
     auto [lat2, lon2] = from.getPosition();
 
@@ -0,0 +1,287 @@
+#include "verlet_neighbor_list.h"
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include "parallel_for.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Mètres par degré de latitude (même approximation que InterferenceGraph)
+static constexpr double METERS_PER_DEG = 111000.0;
+
+void VerletNeighborList::clear() {
+    m_skin = 0.0;
+    m_ids.clear();
+    m_ranges.clear();
+    m_reference.clear();
+    m_offsets.clear();
+    m_candidates.clear();
+    m_inRange.clear();
+}
+
+void VerletNeighborList::update(const std::vector<VehicleSnapshot>& snapshots, int threads, Update& out) {
+    const int threadCount = resolveThreadCount(threads);
+    out.edges.assign(threadCount, EdgeList());
+    out.added.clear();
+    out.removed.clear();
+    out.comparisons = 0;
+    out.rebuilt = false;
+
+    if (snapshots.empty()) {
+        // Plus aucun véhicule: toutes les connexions disparaissent
+        out.removed = currentEdgeIds();
+        clear();
+        return;
+    }
+
+    ProjectedPositions projected;
+    project(snapshots, projected);
+
+    if (!needsRebuild(snapshots, projected)) {
+        testCandidates(projected, threadCount, true, out);
+        std::sort(out.added.begin(), out.added.end());
+        std::sort(out.removed.begin(), out.removed.end());
+        return;
+    }
+
+    // Reconstruction: les indices changent, on compare donc les connexions par IDs
+    const EdgeIdList previous = currentEdgeIds();
+    out.comparisons += rebuild(snapshots, threadCount);
+    out.rebuilt = true;
+    m_rebuildCount++;
+    testCandidates(m_reference, threadCount, false, out);
+
+    const EdgeIdList current = currentEdgeIds();
+    std::set_difference(current.begin(), current.end(), previous.begin(), previous.end(),
+                        std::back_inserter(out.added));
+    std::set_difference(previous.begin(), previous.end(), current.begin(), current.end(),
+                        std::back_inserter(out.removed));
+}
+
+void VerletNeighborList::project(const std::vector<VehicleSnapshot>& snapshots,
+                                 ProjectedPositions& projected) const {
+    projected.x.resize(snapshots.size());
+    projected.y.resize(snapshots.size());
+    projected.range.resize(snapshots.size());
+    for (size_t i = 0; i < snapshots.size(); ++i) {
+        projected.x[i] = static_cast<float>((snapshots[i].lon - m_originLon) * m_metersPerDegLon);
+        projected.y[i] = static_cast<float>((snapshots[i].lat - m_originLat) * METERS_PER_DEG);
+        projected.range[i] = static_cast<float>(snapshots[i].transmissionRange);
+    }
+}
+
+bool VerletNeighborList::needsRebuild(const std::vector<VehicleSnapshot>& snapshots,
+                                      const ProjectedPositions& projected) const {
+    if (snapshots.size() != m_ids.size()) return true;
+
+    // Deux véhicules ayant chacun parcouru au plus skin/2 ne peuvent pas s'être
+    // rapprochés de plus de skin: une paire hors des candidats reste hors de portée
+    const float maxDisplacement = static_cast<float>(m_skin / 2.0);
+    const float maxDisplacementSq = maxDisplacement * maxDisplacement;
+    for (size_t i = 0; i < snapshots.size(); ++i) {
+        if (snapshots[i].id != m_ids[i] || snapshots[i].transmissionRange != m_ranges[i]) return true;
+        const float dx = projected.x[i] - m_reference.x[i];
+        const float dy = projected.y[i] - m_reference.y[i];
+        if (dx * dx + dy * dy > maxDisplacementSq) return true;
+    }
+    return false;
+}
+
+int64_t VerletNeighborList::rebuild(const std::vector<VehicleSnapshot>& snapshots, int threads) {
+    const size_t n = snapshots.size();
+
+    // Nouvelle origine au centre de l'emprise, gardée jusqu'à la prochaine reconstruction
+    double minLat = snapshots[0].lat, maxLat = snapshots[0].lat;
+    double minLon = snapshots[0].lon, maxLon = snapshots[0].lon;
+    double maxRange = 0.0;
+    for (const auto& snap : snapshots) {
+        minLat = std::min(minLat, snap.lat);
+        maxLat = std::max(maxLat, snap.lat);
+        minLon = std::min(minLon, snap.lon);
+        maxLon = std::max(maxLon, snap.lon);
+        maxRange = std::max(maxRange, snap.transmissionRange);
+    }
+    m_originLat = (minLat + maxLat) / 2.0;
+    m_originLon = (minLon + maxLon) / 2.0;
+    m_metersPerDegLon = METERS_PER_DEG * std::cos(m_originLat * M_PI / 180.0);
+    m_skin = m_skinFraction * maxRange;
+
+    m_ids.resize(n);
+    m_ranges.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        m_ids[i] = snapshots[i].id;
+        m_ranges[i] = snapshots[i].transmissionRange;
+    }
+    project(snapshots, m_reference);
+
+    m_offsets.assign(n + 1, 0);
+    m_candidates.clear();
+    m_inRange.clear();
+    const double cellSize0 = maxRange + m_skin;
+    if (cellSize0 <= 0.0) {
+        return 0;
+    }
+
+    // Portées élargies de la marge: min(ri + skin, rj + skin) = min(ri, rj) + skin
+    ProjectedPositions inflated = m_reference;
+    for (float& r : inflated.range) r += static_cast<float>(m_skin);
+
+    float minX = inflated.x[0], minY = inflated.y[0], maxX = inflated.x[0], maxY = inflated.y[0];
+    for (size_t i = 0; i < n; ++i) {
+        minX = std::min(minX, inflated.x[i]);
+        maxX = std::max(maxX, inflated.x[i]);
+        minY = std::min(minY, inflated.y[i]);
+        maxY = std::max(maxY, inflated.y[i]);
+    }
+
+    // Cellule = portée max + marge, agrandie si la zone est immense par rapport à la flotte
+    const size_t maxCells = std::max<size_t>(4 * n, 4096);
+    double cellSize = cellSize0;
+    size_t cols = 0, rows = 0;
+    while (true) {
+        cols = static_cast<size_t>((maxX - minX) / cellSize) + 1;
+        rows = static_cast<size_t>((maxY - minY) / cellSize) + 1;
+        if (cols * rows <= maxCells) break;
+        cellSize *= 2.0;
+    }
+    const size_t numCells = cols * rows;
+
+    // Counting sort des véhicules par cellule
+    std::vector<int> cellOf(n);
+    std::vector<int> cellStart(numCells + 1, 0);
+    for (size_t i = 0; i < n; ++i) {
+        size_t cx = std::min(cols - 1, static_cast<size_t>((inflated.x[i] - minX) / cellSize));
+        size_t cy = std::min(rows - 1, static_cast<size_t>((inflated.y[i] - minY) / cellSize));
+        cellOf[i] = static_cast<int>(cy * cols + cx);
+        cellStart[cellOf[i] + 1]++;
+    }
+    for (size_t c = 0; c < numCells; ++c) {
+        cellStart[c + 1] += cellStart[c];
+    }
+    std::vector<int> sorted(n);
+    std::vector<int> fillPos(cellStart.begin(), cellStart.end() - 1);
+    for (size_t i = 0; i < n; ++i) {
+        sorted[fillPos[cellOf[i]]++] = static_cast<int>(i);
+    }
+    ProjectedPositions sortedPos;
+    sortedPos.gather(inflated, sorted);
+
+    std::vector<int> occupiedCells;
+    for (size_t k = 0; k < n; k = cellStart[cellOf[sorted[k]] + 1]) {
+        occupiedCells.push_back(cellOf[sorted[k]]);
+    }
+
+    std::vector<EdgeList> buffers(threads);
+    std::vector<int64_t> comparisons(threads, 0);
+    static const int halfNeighborhood[4][2] = {{1, 0}, {-1, 1}, {0, 1}, {1, 1}};
+
+    parallelFor(occupiedCells.size(), threads, 16, [&](size_t first, size_t last, int worker) {
+        auto testRange = [&](int a, int candBegin, int candEnd) {
+            if (candBegin >= candEnd) return;
+            comparisons[worker] += candEnd - candBegin;
+            DistanceKernel::forEachInRange(sortedPos.x[a], sortedPos.y[a], sortedPos.range[a],
+                                           sortedPos, candBegin, candEnd, [&](size_t b) {
+                buffers[worker].emplace_back(std::min(sorted[a], sorted[b]), std::max(sorted[a], sorted[b]));
+            });
+        };
+
+        for (size_t c = first; c < last; ++c) {
+            const int cell = occupiedCells[c];
+            const int begin = cellStart[cell];
+            const int end = cellStart[cell + 1];
+            const long cx = cell % static_cast<long>(cols);
+            const long cy = cell / static_cast<long>(cols);
+
+            for (int a = begin; a < end; ++a) {
+                testRange(a, a + 1, end);
+            }
+            for (const auto& offset : halfNeighborhood) {
+                const long nx = cx + offset[0];
+                const long ny = cy + offset[1];
+                if (nx < 0 || ny < 0 || nx >= static_cast<long>(cols) || ny >= static_cast<long>(rows)) continue;
+
+                const size_t neighborCell = ny * cols + nx;
+                for (int a = begin; a < end; ++a) {
+                    testRange(a, cellStart[neighborCell], cellStart[neighborCell + 1]);
+                }
+            }
+        }
+    });
+
+    // CSR des candidats par plus petit indice, chaque ligne triée
+    for (const auto& buffer : buffers) {
+        for (const auto& pair : buffer) m_offsets[pair.first + 1]++;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        m_offsets[i + 1] += m_offsets[i];
+    }
+    m_candidates.resize(m_offsets[n]);
+    std::vector<int> rowFill(m_offsets.begin(), m_offsets.end() - 1);
+    for (const auto& buffer : buffers) {
+        for (const auto& [i, j] : buffer) m_candidates[rowFill[i]++] = j;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        std::sort(m_candidates.begin() + m_offsets[i], m_candidates.begin() + m_offsets[i + 1]);
+    }
+    m_inRange.assign(m_candidates.size(), 0);
+
+    int64_t total = 0;
+    for (int64_t c : comparisons) total += c;
+    return total;
+}
+
+EdgeIdList VerletNeighborList::currentEdgeIds() const {
+    EdgeIdList edges;
+    const size_t n = m_ids.size();
+    for (size_t i = 0; i < n; ++i) {
+        for (int k = m_offsets[i]; k < m_offsets[i + 1]; ++k) {
+            if (!m_inRange[k]) continue;
+            const int a = m_ids[i];
+            const int b = m_ids[m_candidates[k]];
+            edges.emplace_back(std::min(a, b), std::max(a, b));
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+    return edges;
+}
+
+void VerletNeighborList::testCandidates(const ProjectedPositions& projected, int threads,
+                                        bool emitDeltas, Update& out) {
+    const size_t n = m_ids.size();
+    std::vector<EdgeIdList> added(threads);
+    std::vector<EdgeIdList> removed(threads);
+
+    // Chaque ligne écrit ses propres cases de m_inRange: pas de verrou
+    parallelFor(n, threads, 256, [&](size_t begin, size_t end, int worker) {
+        EdgeList& edges = out.edges[worker];
+        for (size_t i = begin; i < end; ++i) {
+            const float xi = projected.x[i];
+            const float yi = projected.y[i];
+            const float ri = projected.range[i];
+            for (int k = m_offsets[i]; k < m_offsets[i + 1]; ++k) {
+                const int j = m_candidates[k];
+                const float dx = projected.x[j] - xi;
+                const float dy = projected.y[j] - yi;
+                const float r = std::min(ri, projected.range[j]);
+                const uint8_t inRange = dx * dx + dy * dy <= r * r;
+                if (inRange) {
+                    edges.emplace_back(static_cast<int>(i), j);
+                }
+                if (emitDeltas && inRange != m_inRange[k]) {
+                    const int a = m_ids[i];
+                    const int b = m_ids[j];
+                    (inRange ? added : removed)[worker].emplace_back(std::min(a, b), std::max(a, b));
+                }
+                m_inRange[k] = inRange;
+            }
+        }
+    });
+    out.comparisons += static_cast<int64_t>(m_candidates.size());
+
+    for (int w = 0; w < threads; ++w) {
+        out.added.insert(out.added.end(), added[w].begin(), added[w].end());
+        out.removed.insert(out.removed.end(), removed[w].begin(), removed[w].end());
+    }
+}